@@ -234,6 +234,9 @@ struct smart_struct_s
   uint32_t              erasesize;        /* Size of an erase block */
   FAR uint8_t          *releasecount;     /* Count of released sectors per erase block */
   FAR uint8_t          *freecount;        /* Count of free sectors per erase block */
+#ifdef CONFIG_MTD_SMART_FREEMAP
+  FAR uint8_t          *freemap;          /* Bitmap of erased physical sectors */
+#endif
   FAR char             *rwbuffer;         /* Our sector read/write buffer */
   char                  partname[SMART_PARTNAME_SIZE]; /* Optional partition name */
   uint8_t               formatversion;    /* Format version on the device */
@@ -674,6 +677,137 @@ static void smart_add_count(struct smart_struct_s *dev, uint8_t *pCount,
 }
 #endif
 
+/****************************************************************************
+ * Name: smart_header_erased
+ *
+ * Description: Test if a physical sector header is still in the erased
+ *              state, i.e. the sector has never been written since the
+ *              last erase and may be allocated.
+ *
+ ****************************************************************************/
+
+static inline bool smart_header_erased(FAR struct smart_sect_header_s *header)
+{
+  return (*((FAR uint16_t *) header->logicalsector) == 0xffff) &&
+#if SMART_STATUS_VERSION == 1
+         (*((FAR uint16_t *) &header->seq) == 0xffff) &&
+#else
+         (header->seq == CONFIG_SMARTFS_ERASEDSTATE) &&
+#endif
+         ((header->status & SMART_STATUS_COMMITTED) ==
+          (CONFIG_SMARTFS_ERASEDSTATE & SMART_STATUS_COMMITTED));
+}
+
+/****************************************************************************
+ * Name: smart_freemap_set
+ *
+ * Description: Mark a physical sector as erased in the free sector bitmap.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_FREEMAP
+static inline void smart_freemap_set(FAR struct smart_struct_s *dev,
+                                     uint16_t sector)
+{
+  dev->freemap[sector >> 3] |= 1 << (sector & 7);
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_freemap_setblock
+ *
+ * Description: Mark every usable physical sector in the specified erase
+ *              block as erased in the free sector bitmap.  Called after the
+ *              erase block has been erased.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_FREEMAP
+static void smart_freemap_setblock(FAR struct smart_struct_s *dev,
+                                   uint16_t block)
+{
+  uint32_t sector;
+  uint32_t end;
+
+  sector = (uint32_t)block * dev->sectorsPerBlk;
+  end    = sector + dev->availSectPerBlk;
+  if (end > dev->totalsectors)
+    {
+      end = dev->totalsectors;
+    }
+
+  for (; sector < end; sector++)
+    {
+      smart_freemap_set(dev, sector);
+    }
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_freemap_clear
+ *
+ * Description: Remove a physical sector from the free sector bitmap.  This
+ *              must be done whenever a sector is handed out for writing.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_FREEMAP
+static inline void smart_freemap_clear(FAR struct smart_struct_s *dev,
+                                       uint16_t sector)
+{
+  dev->freemap[sector >> 3] &= ~(1 << (sector & 7));
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_freemap_find
+ *
+ * Description: Return the first physical sector in the specified erase block
+ *              that is marked as erased in the free sector bitmap, or 0xffff
+ *              if there is none.  Whole bytes of the bitmap are skipped at a
+ *              time, so no media access is needed to locate a free sector.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_FREEMAP
+static uint16_t smart_freemap_find(FAR struct smart_struct_s *dev,
+                                   uint16_t block)
+{
+  uint32_t sector;
+  uint32_t end;
+  uint8_t  bits;
+
+  sector = (uint32_t)block * dev->sectorsPerBlk;
+  end    = sector + dev->availSectPerBlk;
+  if (end > dev->totalsectors)
+    {
+      end = dev->totalsectors;
+    }
+
+  while (sector < end)
+    {
+      bits = dev->freemap[sector >> 3] >> (sector & 7);
+      if (bits == 0)
+        {
+          /* Nothing free in the rest of this byte */
+
+          sector = (sector | 7) + 1;
+          continue;
+        }
+
+      while ((bits & 1) == 0)
+        {
+          bits >>= 1;
+          sector++;
+        }
+
+      return sector < end ? (uint16_t)sector : 0xffff;
+    }
+
+  return 0xffff;
+}
+#endif
+
 /****************************************************************************
  * Name: smart_checkfree
  *
@@ -890,6 +1024,21 @@ static ssize_t smart_write(FAR struct inode *inode,
 
   finfo("mtdsector: %d mtdnsectors: %d\n", mtdstartblock, mtdblockcount);
 
+#ifdef CONFIG_MTD_SMART_FREEMAP
+  /* The raw write bypasses sector allocation.  Forget anything we knew
+   * about the free sectors being overwritten; the allocator will re-read
+   * their headers if it needs them.
+   */
+
+  for (offset = 0; offset < nsectors; offset++)
+    {
+      if (start_sector + offset < dev->totalsectors)
+        {
+          smart_freemap_clear(dev, start_sector + offset);
+        }
+    }
+#endif
+
   /* Start at first block to be written */
 
   remaining = mtdblockcount;
@@ -1101,6 +1250,14 @@ static int smart_setsectorsize(FAR struct smart_struct_s *dev, uint16_t size)
       dev->rwbuffer = NULL;
     }
 
+#ifdef CONFIG_MTD_SMART_FREEMAP
+  if (dev->freemap != NULL)
+    {
+      smart_free(dev, dev->freemap);
+      dev->freemap = NULL;
+    }
+#endif
+
 #ifdef CONFIG_MTD_SMART_WEAR_LEVEL
   if (dev->wearstatus != NULL)
     {
@@ -1211,6 +1368,20 @@ static int smart_setsectorsize(FAR struct smart_struct_s *dev, uint16_t size)
 
 #endif  /* CONFIG_MTD_SMART_MINIMIZE_RAM */
 
+#ifdef CONFIG_MTD_SMART_FREEMAP
+  /* Allocate the free physical sector bitmap.  Nothing is known to be free
+   * until the volume is scanned or formatted.
+   */
+
+  dev->freemap = (FAR uint8_t *) smart_zalloc(dev, (totalsectors + 7) >> 3,
+                                              "Free map");
+  if (!dev->freemap)
+    {
+      ferr("ERROR: Error allocating free sector bitmap\n");
+      goto errexit;
+    }
+#endif
+
 #ifdef CONFIG_MTD_SMART_SECTOR_ERASE_DEBUG
   /* Allocate a buffer to hold the erase counts */
 
@@ -1283,6 +1454,14 @@ errexit:
     }
 #endif
 
+#ifdef CONFIG_MTD_SMART_FREEMAP
+  if (dev->freemap)
+    {
+      smart_free(dev, dev->freemap);
+      dev->freemap = NULL;
+    }
+#endif
+
 #ifdef CONFIG_MTD_SMART_WEAR_LEVEL
   if (dev->wearstatus)
     {
@@ -1950,6 +2129,12 @@ static int smart_scan(FAR struct smart_struct_s *dev)
   memset(dev->sBitMap, 0, (dev->totalsectors + 7) >> 3);
 #endif
 
+#ifdef CONFIG_MTD_SMART_FREEMAP
+  /* The free sector bitmap is rebuilt from the sector headers below */
+
+  memset(dev->freemap, 0, (dev->totalsectors + 7) >> 3);
+#endif
+
   /* Now scan the MTD device */
 
   for (sector = 0; sector < totalsectors; sector++)
@@ -1984,6 +2169,12 @@ static int smart_scan(FAR struct smart_struct_s *dev)
       if ((header.status & SMART_STATUS_COMMITTED) ==
               (CONFIG_SMARTFS_ERASEDSTATE & SMART_STATUS_COMMITTED))
         {
+#ifdef CONFIG_MTD_SMART_FREEMAP
+          if (smart_header_erased(&header))
+            {
+              smart_freemap_set(dev, sector);
+            }
+#endif
           continue;
         }
 
@@ -2505,6 +2696,9 @@ static void smart_erase_block_if_empty(FAR struct smart_struct_s *dev,
       dev->blockerases++;
 #endif
       MTD_ERASE(dev->mtd, block, 1);
+#ifdef CONFIG_MTD_SMART_FREEMAP
+      smart_freemap_setblock(dev, block);
+#endif
 
 #ifdef CONFIG_MTD_SMART_SECTOR_ERASE_DEBUG
       if (dev->erasecounts)
@@ -2764,6 +2958,9 @@ static int smart_relocate_static_data(FAR struct smart_struct_s *dev, uint16_t b
             }
 
           dev->freesectors--;
+#ifdef CONFIG_MTD_SMART_FREEMAP
+          smart_freemap_clear(dev, newsector);
+#endif
 
 #ifndef CONFIG_MTD_SMART_MINIMIZE_RAM
           dev->sMap[*((FAR uint16_t *) header->logicalsector)] = newsector;
@@ -3055,6 +3252,17 @@ static inline int smart_llformat(FAR struct smart_struct_s *dev, unsigned long a
   dev->freecount[0]--;
 #endif
 
+#ifdef CONFIG_MTD_SMART_FREEMAP
+  /* Everything but the format sector is now erased */
+
+  for (x = 0; x < dev->neraseblocks; x++)
+    {
+      smart_freemap_setblock(dev, x);
+    }
+
+  smart_freemap_clear(dev, 0);
+#endif
+
   /* Now initialize the logical to physical sector map */
 
 #ifndef CONFIG_MTD_SMART_MINIMIZE_RAM
@@ -3381,6 +3589,9 @@ static int smart_relocate_block(FAR struct smart_struct_s *dev, uint16_t block)
   /* Now erase the erase block */
 
   MTD_ERASE(dev->mtd, block, 1);
+#ifdef CONFIG_MTD_SMART_FREEMAP
+  smart_freemap_setblock(dev, block);
+#endif
 #if defined(CONFIG_FS_PROCFS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_SMARTFS)
   dev->unusedsectors += freecount;
   dev->blockerases++;
@@ -3630,6 +3841,21 @@ retry:
   /* Now find a free physical sector within this selected
    * erase block to allocate. */
 
+#ifdef CONFIG_MTD_SMART_FREEMAP
+  /* The free sector bitmap normally knows the answer without touching the
+   * media.  Fall back to reading the sector headers only if the bitmap has
+   * lost track of the free sectors in this block (e.g. after a raw block
+   * write or an abandoned temporary allocation).
+   */
+
+  physicalsector = smart_freemap_find(dev, allocblock);
+  if (physicalsector != 0xffff)
+    {
+      dev->lastallocblock = allocblock;
+      goto found;
+    }
+#endif
+
   for (x = allocblock * dev->sectorsPerBlk;
        x < allocblock * dev->sectorsPerBlk + dev->availSectPerBlk; x++)
     {
@@ -3673,14 +3899,7 @@ retry:
           return -1;
         }
 
-      if ((*((FAR uint16_t *) header.logicalsector) == 0xffff) &&
-#if SMART_STATUS_VERSION == 1
-          (*((FAR uint16_t *) &header.seq) == 0xffff) &&
-#else
-          (header.seq == CONFIG_SMARTFS_ERASEDSTATE) &&
-#endif
-          ((header.status & SMART_STATUS_COMMITTED) ==
-           (CONFIG_SMARTFS_ERASEDSTATE & SMART_STATUS_COMMITTED)))
+      if (smart_header_erased(&header))
         {
           physicalsector = x;
           dev->lastallocblock = allocblock;
@@ -3688,6 +3907,16 @@ retry:
         }
     }
 
+#ifdef CONFIG_MTD_SMART_FREEMAP
+found:
+  if (physicalsector != 0xffff)
+    {
+      /* The caller is about to write this sector */
+
+      smart_freemap_clear(dev, physicalsector);
+    }
+#endif
+
   if (physicalsector == 0xffff)
     {
       ferr("ERROR: Program bug!  Expected a free sector\n");
@@ -5488,6 +5717,9 @@ errout:
   smart_free(dev, dev->sCache);
 #endif
   smart_free(dev, dev->rwbuffer);
+#ifdef CONFIG_MTD_SMART_FREEMAP
+  smart_free(dev, dev->freemap);
+#endif
 #ifdef CONFIG_MTD_SMART_WEAR_LEVEL
   smart_free(dev, dev->wearstatus);
 #endif
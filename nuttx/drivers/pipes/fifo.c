@@ -1,7 +1,7 @@
 /****************************************************************************
  * drivers/pipes/fifo.c
  *
- *   Copyright (C) 2008-2009, 2014-2015 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2008-2009, 2014-2015, 2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -67,8 +67,10 @@ static const struct file_operations fifo_fops =
   pipecommon_poll,  /* poll */
 #endif
 #ifndef CONFIG_DISABLE_PSEUDOFS_OPERATIONS
-  pipecommon_unlink /* unlink */
+  pipecommon_unlink, /* unlink */
 #endif
+  pipecommon_readv, /* readv */
+  pipecommon_writev /* writev */
 };
 
 /****************************************************************************
@@ -1,7 +1,7 @@
 /****************************************************************************
  * drivers/pipes/pipe.c
  *
- *   Copyright (C) 2008-2009, 2015 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2008-2009, 2015, 2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -86,8 +86,10 @@ static const struct file_operations pipe_fops =
   pipecommon_poll,   /* poll */
 #endif
 #ifndef CONFIG_DISABLE_PSEUDOFS_OPERATIONS
-  pipecommon_unlink  /* unlink */
+  pipecommon_unlink, /* unlink */
 #endif
+  pipecommon_readv,  /* readv */
+  pipecommon_writev  /* writev */
 };
 
 static sem_t  g_pipesem       = SEM_INITIALIZER(1);
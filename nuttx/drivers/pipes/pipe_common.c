@@ -1,7 +1,8 @@
 /****************************************************************************
  * drivers/pipes/pipe_common.c
  *
- *   Copyright (C) 2008-2009, 2011, 2015-2016 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2008-2009, 2011, 2015-2016, 2018 Gregory Nutt. All rights
+ *     reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -42,6 +43,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/ioctl.h>
+#include <sys/uio.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdlib.h>
@@ -60,6 +62,10 @@
 #include <nuttx/semaphore.h>
 #include <nuttx/fs/fs.h>
 #include <nuttx/fs/ioctl.h>
+#include <nuttx/drivers/drivers.h>
+#ifdef CONFIG_MM_IOB
+#  include <nuttx/mm/iob.h>
+#endif
 
 #include "pipe_common.h"
 
@@ -79,6 +85,10 @@
 #  define pipe_dumpbuffer(m,a,n)
 #endif
 
+#ifndef MIN
+#  define MIN(a,b) ((a) < (b) ? (a) : (b))
+#endif
+
 /****************************************************************************
  * Private Function Prototypes
  ****************************************************************************/
@@ -112,6 +122,404 @@ static void pipecommon_semtake(FAR sem_t *sem)
   while (ret == -EINTR);
 }
 
+/****************************************************************************
+ * Name: pipecommon_nbytes
+ *
+ * Description:
+ *   Return the number of bytes of data held in the pipe.  The caller must
+ *   hold d_bfsem.
+ *
+ ****************************************************************************/
+
+static size_t pipecommon_nbytes(FAR struct pipe_dev_s *dev)
+{
+#ifdef CONFIG_DEV_PIPE_IOB
+  return dev->d_iob != NULL ? dev->d_iob->io_pktlen : 0;
+#else
+  /*   d_rdndx - index to remove next byte from the buffer
+   *   d_wrndx - Index to next location to add a byte to the buffer.
+   */
+
+  if (dev->d_wrndx < dev->d_rdndx)
+    {
+      return (dev->d_bufsize - dev->d_rdndx) + dev->d_wrndx;
+    }
+
+  return dev->d_wrndx - dev->d_rdndx;
+#endif
+}
+
+/****************************************************************************
+ * Name: pipecommon_capacity
+ *
+ * Description:
+ *   Return the maximum number of bytes that the pipe can hold.
+ *
+ ****************************************************************************/
+
+static size_t pipecommon_capacity(FAR struct pipe_dev_s *dev)
+{
+#ifdef CONFIG_DEV_PIPE_IOB
+  return dev->d_bufsize;
+#else
+  /* One byte of the circular buffer is always left unused so that a full
+   * buffer can be distinguished from an empty one.
+   */
+
+  return dev->d_bufsize - 1;
+#endif
+}
+
+/****************************************************************************
+ * Name: pipecommon_nspace
+ *
+ * Description:
+ *   Return the number of bytes that can still be written to the pipe.  The
+ *   caller must hold d_bfsem.
+ *
+ ****************************************************************************/
+
+static size_t pipecommon_nspace(FAR struct pipe_dev_s *dev)
+{
+  return pipecommon_capacity(dev) - pipecommon_nbytes(dev);
+}
+
+/****************************************************************************
+ * Name: pipecommon_bufpeek
+ *
+ * Description:
+ *   Copy up to 'len' bytes of pipe data, starting 'offset' bytes from the
+ *   oldest byte in the pipe, into 'buffer' without removing them from the
+ *   pipe.  The caller must hold d_bfsem.
+ *
+ * Returned Value:
+ *   The number of bytes copied.
+ *
+ ****************************************************************************/
+
+static size_t pipecommon_bufpeek(FAR struct pipe_dev_s *dev,
+                                 FAR uint8_t *buffer, size_t len,
+                                 size_t offset)
+{
+  size_t nbytes = pipecommon_nbytes(dev);
+#ifndef CONFIG_DEV_PIPE_IOB
+  size_t ndx;
+  size_t nfirst;
+#endif
+
+  if (offset >= nbytes)
+    {
+      return 0;
+    }
+
+  if (len > nbytes - offset)
+    {
+      len = nbytes - offset;
+    }
+
+#ifdef CONFIG_DEV_PIPE_IOB
+  return iob_copyout(buffer, dev->d_iob, len, offset);
+#else
+  ndx = dev->d_rdndx + offset;
+  if (ndx >= dev->d_bufsize)
+    {
+      ndx -= dev->d_bufsize;
+    }
+
+  /* The data is in at most two pieces:  From the read index up to the end
+   * of the circular buffer and then from the beginning of the buffer.
+   */
+
+  nfirst = dev->d_bufsize - ndx;
+  if (nfirst >= len)
+    {
+      memcpy(buffer, &dev->d_buffer[ndx], len);
+    }
+  else
+    {
+      memcpy(buffer, &dev->d_buffer[ndx], nfirst);
+      memcpy(buffer + nfirst, dev->d_buffer, len - nfirst);
+    }
+
+  return len;
+#endif
+}
+
+/****************************************************************************
+ * Name: pipecommon_bufdiscard
+ *
+ * Description:
+ *   Remove 'len' bytes (no more than pipecommon_nbytes()) from the head of
+ *   the pipe data.  The caller must hold d_bfsem.
+ *
+ ****************************************************************************/
+
+static void pipecommon_bufdiscard(FAR struct pipe_dev_s *dev, size_t len)
+{
+#ifdef CONFIG_DEV_PIPE_IOB
+  if (dev->d_iob != NULL && len > 0)
+    {
+      /* Emptied I/O buffers are freed by iob_trimhead() except for the last
+       * one.  Free that too if the pipe is now empty so that an idle pipe
+       * holds no I/O buffers at all.
+       */
+
+      dev->d_iob = iob_trimhead(dev->d_iob, len);
+      if (dev->d_iob->io_pktlen == 0)
+        {
+          iob_free_chain(dev->d_iob);
+          dev->d_iob = NULL;
+        }
+    }
+#else
+  size_t ndx = dev->d_rdndx + len;
+
+  if (ndx >= dev->d_bufsize)
+    {
+      ndx -= dev->d_bufsize;
+    }
+
+  dev->d_rdndx = ndx;
+#endif
+}
+
+/****************************************************************************
+ * Name: pipecommon_bufwrite
+ *
+ * Description:
+ *   Append up to 'len' bytes from 'buffer' to the pipe data, as many as
+ *   there is space for.  The caller must hold d_bfsem.
+ *
+ * Returned Value:
+ *   The number of bytes added to the pipe.  With I/O buffer backed pipes
+ *   this may be less than the available space if the I/O buffer pool is
+ *   exhausted.
+ *
+ ****************************************************************************/
+
+static size_t pipecommon_bufwrite(FAR struct pipe_dev_s *dev,
+                                  FAR const uint8_t *buffer, size_t len)
+{
+  size_t nspace = pipecommon_nspace(dev);
+#ifdef CONFIG_DEV_PIPE_IOB
+  size_t nbytes;
+#else
+  size_t ndx;
+  size_t nfirst;
+#endif
+
+  if (len > nspace)
+    {
+      len = nspace;
+    }
+
+#ifdef CONFIG_DEV_PIPE_IOB
+  if (len == 0)
+    {
+      return 0;
+    }
+
+  if (dev->d_iob == NULL)
+    {
+      dev->d_iob = iob_tryalloc(false);
+      if (dev->d_iob == NULL)
+        {
+          return 0;
+        }
+    }
+
+  /* iob_trycopyin() extends the chain as needed but may stop part way
+   * through if it runs out of I/O buffers.  The packet length always
+   * reflects the data actually copied in.
+   */
+
+  nbytes = dev->d_iob->io_pktlen;
+  (void)iob_trycopyin(dev->d_iob, buffer, len, nbytes, false);
+  return dev->d_iob->io_pktlen - nbytes;
+#else
+  /* Copy in at most two pieces, wrapping around at the end of the circular
+   * buffer.
+   */
+
+  ndx    = dev->d_wrndx;
+  nfirst = dev->d_bufsize - ndx;
+
+  if (nfirst > len)
+    {
+      memcpy(&dev->d_buffer[ndx], buffer, len);
+      ndx += len;
+    }
+  else
+    {
+      memcpy(&dev->d_buffer[ndx], buffer, nfirst);
+      memcpy(dev->d_buffer, buffer + nfirst, len - nfirst);
+      ndx = len - nfirst;
+    }
+
+  dev->d_wrndx = ndx;
+  return len;
+#endif
+}
+
+/****************************************************************************
+ * Name: pipecommon_buffree
+ *
+ * Description:
+ *   Discard all pipe data and release the memory that holds it.
+ *
+ ****************************************************************************/
+
+static void pipecommon_buffree(FAR struct pipe_dev_s *dev)
+{
+#ifdef CONFIG_DEV_PIPE_IOB
+  if (dev->d_iob != NULL)
+    {
+      iob_free_chain(dev->d_iob);
+      dev->d_iob = NULL;
+    }
+#else
+  if (dev->d_buffer != NULL)
+    {
+      kmm_free(dev->d_buffer);
+      dev->d_buffer = NULL;
+    }
+
+  dev->d_wrndx = 0;
+  dev->d_rdndx = 0;
+#endif
+}
+
+/****************************************************************************
+ * Name: pipecommon_iobwait
+ *
+ * Description:
+ *   The pipe is empty but no I/O buffer could be allocated to hold new
+ *   data.  Wait (without holding d_bfsem) for an I/O buffer to be freed and
+ *   make it the head of the pipe data.  Called and returns with d_bfsem
+ *   held.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_DEV_PIPE_IOB
+static void pipecommon_iobwait(FAR struct pipe_dev_s *dev)
+{
+  FAR struct iob_s *iob;
+
+  nxsem_post(&dev->d_bfsem);
+  iob = iob_alloc(false);
+  pipecommon_semtake(&dev->d_bfsem);
+
+  if (dev->d_iob == NULL)
+    {
+      dev->d_iob = iob;
+    }
+  else
+    {
+      iob_free(iob);
+    }
+}
+#endif
+
+/****************************************************************************
+ * Name: pipecommon_rdready
+ *
+ * Description:
+ *   Return true if a reader of 'len' bytes should take the data in the pipe
+ *   now rather than wait for more:  Either there is enough data for the
+ *   read or the read watermark has been reached, or there is some data but
+ *   no more will come soon (there are no writers or a writer is waiting
+ *   for space).  poll() passes the read watermark as 'len'.  The caller
+ *   must hold d_bfsem.
+ *
+ ****************************************************************************/
+
+static bool pipecommon_rdready(FAR struct pipe_dev_s *dev, size_t len)
+{
+  size_t nbytes = pipecommon_nbytes(dev);
+  int sval;
+
+  if (nbytes >= MIN(len, (size_t)dev->d_rdwm))
+    {
+      return true;
+    }
+
+  return nbytes > 0 &&
+         (dev->d_nwriters <= 0 ||
+          (nxsem_getvalue(&dev->d_wrsem, &sval) == 0 && sval < 0));
+}
+
+/****************************************************************************
+ * Name: pipecommon_rdwait
+ *
+ * Description:
+ *   Wait until there is data in the pipe:  At least 'len' bytes or as much
+ *   as the read watermark, whichever is less, unless the writers are
+ *   stalled or gone.  Called with d_bfsem held.
+ *
+ * Returned Value:
+ *   One if there is data in the pipe; d_bfsem is still held in this case.
+ *   Zero (end-of-file) if the pipe is empty and there are no writers or a
+ *   negated errno value on failure; d_bfsem has been released in these
+ *   cases.
+ *
+ ****************************************************************************/
+
+static int pipecommon_rdwait(FAR struct pipe_dev_s *dev, size_t len,
+                             bool nonblock)
+{
+  size_t need = MIN(len, (size_t)dev->d_rdwm);
+  int ret;
+
+  /* Wait until enough has been written to the pipe */
+
+  while (!pipecommon_rdready(dev, len))
+    {
+      /* If O_NONBLOCK was set, then return whatever is there or EGAIN */
+
+      if (nonblock)
+        {
+          if (pipecommon_nbytes(dev) > 0)
+            {
+              break;
+            }
+
+          nxsem_post(&dev->d_bfsem);
+          return -EAGAIN;
+        }
+
+      /* If the pipe is empty and there are no writers on the pipe, then
+       * return end of file.
+       */
+
+      if (dev->d_nwriters <= 0)
+        {
+          nxsem_post(&dev->d_bfsem);
+          return 0;
+        }
+
+      /* Otherwise, wait for something to be written to the pipe.  Let the
+       * writers know how much this read needs.
+       */
+
+      if (dev->d_rdmin == 0 || need < dev->d_rdmin)
+        {
+          dev->d_rdmin = (pipe_ndx_t)need;
+        }
+
+      sched_lock();
+      nxsem_post(&dev->d_bfsem);
+      ret = nxsem_wait(&dev->d_rdsem);
+      sched_unlock();
+
+      if (ret < 0 || (ret = nxsem_wait(&dev->d_bfsem)) < 0)
+        {
+          return ret;
+        }
+    }
+
+  return 1;
+}
+
 /****************************************************************************
  * Name: pipecommon_pollnotify
  ****************************************************************************/
@@ -154,6 +562,220 @@ static void pipecommon_pollnotify(FAR struct pipe_dev_s *dev,
 #  define pipecommon_pollnotify(dev,event)
 #endif
 
+/****************************************************************************
+ * Name: pipecommon_rdnotify
+ *
+ * Description:
+ *   Wake up the readers waiting for data and notify poll() waiters of
+ *   POLLIN.  Unless 'force' is true, this is only done once the read
+ *   watermark has been reached so that a reader is not woken up for each
+ *   small write.  Blocked readers are also woken up once there is enough
+ *   data for the smallest of their reads.  The caller must hold d_bfsem.
+ *
+ ****************************************************************************/
+
+static void pipecommon_rdnotify(FAR struct pipe_dev_s *dev, bool force)
+{
+  size_t nbytes = pipecommon_nbytes(dev);
+  int sval;
+
+  if (nbytes == 0)
+    {
+      return;
+    }
+
+  if (force || nbytes >= dev->d_rdwm ||
+      (dev->d_rdmin > 0 && nbytes >= dev->d_rdmin))
+    {
+      /* Notify all of the waiting readers that more data is available.
+       * Those that still need more will register again.
+       */
+
+      while (nxsem_getvalue(&dev->d_rdsem, &sval) == 0 && sval < 0)
+        {
+          nxsem_post(&dev->d_rdsem);
+        }
+
+      dev->d_rdmin = 0;
+    }
+
+  if (force || nbytes >= dev->d_rdwm)
+    {
+      /* Notify all poll/select waiters that they can read from the FIFO */
+
+      pipecommon_pollnotify(dev, POLLIN);
+    }
+}
+
+/****************************************************************************
+ * Name: pipecommon_wrnotify
+ *
+ * Description:
+ *   Wake up the writers waiting for space and notify poll() waiters of
+ *   POLLOUT once there is at least the write watermark of free space in the
+ *   pipe.  The caller must hold d_bfsem.
+ *
+ ****************************************************************************/
+
+static void pipecommon_wrnotify(FAR struct pipe_dev_s *dev)
+{
+  int sval;
+
+  if (pipecommon_nspace(dev) >= dev->d_wrwm)
+    {
+      /* Notify all waiting writers that bytes have been removed from the
+       * buffer.
+       */
+
+      while (nxsem_getvalue(&dev->d_wrsem, &sval) == 0 && sval < 0)
+        {
+          nxsem_post(&dev->d_wrsem);
+        }
+
+      /* Notify all poll/select waiters that they can write to the FIFO */
+
+      pipecommon_pollnotify(dev, POLLOUT);
+    }
+}
+
+/****************************************************************************
+ * Name: pipecommon_copychain
+ *
+ * Description:
+ *   Copy up to 'len' bytes of pipe data into the I/O buffer 'iob',
+ *   extending it with more I/O buffers as needed (and as available).  The
+ *   data is removed from the pipe unless 'peek' is true.  The caller must
+ *   hold d_bfsem.
+ *
+ * Returned Value:
+ *   The number of bytes copied.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_DEV_PIPE_SPLICE
+static size_t pipecommon_copychain(FAR struct pipe_dev_s *dev,
+                                   FAR struct iob_s *iob, size_t len,
+                                   bool peek)
+{
+  FAR struct iob_s *head = iob;
+  FAR struct iob_s *next;
+  size_t ncopied = 0;
+  size_t ncopy;
+
+  for (; ; )
+    {
+      ncopy = len - ncopied;
+      if (ncopy > IOB_BUFSIZE(iob))
+        {
+          ncopy = IOB_BUFSIZE(iob);
+        }
+
+      iob->io_len = pipecommon_bufpeek(dev, iob->io_data, ncopy, ncopied);
+      ncopied    += iob->io_len;
+
+      if (ncopied >= len ||
+          (next = iob_tryalloc_size(len - ncopied, false)) == NULL)
+        {
+          break;
+        }
+
+      iob->io_flink = next;
+      iob           = next;
+    }
+
+  head->io_pktlen = ncopied;
+
+  if (!peek)
+    {
+      pipecommon_bufdiscard(dev, ncopied);
+    }
+
+  return ncopied;
+}
+#endif
+
+/****************************************************************************
+ * Name: pipecommon_moveout
+ *
+ * Description:
+ *   Remove 'len' bytes (no more than pipecommon_nbytes()) from the head of
+ *   an I/O buffer backed pipe.  The I/O buffers that lie entirely within
+ *   those 'len' bytes are unlinked from the pipe and returned as they are;
+ *   only a partial I/O buffer at the end is copied (into 'iob').  The
+ *   caller must hold d_bfsem.
+ *
+ * Returned Value:
+ *   The I/O buffer chain holding the data.  'iob' is freed if it is not
+ *   needed.
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_DEV_PIPE_SPLICE) && defined(CONFIG_DEV_PIPE_IOB)
+static FAR struct iob_s *pipecommon_moveout(FAR struct pipe_dev_s *dev,
+                                            FAR struct iob_s *iob,
+                                            size_t len)
+{
+  FAR struct iob_s *head = NULL;
+  FAR struct iob_s *last = NULL;
+  FAR struct iob_s *next = dev->d_iob;
+  size_t nbytes = pipecommon_nbytes(dev);
+  size_t nmoved = 0;
+
+  /* Find the I/O buffers that can be moved whole */
+
+  while (next != NULL && nmoved + next->io_len <= len)
+    {
+      nmoved += next->io_len;
+      last    = next;
+      next    = next->io_flink;
+    }
+
+  if (last != NULL)
+    {
+      /* Unlink them from the pipe data */
+
+      head            = dev->d_iob;
+      head->io_pktlen = nmoved;
+      last->io_flink  = NULL;
+
+      dev->d_iob      = next;
+      if (next != NULL)
+        {
+          next->io_pktlen = nbytes - nmoved;
+        }
+    }
+
+  if (nmoved < len)
+    {
+      /* Copy the rest from the (new) first I/O buffer of the pipe data.  It
+       * holds more than the remaining bytes, so they are contiguous.
+       */
+
+      DEBUGASSERT(dev->d_iob != NULL && dev->d_iob->io_len > len - nmoved);
+
+      iob->io_len    = len - nmoved;
+      iob->io_pktlen = iob->io_len;
+      memcpy(iob->io_data, IOB_DATA(dev->d_iob), iob->io_len);
+      pipecommon_bufdiscard(dev, iob->io_len);
+
+      if (head != NULL)
+        {
+          iob_concat(head, iob);
+        }
+      else
+        {
+          head = iob;
+        }
+    }
+  else
+    {
+      iob_free(iob);
+    }
+
+  return head;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -188,6 +810,8 @@ FAR struct pipe_dev_s *pipecommon_allocdev(size_t bufsize)
      nxsem_setprotocol(&dev->d_wrsem, SEM_PRIO_NONE);
 
       dev->d_bufsize = bufsize;
+      dev->d_rdwm    = 1;
+      dev->d_wrwm    = 1;
     }
 
   return dev;
@@ -229,9 +853,11 @@ int pipecommon_open(FAR struct file *filep)
       return ret;
     }
 
+#ifndef CONFIG_DEV_PIPE_IOB
   /* If this the first reference on the device, then allocate the buffer.
    * In the case of policy 1, the buffer already be present when the pipe
-   * is first opened.
+   * is first opened.  (I/O buffer backed pipes allocate I/O buffers only
+   * as data is written).
    */
 
   if (dev->d_refs == 0 && dev->d_buffer == NULL)
@@ -243,6 +869,7 @@ int pipecommon_open(FAR struct file *filep)
           return -ENOMEM;
         }
     }
+#endif
 
   /* Increment the reference count on the pipe instance */
 
@@ -284,7 +911,7 @@ int pipecommon_open(FAR struct file *filep)
 
   if ((filep->f_oflags & O_RDWR) == O_RDONLY &&  /* Read-only */
       dev->d_nwriters < 1 &&                     /* No writers on the pipe */
-      dev->d_wrndx == dev->d_rdndx)              /* Buffer is empty */
+      pipecommon_nbytes(dev) == 0)               /* Buffer is empty */
     {
       /* NOTE: d_rdsem is normally used when the read logic waits for more
        * data to be written.  But until the first writer has opened the
@@ -388,17 +1015,14 @@ int pipecommon_close(FAR struct file *filep)
    * obtained when the pipe is re-opened.
    */
 
-  else if (PIPE_IS_POLICY_0(dev->d_flags) || dev->d_wrndx == dev->d_rdndx)
+  else if (PIPE_IS_POLICY_0(dev->d_flags) || pipecommon_nbytes(dev) == 0)
     {
       /* Policy 0 or the buffer is empty ... deallocate the buffer now. */
 
-      kmm_free(dev->d_buffer);
-      dev->d_buffer = NULL;
+      pipecommon_buffree(dev);
 
-      /* And reset all counts and indices */
+      /* And reset all counts */
 
-      dev->d_wrndx    = 0;
-      dev->d_rdndx    = 0;
       dev->d_refs     = 0;
       dev->d_nwriters = 0;
       dev->d_nreaders = 0;
@@ -421,22 +1045,33 @@ int pipecommon_close(FAR struct file *filep)
 }
 
 /****************************************************************************
- * Name: pipecommon_read
+ * Name: pipecommon_readv
+ *
+ * Description:
+ *   Scatter the data available in the pipe into the caller's buffers.  All
+ *   of the buffers are filled with a single hold of the pipe so that the
+ *   data is never interleaved with other readers.
+ *
  ****************************************************************************/
 
-ssize_t pipecommon_read(FAR struct file *filep, FAR char *buffer, size_t len)
+ssize_t pipecommon_readv(FAR struct file *filep, FAR const struct iovec *iov,
+                         int iovcnt)
 {
   FAR struct inode      *inode  = filep->f_inode;
   FAR struct pipe_dev_s *dev    = inode->i_private;
-#ifdef CONFIG_DEV_PIPEDUMP
-  FAR uint8_t           *start  = (FAR uint8_t *)buffer;
-#endif
   ssize_t                nread  = 0;
-  int                    sval;
+  size_t                 ncopy;
+  size_t                 len;
   int                    ret;
+  int                    i;
 
   DEBUGASSERT(dev);
 
+  for (i = 0, len = 0; i < iovcnt; i++)
+    {
+      len += iov[i].iov_len;
+    }
+
   if (len == 0)
     {
       return 0;
@@ -452,84 +1087,84 @@ ssize_t pipecommon_read(FAR struct file *filep, FAR char *buffer, size_t len)
 
   /* If the pipe is empty, then wait for something to be written to it */
 
-  while (dev->d_wrndx == dev->d_rdndx)
+  ret = pipecommon_rdwait(dev, len, (filep->f_oflags & O_NONBLOCK) != 0);
+  if (ret <= 0)
     {
-      /* If O_NONBLOCK was set, then return EGAIN */
-
-      if (filep->f_oflags & O_NONBLOCK)
-        {
-          nxsem_post(&dev->d_bfsem);
-          return -EAGAIN;
-        }
-
-      /* If there are no writers on the pipe, then return end of file */
-
-      if (dev->d_nwriters <= 0)
-        {
-          nxsem_post(&dev->d_bfsem);
-          return 0;
-        }
+      return ret;
+    }
 
-      /* Otherwise, wait for something to be written to the pipe */
+  /* Then return whatever is available in the pipe (which is at least one
+   * byte), filling each buffer in turn.
+   */
 
-      sched_lock();
-      nxsem_post(&dev->d_bfsem);
-      ret = nxsem_wait(&dev->d_rdsem);
-      sched_unlock();
+  for (i = 0; i < iovcnt; i++)
+    {
+      ncopy = pipecommon_bufpeek(dev, (FAR uint8_t *)iov[i].iov_base,
+                                 iov[i].iov_len, nread);
+      pipe_dumpbuffer("From PIPE:", (FAR uint8_t *)iov[i].iov_base, ncopy);
+      nread += ncopy;
 
-      if (ret < 0 || (ret = nxsem_wait(&dev->d_bfsem)) < 0)
+      if (ncopy < iov[i].iov_len)
         {
-          return ret;
+          break;
         }
     }
 
-  /* Then return whatever is available in the pipe (which is at least one byte) */
+  pipecommon_bufdiscard(dev, nread);
 
-  nread = 0;
-  while ((size_t)nread < len && dev->d_wrndx != dev->d_rdndx)
-    {
-      *buffer++ = dev->d_buffer[dev->d_rdndx];
-      if (++dev->d_rdndx >= dev->d_bufsize)
-        {
-          dev->d_rdndx = 0;
-        }
+  /* Notify the waiting writers if there is now enough space in the pipe */
 
-      nread++;
-    }
+  pipecommon_wrnotify(dev);
 
-  /* Notify all waiting writers that bytes have been removed from the buffer */
+  nxsem_post(&dev->d_bfsem);
+  return nread;
+}
 
-  while (nxsem_getvalue(&dev->d_wrsem, &sval) == 0 && sval < 0)
-    {
-      nxsem_post(&dev->d_wrsem);
-    }
+/****************************************************************************
+ * Name: pipecommon_read
+ ****************************************************************************/
 
-  /* Notify all poll/select waiters that they can write to the FIFO */
+ssize_t pipecommon_read(FAR struct file *filep, FAR char *buffer, size_t len)
+{
+  struct iovec iov;
 
-  pipecommon_pollnotify(dev, POLLOUT);
+  iov.iov_base = buffer;
+  iov.iov_len  = len;
 
-  nxsem_post(&dev->d_bfsem);
-  pipe_dumpbuffer("From PIPE:", start, nread);
-  return nread;
+  return pipecommon_readv(filep, &iov, 1);
 }
 
 /****************************************************************************
- * Name: pipecommon_write
+ * Name: pipecommon_writev
+ *
+ * Description:
+ *   Gather the caller's buffers into the pipe.  All of the buffers are
+ *   written with a single hold of the pipe so that, if there is room, the
+ *   whole request appears in the pipe at once and the readers are notified
+ *   only once.
+ *
  ****************************************************************************/
 
-ssize_t pipecommon_write(FAR struct file *filep, FAR const char *buffer,
-                         size_t len)
+ssize_t pipecommon_writev(FAR struct file *filep, FAR const struct iovec *iov,
+                          int iovcnt)
 {
   FAR struct inode      *inode    = filep->f_inode;
   FAR struct pipe_dev_s *dev      = inode->i_private;
   ssize_t                nwritten = 0;
-  ssize_t                last;
-  int                    nxtwrndx;
-  int                    sval;
+  size_t                 offset   = 0;
+  size_t                 ncopy;
+  size_t                 len;
   int                    ret;
+  int                    i;
 
   DEBUGASSERT(dev);
-  pipe_dumpbuffer("To PIPE:", (FAR uint8_t *)buffer, len);
+
+  for (i = 0, len = 0; i < iovcnt; i++)
+    {
+      pipe_dumpbuffer("To PIPE:", (FAR uint8_t *)iov[i].iov_base,
+                      iov[i].iov_len);
+      len += iov[i].iov_len;
+    }
 
   if (len == 0)
     {
@@ -561,90 +1196,101 @@ ssize_t pipecommon_write(FAR struct file *filep, FAR const char *buffer,
 
   /* Loop until all of the bytes have been written */
 
-  last = 0;
+  i = 0;
   for (; ; )
     {
-      /* Calculate the write index AFTER the next byte is written */
+      /* Copy as much as will fit into the pipe */
 
-      nxtwrndx = dev->d_wrndx + 1;
-      if (nxtwrndx >= dev->d_bufsize)
+      for (; i < iovcnt; i++, offset = 0)
         {
-          nxtwrndx = 0;
+          ncopy = pipecommon_bufwrite(dev,
+                                      (FAR const uint8_t *)iov[i].iov_base +
+                                      offset, iov[i].iov_len - offset);
+          nwritten += ncopy;
+          offset   += ncopy;
+
+          if (offset < iov[i].iov_len)
+            {
+              break;
+            }
         }
 
-      /* Would the next write overflow the circular buffer? */
+      /* Is the write complete? */
 
-      if (nxtwrndx != dev->d_rdndx)
+      if ((size_t)nwritten >= len)
         {
-          /* No... copy the byte */
-
-          dev->d_buffer[dev->d_wrndx] = *buffer++;
-          dev->d_wrndx = nxtwrndx;
-
-          /* Is the write complete? */
-
-          nwritten++;
-          if ((size_t)nwritten >= len)
-            {
-              /* Yes.. Notify all of the waiting readers that more data is available */
+          /* Yes.. Notify the waiting readers if the read watermark has
+           * been reached.
+           */
 
-              while (nxsem_getvalue(&dev->d_rdsem, &sval) == 0 && sval < 0)
-                {
-                  nxsem_post(&dev->d_rdsem);
-                }
+          pipecommon_rdnotify(dev, false);
 
-              /* Notify all poll/select waiters that they can read from the FIFO */
+          /* Return the number of bytes written */
 
-              pipecommon_pollnotify(dev, POLLIN);
+          nxsem_post(&dev->d_bfsem);
+          return len;
+        }
 
-              /* Return the number of bytes written */
+      /* There is not enough room for the next byte.  If O_NONBLOCK was
+       * set, then return partial bytes written or EGAIN.
+       */
 
-              nxsem_post(&dev->d_bfsem);
-              return len;
+      if (filep->f_oflags & O_NONBLOCK)
+        {
+          if (nwritten == 0)
+            {
+              nwritten = -EAGAIN;
             }
+          else
+            {
+              pipecommon_rdnotify(dev, false);
+            }
+
+          nxsem_post(&dev->d_bfsem);
+          return nwritten;
         }
-      else
-        {
-          /* There is not enough room for the next byte.  Was anything written in this pass? */
 
-          if (last < nwritten)
-            {
-              /* Yes.. Notify all of the waiting readers that more data is available */
+      /* We are about to wait for the readers to make space.  Notify them of
+       * whatever is in the pipe now regardless of the read watermark.
+       */
 
-              while (nxsem_getvalue(&dev->d_rdsem, &sval) == 0 && sval < 0)
-                {
-                  nxsem_post(&dev->d_rdsem);
-                }
+      pipecommon_rdnotify(dev, true);
 
-              /* Notify all poll/select waiters that they can read from the FIFO */
+#ifdef CONFIG_DEV_PIPE_IOB
+      /* If the pipe is empty, then nothing was written because the I/O
+       * buffer pool is exhausted.  No reader will wake us up in this case.
+       */
 
-              pipecommon_pollnotify(dev, POLLIN);
-            }
+      if (dev->d_iob == NULL)
+        {
+          pipecommon_iobwait(dev);
+          continue;
+        }
+#endif
 
-          last = nwritten;
+      /* There is more to be written.. wait for data to be removed from the pipe */
 
-          /* If O_NONBLOCK was set, then return partial bytes written or EGAIN */
+      sched_lock();
+      nxsem_post(&dev->d_bfsem);
+      pipecommon_semtake(&dev->d_wrsem);
+      sched_unlock();
+      pipecommon_semtake(&dev->d_bfsem);
+    }
+}
 
-          if (filep->f_oflags & O_NONBLOCK)
-            {
-              if (nwritten == 0)
-                {
-                  nwritten = -EAGAIN;
-                }
+/****************************************************************************
+ * Name: pipecommon_write
+ ****************************************************************************/
 
-              nxsem_post(&dev->d_bfsem);
-              return nwritten;
-            }
+ssize_t pipecommon_write(FAR struct file *filep, FAR const char *buffer,
+                         size_t len)
+{
+  struct iovec iov;
 
-          /* There is more to be written.. wait for data to be removed from the pipe */
+  iov.iov_base = (FAR void *)buffer;
+  iov.iov_len  = len;
 
-          sched_lock();
-          nxsem_post(&dev->d_bfsem);
-          pipecommon_semtake(&dev->d_wrsem);
-          sched_unlock();
-          pipecommon_semtake(&dev->d_bfsem);
-        }
-    }
+  return pipecommon_writev(filep, &iov, 1);
 }
 
 /****************************************************************************
@@ -658,7 +1304,7 @@ int pipecommon_poll(FAR struct file *filep, FAR struct pollfd *fds,
   FAR struct inode      *inode    = filep->f_inode;
   FAR struct pipe_dev_s *dev      = inode->i_private;
   pollevent_t            eventset;
-  pipe_ndx_t             nbytes;
+  size_t                 nbytes;
   int                    ret      = OK;
   int                    i;
 
@@ -698,27 +1344,25 @@ int pipecommon_poll(FAR struct file *filep, FAR struct pollfd *fds,
        * First, determine how many bytes are in the buffer
        */
 
-      if (dev->d_wrndx >= dev->d_rdndx)
-        {
-          nbytes = dev->d_wrndx - dev->d_rdndx;
-        }
-      else
-        {
-          nbytes = dev->d_bufsize + dev->d_wrndx - dev->d_rdndx;
-        }
+      nbytes = pipecommon_nbytes(dev);
 
-      /* Notify the POLLOUT event if the pipe is not full, but only if
-       * there is readers. */
+      /* Notify the POLLOUT event if the free space in the pipe has
+       * reached the write watermark, but only if there is readers.
+       */
 
       eventset = 0;
-      if (nbytes < (dev->d_bufsize - 1))
+      if (pipecommon_nspace(dev) >= dev->d_wrwm)
         {
           eventset |= POLLOUT;
         }
 
-      /* Notify the POLLIN event if the pipe is not empty */
+      /* Notify the POLLIN event if the data in the pipe has reached the
+       * read watermark (or there will be no more data).  The size of the
+       * next read is not known, so a read of fewer bytes may succeed even
+       * while POLLIN is not reported.
+       */
 
-      if (nbytes > 0)
+      if (pipecommon_rdready(dev, dev->d_rdwm))
         {
           eventset |= POLLIN;
         }
@@ -811,26 +1455,12 @@ int pipecommon_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
       case FIONWRITE:  /* Number of bytes waiting in send queue */
       case FIONREAD:   /* Number of bytes available for reading */
         {
-          int count;
-
           /* Determine the number of bytes written to the buffer.  This is,
            * of course, also the number of bytes that may be read from the
            * buffer.
-           *
-           *   d_rdndx - index to remove next byte from the buffer
-           *   d_wrndx - Index to next location to add a byte to the buffer.
            */
 
-          if (dev->d_wrndx < dev->d_rdndx)
-            {
-              count = (dev->d_bufsize - dev->d_rdndx) + dev->d_wrndx;
-            }
-          else
-            {
-              count = dev->d_wrndx - dev->d_rdndx;
-            }
-
-          *(FAR int *)((uintptr_t)arg) = count;
+          *(FAR int *)((uintptr_t)arg) = (int)pipecommon_nbytes(dev);
           ret = 0;
         }
         break;
@@ -839,25 +1469,45 @@ int pipecommon_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
 
       case FIONSPACE:
         {
-          int count;
+          /* Determine the number of bytes free in the buffer. */
 
-          /* Determine the number of bytes free in the buffer.
-           *
-           *   d_rdndx - index to remove next byte from the buffer
-           *   d_wrndx - Index to next location to add a byte to the buffer.
-           */
+          *(FAR int *)((uintptr_t)arg) = (int)pipecommon_nspace(dev);
+          ret = 0;
+        }
+        break;
+
+      /* Read and write watermarks.  These are limited to the capacity of
+       * the pipe so that a full (or empty) pipe always wakes up the other
+       * side.
+       */
+
+      case PIPEIOC_RDWATERMARK:
+      case PIPEIOC_WRWATERMARK:
+        {
+          size_t capacity = pipecommon_capacity(dev);
+          size_t watermark = (size_t)arg;
+
+          if (watermark < 1)
+            {
+              watermark = 1;
+            }
+          else if (watermark > capacity)
+            {
+              watermark = capacity;
+            }
 
-          if (dev->d_wrndx < dev->d_rdndx)
+          if (cmd == PIPEIOC_RDWATERMARK)
             {
-              count = (dev->d_rdndx - dev->d_wrndx) - 1;
+              dev->d_rdwm = watermark;
+              pipecommon_rdnotify(dev, false);
             }
           else
             {
-              count = ((dev->d_bufsize - dev->d_wrndx) + dev->d_rdndx) - 1;
+              dev->d_wrwm = watermark;
+              pipecommon_wrnotify(dev);
             }
 
-          *(FAR int *)((uintptr_t)arg) = count;
-          ret = 0;
+          ret = OK;
         }
         break;
 
@@ -891,10 +1541,7 @@ int pipecommon_unlink(FAR struct inode *inode)
     {
       /* No.. free the buffer (if there is one) */
 
-      if (dev->d_buffer)
-        {
-          kmm_free(dev->d_buffer);
-        }
+      pipecommon_buffree(dev);
 
       /* And free the device structure. */
 
@@ -905,4 +1552,299 @@ int pipecommon_unlink(FAR struct inode *inode)
 }
 #endif
 
+/****************************************************************************
+ * Name: pipe_isfile
+ *
+ * Description:
+ *   Return true if 'filep' refers to an open pipe or FIFO.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_DEV_PIPE_SPLICE
+bool pipe_isfile(FAR struct file *filep)
+{
+  FAR struct inode *inode = filep->f_inode;
+
+  /* Both pipes and FIFOs are read with pipecommon_read() */
+
+  return inode != NULL && INODE_IS_DRIVER(inode) &&
+         inode->u.i_ops != NULL && inode->u.i_ops->read == pipecommon_read;
+}
+
+/****************************************************************************
+ * Name: pipe_spliceout
+ *
+ * Description:
+ *   Remove up to 'len' bytes from a pipe and return them as an I/O buffer
+ *   chain.  This behaves like read():  It waits for data (unless the pipe
+ *   was opened with O_NONBLOCK or 'flags' includes SPLICE_F_NONBLOCK) and
+ *   then returns whatever is available, up to 'len' bytes.
+ *
+ *   With I/O buffer backed pipes, the I/O buffers holding the data are
+ *   simply unlinked from the pipe; only a partial I/O buffer at the end is
+ *   copied.
+ *
+ * Input Parameters:
+ *   filep - The open pipe
+ *   iob   - Location to return the I/O buffer chain.  The caller must free
+ *           it when done.
+ *   len   - The maximum number of bytes to remove
+ *   flags - SPLICE_F_* flags
+ *   peek  - Copy the data without removing it from the pipe (as tee()
+ *           does)
+ *
+ * Returned Value:
+ *   The number of bytes in the returned chain, zero at end-of-file, or a
+ *   negated errno value on failure.
+ *
+ ****************************************************************************/
+
+ssize_t pipe_spliceout(FAR struct file *filep, FAR struct iob_s **iob,
+                       size_t len, unsigned int flags, bool peek)
+{
+  FAR struct inode      *inode = filep->f_inode;
+  FAR struct pipe_dev_s *dev   = inode->i_private;
+  FAR struct iob_s      *head;
+  bool                   nonblock;
+  size_t                 nbytes;
+  int                    ret;
+
+  DEBUGASSERT(dev != NULL && iob != NULL);
+
+  *iob = NULL;
+  if (len == 0)
+    {
+      return 0;
+    }
+
+  nonblock = (filep->f_oflags & O_NONBLOCK) != 0 ||
+             (flags & SPLICE_F_NONBLOCK) != 0;
+
+  /* Get the first I/O buffer before taking d_bfsem so that waiting for a
+   * free I/O buffer does not block the other users of the pipe.
+   */
+
+  head = nonblock ? iob_tryalloc_size(len, false) :
+                    iob_alloc_size(len, false);
+  if (head == NULL)
+    {
+      return -EAGAIN;
+    }
+
+  ret = nxsem_wait(&dev->d_bfsem);
+  if (ret >= 0)
+    {
+      ret = pipecommon_rdwait(dev, len, nonblock);
+    }
+
+  if (ret <= 0)
+    {
+      iob_free(head);
+      return ret;
+    }
+
+  nbytes = pipecommon_nbytes(dev);
+  if (len > nbytes)
+    {
+      len = nbytes;
+    }
+
+#ifdef CONFIG_DEV_PIPE_IOB
+  if (!peek)
+    {
+      head = pipecommon_moveout(dev, head, len);
+    }
+  else
+#endif
+    {
+      len = pipecommon_copychain(dev, head, len, peek);
+    }
+
+  if (!peek)
+    {
+      /* Notify the waiting writers if there is now enough space */
+
+      pipecommon_wrnotify(dev);
+    }
+
+  nxsem_post(&dev->d_bfsem);
+
+  *iob = head;
+  return len;
+}
+
+/****************************************************************************
+ * Name: pipe_splicein
+ *
+ * Description:
+ *   Add the first 'len' bytes of the I/O buffer chain '*iob' to a pipe.
+ *   This behaves like write() in non-blocking mode:  It waits until there
+ *   is some space in the pipe (unless the pipe was opened with O_NONBLOCK
+ *   or 'flags' includes SPLICE_F_NONBLOCK) and then adds as much of the
+ *   data as will fit.
+ *
+ *   With I/O buffer backed pipes, a whole chain that fits into the pipe is
+ *   linked to the pipe data without copying.
+ *
+ * Input Parameters:
+ *   filep - The open pipe
+ *   iob   - The I/O buffer chain.  On return, this holds the data that was
+ *           not added to the pipe (or NULL if all of the chain was
+ *           consumed).
+ *   len   - The number of bytes to add (no more than the chain length)
+ *   flags - SPLICE_F_* flags
+ *
+ * Returned Value:
+ *   The number of bytes added to the pipe or a negated errno value on
+ *   failure.
+ *
+ ****************************************************************************/
+
+ssize_t pipe_splicein(FAR struct file *filep, FAR struct iob_s **iob,
+                      size_t len, unsigned int flags)
+{
+  FAR struct inode      *inode = filep->f_inode;
+  FAR struct pipe_dev_s *dev   = inode->i_private;
+  FAR struct iob_s      *next;
+  bool                   nonblock;
+  size_t                 nwritten;
+  size_t                 nspace;
+  size_t                 ncopy;
+  size_t                 ret;
+  int                    errcode;
+
+  DEBUGASSERT(dev != NULL && iob != NULL && *iob != NULL);
+  DEBUGASSERT(len <= (*iob)->io_pktlen);
+
+  if (len == 0)
+    {
+      return 0;
+    }
+
+  nonblock = (filep->f_oflags & O_NONBLOCK) != 0 ||
+             (flags & SPLICE_F_NONBLOCK) != 0;
+
+  errcode = nxsem_wait(&dev->d_bfsem);
+  if (errcode < 0)
+    {
+      return errcode;
+    }
+
+  for (; ; )
+    {
+      /* Wait for space in the pipe */
+
+      while ((nspace = pipecommon_nspace(dev)) == 0)
+        {
+          if (nonblock)
+            {
+              nxsem_post(&dev->d_bfsem);
+              return -EAGAIN;
+            }
+
+          sched_lock();
+          nxsem_post(&dev->d_bfsem);
+          errcode = nxsem_wait(&dev->d_wrsem);
+          sched_unlock();
+
+          if (errcode < 0 || (errcode = nxsem_wait(&dev->d_bfsem)) < 0)
+            {
+              return errcode;
+            }
+        }
+
+#ifdef CONFIG_DEV_PIPE_IOB
+      if (len <= nspace && len == (*iob)->io_pktlen)
+        {
+          /* The whole chain fits:  Link it to the end of the pipe data */
+
+          if (dev->d_iob == NULL)
+            {
+              dev->d_iob = *iob;
+            }
+          else
+            {
+              iob_concat(dev->d_iob, *iob);
+            }
+
+          *iob     = NULL;
+          nwritten = len;
+        }
+      else
+#endif
+        {
+          /* Copy as much as will fit, one I/O buffer at a time */
+
+          nwritten = 0;
+          for (next = *iob; next != NULL && nwritten < len;
+               next = next->io_flink)
+            {
+              ncopy = next->io_len;
+              if (ncopy > len - nwritten)
+                {
+                  ncopy = len - nwritten;
+                }
+
+              ret       = pipecommon_bufwrite(dev, IOB_DATA(next), ncopy);
+              nwritten += ret;
+
+              if (ret < ncopy)
+                {
+                  break;
+                }
+            }
+
+          if (nwritten > 0)
+            {
+              *iob = iob_trimhead(*iob, nwritten);
+              if ((*iob)->io_pktlen == 0)
+                {
+                  iob_free_chain(*iob);
+                  *iob = NULL;
+                }
+            }
+        }
+
+      if (nwritten > 0)
+        {
+          break;
+        }
+
+#ifdef CONFIG_DEV_PIPE_IOB
+      /* Nothing could be written because the I/O buffer pool is exhausted.
+       * If the pipe is not empty, then wait for the reader to free some.
+       */
+
+      if (nonblock)
+        {
+          nxsem_post(&dev->d_bfsem);
+          return -EAGAIN;
+        }
+
+      if (dev->d_iob == NULL)
+        {
+          pipecommon_iobwait(dev);
+        }
+      else
+        {
+          pipecommon_rdnotify(dev, true);
+
+          sched_lock();
+          nxsem_post(&dev->d_bfsem);
+          pipecommon_semtake(&dev->d_wrsem);
+          sched_unlock();
+          pipecommon_semtake(&dev->d_bfsem);
+        }
+#endif
+    }
+
+  /* Notify the waiting readers if the read watermark has been reached */
+
+  pipecommon_rdnotify(dev, false);
+
+  nxsem_post(&dev->d_bfsem);
+  return nwritten;
+}
+#endif /* CONFIG_DEV_PIPE_SPLICE */
+
 #endif /* CONFIG_PIPES */
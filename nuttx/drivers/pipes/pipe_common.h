@@ -1,7 +1,8 @@
 /****************************************************************************
  * drivers/pipe/pipe_common.h
  *
- *   Copyright (C) 2008-2009, 2015-2016 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2008-2009, 2015-2016, 2018 Gregory Nutt. All rights
+ *     reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -84,6 +85,19 @@
 #  define CONFIG_DEV_FIFO_SIZE 1024
 #endif
 
+/* I/O buffer backed pipes and splice() need the I/O buffer support */
+
+#ifndef CONFIG_MM_IOB
+#  undef CONFIG_DEV_PIPE_IOB
+#  undef CONFIG_DEV_PIPE_SPLICE
+#endif
+
+/* The amount of data in an I/O buffer chain is limited to 16-bits */
+
+#if defined(CONFIG_DEV_PIPE_IOB) && CONFIG_DEV_PIPE_MAXSIZE > 65535
+#  error CONFIG_DEV_PIPE_MAXSIZE is too large for CONFIG_DEV_PIPE_IOB
+#endif
+
 /* Maximum number of threads than can be waiting for POLL events */
 
 #ifndef CONFIG_DEV_PIPE_NPOLLWAITERS
@@ -127,20 +141,31 @@ typedef uint8_t pipe_ndx_t;   /*  8-bit index */
  * device is registered.
  */
 
+struct iob_s;  /* Forward reference */
+
 struct pipe_dev_s
 {
   sem_t      d_bfsem;       /* Used to serialize access to d_buffer and indices */
   sem_t      d_rdsem;       /* Empty buffer - Reader waits for data write */
   sem_t      d_wrsem;       /* Full buffer - Writer waits for data read */
+#ifdef CONFIG_DEV_PIPE_IOB
+  FAR struct iob_s *d_iob;  /* I/O buffer chain holding the pipe data */
+#else
   pipe_ndx_t d_wrndx;       /* Index in d_buffer to save next byte written */
   pipe_ndx_t d_rdndx;       /* Index in d_buffer to return the next byte read */
+#endif
   pipe_ndx_t d_bufsize;     /* allocated size of d_buffer in bytes */
+  pipe_ndx_t d_rdwm;        /* Read watermark:  Bytes needed to wake readers */
+  pipe_ndx_t d_wrwm;        /* Write watermark:  Space needed to wake writers */
+  pipe_ndx_t d_rdmin;       /* Bytes needed by the smallest blocked read (0=none) */
   uint8_t    d_refs;        /* References counts on pipe (limited to 255) */
   uint8_t    d_nwriters;    /* Number of reference counts for write access */
   uint8_t    d_nreaders;    /* Number of reference counts for read access */
   uint8_t    d_pipeno;      /* Pipe minor number */
   uint8_t    d_flags;       /* See PIPE_FLAG_* definitions */
+#ifndef CONFIG_DEV_PIPE_IOB
   uint8_t   *d_buffer;      /* Buffer allocated when device opened */
+#endif
 
   /* The following is a list if poll structures of threads waiting for
    * driver events. The 'struct pollfd' reference for each open is also
@@ -166,6 +191,7 @@ extern "C"
 
 struct file;  /* Forward reference */
 struct inode; /* Forward reference */
+struct iovec; /* Forward reference */
 
 FAR struct pipe_dev_s *pipecommon_allocdev(size_t bufsize);
 void    pipecommon_freedev(FAR struct pipe_dev_s *dev);
@@ -173,6 +199,10 @@ int     pipecommon_open(FAR struct file *filep);
 int     pipecommon_close(FAR struct file *filep);
 ssize_t pipecommon_read(FAR struct file *, FAR char *, size_t);
 ssize_t pipecommon_write(FAR struct file *, FAR const char *, size_t);
+ssize_t pipecommon_readv(FAR struct file *filep, FAR const struct iovec *iov,
+                         int iovcnt);
+ssize_t pipecommon_writev(FAR struct file *filep, FAR const struct iovec *iov,
+                          int iovcnt);
 int     pipecommon_ioctl(FAR struct file *filep, int cmd, unsigned long arg);
 #ifndef CONFIG_DISABLE_POLL
 int     pipecommon_poll(FAR struct file *filep, FAR struct pollfd *fds,
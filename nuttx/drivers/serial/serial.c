@@ -1,7 +1,7 @@
 /************************************************************************************
  * drivers/serial/serial.c
  *
- *   Copyright (C) 2007-2009, 2011-2013, 2016-2017 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007-2009, 2011-2013, 2016-2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -107,6 +107,10 @@ static void    uart_pollnotify(FAR uart_dev_t *dev, pollevent_t eventset);
 /* Write support */
 
 static int     uart_putxmitchar(FAR uart_dev_t *dev, int ch, bool oktoblock);
+static ssize_t uart_putxmitblock(FAR uart_dev_t *dev, FAR const char *buffer,
+                                 size_t buflen);
+static inline size_t uart_rawlength(FAR uart_dev_t *dev, FAR const char *buffer,
+                                    size_t buflen);
 static inline ssize_t uart_irqwrite(FAR uart_dev_t *dev, FAR const char *buffer,
                                     size_t buflen);
 static int     uart_tcdrain(FAR uart_dev_t *dev);
@@ -357,6 +361,155 @@ static int uart_putxmitchar(FAR uart_dev_t *dev, int ch, bool oktoblock)
   return OK;
 }
 
+/************************************************************************************
+ * Name: uart_putxmitblock
+ *
+ * Description:
+ *   Copy as much of the caller's buffer as will fit into the TX buffer, in at most
+ *   two memcpy() segments, without blocking.  The TX interrupt must be disabled by
+ *   the caller so that the head index is not observed while it is being updated.
+ *
+ * Returned Value:
+ *   The number of bytes added to the TX buffer; zero if the TX buffer is full.
+ *   -ENOTCONN is returned if the removable device has been disconnected.
+ *
+ ************************************************************************************/
+
+static ssize_t uart_putxmitblock(FAR uart_dev_t *dev, FAR const char *buffer,
+                                 size_t buflen)
+{
+  FAR struct uart_buffer_s *xmit = &dev->xmit;
+  size_t nwritten = 0;
+  size_t nbytes;
+  int16_t head = xmit->head;
+  int16_t tail = xmit->tail;
+
+#ifdef CONFIG_SERIAL_REMOVABLE
+  /* Do not fill the TX buffer of a device that is no longer connected */
+
+  if (dev->disconnected)
+    {
+      return -ENOTCONN;
+    }
+#endif
+
+  while (buflen > 0)
+    {
+      /* How much contiguous space is there after the head?  One slot is always
+       * left empty so that a full buffer can be distinguished from an empty one.
+       */
+
+      if (head >= tail)
+        {
+          nbytes = xmit->size - head;
+          if (tail == 0)
+            {
+              nbytes--;
+            }
+        }
+      else
+        {
+          nbytes = tail - head - 1;
+        }
+
+      if (nbytes == 0)
+        {
+          break;
+        }
+
+      if (nbytes > buflen)
+        {
+          nbytes = buflen;
+        }
+
+      memcpy(&xmit->buffer[head], buffer, nbytes);
+
+      head += nbytes;
+      if (head >= xmit->size)
+        {
+          head = 0;
+        }
+
+      buffer   += nbytes;
+      buflen   -= nbytes;
+      nwritten += nbytes;
+    }
+
+  /* Publish the new head index with a single store */
+
+  xmit->head = head;
+  return nwritten;
+}
+
+/************************************************************************************
+ * Name: uart_rawlength
+ *
+ * Description:
+ *   Return the number of leading characters in the buffer that are not subject to
+ *   any output post-processing and may be copied to the TX buffer as they are.
+ *   No more than the free space in the TX buffer is examined.
+ *
+ ************************************************************************************/
+
+static inline size_t uart_rawlength(FAR uart_dev_t *dev, FAR const char *buffer,
+                                    size_t buflen)
+{
+  int16_t space;
+  size_t nraw;
+
+  /* Only what fits in the TX buffer can be copied now, so do not scan any
+   * further than that.  One slot is always left empty.
+   */
+
+  space = dev->xmit.tail - dev->xmit.head - 1;
+  if (space < 0)
+    {
+      space += dev->xmit.size;
+    }
+
+  if (buflen > (size_t)space)
+    {
+      buflen = space;
+    }
+
+#ifdef CONFIG_SERIAL_TERMIOS
+  bool crnl;
+  bool nlcr;
+
+  if ((dev->tc_oflag & OPOST) == 0)
+    {
+      return buflen;
+    }
+
+  crnl = (dev->tc_oflag & OCRNL) != 0;
+  nlcr = (dev->tc_oflag & (ONLCR | ONLRET)) != 0;
+  if (!crnl && !nlcr)
+    {
+      return buflen;
+    }
+
+  for (nraw = 0; nraw < buflen; nraw++)
+    {
+      if ((crnl && buffer[nraw] == '\r') || (nlcr && buffer[nraw] == '\n'))
+        {
+          break;
+        }
+    }
+
+#else
+  if (!dev->isconsole)
+    {
+      return buflen;
+    }
+
+  for (nraw = 0; nraw < buflen && buffer[nraw] != '\n'; nraw++)
+    {
+    }
+#endif
+
+  return nraw;
+}
+
 /************************************************************************************
  * Name: uart_irqwrite
  ************************************************************************************/
@@ -703,8 +856,12 @@ static ssize_t uart_read(FAR struct file *filep, FAR char *buffer, size_t buflen
 #endif
   irqstate_t flags;
   ssize_t recvd = 0;
+  size_t nbytes;
+  int16_t head;
   int16_t tail;
+#ifdef CONFIG_SERIAL_TERMIOS
   char ch;
+#endif
   int ret;
 
   /* Only one user can access rxbuf->tail at a time */
@@ -755,8 +912,38 @@ static ssize_t uart_read(FAR struct file *filep, FAR char *buffer, size_t buflen
        */
 
       tail = rxbuf->tail;
-      if (rxbuf->head != tail)
+      head = rxbuf->head;
+      if (head != tail)
         {
+#ifdef CONFIG_SERIAL_TERMIOS
+          if ((dev->tc_iflag & (INLCR | IGNCR | ICRNL)) == 0)
+#endif
+            {
+              /* No input processing.  Copy the contiguous data at the tail of
+               * the buffer in one segment.
+               */
+
+              nbytes = (head > tail ? head : rxbuf->size) - tail;
+              if (nbytes > buflen - recvd)
+                {
+                  nbytes = buflen - recvd;
+                }
+
+              memcpy(buffer, &rxbuf->buffer[tail], nbytes);
+
+              tail += nbytes;
+              if (tail >= rxbuf->size)
+                {
+                  tail = 0;
+                }
+
+              rxbuf->tail = tail;
+              buffer     += nbytes;
+              recvd      += nbytes;
+              continue;
+            }
+
+#ifdef CONFIG_SERIAL_TERMIOS
           /* Take the next character from the tail of the buffer */
 
           ch = rxbuf->buffer[tail];
@@ -773,8 +960,7 @@ static ssize_t uart_read(FAR struct file *filep, FAR char *buffer, size_t buflen
 
           rxbuf->tail = tail;
 
-#ifdef CONFIG_SERIAL_TERMIOS
-          /* Do input processing if any is enabled */
+          /* Do input processing */
 
           if (dev->tc_iflag & (INLCR | IGNCR | ICRNL))
             {
@@ -805,12 +991,12 @@ static ssize_t uart_read(FAR struct file *filep, FAR char *buffer, size_t buflen
            * IUCLC - Not Posix
            * IXON/OXOFF - no xon/xoff flow control.
            */
-#endif
 
           /* Store the received character */
 
           *buffer++ = ch;
           recvd++;
+#endif
         }
 
 #ifdef CONFIG_DEV_SERIAL_FULLBLOCKS
@@ -1038,6 +1224,8 @@ static ssize_t uart_write(FAR struct file *filep, FAR const char *buffer,
   FAR struct inode *inode    = filep->f_inode;
   FAR uart_dev_t   *dev      = inode->i_private;
   ssize_t           nwritten = buflen;
+  ssize_t           nput;
+  size_t            nbytes;
   bool              oktoblock;
   int               ret;
   char              ch;
@@ -1118,6 +1306,31 @@ static ssize_t uart_write(FAR struct file *filep, FAR const char *buffer,
   uart_disabletxint(dev);
   for (; buflen; buflen--)
     {
+      /* Copy any run of characters that needs no output processing directly
+       * into the TX buffer.  Only the character that follows the run (one that
+       * needs processing, or the first one that did not fit) goes through the
+       * character-at-a-time logic below, which may block for TX buffer space.
+       */
+
+      nbytes = uart_rawlength(dev, buffer, buflen);
+      if (nbytes > 0)
+        {
+          nput = uart_putxmitblock(dev, buffer, nbytes);
+          if (nput < 0)
+            {
+              ret = (int)nput;
+              break;
+            }
+
+          buffer += nput;
+          buflen -= nput;
+
+          if (buflen == 0)
+            {
+              break;
+            }
+        }
+
       ch  = *buffer++;
       ret = OK;
 
@@ -1140,7 +1353,6 @@ static ssize_t uart_write(FAR struct file *filep, FAR const char *buffer,
               ret = uart_putxmitchar(dev, '\r', oktoblock);
               if (ret < 0)
                 {
-                  nwritten = ret;
                   break;
                 }
             }
@@ -1182,29 +1394,32 @@ static ssize_t uart_write(FAR struct file *filep, FAR const char *buffer,
 
       if (ret < 0)
         {
-          /* POSIX requires that we return -1 and errno set if no data was
-           * transferred.  Otherwise, we return the number of bytes in the
-           * interrupted transfer.
-           */
+          break;
+        }
+    }
 
-          if (buflen < (size_t)nwritten)
-            {
-              /* Some data was transferred.  Return the number of bytes that
-               * were successfully transferred.
-               */
+  if (ret < 0)
+    {
+      /* POSIX requires that we return -1 and errno set if no data was
+       * transferred.  Otherwise, we return the number of bytes in the
+       * interrupted transfer.
+       */
 
-              nwritten -= buflen;
-            }
-          else
-            {
-              /* No data was transferred. Return the negated errno value.
-               * The VFS layer will set the errno value appropriately).
-               */
+      if (buflen < (size_t)nwritten)
+        {
+          /* Some data was transferred.  Return the number of bytes that
+           * were successfully transferred.
+           */
 
-              nwritten = ret;
-            }
+          nwritten -= buflen;
+        }
+      else
+        {
+          /* No data was transferred. Return the negated errno value.
+           * The VFS layer will set the errno value appropriately).
+           */
 
-          break;
+          nwritten = ret;
         }
     }
 
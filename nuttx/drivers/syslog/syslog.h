@@ -1,7 +1,7 @@
 /****************************************************************************
  * drivers/syslog/syslog.h
  *
- *   Copyright (C) 2016-2017 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2016-2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -43,6 +43,7 @@
 #include <nuttx/config.h>
 
 #include <stdbool.h>
+#include <stdarg.h>
 
 /****************************************************************************
  * Public Data
@@ -236,6 +237,54 @@ int syslog_flush_intbuffer(FAR const struct syslog_channel_s *channel,
                            bool force);
 #endif
 
+/****************************************************************************
+ * Name: syslog_deferred
+ *
+ * Description:
+ *   Record a SYSLOG message for later formatting by the SYSLOG drain
+ *   thread.  Only the format string pointer and the raw argument values
+ *   (plus copies of any string arguments) are saved, in a ring belonging
+ *   to the current CPU.
+ *
+ * Input Parameters:
+ *   priority - The message priority
+ *   fmt      - The format string.  This must remain valid until the
+ *              message has been formatted (normally it is a literal).
+ *   ap       - The arguments
+ *
+ * Returned Value:
+ *   Zero (OK) if the message was deferred.  -ENOSPC if the ring is full
+ *   and the message was dropped.  Any other negated errno value means that
+ *   the message was not recorded and should be formatted synchronously by
+ *   the caller.
+ *
+ * Assumptions:
+ *   May be called from any context, including interrupt handlers.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SYSLOG_DEFERRED
+int syslog_deferred(int priority, FAR const IPTR char *fmt, va_list ap);
+#endif
+
+/****************************************************************************
+ * Name: syslog_deferred_drain
+ *
+ * Description:
+ *   Format and output all complete messages in the deferred rings.
+ *
+ * Input Parameters:
+ *   None
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SYSLOG_DEFERRED
+void syslog_deferred_drain(void);
+#endif
+
 /****************************************************************************
  * Name: syslog_putc
  *
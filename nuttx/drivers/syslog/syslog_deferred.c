@@ -0,0 +1,939 @@
+/****************************************************************************
+ * drivers/syslog/syslog_deferred.c
+ *
+ *   Copyright (C) 2018 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <sched.h>
+#include <syslog.h>
+#include <errno.h>
+
+#include <nuttx/init.h>
+#include <nuttx/irq.h>
+#include <nuttx/arch.h>
+#include <nuttx/clock.h>
+#include <nuttx/kthread.h>
+#include <nuttx/semaphore.h>
+#include <nuttx/spinlock.h>
+#include <nuttx/streams.h>
+#include <nuttx/syslog/syslog.h>
+
+#include "syslog.h"
+
+#ifdef CONFIG_SYSLOG_DEFERRED
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Configuration ************************************************************/
+
+#ifndef CONFIG_SYSLOG_DEFERRED_BUFSIZE
+#  define CONFIG_SYSLOG_DEFERRED_BUFSIZE 1024
+#endif
+
+#if (CONFIG_SYSLOG_DEFERRED_BUFSIZE & (CONFIG_SYSLOG_DEFERRED_BUFSIZE - 1)) != 0
+#  error CONFIG_SYSLOG_DEFERRED_BUFSIZE must be a power of two
+#endif
+
+#ifndef CONFIG_SYSLOG_DEFERRED_MAXARGS
+#  define CONFIG_SYSLOG_DEFERRED_MAXARGS 8
+#endif
+
+#ifndef CONFIG_SYSLOG_DEFERRED_STRSIZE
+#  define CONFIG_SYSLOG_DEFERRED_STRSIZE 64
+#endif
+
+#ifndef CONFIG_SYSLOG_DEFERRED_PRIORITY
+#  define CONFIG_SYSLOG_DEFERRED_PRIORITY 50
+#endif
+
+#ifndef CONFIG_SYSLOG_DEFERRED_STACKSIZE
+#  define CONFIG_SYSLOG_DEFERRED_STACKSIZE 2048
+#endif
+
+#ifndef CONFIG_SYSLOG_DEFERRED_INTERVAL
+#  define CONFIG_SYSLOG_DEFERRED_INTERVAL 100
+#endif
+
+/* Memory barriers are only needed (and only provided) with spinlocks */
+
+#ifndef SP_DMB
+#  define SP_DMB()
+#endif
+
+#ifdef CONFIG_SMP
+#  define SYSLOG_NRINGS          CONFIG_SMP_NCPUS
+#else
+#  define SYSLOG_NRINGS          1
+#endif
+
+/* Records are aligned to the size of one argument slot so that the slots
+ * that follow the record header can be accessed directly in the ring.
+ */
+
+#define SYSLOG_DALIGNMENT        sizeof(union syslog_darg_u)
+#define SYSLOG_DALIGN(n)         (((n) + SYSLOG_DALIGNMENT - 1) & \
+                                  ~(SYSLOG_DALIGNMENT - 1))
+#define SYSLOG_DHDRSIZE          SYSLOG_DALIGN(sizeof(struct syslog_drec_s))
+#define SYSLOG_DMASK             (CONFIG_SYSLOG_DEFERRED_BUFSIZE - 1)
+
+/* Record states */
+
+#define SYSLOG_DSTATE_BUSY       0  /* Reserved, being filled in */
+#define SYSLOG_DSTATE_READY      1  /* Ready to be formatted */
+#define SYSLOG_DSTATE_PAD        2  /* Unused space at the end of the ring */
+
+/* Argument types, following the conversions accepted by lib_vsprintf() */
+
+#define SYSLOG_DTYPE_NONE        0  /* "%%", no argument */
+#define SYSLOG_DTYPE_INT         1
+#define SYSLOG_DTYPE_LONG        2
+#define SYSLOG_DTYPE_LLONG       3
+#define SYSLOG_DTYPE_DOUBLE      4
+#define SYSLOG_DTYPE_PTR         5
+#define SYSLOG_DTYPE_STR         6
+#define SYSLOG_DTYPE_BAD         7  /* Cannot be deferred */
+
+/* Offset of a NULL string argument */
+
+#define SYSLOG_DNULLSTR          0xffff
+
+/* Maximum length of a conversion specification that may be deferred, and
+ * the size of the buffer that holds it after '*' values are expanded.
+ */
+
+#define SYSLOG_DSPECMAX          16
+#define SYSLOG_DSPECSIZE         48
+
+/* Drain thread state */
+
+#define SYSLOG_DTHREAD_IDLE      0  /* Not yet started */
+#define SYSLOG_DTHREAD_STARTING  1  /* kthread_create() in progress */
+#define SYSLOG_DTHREAD_RUNNING   2  /* Accepting deferred messages */
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* One recorded argument */
+
+union syslog_darg_u
+{
+  int                  i;
+  long                 l;
+#if defined(CONFIG_HAVE_LONG_LONG) && defined(CONFIG_LIBC_LONG_LONG)
+  long long            ll;
+#endif
+#ifdef CONFIG_LIBC_FLOATINGPOINT
+  double               d;
+#endif
+  FAR void            *p;
+  uint16_t             soff;     /* Offset of a copied string argument */
+};
+
+/* The header of one deferred message.  It is followed in the ring by
+ * 'nargs' argument slots and then by the copies of any string arguments.
+ */
+
+struct syslog_drec_s
+{
+  uint16_t             len;      /* Total length of the record */
+  volatile uint8_t     state;    /* See SYSLOG_DSTATE_* */
+  uint8_t              priority; /* Message priority */
+  uint8_t              nargs;    /* Number of argument slots */
+  FAR const IPTR char *fmt;      /* The caller's format string */
+#ifdef CONFIG_SYSLOG_TIMESTAMP
+  systime_t            ticks;    /* System time when the message was logged */
+#endif
+};
+
+/* One ring of deferred messages.  There is one ring per CPU so that only
+ * the local CPU ever produces into a ring; the drain thread is the only
+ * consumer.  'head' and 'tail' are free-running byte counts.
+ */
+
+struct syslog_dring_s
+{
+  volatile uint32_t    head;     /* Producer position */
+  volatile uint32_t    tail;     /* Consumer position */
+  volatile uint32_t    dropped;  /* Messages lost because the ring was full */
+  uint32_t             reported; /* Dropped messages already reported */
+  union syslog_darg_u  buffer[CONFIG_SYSLOG_DEFERRED_BUFSIZE /
+                              sizeof(union syslog_darg_u)];
+};
+
+/* A message encoded on the caller's stack before it is copied to a ring */
+
+struct syslog_dmsg_s
+{
+  uint8_t              nargs;
+  uint16_t             strlen;
+  union syslog_darg_u  args[CONFIG_SYSLOG_DEFERRED_MAXARGS];
+  char                 strings[CONFIG_SYSLOG_DEFERRED_STRSIZE];
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct syslog_dring_s g_syslog_drings[SYSLOG_NRINGS];
+static sem_t g_syslog_dsem;
+static volatile uint8_t g_syslog_dthread;
+static volatile bool g_syslog_ddraining;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: syslog_deferred_spec
+ *
+ * Description:
+ *   Parse one conversion specification following a '%' in the same way
+ *   that lib_vsprintf() does and determine the type of argument that it
+ *   consumes.
+ *
+ * Input Parameters:
+ *   fmt    - Points to the character after the '%'
+ *   pend   - Location to return the address of the conversion character
+ *   nstars - Location to return the number of '*' int arguments that
+ *            precede the converted argument
+ *
+ * Returned Value:
+ *   One of SYSLOG_DTYPE_*.
+ *
+ ****************************************************************************/
+
+static int syslog_deferred_spec(FAR const IPTR char *fmt,
+                                FAR const IPTR char **pend,
+                                FAR int *nstars)
+{
+  bool lflag  = false;
+  bool llflag = false;
+  int type;
+
+  *nstars = 0;
+  for (; *fmt != '\0'; fmt++)
+    {
+      if (strchr("diuxXpobeEfgGlLsc%", *fmt) != NULL)
+        {
+          break;
+        }
+      else if (*fmt == '*')
+        {
+#ifdef CONFIG_NOPRINTF_FIELDWIDTH
+          return SYSLOG_DTYPE_BAD;
+#else
+          (*nstars)++;
+#endif
+        }
+    }
+
+  if (*fmt == '\0')
+    {
+      return SYSLOG_DTYPE_BAD;
+    }
+
+  /* Check for the conversions that do not accept a size prefix */
+
+  if (*fmt == '%')
+    {
+      *pend = fmt;
+      return SYSLOG_DTYPE_NONE;
+    }
+  else if (*fmt == 's')
+    {
+      *pend = fmt;
+      return SYSLOG_DTYPE_STR;
+    }
+  else if (*fmt == 'c')
+    {
+      *pend = fmt;
+      return SYSLOG_DTYPE_INT;
+    }
+
+  /* Check for the long and long long prefixes */
+
+  if (*fmt == 'L')
+    {
+      llflag = true;
+      fmt++;
+    }
+  else if (*fmt == 'l')
+    {
+      lflag = true;
+      fmt++;
+      if (*fmt == 'l')
+        {
+          llflag = true;
+          fmt++;
+        }
+    }
+
+  if (*fmt == '\0')
+    {
+      return SYSLOG_DTYPE_BAD;
+    }
+
+  if (strchr("diuxXpob", *fmt) != NULL)
+    {
+      if (*fmt == 'p')
+        {
+          type = SYSLOG_DTYPE_PTR;
+        }
+#if defined(CONFIG_HAVE_LONG_LONG) && defined(CONFIG_LIBC_LONG_LONG)
+      else if (llflag)
+        {
+          type = SYSLOG_DTYPE_LLONG;
+        }
+#endif
+      else if (lflag)
+        {
+          type = SYSLOG_DTYPE_LONG;
+        }
+      else
+        {
+          type = SYSLOG_DTYPE_INT;
+        }
+    }
+#ifdef CONFIG_LIBC_FLOATINGPOINT
+  else if (strchr("eEfgG", *fmt) != NULL)
+    {
+      type = SYSLOG_DTYPE_DOUBLE;
+    }
+#endif
+  else
+    {
+      return SYSLOG_DTYPE_BAD;
+    }
+
+  UNUSED(llflag);
+  *pend = fmt;
+  return type;
+}
+
+/****************************************************************************
+ * Name: syslog_deferred_encode
+ *
+ * Description:
+ *   Walk the format string and copy the raw argument values into 'msg'.
+ *   String arguments are copied (and truncated if necessary) since they
+ *   may not be valid by the time that the message is formatted.
+ *
+ * Returned Value:
+ *   Zero (OK) on success; a negated errno value if the message cannot be
+ *   deferred and must be formatted synchronously.
+ *
+ ****************************************************************************/
+
+static int syslog_deferred_encode(FAR struct syslog_dmsg_s *msg,
+                                  FAR const IPTR char *fmt, va_list ap)
+{
+  FAR const IPTR char *end;
+  FAR const char *str;
+  size_t len;
+  int nstars;
+  int type;
+
+  msg->nargs  = 0;
+  msg->strlen = 0;
+
+  for (; *fmt != '\0'; fmt++)
+    {
+      if (*fmt != '%')
+        {
+          continue;
+        }
+
+      type = syslog_deferred_spec(fmt + 1, &end, &nstars);
+      if (type == SYSLOG_DTYPE_BAD || end - fmt > SYSLOG_DSPECMAX)
+        {
+          return -ENOSYS;
+        }
+
+      if (msg->nargs + nstars + 1 > CONFIG_SYSLOG_DEFERRED_MAXARGS)
+        {
+          return -E2BIG;
+        }
+
+      /* Field width and precision values given as '*' */
+
+      for (; nstars > 0; nstars--)
+        {
+          msg->args[msg->nargs++].i = va_arg(ap, int);
+        }
+
+      switch (type)
+        {
+          case SYSLOG_DTYPE_INT:
+            msg->args[msg->nargs++].i = va_arg(ap, int);
+            break;
+
+          case SYSLOG_DTYPE_LONG:
+            msg->args[msg->nargs++].l = va_arg(ap, long);
+            break;
+
+#if defined(CONFIG_HAVE_LONG_LONG) && defined(CONFIG_LIBC_LONG_LONG)
+          case SYSLOG_DTYPE_LLONG:
+            msg->args[msg->nargs++].ll = va_arg(ap, long long);
+            break;
+#endif
+
+#ifdef CONFIG_LIBC_FLOATINGPOINT
+          case SYSLOG_DTYPE_DOUBLE:
+            msg->args[msg->nargs++].d = va_arg(ap, double);
+            break;
+#endif
+
+          case SYSLOG_DTYPE_PTR:
+            msg->args[msg->nargs++].p = va_arg(ap, FAR void *);
+            break;
+
+          case SYSLOG_DTYPE_STR:
+            str = va_arg(ap, FAR const char *);
+            if (str == NULL)
+              {
+                msg->args[msg->nargs++].soff = SYSLOG_DNULLSTR;
+                break;
+              }
+
+            /* Copy as much of the string as fits, always NUL terminated */
+
+            len = CONFIG_SYSLOG_DEFERRED_STRSIZE - msg->strlen;
+            if (len == 0)
+              {
+                return -E2BIG;
+              }
+
+            len = strnlen(str, len - 1);
+            memcpy(&msg->strings[msg->strlen], str, len);
+            msg->strings[msg->strlen + len] = '\0';
+
+            msg->args[msg->nargs++].soff = msg->strlen;
+            msg->strlen += len + 1;
+            break;
+
+          default:
+            break;
+        }
+
+      fmt = end;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: syslog_deferred_commit
+ *
+ * Description:
+ *   Reserve space for the encoded message in this CPU's ring and copy it
+ *   there.  Only the reservation itself is done with local interrupts
+ *   disabled; no lock is shared with other CPUs.
+ *
+ ****************************************************************************/
+
+static int syslog_deferred_commit(int priority, FAR const IPTR char *fmt,
+                                  FAR const struct syslog_dmsg_s *msg)
+{
+  FAR struct syslog_dring_s *ring;
+  FAR struct syslog_drec_s *rec;
+  FAR struct syslog_drec_s *pad;
+  FAR uint8_t *buffer;
+  irqstate_t flags;
+  uint32_t head;
+  uint32_t contig;
+  uint32_t need;
+  size_t argsize;
+  size_t reclen;
+  bool wasempty;
+
+  argsize = msg->nargs * sizeof(union syslog_darg_u);
+  reclen  = SYSLOG_DALIGN(SYSLOG_DHDRSIZE + argsize + msg->strlen);
+
+  flags  = up_irq_save();
+  ring   = &g_syslog_drings[up_cpu_index()];
+  buffer = (FAR uint8_t *)ring->buffer;
+  head   = ring->head;
+
+  /* A record never wraps around the end of the ring.  If it would, the
+   * remaining space is filled with a pad record.
+   */
+
+  contig = CONFIG_SYSLOG_DEFERRED_BUFSIZE - (head & SYSLOG_DMASK);
+  need   = contig < reclen ? contig + reclen : reclen;
+
+  if (head + need - ring->tail > CONFIG_SYSLOG_DEFERRED_BUFSIZE)
+    {
+      /* Only this CPU ever modifies the dropped count */
+
+      ring->dropped++;
+      up_irq_restore(flags);
+      return -ENOSPC;
+    }
+
+  wasempty = (head == ring->tail);
+
+  if (contig < reclen)
+    {
+      pad        = (FAR struct syslog_drec_s *)&buffer[head & SYSLOG_DMASK];
+      pad->len   = contig;
+      pad->state = SYSLOG_DSTATE_PAD;
+      head      += contig;
+    }
+
+  rec        = (FAR struct syslog_drec_s *)&buffer[head & SYSLOG_DMASK];
+  rec->len   = reclen;
+  rec->state = SYSLOG_DSTATE_BUSY;
+
+  SP_DMB();
+  ring->head = head + reclen;
+  up_irq_restore(flags);
+
+  /* The record is ours now.  Fill it in with interrupts enabled. */
+
+  rec->priority = priority;
+  rec->nargs    = msg->nargs;
+  rec->fmt      = fmt;
+#ifdef CONFIG_SYSLOG_TIMESTAMP
+  rec->ticks    = clock_systimer();
+#endif
+
+  memcpy((FAR uint8_t *)rec + SYSLOG_DHDRSIZE, msg->args, argsize);
+  memcpy((FAR uint8_t *)rec + SYSLOG_DHDRSIZE + argsize, msg->strings,
+         msg->strlen);
+
+  SP_DMB();
+  rec->state = SYSLOG_DSTATE_READY;
+
+  /* Wake up the drain thread if the ring was idle.  If the drain thread
+   * misses this, it will still find the message on its next poll.
+   */
+
+  if (wasempty)
+    {
+      (void)nxsem_post(&g_syslog_dsem);
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: syslog_deferred_format
+ *
+ * Description:
+ *   Format one deferred message to the SYSLOG stream.  Literal text is
+ *   copied through; each conversion specification is handed to
+ *   lib_sprintf() along with its recorded argument.
+ *
+ ****************************************************************************/
+
+static void syslog_deferred_format(FAR struct lib_outstream_s *stream,
+                                   FAR const struct syslog_drec_s *rec)
+{
+  FAR const union syslog_darg_u *args;
+  FAR const char *strings;
+  FAR const IPTR char *fmt;
+  FAR const IPTR char *end;
+  FAR const char *str;
+  char spec[SYSLOG_DSPECSIZE];
+  int argndx = 0;
+  int nstars;
+  int type;
+  int len;
+
+  args    = (FAR const union syslog_darg_u *)
+            ((FAR const uint8_t *)rec + SYSLOG_DHDRSIZE);
+  strings = (FAR const char *)&args[rec->nargs];
+
+  for (fmt = rec->fmt; *fmt != '\0'; fmt++)
+    {
+      if (*fmt != '%')
+        {
+          stream->put(stream, *fmt);
+          continue;
+        }
+
+      type = syslog_deferred_spec(fmt + 1, &end, &nstars);
+      if (type == SYSLOG_DTYPE_NONE)
+        {
+          stream->put(stream, '%');
+          argndx += nstars;
+          fmt = end;
+          continue;
+        }
+
+      /* Rebuild the specification, replacing each '*' with its value.  The
+       * length of the specification was checked when it was recorded.
+       */
+
+      for (len = 0; fmt <= end; fmt++)
+        {
+          if (*fmt != '*')
+            {
+              spec[len++] = *fmt;
+            }
+          else if (len > 0 && spec[len - 1] == '.' && args[argndx].i < 0)
+            {
+              /* A negative precision is taken as if it were omitted */
+
+              len--;
+              argndx++;
+            }
+          else
+            {
+              len += snprintf(&spec[len], 12, "%d", args[argndx++].i);
+            }
+        }
+
+      spec[len] = '\0';
+      fmt = end;
+
+      switch (type)
+        {
+          case SYSLOG_DTYPE_INT:
+            (void)lib_sprintf(stream, spec, args[argndx++].i);
+            break;
+
+          case SYSLOG_DTYPE_LONG:
+            (void)lib_sprintf(stream, spec, args[argndx++].l);
+            break;
+
+#if defined(CONFIG_HAVE_LONG_LONG) && defined(CONFIG_LIBC_LONG_LONG)
+          case SYSLOG_DTYPE_LLONG:
+            (void)lib_sprintf(stream, spec, args[argndx++].ll);
+            break;
+#endif
+
+#ifdef CONFIG_LIBC_FLOATINGPOINT
+          case SYSLOG_DTYPE_DOUBLE:
+            (void)lib_sprintf(stream, spec, args[argndx++].d);
+            break;
+#endif
+
+          case SYSLOG_DTYPE_PTR:
+            (void)lib_sprintf(stream, spec, args[argndx++].p);
+            break;
+
+          case SYSLOG_DTYPE_STR:
+            str = NULL;
+            if (args[argndx].soff != SYSLOG_DNULLSTR)
+              {
+                str = &strings[args[argndx].soff];
+              }
+
+            argndx++;
+            (void)lib_sprintf(stream, spec, str);
+            break;
+
+          default:
+            break;
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: syslog_deferred_emit
+ *
+ * Description:
+ *   Send one deferred message to the SYSLOG channel, prefixed with its
+ *   timestamp if so configured.
+ *
+ ****************************************************************************/
+
+static void syslog_deferred_emit(FAR const struct syslog_drec_s *rec)
+{
+  struct lib_syslogstream_s stream;
+
+  syslogstream_create(&stream);
+
+#ifdef CONFIG_SYSLOG_TIMESTAMP
+  /* The time is that at which the message was logged */
+
+  (void)lib_sprintf(&stream.public, "[%6d.%06d]",
+                    (int)(rec->ticks / TICK_PER_SEC),
+                    (int)((rec->ticks % TICK_PER_SEC) * USEC_PER_TICK));
+#endif
+
+  syslog_deferred_format(&stream.public, rec);
+  syslogstream_destroy(&stream);
+}
+
+/****************************************************************************
+ * Name: syslog_deferred_dropped
+ *
+ * Description:
+ *   Report messages that were lost because a ring was full.
+ *
+ ****************************************************************************/
+
+static void syslog_deferred_dropped(int cpu, uint32_t count)
+{
+  struct lib_syslogstream_s stream;
+
+  syslogstream_create(&stream);
+  (void)lib_sprintf(&stream.public, "[%lu syslog messages dropped on CPU %d]\n",
+                    (unsigned long)count, cpu);
+  syslogstream_destroy(&stream);
+}
+
+/****************************************************************************
+ * Name: syslog_deferred_thread
+ *
+ * Description:
+ *   The low priority thread that formats deferred messages.
+ *
+ ****************************************************************************/
+
+static int syslog_deferred_thread(int argc, FAR char *argv[])
+{
+  for (; ; )
+    {
+      (void)nxsem_tickwait(&g_syslog_dsem, clock_systimer(),
+                           MSEC2TICK(CONFIG_SYSLOG_DEFERRED_INTERVAL));
+      syslog_deferred_drain();
+    }
+
+  return OK; /* Not reachable */
+}
+
+/****************************************************************************
+ * Name: syslog_deferred_start
+ *
+ * Description:
+ *   Start the drain thread.  This is done lazily, on the first message
+ *   logged from a normal task context after the OS is up.
+ *
+ ****************************************************************************/
+
+static void syslog_deferred_start(void)
+{
+  irqstate_t flags;
+  int ret;
+
+  if (up_interrupt_context() || sched_idletask() || !OSINIT_OS_READY())
+    {
+      return;
+    }
+
+  flags = enter_critical_section();
+  if (g_syslog_dthread != SYSLOG_DTHREAD_IDLE)
+    {
+      leave_critical_section(flags);
+      return;
+    }
+
+  g_syslog_dthread = SYSLOG_DTHREAD_STARTING;
+  leave_critical_section(flags);
+
+  /* The semaphore is used for signaling and, hence, should not have
+   * priority inheritance enabled.
+   */
+
+  nxsem_init(&g_syslog_dsem, 0, 0);
+  nxsem_setprotocol(&g_syslog_dsem, SEM_PRIO_NONE);
+
+  ret = kthread_create("syslogd", CONFIG_SYSLOG_DEFERRED_PRIORITY,
+                       CONFIG_SYSLOG_DEFERRED_STACKSIZE,
+                       (main_t)syslog_deferred_thread, NULL);
+  if (ret < 0)
+    {
+      /* Stay in the STARTING state so that we do not retry on every
+       * message; output simply remains synchronous.
+       */
+
+      nxsem_destroy(&g_syslog_dsem);
+      return;
+    }
+
+  g_syslog_dthread = SYSLOG_DTHREAD_RUNNING;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: syslog_deferred
+ *
+ * Description:
+ *   Record a SYSLOG message for later formatting by the SYSLOG drain
+ *   thread.  Only the format string pointer and the raw argument values
+ *   (plus copies of any string arguments) are saved, in a ring belonging
+ *   to the current CPU.
+ *
+ * Input Parameters:
+ *   priority - The message priority
+ *   fmt      - The format string.  This must remain valid until the
+ *              message has been formatted (normally it is a literal).
+ *   ap       - The arguments
+ *
+ * Returned Value:
+ *   Zero (OK) if the message was deferred.  -ENOSPC if the ring is full;
+ *   the message is then dropped, counted and later reported by the drain
+ *   thread.  Any other negated errno value means that the message was not
+ *   recorded and should be formatted synchronously by the caller:  The
+ *   drain thread is not running, or the format uses unsupported
+ *   conversions or too many arguments.
+ *
+ * Assumptions:
+ *   May be called from any context, including interrupt handlers.
+ *
+ ****************************************************************************/
+
+int syslog_deferred(int priority, FAR const IPTR char *fmt, va_list ap)
+{
+  struct syslog_dmsg_s msg;
+  int ret;
+
+  if (g_syslog_dthread != SYSLOG_DTHREAD_RUNNING)
+    {
+      syslog_deferred_start();
+      if (g_syslog_dthread != SYSLOG_DTHREAD_RUNNING)
+        {
+          return -EAGAIN;
+        }
+    }
+
+  ret = syslog_deferred_encode(&msg, fmt, ap);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  return syslog_deferred_commit(priority, fmt, &msg);
+}
+
+/****************************************************************************
+ * Name: syslog_deferred_drain
+ *
+ * Description:
+ *   Format and output all complete messages in the deferred rings.  This
+ *   is normally done by the drain thread but may also be called to flush
+ *   the rings before a shutdown.
+ *
+ * Input Parameters:
+ *   None
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void syslog_deferred_drain(void)
+{
+  FAR struct syslog_dring_s *ring;
+  FAR struct syslog_drec_s *rec;
+  FAR uint8_t *buffer;
+  irqstate_t flags;
+  uint32_t dropped;
+  uint32_t tail;
+  bool progress;
+  int i;
+
+  /* Only one drain may run at a time */
+
+  flags = enter_critical_section();
+  if (g_syslog_ddraining)
+    {
+      leave_critical_section(flags);
+      return;
+    }
+
+  g_syslog_ddraining = true;
+  leave_critical_section(flags);
+
+  /* Take one message from each ring in turn so that the output of the
+   * CPUs is roughly interleaved in time.
+   */
+
+  do
+    {
+      progress = false;
+
+      for (i = 0; i < SYSLOG_NRINGS; i++)
+        {
+          ring   = &g_syslog_drings[i];
+          buffer = (FAR uint8_t *)ring->buffer;
+          tail   = ring->tail;
+
+          dropped = ring->dropped;
+          if (dropped != ring->reported)
+            {
+              syslog_deferred_dropped(i, dropped - ring->reported);
+              ring->reported = dropped;
+            }
+
+          while (tail != ring->head)
+            {
+              SP_DMB();
+              rec = (FAR struct syslog_drec_s *)&buffer[tail & SYSLOG_DMASK];
+
+              if (rec->state == SYSLOG_DSTATE_PAD)
+                {
+                  tail += rec->len;
+                  continue;
+                }
+              else if (rec->state == SYSLOG_DSTATE_READY)
+                {
+                  syslog_deferred_emit(rec);
+                  tail    += rec->len;
+                  progress = true;
+                }
+
+              /* Stop at a message that is still being filled in */
+
+              break;
+            }
+
+          SP_DMB();
+          ring->tail = tail;
+        }
+    }
+  while (progress);
+
+  g_syslog_ddraining = false;
+}
+
+#endif /* CONFIG_SYSLOG_DEFERRED */
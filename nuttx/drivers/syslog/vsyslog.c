@@ -49,6 +49,8 @@
 #include <nuttx/streams.h>
 #include <nuttx/syslog/syslog.h>
 
+#include "syslog.h"
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -69,11 +71,42 @@
 int _vsyslog(int priority, FAR const IPTR char *fmt, FAR va_list *ap)
 {
   struct lib_syslogstream_s stream;
-  int ret;
-
 #ifdef CONFIG_SYSLOG_TIMESTAMP
   struct timespec ts;
+#endif
+  int ret;
 
+#ifdef CONFIG_SYSLOG_DEFERRED
+  /* Try to record the message for formatting later by the SYSLOG drain
+   * thread.  Emergency output is never deferred.  If the ring is full, the
+   * message is dropped (and counted) rather than formatted here:  The
+   * caller may be time critical, and formatting synchronously would also
+   * reorder the output ahead of the messages still in the ring.
+   */
+
+  if (priority != LOG_EMERG)
+    {
+      va_list copy;
+
+      va_copy(copy, *ap);
+      ret = syslog_deferred(priority, fmt, copy);
+      va_end(copy);
+
+      if (ret >= 0 || ret == -ENOSPC)
+        {
+          struct lib_outstream_s nullstream;
+
+          /* Return the length of the message, as when it is output
+           * directly.  Counting it is much cheaper than writing it.
+           */
+
+          lib_nulloutstream(&nullstream);
+          return lib_vsprintf(&nullstream, fmt, *ap);
+        }
+    }
+#endif
+
+#ifdef CONFIG_SYSLOG_TIMESTAMP
   /* Get the current time.  Since debug output may be generated very early
    * in the start-up sequence, hardware timer support may not yet be
    * available.
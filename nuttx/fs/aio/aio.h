@@ -43,6 +43,7 @@
 #include <nuttx/config.h>
 
 #include <sys/types.h>
+#include <stdbool.h>
 #include <string.h>
 #include <aio.h>
 #include <queue.h>
@@ -78,6 +79,34 @@
 #  error AIO needs file and/or socket descriptors
 #endif
 
+/* AIO worker thread pool */
+
+#ifdef CONFIG_FS_AIO_WORKERS
+#  ifndef CONFIG_FS_AIO_NWORKERS
+#    define CONFIG_FS_AIO_NWORKERS 1
+#  endif
+#  ifndef CONFIG_FS_AIO_PRIORITY
+#    define CONFIG_FS_AIO_PRIORITY 100
+#  endif
+#  ifndef CONFIG_FS_AIO_STACKSIZE
+#    define CONFIG_FS_AIO_STACKSIZE 2048
+#  endif
+#  ifndef CONFIG_FS_AIO_MAXMERGE
+#    define CONFIG_FS_AIO_MAXMERGE 8
+#  endif
+#endif
+
+/* When the I/O is performed on the low priority work queue, the priority of
+ * the work queue is boosted to the priority of the requester (aio_queue())
+ * and restored by the worker function when the I/O completes.  The AIO
+ * worker threads manage their own priority.
+ */
+
+#undef AIO_LPWORK_INHERITANCE
+#if defined(CONFIG_PRIORITY_INHERITANCE) && !defined(CONFIG_FS_AIO_WORKERS)
+#  define AIO_LPWORK_INHERITANCE 1
+#endif
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -101,8 +130,15 @@ struct aio_container_s
 #endif
     FAR void *ptr;                 /* Generic pointer to FAR data */
   } u;
+#ifdef CONFIG_FS_AIO_WORKERS
+  dq_entry_t aioc_wlink;           /* Supports the AIO worker queue */
+  worker_t aioc_worker;            /* Worker function that performs the I/O */
+  bool aioc_queued;                /* True: In an AIO worker queue */
+#else
   struct work_s aioc_work;         /* Used to defer I/O to the work thread */
+#endif
   pid_t aioc_pid;                  /* ID of the waiting task */
+  uint8_t aioc_opcode;             /* LIO_READ, LIO_WRITE, or LIO_NOP */
 #ifdef CONFIG_PRIORITY_INHERITANCE
   uint8_t aioc_prio;               /* Priority of the waiting task */
 #endif
@@ -212,6 +248,9 @@ void aioc_free(FAR struct aio_container_s *aioc);
  *
  * Input Parameters:
  *   aiocbp - The AIO control block pointer
+ *   opcode - The type of the I/O operation:  LIO_READ, LIO_WRITE, or
+ *            LIO_NOP for operations that may never be merged with other
+ *            requests (such as fsync).
  *
  * Returned Value:
  *   A reference to the new AIO control block container.   This function
@@ -221,7 +260,8 @@ void aioc_free(FAR struct aio_container_s *aioc);
  *
  ****************************************************************************/
 
-FAR struct aio_container_s *aio_contain(FAR struct aiocb *aiocbp);
+FAR struct aio_container_s *aio_contain(FAR struct aiocb *aiocbp,
+                                        int opcode);
 
 /****************************************************************************
  * Name: aioc_decant
@@ -244,11 +284,12 @@ FAR struct aiocb *aioc_decant(FAR struct aio_container_s *aioc);
  * Name: aio_queue
  *
  * Description:
- *   Schedule the asynchronous I/O on the low priority work queue
+ *   Schedule the asynchronous I/O on the low priority work queue or, if
+ *   CONFIG_FS_AIO_WORKERS is selected, on one of the AIO worker threads.
  *
  * Input Parameters:
- *   arg - Worker argument.  In this case, a pointer to an instance of
- *     struct aiocb cast to void *.
+ *   aioc   - The AIO container to be queued
+ *   worker - The function that will perform the I/O
  *
  * Returned Value:
  *   Zero (OK) on success.  Otherwise, -1 is returned and the errno is set
@@ -258,6 +299,65 @@ FAR struct aiocb *aioc_decant(FAR struct aio_container_s *aioc);
 
 int aio_queue(FAR struct aio_container_s *aioc, worker_t worker);
 
+/****************************************************************************
+ * Name: aio_dequeue
+ *
+ * Description:
+ *   Remove a queued asynchronous I/O operation before it is started.
+ *
+ * Input Parameters:
+ *   aioc - The AIO container to be removed from the queue
+ *
+ * Returned Value:
+ *   Zero (OK) if the I/O was removed from the queue.  -ENOENT is returned
+ *   if the I/O could not be removed because it has already been started.
+ *
+ * Assumptions:
+ *   The caller holds the AIO lock.
+ *
+ ****************************************************************************/
+
+int aio_dequeue(FAR struct aio_container_s *aioc);
+
+#ifdef CONFIG_FS_AIO_WORKERS
+/****************************************************************************
+ * Name: aio_worker_queue
+ *
+ * Description:
+ *   Add the asynchronous I/O to the queue of the AIO worker thread that
+ *   services the file, starting the worker threads if necessary.
+ *
+ * Input Parameters:
+ *   aioc   - The AIO container to be queued
+ *   worker - The function that will perform the I/O
+ *
+ * Returned Value:
+ *   Zero (OK) on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int aio_worker_queue(FAR struct aio_container_s *aioc, worker_t worker);
+
+/****************************************************************************
+ * Name: aio_worker_cancel
+ *
+ * Description:
+ *   Remove the asynchronous I/O from the queue of the AIO worker thread.
+ *
+ * Input Parameters:
+ *   aioc - The AIO container to be removed from the queue
+ *
+ * Returned Value:
+ *   Zero (OK) on success; -ENOENT if the I/O is no longer queued.
+ *
+ * Assumptions:
+ *   The caller holds the AIO lock.
+ *
+ ****************************************************************************/
+
+int aio_worker_cancel(FAR struct aio_container_s *aioc);
+#endif
+
 /****************************************************************************
  * Name: aio_signal
  *
@@ -133,13 +133,19 @@ int aio_cancel(int fildes, FAR struct aiocb *aiocbp)
                * possibilities:* (1) the work has already been started and
                * is no longer queued, or (2) the work has not been started
                * and is still in the work queue.  Only the second case can
-               * be canceled.  work_cancel() will return -ENOENT in the
+               * be canceled.  aio_dequeue() will return -ENOENT in the
                * first case.
                */
 
-              status = work_cancel(LPWORK, &aioc->aioc_work);
+              status = aio_dequeue(aioc);
               if (status >= 0)
                 {
+                  /* Remove the container from the list of pending
+                   * transfers.  Otherwise, the worker owns the container
+                   * and will release it when the I/O completes.
+                   */
+
+                  (void)aioc_decant(aioc);
                   aiocbp->aio_result = -ECANCELED;
                   ret = AIO_CANCELED;
                 }
@@ -147,10 +153,6 @@ int aio_cancel(int fildes, FAR struct aiocb *aiocbp)
                 {
                   ret = AIO_NOTCANCELED;
                 }
-
-              /* Remove the container from the list of pending transfers */
-
-              (void)aioc_decant(aioc);
             }
         }
     }
@@ -177,20 +179,22 @@ int aio_cancel(int fildes, FAR struct aiocb *aiocbp)
                * possibilities:* (1) the work has already been started and
                * is no longer queued, or (2) the work has not been started
                * and is still in the work queue.  Only the second case can
-               * be canceled.  work_cancel() will return -ENOENT in the
+               * be canceled.  aio_dequeue() will return -ENOENT in the
                * first case.
                */
 
-              status = work_cancel(LPWORK, &aioc->aioc_work);
-
-              /* Remove the container from the list of pending transfers */
-
+              status = aio_dequeue(aioc);
               next   = (FAR struct aio_container_s *)aioc->aioc_link.flink;
-              aiocbp = aioc_decant(aioc);
-              DEBUGASSERT(aiocbp);
 
               if (status >= 0)
                 {
+                  /* Remove the container from the list of pending
+                   * transfers.
+                   */
+
+                  aiocbp = aioc_decant(aioc);
+                  DEBUGASSERT(aiocbp);
+
                   aiocbp->aio_result = -ECANCELED;
                   if (ret != AIO_NOTCANCELED)
                     {
@@ -76,8 +76,9 @@ static void aio_fsync_worker(FAR void *arg)
 {
   FAR struct aio_container_s *aioc = (FAR struct aio_container_s *)arg;
   FAR struct aiocb *aiocbp;
+  FAR struct file *filep;
   pid_t pid;
-#ifdef CONFIG_PRIORITY_INHERITANCE
+#ifdef AIO_LPWORK_INHERITANCE
   uint8_t prio;
 #endif
   int ret;
@@ -89,14 +90,15 @@ static void aio_fsync_worker(FAR void *arg)
 
   DEBUGASSERT(aioc && aioc->aioc_aiocbp);
   pid    = aioc->aioc_pid;
-#ifdef CONFIG_PRIORITY_INHERITANCE
+#ifdef AIO_LPWORK_INHERITANCE
   prio   = aioc->aioc_prio;
 #endif
+  filep  = aioc->u.aioc_filep;
   aiocbp = aioc_decant(aioc);
 
-  /* Perform the fsync using u.aioc_filep */
+  /* Perform the fsync using the file structure pointer */
 
-  ret = file_fsync(aioc->u.aioc_filep);
+  ret = file_fsync(filep);
   if (ret < 0)
     {
       ferr("ERROR: file_fsync failed: %d\n", ret);
@@ -111,7 +113,7 @@ static void aio_fsync_worker(FAR void *arg)
 
   (void)aio_signal(pid, aiocbp);
 
-#ifdef CONFIG_PRIORITY_INHERITANCE
+#ifdef AIO_LPWORK_INHERITANCE
   /* Restore the low priority worker thread default priority */
 
   lpwork_restorepriority(prio);
@@ -217,7 +219,7 @@ int aio_fsync(int op, FAR struct aiocb *aiocbp)
    * block if there are insufficient resources to satisfy the request.
    */
 
-  aioc = aio_contain(aiocbp);
+  aioc = aio_contain(aiocbp, LIO_NOP);
   if (!aioc)
     {
       /* The errno has already been set (probably EBADF) */
@@ -51,18 +51,19 @@
 #ifdef CONFIG_FS_AIO
 
 /****************************************************************************
- * Private Functions
+ * Public Functions
  ****************************************************************************/
 
 /****************************************************************************
  * Name: aio_queue
  *
  * Description:
- *   Schedule the asynchronous I/O on the low priority work queue
+ *   Schedule the asynchronous I/O on the low priority work queue or, if
+ *   CONFIG_FS_AIO_WORKERS is selected, on one of the AIO worker threads.
  *
  * Input Parameters:
- *   arg - Worker argument.  In this case, a pointer to an instance of
- *     struct aiocb cast to void *.
+ *   aioc   - The AIO container to be queued
+ *   worker - The function that will perform the I/O
  *
  * Returned Value:
  *   Zero (OK) on success.  Otherwise, -1 is returned and the errno is set
@@ -74,6 +75,13 @@ int aio_queue(FAR struct aio_container_s *aioc, worker_t worker)
 {
   int ret;
 
+#ifdef CONFIG_FS_AIO_WORKERS
+  /* Add the work to the queue of the AIO worker thread that services this
+   * file.  The worker thread manages its own priority.
+   */
+
+  ret = aio_worker_queue(aioc, worker);
+#else
 #ifdef CONFIG_PRIORITY_INHERITANCE
   /* Prohibit context switches until we complete the queuing */
 
@@ -89,9 +97,21 @@ int aio_queue(FAR struct aio_container_s *aioc, worker_t worker)
   /* Schedule the work on the low priority worker thread */
 
   ret = work_queue(LPWORK, &aioc->aioc_work, worker, aioc, 0);
+
+#ifdef CONFIG_PRIORITY_INHERITANCE
+  /* Now the low-priority work queue might run at its new priority */
+
+  sched_unlock();
+#endif
+#endif /* CONFIG_FS_AIO_WORKERS */
+
   if (ret < 0)
     {
-      FAR struct aiocb *aiocbp = aioc->aioc_aiocbp;
+      FAR struct aiocb *aiocbp;
+
+      /* Release the container; it will never be processed */
+
+      aiocbp = aioc_decant(aioc);
       DEBUGASSERT(aiocbp);
 
       aiocbp->aio_result = ret;
@@ -99,12 +119,34 @@ int aio_queue(FAR struct aio_container_s *aioc, worker_t worker)
       ret = ERROR;
     }
 
-#ifdef CONFIG_PRIORITY_INHERITANCE
-  /* Now the low-priority work queue might run at its new priority */
+  return ret;
+}
 
-  sched_unlock();
+/****************************************************************************
+ * Name: aio_dequeue
+ *
+ * Description:
+ *   Remove a queued asynchronous I/O operation before it is started.
+ *
+ * Input Parameters:
+ *   aioc - The AIO container to be removed from the queue
+ *
+ * Returned Value:
+ *   Zero (OK) if the I/O was removed from the queue.  -ENOENT is returned
+ *   if the I/O could not be removed because it has already been started.
+ *
+ * Assumptions:
+ *   The caller holds the AIO lock.
+ *
+ ****************************************************************************/
+
+int aio_dequeue(FAR struct aio_container_s *aioc)
+{
+#ifdef CONFIG_FS_AIO_WORKERS
+  return aio_worker_cancel(aioc);
+#else
+  return work_cancel(LPWORK, &aioc->aioc_work);
 #endif
-  return ret;
 }
 
 #endif /* CONFIG_FS_AIO */
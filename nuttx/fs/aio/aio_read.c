@@ -76,8 +76,14 @@ static void aio_read_worker(FAR void *arg)
 {
   FAR struct aio_container_s *aioc = (FAR struct aio_container_s *)arg;
   FAR struct aiocb *aiocbp;
+#ifdef AIO_HAVE_FILEP
+  FAR struct file *filep;
+#endif
+#ifdef AIO_HAVE_PSOCK
+  FAR struct socket *psock;
+#endif
   pid_t pid;
-#ifdef CONFIG_PRIORITY_INHERITANCE
+#ifdef AIO_LPWORK_INHERITANCE
   uint8_t prio;
 #endif
   ssize_t nread = 0;
@@ -89,8 +95,14 @@ static void aio_read_worker(FAR void *arg)
 
   DEBUGASSERT(aioc && aioc->aioc_aiocbp);
   pid    = aioc->aioc_pid;
-#ifdef CONFIG_PRIORITY_INHERITANCE
+#ifdef AIO_LPWORK_INHERITANCE
   prio   = aioc->aioc_prio;
+#endif
+#ifdef AIO_HAVE_FILEP
+  filep  = aioc->u.aioc_filep;
+#endif
+#ifdef AIO_HAVE_PSOCK
+  psock  = aioc->u.aioc_psock;
 #endif
   aiocbp = aioc_decant(aioc);
 
@@ -101,13 +113,13 @@ static void aio_read_worker(FAR void *arg)
     {
       /* Perform the file read using:
        *
-       *   u.aioc_filep - File structure pointer
+       *   filep        - File structure pointer
        *   aio_buf      - Location of buffer
        *   aio_nbytes   - Length of transfer
        *   aio_offset   - File offset
        */
 
-     nread = file_pread(aioc->u.aioc_filep, (FAR void *)aiocbp->aio_buf,
+     nread = file_pread(filep, (FAR void *)aiocbp->aio_buf,
                         aiocbp->aio_nbytes, aiocbp->aio_offset);
     }
 #endif
@@ -118,12 +130,12 @@ static void aio_read_worker(FAR void *arg)
     {
       /* Perform the socket receive using:
        *
-       *   u.aioc_psock - Socket structure pointer
+       *   psock        - Socket structure pointer
        *   aio_buf      - Location of buffer
        *   aio_nbytes   - Length of transfer
        */
 
-      nread = psock_recv(aioc->u.aioc_psock, (FAR void *)aiocbp->aio_buf,
+      nread = psock_recv(psock, (FAR void *)aiocbp->aio_buf,
                          aiocbp->aio_nbytes, 0);
     }
 #endif
@@ -143,7 +155,7 @@ static void aio_read_worker(FAR void *arg)
 
   (void)aio_signal(pid, aiocbp);
 
-#ifdef CONFIG_PRIORITY_INHERITANCE
+#ifdef AIO_LPWORK_INHERITANCE
   /* Restore the low priority worker thread default priority */
 
   lpwork_restorepriority(prio);
@@ -266,7 +278,7 @@ int aio_read(FAR struct aiocb *aiocbp)
    * block if there are insufficient resources to satisfy the request.
    */
 
-  aioc = aio_contain(aiocbp);
+  aioc = aio_contain(aiocbp, LIO_READ);
   if (!aioc)
     {
       /* The errno has already been set (probably EBADF) */
@@ -0,0 +1,617 @@
+/****************************************************************************
+ * fs/aio/aio_worker.c
+ *
+ *   Copyright (C) 2018 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <sched.h>
+#include <fcntl.h>
+#include <aio.h>
+#include <queue.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/sched.h>
+#include <nuttx/kthread.h>
+#include <nuttx/semaphore.h>
+#include <nuttx/fs/fs.h>
+
+#include "aio/aio.h"
+
+#if defined(CONFIG_FS_AIO) && defined(CONFIG_FS_AIO_WORKERS)
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Only file I/O is merged */
+
+#undef AIO_HAVE_MERGE
+#if CONFIG_FS_AIO_MAXMERGE > 1 && defined(AIO_HAVE_FILEP)
+#  define AIO_HAVE_MERGE 1
+#endif
+
+/* Convert a worker queue entry to the containing AIO container */
+
+#define AIO_WLINK2AIOC(e) \
+  ((FAR struct aio_container_s *) \
+   ((uintptr_t)(e) - offsetof(struct aio_container_s, aioc_wlink)))
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* This structure describes the state of one AIO worker thread */
+
+struct aio_worker_s
+{
+  dq_queue_t aw_queue;             /* Queue of pending I/O (FIFO) */
+  sem_t aw_sem;                    /* Used to wake up the worker thread */
+  pid_t aw_pid;                    /* Task ID of the worker thread */
+};
+
+/* This structure holds the information needed to complete one request
+ * that was merged into a larger transfer.  The information must be
+ * captured before the container is released.
+ */
+
+#ifdef AIO_HAVE_MERGE
+struct aio_merged_s
+{
+  FAR struct aiocb *am_aiocbp;     /* The AIO control block */
+  pid_t am_pid;                    /* ID of the waiting task */
+};
+#endif
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* The AIO worker threads */
+
+static struct aio_worker_s g_aio_workers[CONFIG_FS_AIO_NWORKERS];
+
+/* The number of AIO worker threads that have been started */
+
+static int g_aio_nstarted;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: aio_worker_select
+ *
+ * Description:
+ *   Select the worker thread that will perform I/O for the file or socket
+ *   associated with the container.  All I/O for the same file is always
+ *   assigned to the same worker so that the requests are performed in the
+ *   order in which they were submitted.
+ *
+ ****************************************************************************/
+
+static inline FAR struct aio_worker_s *
+aio_worker_select(FAR struct aio_container_s *aioc)
+{
+#if CONFIG_FS_AIO_NWORKERS > 1
+  uintptr_t hash = (uintptr_t)aioc->u.ptr;
+
+  hash ^= hash >> 8;
+  return &g_aio_workers[(hash >> 4) % CONFIG_FS_AIO_NWORKERS];
+#else
+  return &g_aio_workers[0];
+#endif
+}
+
+/****************************************************************************
+ * Name: aio_worker_boost and aio_worker_restore
+ *
+ * Description:
+ *   Raise the priority of the worker thread to the priority of the
+ *   requester, then restore the default priority when the I/O completes.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_PRIORITY_INHERITANCE
+static void aio_worker_boost(uint8_t reqprio)
+{
+  struct sched_param param;
+
+  if (reqprio > CONFIG_FS_AIO_PRIORITY)
+    {
+      param.sched_priority = reqprio;
+      (void)nxsched_setparam(0, &param);
+    }
+}
+
+static void aio_worker_restore(uint8_t reqprio)
+{
+  struct sched_param param;
+
+  if (reqprio > CONFIG_FS_AIO_PRIORITY)
+    {
+      param.sched_priority = CONFIG_FS_AIO_PRIORITY;
+      (void)nxsched_setparam(0, &param);
+    }
+}
+#else
+#  define aio_worker_boost(p)
+#  define aio_worker_restore(p)
+#endif
+
+/****************************************************************************
+ * Name: aio_worker_canmerge
+ *
+ * Description:
+ *   Return true if the I/O in 'next' can be merged into the same transfer
+ *   as 'prev'.  The requests must be reads or writes on the same file, from
+ *   the same task, and both the file offsets and the user buffers must be
+ *   contiguous.
+ *
+ ****************************************************************************/
+
+#ifdef AIO_HAVE_MERGE
+static bool aio_worker_canmerge(FAR struct aio_container_s *prev,
+                                FAR struct aio_container_s *next)
+{
+  FAR struct aiocb *pcb = prev->aioc_aiocbp;
+  FAR struct aiocb *ncb = next->aioc_aiocbp;
+
+  if (prev->aioc_opcode != next->aioc_opcode ||
+      (prev->aioc_opcode != LIO_READ && prev->aioc_opcode != LIO_WRITE) ||
+      prev->u.ptr != next->u.ptr || prev->aioc_pid != next->aioc_pid)
+    {
+      return false;
+    }
+
+#ifdef AIO_HAVE_PSOCK
+  /* Socket I/O is never merged */
+
+  if (pcb->aio_fildes >= CONFIG_NFILE_DESCRIPTORS)
+    {
+      return false;
+    }
+#endif
+
+  /* Writes in append mode ignore the file offset */
+
+  if (prev->aioc_opcode == LIO_WRITE &&
+      (prev->u.aioc_filep->f_oflags & O_APPEND) != 0)
+    {
+      return false;
+    }
+
+  return ncb->aio_offset == pcb->aio_offset + (off_t)pcb->aio_nbytes &&
+         (FAR uint8_t *)ncb->aio_buf ==
+         (FAR uint8_t *)pcb->aio_buf + pcb->aio_nbytes;
+}
+#endif
+
+/****************************************************************************
+ * Name: aio_worker_merged
+ *
+ * Description:
+ *   Perform several adjacent read or write requests as a single transfer
+ *   and distribute the result among the requests.
+ *
+ * Input Parameters:
+ *   list  - The list of merged containers, in file order
+ *   nreqs - The number of containers in the list
+ *
+ * Assumptions:
+ *   Called with the AIO lock held.  The lock is released before the
+ *   transfer is started.
+ *
+ ****************************************************************************/
+
+#ifdef AIO_HAVE_MERGE
+static void aio_worker_merged(FAR struct aio_container_s **list, int nreqs)
+{
+  struct aio_merged_s merged[CONFIG_FS_AIO_MAXMERGE];
+  FAR struct file *filep;
+  FAR struct aiocb *aiocbp;
+  FAR void *buffer;
+  ssize_t remaining;
+  size_t nbytes;
+  off_t offset;
+  bool write;
+  int i;
+
+  /* Capture everything that we need from the containers, then release the
+   * containers before starting the I/O.
+   */
+
+  filep  = list[0]->u.aioc_filep;
+  write  = (list[0]->aioc_opcode == LIO_WRITE);
+  buffer = (FAR void *)list[0]->aioc_aiocbp->aio_buf;
+  offset = list[0]->aioc_aiocbp->aio_offset;
+  nbytes = 0;
+
+  for (i = 0; i < nreqs; i++)
+    {
+      merged[i].am_pid    = list[i]->aioc_pid;
+      merged[i].am_aiocbp = aioc_decant(list[i]);
+      nbytes             += merged[i].am_aiocbp->aio_nbytes;
+    }
+
+  aio_unlock();
+
+  finfo("Merged %d requests: offset=%ld nbytes=%lu\n",
+        nreqs, (long)offset, (unsigned long)nbytes);
+
+  /* Perform the transfer */
+
+  if (write)
+    {
+      remaining = file_pwrite(filep, buffer, nbytes, offset);
+    }
+  else
+    {
+      remaining = file_pread(filep, buffer, nbytes, offset);
+    }
+
+  if (remaining < 0)
+    {
+      ferr("ERROR: Merged transfer failed: %d\n", (int)remaining);
+    }
+
+  /* Distribute the result.  On a short transfer, the leading requests are
+   * satisfied first.  An error is reported to each request.
+   */
+
+  for (i = 0; i < nreqs; i++)
+    {
+      aiocbp = merged[i].am_aiocbp;
+      if (remaining < 0)
+        {
+          aiocbp->aio_result = remaining;
+        }
+      else if ((size_t)remaining >= aiocbp->aio_nbytes)
+        {
+          aiocbp->aio_result = aiocbp->aio_nbytes;
+          remaining         -= aiocbp->aio_nbytes;
+        }
+      else
+        {
+          aiocbp->aio_result = remaining;
+          remaining          = 0;
+        }
+
+      (void)aio_signal(merged[i].am_pid, aiocbp);
+    }
+}
+#endif
+
+/****************************************************************************
+ * Name: aio_worker_process
+ *
+ * Description:
+ *   Perform all of the I/O in the worker's queue.
+ *
+ ****************************************************************************/
+
+static void aio_worker_process(FAR struct aio_worker_s *worker)
+{
+  FAR struct aio_container_s *list[CONFIG_FS_AIO_MAXMERGE];
+  FAR struct aio_container_s *aioc;
+  FAR dq_entry_t *entry;
+  worker_t func;
+#ifdef CONFIG_PRIORITY_INHERITANCE
+  uint8_t prio;
+#endif
+  int nreqs;
+
+  for (; ; )
+    {
+      /* Remove the next I/O from the queue */
+
+      aio_lock();
+      entry = dq_remfirst(&worker->aw_queue);
+      if (entry == NULL)
+        {
+          aio_unlock();
+          return;
+        }
+
+      aioc = AIO_WLINK2AIOC(entry);
+      aioc->aioc_queued = false;
+      list[0] = aioc;
+      nreqs   = 1;
+
+#ifdef CONFIG_PRIORITY_INHERITANCE
+      prio    = aioc->aioc_prio;
+#endif
+
+#ifdef AIO_HAVE_MERGE
+      /* Collect any adjacent requests that can be merged */
+
+      while (nreqs < CONFIG_FS_AIO_MAXMERGE)
+        {
+          entry = dq_peek(&worker->aw_queue);
+          if (entry == NULL)
+            {
+              break;
+            }
+
+          aioc = AIO_WLINK2AIOC(entry);
+          if (!aio_worker_canmerge(list[nreqs - 1], aioc))
+            {
+              break;
+            }
+
+          dq_rem(&aioc->aioc_wlink, &worker->aw_queue);
+          aioc->aioc_queued = false;
+          list[nreqs++]     = aioc;
+
+#ifdef CONFIG_PRIORITY_INHERITANCE
+          if (aioc->aioc_prio > prio)
+            {
+              prio = aioc->aioc_prio;
+            }
+#endif
+        }
+#endif
+
+      aio_worker_boost(prio);
+
+#ifdef AIO_HAVE_MERGE
+      if (nreqs > 1)
+        {
+          /* Perform the merged transfer.  The AIO lock is released. */
+
+          aio_worker_merged(list, nreqs);
+        }
+      else
+#endif
+        {
+          /* Perform the single I/O using the worker function provided
+           * with the request.  The worker releases the container.
+           */
+
+          func = list[0]->aioc_worker;
+          aio_unlock();
+          func(list[0]);
+        }
+
+      aio_worker_restore(prio);
+    }
+}
+
+/****************************************************************************
+ * Name: aio_worker_thread
+ *
+ * Description:
+ *   This is the main loop of an AIO worker thread.
+ *
+ ****************************************************************************/
+
+static int aio_worker_thread(int argc, FAR char *argv[])
+{
+  FAR struct aio_worker_s *worker;
+  pid_t me = getpid();
+  int ret;
+  int i;
+
+  /* Find our worker structure */
+
+  sched_lock();
+  for (i = 0, worker = NULL; i < CONFIG_FS_AIO_NWORKERS; i++)
+    {
+      if (g_aio_workers[i].aw_pid == me)
+        {
+          worker = &g_aio_workers[i];
+          break;
+        }
+    }
+
+  sched_unlock();
+  DEBUGASSERT(worker != NULL);
+
+  /* Loop forever */
+
+  for (; ; )
+    {
+      /* Wait for I/O to be queued */
+
+      ret = nxsem_wait(&worker->aw_sem);
+      DEBUGASSERT(ret == OK || ret == -EINTR);
+      UNUSED(ret);
+
+      /* Then perform all queued I/O */
+
+      aio_worker_process(worker);
+    }
+
+  return OK; /* To keep some compilers happy */
+}
+
+/****************************************************************************
+ * Name: aio_worker_start
+ *
+ * Description:
+ *   Start the AIO worker threads.  If a thread cannot be created, the
+ *   threads already started are kept and only the missing ones are created
+ *   on the next attempt.
+ *
+ * Assumptions:
+ *   The caller holds the AIO lock.
+ *
+ ****************************************************************************/
+
+static int aio_worker_start(void)
+{
+  FAR struct aio_worker_s *worker;
+  pid_t pid;
+  int i;
+
+  /* Don't permit any of the threads to run until we have fully initialized
+   * the worker structures.
+   */
+
+  sched_lock();
+
+  for (i = g_aio_nstarted; i < CONFIG_FS_AIO_NWORKERS; i++)
+    {
+      worker = &g_aio_workers[i];
+
+      dq_init(&worker->aw_queue);
+      (void)nxsem_init(&worker->aw_sem, 0, 0);
+      nxsem_setprotocol(&worker->aw_sem, SEM_PRIO_NONE);
+
+      pid = kthread_create("aio", CONFIG_FS_AIO_PRIORITY,
+                           CONFIG_FS_AIO_STACKSIZE,
+                           (main_t)aio_worker_thread, NULL);
+      if (pid < 0)
+        {
+          ferr("ERROR: kthread_create failed: %d\n", (int)pid);
+          sched_unlock();
+          return (int)pid;
+        }
+
+      worker->aw_pid = pid;
+      g_aio_nstarted++;
+    }
+
+  sched_unlock();
+  return OK;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: aio_worker_queue
+ *
+ * Description:
+ *   Add the asynchronous I/O to the queue of the AIO worker thread that
+ *   services the file, starting the worker threads if necessary.
+ *
+ * Input Parameters:
+ *   aioc   - The AIO container to be queued
+ *   worker - The function that will perform the I/O
+ *
+ * Returned Value:
+ *   Zero (OK) on success; a negated errno value on failure.  On failure,
+ *   the I/O is not left on any queue.
+ *
+ ****************************************************************************/
+
+int aio_worker_queue(FAR struct aio_container_s *aioc, worker_t worker)
+{
+  FAR struct aio_worker_s *aw;
+  int ret;
+
+  DEBUGASSERT(aioc != NULL && worker != NULL);
+
+  aio_lock();
+
+  /* Start the worker threads when the first I/O is queued */
+
+  if (g_aio_nstarted < CONFIG_FS_AIO_NWORKERS)
+    {
+      ret = aio_worker_start();
+      if (ret < 0)
+        {
+          aio_unlock();
+          return ret;
+        }
+    }
+
+  /* Add the I/O to the end of the selected worker's queue and wake up the
+   * worker.
+   */
+
+  aw                = aio_worker_select(aioc);
+  aioc->aioc_worker = worker;
+  aioc->aioc_queued = true;
+  dq_addlast(&aioc->aioc_wlink, &aw->aw_queue);
+
+  /* If the worker cannot be woken, take the I/O back off of its queue so
+   * that the caller can safely release the container.
+   */
+
+  ret = nxsem_post(&aw->aw_sem);
+  if (ret < 0)
+    {
+      dq_rem(&aioc->aioc_wlink, &aw->aw_queue);
+      aioc->aioc_queued = false;
+    }
+
+  aio_unlock();
+  return ret;
+}
+
+/****************************************************************************
+ * Name: aio_worker_cancel
+ *
+ * Description:
+ *   Remove the asynchronous I/O from the queue of the AIO worker thread.
+ *
+ * Input Parameters:
+ *   aioc - The AIO container to be removed from the queue
+ *
+ * Returned Value:
+ *   Zero (OK) on success; -ENOENT if the I/O is no longer queued.
+ *
+ * Assumptions:
+ *   The caller holds the AIO lock.
+ *
+ ****************************************************************************/
+
+int aio_worker_cancel(FAR struct aio_container_s *aioc)
+{
+  DEBUGASSERT(aioc != NULL);
+
+  if (!aioc->aioc_queued)
+    {
+      return -ENOENT;
+    }
+
+  dq_rem(&aioc->aioc_wlink, &aio_worker_select(aioc)->aw_queue);
+  aioc->aioc_queued = false;
+  return OK;
+}
+
+#endif /* CONFIG_FS_AIO && CONFIG_FS_AIO_WORKERS */
@@ -93,8 +93,14 @@ static void aio_write_worker(FAR void *arg)
 {
   FAR struct aio_container_s *aioc = (FAR struct aio_container_s *)arg;
   FAR struct aiocb *aiocbp;
+#ifdef AIO_HAVE_FILEP
+  FAR struct file *filep;
+#endif
+#ifdef AIO_HAVE_PSOCK
+  FAR struct socket *psock;
+#endif
   pid_t pid;
-#ifdef CONFIG_PRIORITY_INHERITANCE
+#ifdef AIO_LPWORK_INHERITANCE
   uint8_t prio;
 #endif
   ssize_t nwritten = 0;
@@ -109,8 +115,14 @@ static void aio_write_worker(FAR void *arg)
 
   DEBUGASSERT(aioc && aioc->aioc_aiocbp);
   pid    = aioc->aioc_pid;
-#ifdef CONFIG_PRIORITY_INHERITANCE
+#ifdef AIO_LPWORK_INHERITANCE
   prio   = aioc->aioc_prio;
+#endif
+#ifdef AIO_HAVE_FILEP
+  filep  = aioc->u.aioc_filep;
+#endif
+#ifdef AIO_HAVE_PSOCK
+  psock  = aioc->u.aioc_psock;
 #endif
   aiocbp = aioc_decant(aioc);
 
@@ -121,7 +133,7 @@ static void aio_write_worker(FAR void *arg)
     {
       /* Call fcntl(F_GETFL) to get the file open mode. */
 
-      oflags = file_fcntl(aioc->u.aioc_filep, F_GETFL);
+      oflags = file_fcntl(filep, F_GETFL);
       if (oflags < 0)
         {
           ferr("ERROR: file_fcntl failed: %d\n", oflags);
@@ -131,7 +143,7 @@ static void aio_write_worker(FAR void *arg)
 
       /* Perform the write using:
        *
-       *   u.aioc_filep - File structure pointer
+       *   filep        - File structure pointer
        *   aio_buf      - Location of buffer
        *   aio_nbytes   - Length of transfer
        *   aio_offset   - File offset
@@ -143,13 +155,13 @@ static void aio_write_worker(FAR void *arg)
         {
           /* Append to the current file position */
 
-          nwritten = file_write(aioc->u.aioc_filep,
+          nwritten = file_write(filep,
                                 (FAR const void *)aiocbp->aio_buf,
                                 aiocbp->aio_nbytes);
         }
       else
         {
-          nwritten = file_pwrite(aioc->u.aioc_filep,
+          nwritten = file_pwrite(filep,
                                  (FAR const void *)aiocbp->aio_buf,
                                  aiocbp->aio_nbytes,
                                  aiocbp->aio_offset);
@@ -163,12 +175,12 @@ static void aio_write_worker(FAR void *arg)
     {
       /* Perform the send using:
        *
-       *   u.aioc_psock - Socket structure pointer
+       *   psock        - Socket structure pointer
        *   aio_buf      - Location of buffer
        *   aio_nbytes   - Length of transfer
        */
 
-      nwritten = psock_send(aioc->u.aioc_psock,
+      nwritten = psock_send(psock,
                             (FAR const void *)aiocbp->aio_buf,
                             aiocbp->aio_nbytes, 0);
     }
@@ -191,7 +203,7 @@ errout:
 
   (void)aio_signal(pid, aiocbp);
 
-#ifdef CONFIG_PRIORITY_INHERITANCE
+#ifdef AIO_LPWORK_INHERITANCE
   /* Restore the low priority worker thread default priority */
 
   lpwork_restorepriority(prio);
@@ -316,7 +328,7 @@ int aio_write(FAR struct aiocb *aiocbp)
    * block if there are insufficient resources to satisfy the request.
    */
 
-  aioc = aio_contain(aiocbp);
+  aioc = aio_contain(aiocbp, LIO_WRITE);
   if (!aioc)
     {
       /* The errno has already been set (probably EBADF) */
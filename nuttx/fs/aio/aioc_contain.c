@@ -62,6 +62,9 @@
  *
  * Input Parameters:
  *   aiocbp - The AIO control block pointer
+ *   opcode - The type of the I/O operation:  LIO_READ, LIO_WRITE, or
+ *            LIO_NOP for operations that may never be merged with other
+ *            requests (such as fsync).
  *
  * Returned Value:
  *   A reference to the new AIO control block container.   This function
@@ -71,7 +74,8 @@
  *
  ****************************************************************************/
 
-FAR struct aio_container_s *aio_contain(FAR struct aiocb *aiocbp)
+FAR struct aio_container_s *aio_contain(FAR struct aiocb *aiocbp,
+                                        int opcode)
 {
   FAR struct aio_container_s *aioc;
   union
@@ -79,7 +83,7 @@ FAR struct aio_container_s *aio_contain(FAR struct aiocb *aiocbp)
 #ifdef AIO_HAVE_FILEP
     FAR struct file *filep;
 #endif
-#ifdef AIO_HAVE_FILEP
+#ifdef AIO_HAVE_PSOCK
     FAR struct socket *psock;
 #endif
     FAR void *ptr;
@@ -138,6 +142,7 @@ FAR struct aio_container_s *aio_contain(FAR struct aiocb *aiocbp)
   aioc->aioc_aiocbp = aiocbp;
   aioc->u.ptr = u.ptr;
   aioc->aioc_pid = getpid();
+  aioc->aioc_opcode = (uint8_t)opcode;
 
 #ifdef CONFIG_PRIORITY_INHERITANCE
   DEBUGVERIFY(nxsched_getparam (aioc->aioc_pid, &param));
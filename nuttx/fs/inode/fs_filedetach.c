@@ -1,7 +1,7 @@
 /****************************************************************************
  * fs/inode/fs_filedetach.c
  *
- *   Copyright (C) 2016-2017 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2016-2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -167,6 +167,69 @@ int file_detach(int fd, FAR struct file *filep)
 }
 #endif
 
+/****************************************************************************
+ * Name: file_attach
+ *
+ * Description:
+ *   This is the inverse of file_detach():  The detached file structure is
+ *   installed in the calling task's list of open files.  Ownership of the
+ *   open file passes to the new file descriptor; the driver open method is
+ *   not called again and the inode reference count is not changed.
+ *
+ * Input Parameters:
+ *   filep - A pointer to the detached file structure.  It is reset on
+ *           success and may not be used again.
+ *   minfd - The lowest file descriptor number that may be used.
+ *
+ * Returned Value:
+ *   The new file descriptor is returned on success; A negated errno value
+ *   is returned on any failure.
+ *
+ ****************************************************************************/
+
+#if CONFIG_NFILE_DESCRIPTORS > 0
+int file_attach(FAR struct file *filep, int minfd)
+{
+  FAR struct filelist *list;
+  FAR struct file *child;
+  int fd;
+
+  if (filep == NULL || filep->f_inode == NULL)
+    {
+      return -EBADF;
+    }
+
+  list = sched_getfiles();
+  DEBUGASSERT(list != NULL);
+
+  _files_semtake(list);
+  for (fd = minfd; fd < CONFIG_NFILE_DESCRIPTORS; fd++)
+    {
+      child = &list->fl_files[fd];
+      if (child->f_inode == NULL)
+        {
+          /* Move the file structure content into the free slot */
+
+          child->f_oflags = filep->f_oflags;
+          child->f_pos    = filep->f_pos;
+          child->f_inode  = filep->f_inode;
+          child->f_priv   = filep->f_priv;
+
+          filep->f_oflags = 0;
+          filep->f_pos    = 0;
+          filep->f_inode  = NULL;
+          filep->f_priv   = NULL;
+
+          _files_semgive(list);
+          return fd;
+        }
+    }
+
+  _files_semgive(list);
+  return -EMFILE;
+}
+#endif
+
 /****************************************************************************
  * Name: file_close_detached
  *
@@ -52,10 +52,31 @@
 
 #include <nuttx/mtd/mtd.h>
 #include <nuttx/fs/nxffs.h>
+#ifdef CONFIG_NXFFS_BGPACK
+#  include <nuttx/wqueue.h>
+#endif
 
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
+/* Configuration ************************************************************/
+
+#ifndef CONFIG_NXFFS_CACHEBLOCKS
+#  define CONFIG_NXFFS_CACHEBLOCKS 1
+#endif
+
+#ifdef CONFIG_NXFFS_BGPACK
+#  ifndef CONFIG_SCHED_LPWORK
+#    error CONFIG_NXFFS_BGPACK requires CONFIG_SCHED_LPWORK
+#  endif
+#  ifndef CONFIG_NXFFS_BGPACK_RESERVE
+#    define CONFIG_NXFFS_BGPACK_RESERVE 25
+#  endif
+#  ifndef CONFIG_NXFFS_BGPACK_DELAY
+#    define CONFIG_NXFFS_BGPACK_DELAY 500
+#  endif
+#endif
+
 /* NXFFS Definitions ********************************************************/
 /* General NXFFS organization.  The following example assumes 4 logical
  * blocks per FLASH erase block.  The actual relationship is determined by
@@ -131,9 +152,12 @@
  *    string providing some illusion of directories.
  * 5. Files may be opened for reading or for writing, but not both: The O_RDWR
  *    open flag is not supported.
- * 6. The re-packing process occurs only during a write when the free FLASH
+ * 6. The re-packing process occurs during a write when the free FLASH
  *    memory at the end of the FLASH is exhausted.  Thus, occasionally, file
- *    writing may take a long time.
+ *    writing may take a long time.  With CONFIG_NXFFS_BGPACK, the volume
+ *    is also re-packed from the low priority work queue when free FLASH
+ *    falls below a reserve threshold and no file is open so that these
+ *    stalls are rare.
  * 7. Another limitation is that there can be only a single NXFFS volume
  *    mounted at any time.  This has to do with the fact that we bind to
  *    an MTD driver (instead of a block driver) and bypass all of the normal
@@ -284,6 +308,26 @@ struct nxffs_wrfile_s
   uint32_t                  crc;        /* Accumulated data block CRC */
 };
 
+/* This structure describes one slot in the volume block cache */
+
+struct nxffs_cslot_s
+{
+  off_t                     block;     /* Block held in this slot (-1: none) */
+  uint32_t                  stamp;     /* Last access (for LRU replacement) */
+};
+
+/* This structure describes one entry in the in-memory index of valid inode
+ * headers.
+ */
+
+#ifdef CONFIG_NXFFS_INDEX
+struct nxffs_index_s
+{
+  off_t                     hoffset;   /* FLASH offset to the inode header */
+  uint32_t                  hash;      /* Hash of the inode name */
+};
+#endif
+
 /* This structure represents the overall state of on NXFFS instance. */
 
 struct nxffs_volume_s
@@ -298,10 +342,23 @@ struct nxffs_volume_s
   off_t                     froffset;  /* Offset to the first free byte */
   off_t                     nblocks;   /* Number of R/W blocks on volume */
   off_t                     ioblock;   /* Current block number being accessed */
-  off_t                     cblock;    /* Starting block number in cache */
+  off_t                     cblock;    /* Block number of the current cache block */
   FAR struct nxffs_ofile_s *ofiles;    /* A singly-linked list of open files */
-  FAR uint8_t              *cache;     /* On cached erase block for general I/O */
+  FAR uint8_t              *cache;     /* Current cached block for general I/O */
+  FAR uint8_t              *cpool;     /* Memory for all cached blocks */
   FAR uint8_t              *pack;      /* A full erase block to support packing */
+  uint32_t                  cstamp;    /* Cache access counter */
+  struct nxffs_cslot_s      cslot[CONFIG_NXFFS_CACHEBLOCKS];
+#ifdef CONFIG_NXFFS_INDEX
+  FAR struct nxffs_index_s *index;     /* Index of valid inode headers */
+  uint16_t                  ninodes;   /* Number of entries in index[] */
+  uint16_t                  nalloc;    /* Allocated size of index[] */
+  bool                      ivalid;    /* True: index[] matches FLASH content */
+#endif
+#ifdef CONFIG_NXFFS_BGPACK
+  bool                      bgdirty;   /* True: Inodes deleted since last pack */
+  struct work_s             bgwork;    /* Background packing work */
+#endif
 };
 
 /* This structure describes the state of the blocks on the NXFFS volume */
@@ -508,6 +565,46 @@ int nxffs_rdcache(FAR struct nxffs_volume_s *volume, off_t block);
 
 int nxffs_wrcache(FAR struct nxffs_volume_s *volume);
 
+/****************************************************************************
+ * Name: nxffs_initcache
+ *
+ * Description:
+ *   Mark every slot of the volume block cache as empty.
+ *
+ * Input Parameters:
+ *   volume - Describes the current volume
+ *
+ * Returned Value:
+ *   None
+ *
+ * Defined in nxffs_cache.c
+ *
+ ****************************************************************************/
+
+void nxffs_initcache(FAR struct nxffs_volume_s *volume);
+
+/****************************************************************************
+ * Name: nxffs_invalidate
+ *
+ * Description:
+ *   Discard any cached copies of a range of blocks.  This must be called
+ *   whenever FLASH is erased or written other than through nxffs_wrcache().
+ *
+ * Input Parameters:
+ *   volume  - Describes the current volume
+ *   block   - The first logical block to discard
+ *   nblocks - The number of logical blocks to discard
+ *
+ * Returned Value:
+ *   None
+ *
+ * Defined in nxffs_cache.c
+ *
+ ****************************************************************************/
+
+void nxffs_invalidate(FAR struct nxffs_volume_s *volume, off_t block,
+                      off_t nblocks);
+
 /****************************************************************************
  * Name: nxffs_ioseek
  *
@@ -667,6 +764,128 @@ int nxffs_findinode(FAR struct nxffs_volume_s *volume, FAR const char *name,
 off_t nxffs_inodeend(FAR struct nxffs_volume_s *volume,
                      FAR struct nxffs_entry_s *entry);
 
+/****************************************************************************
+ * Name: nxffs_buildindex
+ *
+ * Description:
+ *   Scan the volume and build the in-memory index of valid inode headers.
+ *   On failure, the index is marked invalid and nxffs_findinode() will
+ *   fall back to scanning FLASH.
+ *
+ * Input Parameters:
+ *   volume - Describes the NXFFS volume
+ *
+ * Returned Value:
+ *   Zero is returned on success. Otherwise, a negated errno is returned
+ *   that indicates the nature of the failure.
+ *
+ * Defined in nxffs_index.c
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXFFS_INDEX
+int nxffs_buildindex(FAR struct nxffs_volume_s *volume);
+#else
+#  define nxffs_buildindex(v) (OK)
+#endif
+
+/****************************************************************************
+ * Name: nxffs_resetindex
+ *
+ * Description:
+ *   Discard the content of the inode index.  If 'valid' is true, the
+ *   volume is known to contain no inodes and the empty index is valid.
+ *
+ * Input Parameters:
+ *   volume - Describes the NXFFS volume
+ *   valid  - True if the empty index describes the volume
+ *
+ * Returned Value:
+ *   None
+ *
+ * Defined in nxffs_index.c
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXFFS_INDEX
+void nxffs_resetindex(FAR struct nxffs_volume_s *volume, bool valid);
+#else
+#  define nxffs_resetindex(v,b)
+#endif
+
+/****************************************************************************
+ * Name: nxffs_addindex
+ *
+ * Description:
+ *   Add a newly written inode header to the inode index.
+ *
+ * Input Parameters:
+ *   volume - Describes the NXFFS volume
+ *   entry  - Describes the inode that was written
+ *
+ * Returned Value:
+ *   None.  If memory cannot be allocated, the index is marked invalid.
+ *
+ * Defined in nxffs_index.c
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXFFS_INDEX
+void nxffs_addindex(FAR struct nxffs_volume_s *volume,
+                    FAR const struct nxffs_entry_s *entry);
+#else
+#  define nxffs_addindex(v,e)
+#endif
+
+/****************************************************************************
+ * Name: nxffs_rmindex
+ *
+ * Description:
+ *   Remove a deleted inode header from the inode index.
+ *
+ * Input Parameters:
+ *   volume  - Describes the NXFFS volume
+ *   hoffset - FLASH offset to the deleted inode header
+ *
+ * Returned Value:
+ *   None
+ *
+ * Defined in nxffs_index.c
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXFFS_INDEX
+void nxffs_rmindex(FAR struct nxffs_volume_s *volume, off_t hoffset);
+#else
+#  define nxffs_rmindex(v,o)
+#endif
+
+/****************************************************************************
+ * Name: nxffs_findindex
+ *
+ * Description:
+ *   Use the inode index to find the inode with the provided name.  Only
+ *   the inode headers whose name hash matches are read from FLASH.
+ *
+ * Input Parameters:
+ *   volume - Describes the NXFFS volume
+ *   name   - The name of the inode to find
+ *   entry  - The location to return information about the inode.
+ *
+ * Returned Value:
+ *   Zero is returned on success; -ENOENT if there is no inode with this
+ *   name.  -ENOSYS is returned if the index is not valid and the caller
+ *   must search FLASH.
+ *
+ * Defined in nxffs_index.c
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXFFS_INDEX
+int nxffs_findindex(FAR struct nxffs_volume_s *volume, FAR const char *name,
+                    FAR struct nxffs_entry_s *entry);
+#endif
+
 /****************************************************************************
  * Name: nxffs_verifyblock
  *
@@ -1082,6 +1301,34 @@ int nxffs_rminode(FAR struct nxffs_volume_s *volume, FAR const char *name);
 
 int nxffs_pack(FAR struct nxffs_volume_s *volume);
 
+/****************************************************************************
+ * Name: nxffs_bgpack
+ *
+ * Description:
+ *   Schedule packing of the volume on the low priority work queue if the
+ *   free FLASH has fallen below CONFIG_NXFFS_BGPACK_RESERVE percent of the
+ *   volume, inodes have been deleted since the last time that the volume
+ *   was packed, and no file is open.
+ *
+ * Input Parameters:
+ *   volume - The volume to be packed.
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   The caller holds the volume exclsem.
+ *
+ * Defined in nxffs_pack.c
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXFFS_BGPACK
+void nxffs_bgpack(FAR struct nxffs_volume_s *volume);
+#else
+#  define nxffs_bgpack(v)
+#endif
+
 /****************************************************************************
  * Standard mountpoint operation methods
  *
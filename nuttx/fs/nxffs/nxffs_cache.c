@@ -1,7 +1,7 @@
 /****************************************************************************
  * fs/nxffs/nxffs_cache.c
  *
- *   Copyright (C) 2011, 2013 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2011, 2013, 2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * References: Linux/Documentation/filesystems/romfs.txt
@@ -73,7 +73,10 @@
  * Name: nxffs_rdcache
  *
  * Description:
- *   Read one I/O block into the volume block cache memory.
+ *   Make one I/O block the current block in the volume block cache,
+ *   reading it from FLASH if it is not already cached.  The cache holds
+ *   CONFIG_NXFFS_CACHEBLOCKS blocks; the least recently used block is
+ *   replaced on a miss.
  *
  * Input Parameters:
  *   volume - Describes the current volume
@@ -87,26 +90,72 @@
 
 int nxffs_rdcache(FAR struct nxffs_volume_s *volume, off_t block)
 {
+  FAR struct nxffs_cslot_s *cslot;
+  FAR struct nxffs_cslot_s *victim;
   size_t nxfrd;
+  int i;
 
-  /* Check if the requested data is already in the cache */
+  /* Check if the requested data is already the current cache block */
 
-  if (block != volume->cblock)
+  if (block == volume->cblock)
     {
-      /* Read the specified blocks into cache */
+      return OK;
+    }
+
+  /* Check if the block is in one of the other cache slots.  At the same
+   * time, find the least recently used slot in case it is not.
+   */
+
+  victim = &volume->cslot[0];
+  for (i = 0; i < CONFIG_NXFFS_CACHEBLOCKS; i++)
+    {
+      cslot = &volume->cslot[i];
+      if (cslot->block == block)
+        {
+          /* Cache hit.  Make this the current cache block */
+
+          volume->cache  = &volume->cpool[i * volume->geo.blocksize];
+          volume->cblock = block;
+          cslot->stamp   = ++volume->cstamp;
+          return OK;
+        }
 
-      nxfrd = MTD_BREAD(volume->mtd, block, 1, volume->cache);
-      if (nxfrd != 1)
+      if (cslot->block < 0)
         {
-          ferr("ERROR: Read block %d failed: %d\n", block, nxfrd);
-          return -EIO;
+          /* An empty slot is always the best choice */
+
+          if (victim->block >= 0)
+            {
+              victim = cslot;
+            }
         }
+      else if (victim->block >= 0 &&
+               (int32_t)(cslot->stamp - victim->stamp) < 0)
+        {
+          victim = cslot;
+        }
+    }
 
-      /* Remember what is in the cache */
+  /* Read the specified block into the selected slot */
 
-      volume->cblock  = block;
+  i              = victim - volume->cslot;
+  volume->cache  = &volume->cpool[i * volume->geo.blocksize];
+
+  nxfrd = MTD_BREAD(volume->mtd, block, 1, volume->cache);
+  if (nxfrd != 1)
+    {
+      ferr("ERROR: Read block %d failed: %d\n", block, nxfrd);
+
+      victim->block  = -1;
+      volume->cblock = -1;
+      return -EIO;
     }
 
+  /* Remember what is in the cache */
+
+  victim->block  = block;
+  victim->stamp  = ++volume->cstamp;
+  volume->cblock = block;
   return OK;
 }
 
@@ -142,6 +191,67 @@ int nxffs_wrcache(FAR struct nxffs_volume_s *volume)
   return OK;
 }
 
+/****************************************************************************
+ * Name: nxffs_initcache
+ *
+ * Description:
+ *   Mark every slot of the volume block cache as empty.
+ *
+ * Input Parameters:
+ *   volume - Describes the current volume
+ *
+ ****************************************************************************/
+
+void nxffs_initcache(FAR struct nxffs_volume_s *volume)
+{
+  int i;
+
+  for (i = 0; i < CONFIG_NXFFS_CACHEBLOCKS; i++)
+    {
+      volume->cslot[i].block = -1;
+      volume->cslot[i].stamp = 0;
+    }
+
+  volume->cache  = volume->cpool;
+  volume->cblock = -1;
+  volume->cstamp = 0;
+}
+
+/****************************************************************************
+ * Name: nxffs_invalidate
+ *
+ * Description:
+ *   Discard any cached copies of a range of blocks.  This must be called
+ *   whenever FLASH is erased or written other than through nxffs_wrcache().
+ *
+ * Input Parameters:
+ *   volume  - Describes the current volume
+ *   block   - The first logical block to discard
+ *   nblocks - The number of logical blocks to discard
+ *
+ ****************************************************************************/
+
+void nxffs_invalidate(FAR struct nxffs_volume_s *volume, off_t block,
+                      off_t nblocks)
+{
+  off_t cblock;
+  int i;
+
+  for (i = 0; i < CONFIG_NXFFS_CACHEBLOCKS; i++)
+    {
+      cblock = volume->cslot[i].block;
+      if (cblock >= block && cblock < block + nblocks)
+        {
+          volume->cslot[i].block = -1;
+        }
+    }
+
+  if (volume->cblock >= block && volume->cblock < block + nblocks)
+    {
+      volume->cblock = -1;
+    }
+}
+
 /****************************************************************************
  * Name: nxffs_ioseek
  *
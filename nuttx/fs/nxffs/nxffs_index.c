@@ -0,0 +1,336 @@
+/****************************************************************************
+ * fs/nxffs/nxffs_index.c
+ *
+ *   Copyright (C) 2018 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <string.h>
+#include <errno.h>
+#include <assert.h>
+#include <debug.h>
+
+#include <nuttx/kmalloc.h>
+
+#include "nxffs.h"
+
+#ifdef CONFIG_NXFFS_INDEX
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The index grows by this many entries at a time */
+
+#define NXFFS_INDEX_INCR  8
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxffs_namehash
+ *
+ * Description:
+ *   Return a 32-bit (FNV-1a) hash of an inode name.
+ *
+ ****************************************************************************/
+
+static uint32_t nxffs_namehash(FAR const char *name)
+{
+  uint32_t hash = 2166136261u;
+
+  while (*name != '\0')
+    {
+      hash = (hash ^ (uint8_t)*name++) * 16777619u;
+    }
+
+  return hash;
+}
+
+/****************************************************************************
+ * Name: nxffs_appendindex
+ *
+ * Description:
+ *   Append one inode to the index, growing the index if necessary.
+ *
+ ****************************************************************************/
+
+static int nxffs_appendindex(FAR struct nxffs_volume_s *volume,
+                             off_t hoffset, FAR const char *name)
+{
+  FAR struct nxffs_index_s *index;
+  unsigned int nalloc;
+
+  if (volume->ninodes >= volume->nalloc)
+    {
+      nalloc = volume->nalloc + NXFFS_INDEX_INCR;
+      if (nalloc > UINT16_MAX)
+        {
+          return -ENOSPC;
+        }
+
+      index = (FAR struct nxffs_index_s *)
+        kmm_realloc(volume->index, nalloc * sizeof(struct nxffs_index_s));
+      if (index == NULL)
+        {
+          return -ENOMEM;
+        }
+
+      volume->index  = index;
+      volume->nalloc = nalloc;
+    }
+
+  index          = &volume->index[volume->ninodes];
+  index->hoffset = hoffset;
+  index->hash    = nxffs_namehash(name);
+  volume->ninodes++;
+  return OK;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxffs_buildindex
+ *
+ * Description:
+ *   Scan the volume and build the in-memory index of valid inode headers.
+ *   On failure, the index is marked invalid and nxffs_findinode() will
+ *   fall back to scanning FLASH.
+ *
+ * Input Parameters:
+ *   volume - Describes the NXFFS volume
+ *
+ * Returned Value:
+ *   Zero is returned on success. Otherwise, a negated errno is returned
+ *   that indicates the nature of the failure.
+ *
+ ****************************************************************************/
+
+int nxffs_buildindex(FAR struct nxffs_volume_s *volume)
+{
+  struct nxffs_entry_s entry;
+  off_t offset;
+  int ret;
+
+  nxffs_resetindex(volume, false);
+
+  /* Visit each valid inode on the volume, starting with the first valid
+   * inode, exactly as nxffs_findinode() would.
+   */
+
+  offset = volume->inoffset;
+  for (; ; )
+    {
+      ret = nxffs_nextentry(volume, offset, &entry);
+      if (ret < 0)
+        {
+          /* -ENOENT means that the end of the inodes was reached */
+
+          break;
+        }
+
+      ret = nxffs_appendindex(volume, entry.hoffset, entry.name);
+      offset = nxffs_inodeend(volume, &entry);
+      nxffs_freeentry(&entry);
+
+      if (ret < 0)
+        {
+          break;
+        }
+    }
+
+  if (ret != -ENOENT)
+    {
+      ferr("ERROR: Failed to index inodes: %d\n", -ret);
+      nxffs_resetindex(volume, false);
+      return ret;
+    }
+
+  finfo("Indexed %d inodes\n", volume->ninodes);
+  volume->ivalid = true;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: nxffs_resetindex
+ *
+ * Description:
+ *   Discard the content of the inode index.  If 'valid' is true, the
+ *   volume is known to contain no inodes and the empty index is valid.
+ *
+ * Input Parameters:
+ *   volume - Describes the NXFFS volume
+ *   valid  - True if the empty index describes the volume
+ *
+ ****************************************************************************/
+
+void nxffs_resetindex(FAR struct nxffs_volume_s *volume, bool valid)
+{
+  /* Keep the allocation; it will most likely be needed again */
+
+  volume->ninodes = 0;
+  volume->ivalid  = valid;
+}
+
+/****************************************************************************
+ * Name: nxffs_addindex
+ *
+ * Description:
+ *   Add a newly written inode header to the inode index.
+ *
+ * Input Parameters:
+ *   volume - Describes the NXFFS volume
+ *   entry  - Describes the inode that was written
+ *
+ ****************************************************************************/
+
+void nxffs_addindex(FAR struct nxffs_volume_s *volume,
+                    FAR const struct nxffs_entry_s *entry)
+{
+  if (volume->ivalid &&
+      nxffs_appendindex(volume, entry->hoffset, entry->name) < 0)
+    {
+      /* We can no longer trust the index */
+
+      fwarn("WARNING: Inode index disabled\n");
+      nxffs_resetindex(volume, false);
+    }
+}
+
+/****************************************************************************
+ * Name: nxffs_rmindex
+ *
+ * Description:
+ *   Remove a deleted inode header from the inode index.
+ *
+ * Input Parameters:
+ *   volume  - Describes the NXFFS volume
+ *   hoffset - FLASH offset to the deleted inode header
+ *
+ ****************************************************************************/
+
+void nxffs_rmindex(FAR struct nxffs_volume_s *volume, off_t hoffset)
+{
+  int i;
+
+  if (volume->ivalid)
+    {
+      for (i = 0; i < volume->ninodes; i++)
+        {
+          if (volume->index[i].hoffset == hoffset)
+            {
+              /* Replace this entry with the final entry */
+
+              volume->ninodes--;
+              volume->index[i] = volume->index[volume->ninodes];
+              break;
+            }
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: nxffs_findindex
+ *
+ * Description:
+ *   Use the inode index to find the inode with the provided name.  Only
+ *   the inode headers whose name hash matches are read from FLASH.
+ *
+ * Input Parameters:
+ *   volume - Describes the NXFFS volume
+ *   name   - The name of the inode to find
+ *   entry  - The location to return information about the inode.
+ *
+ * Returned Value:
+ *   Zero is returned on success; -ENOENT if there is no inode with this
+ *   name.  -ENOSYS is returned if the index is not valid and the caller
+ *   must search FLASH.
+ *
+ ****************************************************************************/
+
+int nxffs_findindex(FAR struct nxffs_volume_s *volume, FAR const char *name,
+                    FAR struct nxffs_entry_s *entry)
+{
+  uint32_t hash;
+  off_t hoffset;
+  int ret;
+  int i;
+
+  if (!volume->ivalid)
+    {
+      return -ENOSYS;
+    }
+
+  hash = nxffs_namehash(name);
+  for (i = 0; i < volume->ninodes; i++)
+    {
+      if (volume->index[i].hash != hash)
+        {
+          continue;
+        }
+
+      /* Read and verify the inode header at this offset */
+
+      hoffset = volume->index[i].hoffset;
+      ret = nxffs_nextentry(volume, hoffset, entry);
+      if (ret < 0)
+        {
+          if (ret != -ENOENT)
+            {
+              return ret;
+            }
+
+          continue;
+        }
+
+      if (entry->hoffset == hoffset && strcmp(name, entry->name) == 0)
+        {
+          return OK;
+        }
+
+      /* A hash collision (or a stale index entry) */
+
+      nxffs_freeentry(entry);
+    }
+
+  return -ENOENT;
+}
+
+#endif /* CONFIG_NXFFS_INDEX */
@@ -185,7 +185,6 @@ int nxffs_initialize(FAR struct mtd_dev_s *mtd)
   /* Initialize the NXFFS volume structure */
 
   volume->mtd    = mtd;
-  volume->cblock = (off_t)-1;
   nxsem_init(&volume->exclsem, 0, 1);
   nxsem_init(&volume->wrsem, 0, 1);
 
@@ -201,16 +200,19 @@ int nxffs_initialize(FAR struct mtd_dev_s *mtd)
       goto errout_with_volume;
     }
 
-  /* Allocate one I/O block buffer to general files system access */
+  /* Allocate the I/O block buffers for general files system access */
 
-  volume->cache = (FAR uint8_t *)kmm_malloc(volume->geo.blocksize);
-  if (!volume->cache)
+  volume->cpool = (FAR uint8_t *)
+    kmm_malloc(CONFIG_NXFFS_CACHEBLOCKS * volume->geo.blocksize);
+  if (!volume->cpool)
     {
-      ferr("ERROR: Failed to allocate an erase block buffer\n");
+      ferr("ERROR: Failed to allocate the block cache\n");
       ret = -ENOMEM;
       goto errout_with_volume;
     }
 
+  nxffs_initcache(volume);
+
   /* Pre-allocate one, full, in-memory erase block.  This is needed for filesystem
    * packing (but is useful in other places as well). This buffer is not needed
    * often, but is best to have pre-allocated and in-place.
@@ -276,7 +278,7 @@ int nxffs_initialize(FAR struct mtd_dev_s *mtd)
   ret = nxffs_limits(volume);
   if (ret == OK)
     {
-      return OK;
+      goto volume_ready;
     }
 
   /* We may need to format the volume.  Try that before giving up. */
@@ -303,19 +305,40 @@ int nxffs_initialize(FAR struct mtd_dev_s *mtd)
   /* Now try to get the file system limits again */
 
   ret = nxffs_limits(volume);
-  if (ret == OK)
+  if (ret < 0)
     {
-      return OK;
+      /* Now give up */
+
+      ferr("ERROR: Failed to calculate file system limits: %d\n", -ret);
+      goto errout_with_buffer;
     }
 
-  /* Now give up */
+volume_ready:
+  /* Build the index of inode headers so that opening a file does not
+   * require a scan of the FLASH.  This is not fatal on failure:  Inodes
+   * will then be found by scanning the FLASH.
+   */
+
+  ret = nxffs_buildindex(volume);
+  if (ret < 0)
+    {
+      fwarn("WARNING: Failed to build the inode index: %d\n", -ret);
+    }
 
-  ferr("ERROR: Failed to calculate file system limits: %d\n", -ret);
+  /* There may be deleted inodes left from before.  Check if the volume
+   * should be packed in the background.
+   */
+
+#ifdef CONFIG_NXFFS_BGPACK
+  volume->bgdirty = true;
+  nxffs_bgpack(volume);
+#endif
+  return OK;
 
 errout_with_buffer:
   kmm_free(volume->pack);
 errout_with_cache:
-  kmm_free(volume->cache);
+  kmm_free(volume->cpool);
 errout_with_volume:
 #ifndef CONFIG_NXFFS_PREALLOCATED
   kmm_free(volume);
@@ -528,6 +551,10 @@ int nxffs_limits(FAR struct nxffs_volume_s *volume)
 int nxffs_bind(FAR struct inode *blkdriver, FAR const void *data,
                FAR void **handle)
 {
+#ifdef CONFIG_NXFFS_BGPACK
+  int ret;
+#endif
+
 #ifndef CONFIG_NXFFS_PREALLOCATED
 #  error "No design to support dynamic allocation of volumes"
 #else
@@ -537,6 +564,23 @@ int nxffs_bind(FAR struct inode *blkdriver, FAR const void *data,
    */
 
   DEBUGASSERT(g_volume.cache);
+
+#ifdef CONFIG_NXFFS_BGPACK
+  /* Background packing is stopped when the volume is unmounted.  Deleted
+   * inodes may remain, so check again whether it is needed.
+   */
+
+  ret = nxsem_wait(&g_volume.exclsem);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  g_volume.bgdirty = true;
+  nxffs_bgpack(&g_volume);
+  nxsem_post(&g_volume.exclsem);
+#endif
+
   *handle = &g_volume;
 #endif
   return OK;
@@ -546,7 +590,9 @@ int nxffs_bind(FAR struct inode *blkdriver, FAR const void *data,
  * Name: nxffs_unbind
  *
  * Description: This implements the filesystem portion of the umount
- *   operation.
+ *   operation.  With CONFIG_NXFFS_BGPACK, background packing is cancelled
+ *   and any pack that is already running is allowed to finish before the
+ *   volume is released.
  *
  ****************************************************************************/
 
@@ -556,6 +602,8 @@ int nxffs_unbind(FAR void *handle, FAR struct inode **blkdriver,
 #ifndef CONFIG_NXFFS_PREALLOCATED
 #  error "No design to support dynamic allocation of volumes"
 #else
+  int ret;
+
   /* This implementation currently only supports unmounting if there are no
    * open file references.
    */
@@ -565,6 +613,32 @@ int nxffs_unbind(FAR void *handle, FAR struct inode **blkdriver,
       return -ENOSYS;
     }
 
-  return g_volume.ofiles ? -EBUSY : OK;
+  /* Taking the volume waits for a background pack that is in progress */
+
+  ret = nxsem_wait(&g_volume.exclsem);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  if (g_volume.ofiles != NULL)
+    {
+      ret = -EBUSY;
+    }
+#ifdef CONFIG_NXFFS_BGPACK
+  else
+    {
+      /* Cancel a pack that is still queued.  A worker that has already
+       * been dequeued and is waiting for the volume will find nothing to
+       * do.
+       */
+
+      (void)work_cancel(LPWORK, &g_volume.bgwork);
+      g_volume.bgdirty = false;
+    }
+#endif
+
+  nxsem_post(&g_volume.exclsem);
+  return ret;
 #endif
 }
@@ -1,7 +1,7 @@
 /****************************************************************************
  * fs/nxffs/nxffs_inode.c
  *
- *   Copyright (C) 2011, 2013 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2011, 2013, 2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * References: Linux/Documentation/filesystems/romfs.txt
@@ -359,7 +359,8 @@ int nxffs_nextentry(FAR struct nxffs_volume_s *volume, off_t offset,
  * Description:
  *   Search for an inode with the provided name starting with the first
  *   valid inode and proceeding to the end FLASH or until the matching
- *   inode is found.
+ *   inode is found.  If the in-memory inode index is available, only the
+ *   indexed inode headers with a matching name hash are examined.
  *
  * Input Parameters:
  *   volume - Describes the NXFFS volume
@@ -378,6 +379,16 @@ int nxffs_findinode(FAR struct nxffs_volume_s *volume, FAR const char *name,
   off_t offset;
   int ret;
 
+#ifdef CONFIG_NXFFS_INDEX
+  /* Use the in-memory inode index if it is valid */
+
+  ret = nxffs_findindex(volume, name, entry);
+  if (ret != -ENOSYS)
+    {
+      return ret;
+    }
+#endif
+
   /* Start with the first valid inode that was discovered when the volume
    * was created (or modified after the last file system re-packing).
    */
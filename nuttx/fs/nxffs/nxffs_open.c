@@ -1,7 +1,7 @@
 /****************************************************************************
  * fs/nxffs/nxffs_open.c
  *
- *   Copyright (C) 2011, 2013, 2017 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2011, 2013, 2017-2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * References: Linux/Documentation/filesystems/romfs.txt
@@ -1172,6 +1172,12 @@ int nxffs_close(FAR struct file *filep)
       /* Release all resouces held by the open file */
 
       nxffs_freeofile(volume, ofile);
+
+      /* If this was the last open file, packing may now proceed in the
+       * background if the volume is getting full.
+       */
+
+      nxffs_bgpack(volume);
     }
   else
     {
@@ -1267,8 +1273,13 @@ int nxffs_wrinode(FAR struct nxffs_volume_s *volume,
     {
       ferr("ERROR: Failed to write inode header block %d: %d\n",
            volume->ioblock, -ret);
+      goto errout;
     }
 
+  /* Add the new inode to the in-memory inode index */
+
+  nxffs_addindex(volume, entry);
+
   /* The volume is now available for other writers */
 
 errout:
@@ -1,7 +1,7 @@
 /****************************************************************************
  * fs/nxffs/nxffs_pack.c
  *
- *   Copyright (C) 2011, 2013 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2011, 2013, 2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * References: Linux/Documentation/filesystems/romfs.txt
@@ -48,6 +48,11 @@
 #include <debug.h>
 
 #include <nuttx/kmalloc.h>
+#include <nuttx/semaphore.h>
+#ifdef CONFIG_NXFFS_BGPACK
+#  include <nuttx/clock.h>
+#  include <nuttx/wqueue.h>
+#endif
 
 #include "nxffs.h"
 
@@ -1244,15 +1249,11 @@ static inline int nxffs_packwriter(FAR struct nxffs_volume_s *volume,
 }
 
 /****************************************************************************
- * Public Functions
- ****************************************************************************/
-
-/****************************************************************************
- * Name: nxffs_pack
+ * Name: nxffs_packvolume
  *
  * Description:
  *   Pack and re-write the filesystem in order to free up memory at the end
- *   of FLASH.
+ *   of FLASH.  This is the body of nxffs_pack().
  *
  * Input Parameters:
  *   volume - The volume to be packed.
@@ -1263,7 +1264,7 @@ static inline int nxffs_packwriter(FAR struct nxffs_volume_s *volume,
  *
  ****************************************************************************/
 
-int nxffs_pack(FAR struct nxffs_volume_s *volume)
+static int nxffs_packvolume(FAR struct nxffs_volume_s *volume)
 {
   struct nxffs_pack_s pack;
   FAR struct nxffs_wrfile_s *wrfile;
@@ -1588,6 +1589,11 @@ start_pack:
       /* Write the packed I/O block to FLASH */
 
       ret = MTD_BWRITE(volume->mtd, pack.block0, volume->blkper, volume->pack);
+
+      /* Any cached copies of the blocks in this erase block are now stale */
+
+      nxffs_invalidate(volume, pack.block0, volume->blkper);
+
       if (ret < 0)
         {
           ferr("ERROR: Failed to write erase block %d [%d]: %d\n",
@@ -1601,3 +1607,142 @@ errout_with_pack:
   nxffs_freeentry(&pack.dest.entry);
   return ret;
 }
+
+/****************************************************************************
+ * Name: nxffs_bgneeded
+ *
+ * Description:
+ *   Return true if the free FLASH at the end of the volume has fallen below
+ *   the background packing reserve.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXFFS_BGPACK
+static bool nxffs_bgneeded(FAR struct nxffs_volume_s *volume)
+{
+  off_t total = volume->nblocks * volume->geo.blocksize;
+  off_t avail = total - volume->froffset;
+
+  return avail < (total / 100) * CONFIG_NXFFS_BGPACK_RESERVE;
+}
+#endif
+
+/****************************************************************************
+ * Name: nxffs_bgworker
+ *
+ * Description:
+ *   Pack the volume from the low priority work queue.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXFFS_BGPACK
+static void nxffs_bgworker(FAR void *arg)
+{
+  FAR struct nxffs_volume_s *volume = (FAR struct nxffs_volume_s *)arg;
+  int ret;
+
+  ret = nxsem_wait(&volume->exclsem);
+  if (ret < 0)
+    {
+      return;
+    }
+
+  /* Re-check the conditions now that we hold the volume.  Packing moves
+   * and erases blocks, so it is not attempted while any file is open:
+   * The offsets held by open readers would no longer be valid.
+   * nxffs_bgpack() will be called again when the last file is closed.
+   */
+
+  if (volume->bgdirty && volume->ofiles == NULL &&
+      nxffs_bgneeded(volume))
+    {
+      finfo("Background packing, froffset: %d\n", volume->froffset);
+
+      ret = nxffs_pack(volume);
+      if (ret < 0)
+        {
+          ferr("ERROR: Background packing failed: %d\n", -ret);
+        }
+    }
+
+  nxsem_post(&volume->exclsem);
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxffs_pack
+ *
+ * Description:
+ *   Pack and re-write the filesystem in order to free up memory at the end
+ *   of FLASH.
+ *
+ * Input Parameters:
+ *   volume - The volume to be packed.
+ *
+ * Returned Value:
+ *   Zero on success; Otherwise, a negated errno value is returned to
+ *   indicate the nature of the failure.
+ *
+ ****************************************************************************/
+
+int nxffs_pack(FAR struct nxffs_volume_s *volume)
+{
+  int ret;
+  int ret2;
+
+  /* Inodes will move.  The inode index is rebuilt when packing completes
+   * (successfully or not).
+   */
+
+  nxffs_resetindex(volume, false);
+
+  ret = nxffs_packvolume(volume);
+
+#ifdef CONFIG_NXFFS_BGPACK
+  volume->bgdirty = false;
+#endif
+
+  ret2 = nxffs_buildindex(volume);
+  if (ret2 < 0)
+    {
+      fwarn("WARNING: Failed to rebuild the inode index: %d\n", -ret2);
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: nxffs_bgpack
+ *
+ * Description:
+ *   Schedule packing of the volume on the low priority work queue if the
+ *   free FLASH has fallen below CONFIG_NXFFS_BGPACK_RESERVE percent of the
+ *   volume, inodes have been deleted since the last time that the volume
+ *   was packed, and no file is open.
+ *
+ * Input Parameters:
+ *   volume - The volume to be packed.
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   The caller holds the volume exclsem.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXFFS_BGPACK
+void nxffs_bgpack(FAR struct nxffs_volume_s *volume)
+{
+  if (volume->bgdirty && volume->ofiles == NULL &&
+      work_available(&volume->bgwork) && nxffs_bgneeded(volume))
+    {
+      (void)work_queue(LPWORK, &volume->bgwork, nxffs_bgworker, volume,
+                       MSEC2TICK(CONFIG_NXFFS_BGPACK_DELAY));
+    }
+}
+#endif
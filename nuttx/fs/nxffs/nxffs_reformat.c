@@ -1,7 +1,7 @@
 /****************************************************************************
  * fs/nxffs/nxffs_reformat.c
  *
- *   Copyright (C) 2011, 2013 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2011, 2013, 2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * References: Linux/Documentation/filesystems/romfs.txt
@@ -281,6 +281,14 @@ int nxffs_reformat(FAR struct nxffs_volume_s *volume)
   /* Erase and reformat the entire volume */
 
   ret = nxffs_format(volume);
+
+  /* Nothing cached from the old content of the volume is valid now and,
+   * if the format succeeded, there are no inodes on the volume.
+   */
+
+  nxffs_invalidate(volume, 0, volume->nblocks);
+  nxffs_resetindex(volume, ret >= 0);
+
   if (ret < 0)
     {
       ferr("ERROR: Failed to reformat the volume: %d\n", -ret);
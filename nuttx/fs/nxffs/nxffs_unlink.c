@@ -129,8 +129,20 @@ int nxffs_rminode(FAR struct nxffs_volume_s *volume, FAR const char *name)
     {
       ferr("ERROR: Failed to write block %d: %d\n",
            volume->ioblock, ret);
+      goto errout_with_entry;
     }
 
+  /* The inode is gone.  Remove it from the index and check if it is time
+   * to reclaim the FLASH that it occupies.
+   */
+
+  nxffs_rmindex(volume, entry.hoffset);
+
+#ifdef CONFIG_NXFFS_BGPACK
+  volume->bgdirty = true;
+  nxffs_bgpack(volume);
+#endif
+
 errout_with_entry:
   nxffs_freeentry(&entry);
 errout:
@@ -67,9 +67,10 @@
 #  warning CONFIG_FS_TMPFS_DIRECTORY_FREEGUARD needs to be > ALLOCGUARD
 #endif
 
-#if CONFIG_FS_TMPFS_FILE_FREEGUARD <= CONFIG_FS_TMPFS_FILE_ALLOCGUARD
-#  warning CONFIG_FS_TMPFS_FILE_FREEGUARD needs to be > ALLOCGUARD
-#endif
+/* Initial number of directory hash buckets and file chunk table slots */
+
+#define TMPFS_MIN_BUCKETS 8
+#define TMPFS_MIN_SLOTS   4
 
 #define tmpfs_lock_file(tfo) \
            (tmpfs_lock_object((FAR struct tmpfs_object_s *)tfo))
@@ -93,12 +94,27 @@ static void tmpfs_lock_object(FAR struct tmpfs_object_s *to);
 static void tmpfs_unlock_object(FAR struct tmpfs_object_s *to);
 static int  tmpfs_realloc_directory(FAR struct tmpfs_directory_s **tdo,
               unsigned int nentries);
-static int  tmpfs_realloc_file(FAR struct tmpfs_file_s **tfo,
+static int  tmpfs_realloc_file(FAR struct tmpfs_file_s *tfo,
               size_t newsize);
+static void tmpfs_read_chunks(FAR struct tmpfs_file_s *tfo, size_t offset,
+              FAR uint8_t *buffer, size_t buflen);
+static void tmpfs_write_chunks(FAR struct tmpfs_file_s *tfo, size_t offset,
+              FAR const uint8_t *buffer, size_t buflen);
+static void tmpfs_free_file(FAR struct tmpfs_file_s *tfo);
+static void tmpfs_free_directory(FAR struct tmpfs_directory_s *tdo);
 static void tmpfs_release_lockedobject(FAR struct tmpfs_object_s *to);
 static void tmpfs_release_lockedfile(FAR struct tmpfs_file_s *tfo);
+static uint32_t tmpfs_hash(FAR const char *name);
+static void tmpfs_hash_insert(FAR struct tmpfs_directory_s *tdo,
+              unsigned int index);
+static void tmpfs_hash_remove(FAR struct tmpfs_directory_s *tdo,
+              unsigned int index);
+static int  tmpfs_hash_resize(FAR struct tmpfs_directory_s *tdo,
+              unsigned int nbuckets);
 static int  tmpfs_find_dirent(FAR struct tmpfs_directory_s *tdo,
               FAR const char *name);
+static void tmpfs_delete_dirent(FAR struct tmpfs_directory_s *tdo,
+              unsigned int index);
 static int  tmpfs_remove_dirent(FAR struct tmpfs_directory_s *tdo,
               FAR const char *name);
 static int  tmpfs_add_dirent(FAR struct tmpfs_directory_s **tdo,
@@ -322,6 +338,14 @@ static int tmpfs_realloc_directory(FAR struct tmpfs_directory_s **tdo,
   FAR struct tmpfs_directory_s *newtdo;
   size_t objsize;
   int ret = oldtdo->tdo_nentries;
+  int i;
+
+  /* Directory entries are referenced by 16-bit indices */
+
+  if (nentries >= TMPFS_NO_DIRENT)
+    {
+      return -ENOSPC;
+    }
 
   /* Get the new object size */
 
@@ -350,11 +374,6 @@ static int tmpfs_realloc_directory(FAR struct tmpfs_directory_s **tdo,
       return -ENOMEM;
     }
 
-  /* Adjust the reference in the parent directory entry */
-
-  DEBUGASSERT(newtdo->tdo_dirent);
-  newtdo->tdo_dirent->tde_object = (FAR struct tmpfs_object_s *)newtdo;
-
   /* Return the new address of the reallocated directory object */
 
   newtdo->tdo_alloc    = objsize;
@@ -366,6 +385,15 @@ static int tmpfs_realloc_directory(FAR struct tmpfs_directory_s **tdo,
   DEBUGASSERT(newtdo->tdo_dirent);
   newtdo->tdo_dirent->tde_object = (FAR struct tmpfs_object_s *)newtdo;
 
+  /* The directory entries moved with the directory object.  Adjust the
+   * backward links from each object in the directory.
+   */
+
+  for (i = 0; i < ret; i++)
+    {
+      newtdo->tdo_entry[i].tde_object->to_dirent = &newtdo->tdo_entry[i];
+    }
+
   /* Return the index to the first, newly allocated directory entry */
 
   return ret;
@@ -373,71 +401,207 @@ static int tmpfs_realloc_directory(FAR struct tmpfs_directory_s **tdo,
 
 /****************************************************************************
  * Name: tmpfs_realloc_file
+ *
+ * Description:
+ *   Change the size of a file object, allocating or freeing data chunks as
+ *   necessary.  The file object itself never moves and existing file data
+ *   is never copied.  The content of any newly added region is undefined;
+ *   the caller is responsible for initializing it.
+ *
  ****************************************************************************/
 
-static int tmpfs_realloc_file(FAR struct tmpfs_file_s **tfo,
+static int tmpfs_realloc_file(FAR struct tmpfs_file_s *tfo,
                               size_t newsize)
 {
-  FAR struct tmpfs_file_s *oldtfo = *tfo;
-  FAR struct tmpfs_file_s *newtfo;
-  size_t objsize;
-  size_t allocsize;
-  size_t delta;
+  FAR uint8_t **chunks;
+  unsigned int oldchunks;
+  unsigned int newchunks;
+  unsigned int nslots;
+  unsigned int i;
+
+  oldchunks = TMPFS_NCHUNKS(tfo->tfo_size);
+  newchunks = TMPFS_NCHUNKS(newsize);
+
+  /* Make sure that the chunk table is large enough.  The table grows
+   * geometrically so that a file that is extended by many small appends
+   * reallocates the table only rarely.
+   */
+
+  if (newchunks > tfo->tfo_nslots)
+    {
+      nslots = tfo->tfo_nslots > 0 ? tfo->tfo_nslots : TMPFS_MIN_SLOTS;
+      while (nslots < newchunks)
+        {
+          nslots <<= 1;
+        }
 
-  /* Check if the current allocation is sufficient */
+      chunks = (FAR uint8_t **)
+        kmm_realloc(tfo->tfo_chunks, nslots * sizeof(FAR uint8_t *));
+      if (chunks == NULL)
+        {
+          return -ENOMEM;
+        }
 
-  objsize = SIZEOF_TMPFS_FILE(newsize);
+      tfo->tfo_alloc += (nslots - tfo->tfo_nslots) * sizeof(FAR uint8_t *);
+      tfo->tfo_chunks = chunks;
+      tfo->tfo_nslots = nslots;
+    }
 
-  /* Are we growing or shrinking the object? */
+  /* Allocate new chunks if the file is growing */
 
-  if (objsize <= oldtfo->tfo_alloc)
+  for (i = oldchunks; i < newchunks; i++)
     {
-      /* Shrinking ... Shrink unconditionally if the size is shrinking to
-       * zero.
-       */
-
-      if (newsize > 0)
+      tfo->tfo_chunks[i] = (FAR uint8_t *)kmm_malloc(TMPFS_CHUNKSIZE);
+      if (tfo->tfo_chunks[i] == NULL)
         {
-          /* Otherwise, don't realloc unless the object has shrunk by a
-           * lot.
-           */
+          /* Back out the chunks that we did allocate */
 
-          delta = oldtfo->tfo_alloc - objsize;
-          if (delta <= CONFIG_FS_TMPFS_FILE_FREEGUARD)
+          while (i-- > oldchunks)
             {
-              /* Hasn't shrunk enough.. Return doing nothing for now */
-
-              oldtfo->tfo_size = newsize;
-              return OK;
+              kmm_free(tfo->tfo_chunks[i]);
             }
+
+          return -ENOMEM;
         }
     }
 
-  /* Added some additional amount to the new size to account frequent
-   * reallocations.
-   */
+  /* Free chunks beyond the new end of file if the file is shrinking */
 
-  allocsize = objsize + CONFIG_FS_TMPFS_FILE_ALLOCGUARD;
+  for (i = newchunks; i < oldchunks; i++)
+    {
+      kmm_free(tfo->tfo_chunks[i]);
+    }
 
-  /* Realloc the file object */
+  /* Free the chunk table too if the file is now empty */
 
-  newtfo = (FAR struct tmpfs_file_s *)kmm_realloc(oldtfo, allocsize);
-  if (newtfo == NULL)
+  if (newchunks == 0 && tfo->tfo_chunks != NULL)
     {
-      return -ENOMEM;
+      kmm_free(tfo->tfo_chunks);
+
+      tfo->tfo_alloc -= tfo->tfo_nslots * sizeof(FAR uint8_t *);
+      tfo->tfo_chunks = NULL;
+      tfo->tfo_nslots = 0;
     }
 
-  /* Adjust the reference in the parent directory entry */
+  tfo->tfo_alloc = tfo->tfo_alloc - oldchunks * TMPFS_CHUNKSIZE +
+                   newchunks * TMPFS_CHUNKSIZE;
+  tfo->tfo_size  = newsize;
+  return OK;
+}
 
-  DEBUGASSERT(newtfo->tfo_dirent);
-  newtfo->tfo_dirent->tde_object = (FAR struct tmpfs_object_s *)newtfo;
+/****************************************************************************
+ * Name: tmpfs_read_chunks
+ *
+ * Description:
+ *   Copy file data beginning at 'offset' into the user buffer.  The caller
+ *   has verified that the region lies within the file.
+ *
+ ****************************************************************************/
 
-  /* Return the new address of the reallocated file object */
+static void tmpfs_read_chunks(FAR struct tmpfs_file_s *tfo, size_t offset,
+                              FAR uint8_t *buffer, size_t buflen)
+{
+  unsigned int chunk = offset / TMPFS_CHUNKSIZE;
+  size_t chunkoff    = offset % TMPFS_CHUNKSIZE;
+  size_t ncopy;
 
-  newtfo->tfo_alloc = allocsize;
-  newtfo->tfo_size  = newsize;
-  *tfo              = newtfo;
-  return OK;
+  while (buflen > 0)
+    {
+      ncopy = TMPFS_CHUNKSIZE - chunkoff;
+      if (ncopy > buflen)
+        {
+          ncopy = buflen;
+        }
+
+      memcpy(buffer, &tfo->tfo_chunks[chunk][chunkoff], ncopy);
+
+      buffer  += ncopy;
+      buflen  -= ncopy;
+      chunkoff = 0;
+      chunk++;
+    }
+}
+
+/****************************************************************************
+ * Name: tmpfs_write_chunks
+ *
+ * Description:
+ *   Copy user data into the file beginning at 'offset'.  The region is
+ *   zeroed if 'buffer' is NULL.  The caller has verified that the region
+ *   lies within the file.
+ *
+ ****************************************************************************/
+
+static void tmpfs_write_chunks(FAR struct tmpfs_file_s *tfo, size_t offset,
+                               FAR const uint8_t *buffer, size_t buflen)
+{
+  unsigned int chunk = offset / TMPFS_CHUNKSIZE;
+  size_t chunkoff    = offset % TMPFS_CHUNKSIZE;
+  size_t ncopy;
+
+  while (buflen > 0)
+    {
+      ncopy = TMPFS_CHUNKSIZE - chunkoff;
+      if (ncopy > buflen)
+        {
+          ncopy = buflen;
+        }
+
+      if (buffer != NULL)
+        {
+          memcpy(&tfo->tfo_chunks[chunk][chunkoff], buffer, ncopy);
+          buffer += ncopy;
+        }
+      else
+        {
+          memset(&tfo->tfo_chunks[chunk][chunkoff], 0, ncopy);
+        }
+
+      buflen  -= ncopy;
+      chunkoff = 0;
+      chunk++;
+    }
+}
+
+/****************************************************************************
+ * Name: tmpfs_free_file
+ ****************************************************************************/
+
+static void tmpfs_free_file(FAR struct tmpfs_file_s *tfo)
+{
+  unsigned int nchunks;
+  unsigned int i;
+
+  /* Free the file data, the chunk table, and the file object itself */
+
+  nchunks = TMPFS_NCHUNKS(tfo->tfo_size);
+  for (i = 0; i < nchunks; i++)
+    {
+      kmm_free(tfo->tfo_chunks[i]);
+    }
+
+  if (tfo->tfo_chunks != NULL)
+    {
+      kmm_free(tfo->tfo_chunks);
+    }
+
+  nxsem_destroy(&tfo->tfo_exclsem.ts_sem);
+  kmm_free(tfo);
+}
+
+/****************************************************************************
+ * Name: tmpfs_free_directory
+ ****************************************************************************/
+
+static void tmpfs_free_directory(FAR struct tmpfs_directory_s *tdo)
+{
+  if (tdo->tdo_hash != NULL)
+    {
+      kmm_free(tdo->tdo_hash);
+    }
+
+  nxsem_destroy(&tdo->tdo_exclsem.ts_sem);
+  kmm_free(tdo);
 }
 
 /****************************************************************************
@@ -475,8 +639,7 @@ static void tmpfs_release_lockedfile(FAR struct tmpfs_file_s *tfo)
 
   if (tfo->tfo_refs == 1 && (tfo->tfo_flags & TFO_FLAG_UNLINKED) != 0)
     {
-      nxsem_destroy(&tfo->tfo_exclsem.ts_sem);
-      kmm_free(tfo);
+      tmpfs_free_file(tfo);
     }
 
   /* Otherwise, just decrement the reference count on the file object */
@@ -489,49 +652,167 @@ static void tmpfs_release_lockedfile(FAR struct tmpfs_file_s *tfo)
 }
 
 /****************************************************************************
- * Name: tmpfs_find_dirent
+ * Name: tmpfs_hash
+ *
+ * Description:
+ *   Return the 32-bit FNV-1a hash of a directory entry name.
+ *
  ****************************************************************************/
 
-static int tmpfs_find_dirent(FAR struct tmpfs_directory_s *tdo,
-                             FAR const char *name)
+static uint32_t tmpfs_hash(FAR const char *name)
 {
-  int i;
+  uint32_t hash = 2166136261u;
 
-  /* Search the list of directory entries for a match */
+  while (*name != '\0')
+    {
+      hash ^= (uint8_t)*name++;
+      hash *= 16777619u;
+    }
+
+  return hash;
+}
 
-  for (i = 0;
-       i < tdo->tdo_nentries &&
-       strcmp(tdo->tdo_entry[i].tde_name, name) != 0;
-       i++);
+/****************************************************************************
+ * Name: tmpfs_hash_insert
+ ****************************************************************************/
 
-  /* Return what we found, if anything */
+static void tmpfs_hash_insert(FAR struct tmpfs_directory_s *tdo,
+                              unsigned int index)
+{
+  FAR struct tmpfs_dirent_s *tde = &tdo->tdo_entry[index];
+  unsigned int bucket = tde->tde_hash & (tdo->tdo_nbuckets - 1);
 
-  return i < tdo->tdo_nentries ? i : -ENOENT;
+  tde->tde_next         = tdo->tdo_hash[bucket];
+  tdo->tdo_hash[bucket] = (uint16_t)index;
 }
 
 /****************************************************************************
- * Name: tmpfs_remove_dirent
+ * Name: tmpfs_hash_remove
  ****************************************************************************/
 
-static int tmpfs_remove_dirent(FAR struct tmpfs_directory_s *tdo,
-                               FAR const char *name)
+static void tmpfs_hash_remove(FAR struct tmpfs_directory_s *tdo,
+                              unsigned int index)
 {
-  int index;
-  int last;
+  FAR struct tmpfs_dirent_s *tde = &tdo->tdo_entry[index];
+  FAR uint16_t *link;
 
-  /* Search the list of directory entries for a match */
+  /* Find the link to this entry in its hash bucket and unlink it */
 
-  index = tmpfs_find_dirent(tdo, name);
-  if (index < 0)
+  link = &tdo->tdo_hash[tde->tde_hash & (tdo->tdo_nbuckets - 1)];
+  while (*link != TMPFS_NO_DIRENT)
     {
-      return index;
+      if (*link == index)
+        {
+          *link = tde->tde_next;
+          return;
+        }
+
+      link = &tdo->tdo_entry[*link].tde_next;
+    }
+
+  DEBUGPANIC();
+}
+
+/****************************************************************************
+ * Name: tmpfs_hash_resize
+ *
+ * Description:
+ *   Replace the directory hash table with one containing 'nbuckets' buckets
+ *   (a power of two) and rehash all of the directory entries into it.  The
+ *   old hash table is retained if the allocation fails.
+ *
+ ****************************************************************************/
+
+static int tmpfs_hash_resize(FAR struct tmpfs_directory_s *tdo,
+                             unsigned int nbuckets)
+{
+  FAR uint16_t *hash;
+  unsigned int i;
+
+  hash = (FAR uint16_t *)kmm_malloc(nbuckets * sizeof(uint16_t));
+  if (hash == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  if (tdo->tdo_hash != NULL)
+    {
+      kmm_free(tdo->tdo_hash);
+    }
+
+  for (i = 0; i < nbuckets; i++)
+    {
+      hash[i] = TMPFS_NO_DIRENT;
+    }
+
+  tdo->tdo_hash     = hash;
+  tdo->tdo_nbuckets = nbuckets;
+
+  for (i = 0; i < tdo->tdo_nentries; i++)
+    {
+      tmpfs_hash_insert(tdo, i);
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: tmpfs_find_dirent
+ ****************************************************************************/
+
+static int tmpfs_find_dirent(FAR struct tmpfs_directory_s *tdo,
+                             FAR const char *name)
+{
+  FAR struct tmpfs_dirent_s *tde;
+  uint32_t hash;
+  unsigned int index;
+
+  /* There is no hash table until the first entry is added */
+
+  if (tdo->tdo_hash == NULL)
+    {
+      return -ENOENT;
+    }
+
+  /* Search the hash bucket for a match */
+
+  hash = tmpfs_hash(name);
+  for (index = tdo->tdo_hash[hash & (tdo->tdo_nbuckets - 1)];
+       index != TMPFS_NO_DIRENT;
+       index = tde->tde_next)
+    {
+      tde = &tdo->tdo_entry[index];
+      if (tde->tde_hash == hash && strcmp(tde->tde_name, name) == 0)
+        {
+          return index;
+        }
     }
 
+  return -ENOENT;
+}
+
+/****************************************************************************
+ * Name: tmpfs_delete_dirent
+ *
+ * Description:
+ *   Remove the directory entry at 'index', freeing its name.  The object
+ *   referenced by the entry is not affected.
+ *
+ ****************************************************************************/
+
+static void tmpfs_delete_dirent(FAR struct tmpfs_directory_s *tdo,
+                                unsigned int index)
+{
+  FAR struct tmpfs_dirent_s *tde = &tdo->tdo_entry[index];
+  unsigned int last;
+
+  tmpfs_hash_remove(tdo, index);
+
   /* Free the object name */
 
-  if (tdo->tdo_entry[index].tde_name != NULL)
+  if (tde->tde_name != NULL)
     {
-      kmm_free(tdo->tdo_entry[index].tde_name);
+      kmm_free(tde->tde_name);
     }
 
   /* Remove by replacing this entry with the final directory entry */
@@ -539,27 +820,46 @@ static int tmpfs_remove_dirent(FAR struct tmpfs_directory_s *tdo,
   last = tdo->tdo_nentries - 1;
   if (index != last)
     {
-      FAR struct tmpfs_dirent_s *newtde;
-      FAR struct tmpfs_dirent_s *oldtde;
-      FAR struct tmpfs_object_s *to;
+      FAR struct tmpfs_dirent_s *oldtde = &tdo->tdo_entry[last];
+
+      /* Move the directory entry and its hash bucket link */
 
-      /* Move the directory entry */
+      tmpfs_hash_remove(tdo, last);
 
-      newtde             = &tdo->tdo_entry[index];
-      oldtde             = &tdo->tdo_entry[last];
-      to                 = oldtde->tde_object;
+      tde->tde_object = oldtde->tde_object;
+      tde->tde_name   = oldtde->tde_name;
+      tde->tde_hash   = oldtde->tde_hash;
 
-      newtde->tde_object = to;
-      newtde->tde_name   = oldtde->tde_name;
+      tmpfs_hash_insert(tdo, index);
 
       /* Reset the backward link to the directory entry */
 
-      to->to_dirent      = newtde;
+      tde->tde_object->to_dirent = tde;
     }
 
   /* And decrement the count of directory entries */
 
   tdo->tdo_nentries = last;
+}
+
+/****************************************************************************
+ * Name: tmpfs_remove_dirent
+ ****************************************************************************/
+
+static int tmpfs_remove_dirent(FAR struct tmpfs_directory_s *tdo,
+                               FAR const char *name)
+{
+  int index;
+
+  /* Search the list of directory entries for a match */
+
+  index = tmpfs_find_dirent(tdo, name);
+  if (index < 0)
+    {
+      return index;
+    }
+
+  tmpfs_delete_dirent(tdo, index);
   return OK;
 }
 
@@ -576,7 +876,9 @@ static int tmpfs_add_dirent(FAR struct tmpfs_directory_s **tdo,
   FAR struct tmpfs_dirent_s *tde;
   FAR char *newname;
   unsigned int nentries;
+  unsigned int nbuckets;
   int index;
+  int ret;
 
   /* Copy the name string so that it will persist as long as the
    * directory entry.
@@ -608,6 +910,40 @@ static int tmpfs_add_dirent(FAR struct tmpfs_directory_s **tdo,
   tde             = &newtdo->tdo_entry[index];
   tde->tde_object = to;
   tde->tde_name   = newname;
+  tde->tde_hash   = tmpfs_hash(newname);
+
+  /* Grow the hash table when the average bucket holds more than two
+   * entries.  Resizing rehashes all entries, including the new one.
+   */
+
+  if (newtdo->tdo_hash == NULL || nentries > 2 * newtdo->tdo_nbuckets)
+    {
+      nbuckets = newtdo->tdo_hash == NULL ?
+                 TMPFS_MIN_BUCKETS : 2 * newtdo->tdo_nbuckets;
+
+      ret = tmpfs_hash_resize(newtdo, nbuckets);
+      if (ret < 0)
+        {
+          if (newtdo->tdo_hash == NULL)
+            {
+              /* There is no hash table at all.  Back out the new entry */
+
+              newtdo->tdo_nentries = index;
+              kmm_free(newname);
+              return ret;
+            }
+
+          /* Keep using the existing, smaller hash table */
+
+          tmpfs_hash_insert(newtdo, index);
+        }
+    }
+  else
+    {
+      /* Just add the new entry to the existing hash table */
+
+      tmpfs_hash_insert(newtdo, index);
+    }
 
   /* Add backward link to the directory entry to the object */
 
@@ -622,12 +958,12 @@ static int tmpfs_add_dirent(FAR struct tmpfs_directory_s **tdo,
 static FAR struct tmpfs_file_s *tmpfs_alloc_file(void)
 {
   FAR struct tmpfs_file_s *tfo;
-  size_t allocsize;
 
-  /* Create a new zero length file object */
+  /* Create a new zero length file object.  No data chunks are allocated
+   * until data is written to the file.
+   */
 
-  allocsize = SIZEOF_TMPFS_FILE(CONFIG_FS_TMPFS_FILE_ALLOCGUARD);
-  tfo = (FAR struct tmpfs_file_s *)kmm_malloc(allocsize);
+  tfo = (FAR struct tmpfs_file_s *)kmm_malloc(sizeof(struct tmpfs_file_s));
   if (tfo == NULL)
     {
       return NULL;
@@ -637,11 +973,13 @@ static FAR struct tmpfs_file_s *tmpfs_alloc_file(void)
    * locked with one reference count.
    */
 
-  tfo->tfo_alloc = allocsize;
-  tfo->tfo_type  = TMPFS_REGULAR;
-  tfo->tfo_refs  = 1;
-  tfo->tfo_flags = 0;
-  tfo->tfo_size  = 0;
+  tfo->tfo_alloc  = sizeof(struct tmpfs_file_s);
+  tfo->tfo_type   = TMPFS_REGULAR;
+  tfo->tfo_refs   = 1;
+  tfo->tfo_flags  = 0;
+  tfo->tfo_size   = 0;
+  tfo->tfo_nslots = 0;
+  tfo->tfo_chunks = NULL;
 
   tfo->tfo_exclsem.ts_holder = getpid();
   tfo->tfo_exclsem.ts_count  = 1;
@@ -757,8 +1095,7 @@ static int tmpfs_create_file(FAR struct tmpfs_s *fs,
 /* Error exits */
 
 errout_with_file:
-  nxsem_destroy(&newtfo->tfo_exclsem.ts_sem);
-  kmm_free(newtfo);
+  tmpfs_free_file(newtfo);
 
 errout_with_parent:
   parent->tdo_refs--;
@@ -800,6 +1137,8 @@ static FAR struct tmpfs_directory_s *tmpfs_alloc_directory(void)
   tdo->tdo_type     = TMPFS_DIRECTORY;
   tdo->tdo_refs     = 0;
   tdo->tdo_nentries = 0;
+  tdo->tdo_nbuckets = 0;
+  tdo->tdo_hash     = NULL;
 
   tdo->tdo_exclsem.ts_holder = TMPFS_NO_HOLDER;
   tdo->tdo_exclsem.ts_count  = 0;
@@ -919,8 +1258,7 @@ static int tmpfs_create_directory(FAR struct tmpfs_s *fs,
 /* Error exits */
 
 errout_with_directory:
-  nxsem_destroy(&newtdo->tdo_exclsem.ts_sem);
-  kmm_free(newtdo);
+  tmpfs_free_directory(newtdo);
 
 errout_with_parent:
   parent->tdo_refs--;
@@ -1195,6 +1533,7 @@ static int tmpfs_statfs_callout(FAR struct tmpfs_directory_s *tdo,
   else /* if (to->to_type == TMPFS_DIRECTORY) */
     {
       FAR struct tmpfs_directory_s *tmptdo;
+      size_t hashsize;
       size_t inuse;
       size_t avail;
 
@@ -1202,11 +1541,13 @@ static int tmpfs_statfs_callout(FAR struct tmpfs_directory_s *tdo,
        * for the directory and estimate the number of free directory nodes.
        */
 
-      tmptdo = (FAR struct tmpfs_directory_s *)to;
-      inuse  = SIZEOF_TMPFS_DIRECTORY(tmptdo->tdo_nentries);
-      avail  = tmptdo->tdo_alloc - inuse;
+      tmptdo   = (FAR struct tmpfs_directory_s *)to;
+      hashsize = tmptdo->tdo_nbuckets * sizeof(uint16_t);
+      inuse    = SIZEOF_TMPFS_DIRECTORY(tmptdo->tdo_nentries);
+      avail    = tmptdo->tdo_alloc - inuse;
 
-      tmpbuf->tsf_inuse += inuse;
+      tmpbuf->tsf_alloc += hashsize;
+      tmpbuf->tsf_inuse += inuse + hashsize;
       tmpbuf->tsf_ffree += avail / sizeof(struct tmpfs_dirent_s);
     }
 
@@ -1220,45 +1561,13 @@ static int tmpfs_statfs_callout(FAR struct tmpfs_directory_s *tdo,
 static int tmpfs_free_callout(FAR struct tmpfs_directory_s *tdo,
                               unsigned int index, FAR void *arg)
 {
-  FAR struct tmpfs_dirent_s *tde;
   FAR struct tmpfs_object_s *to;
   FAR struct tmpfs_file_s *tfo;
-  unsigned int last;
-
-  /* Free the object name */
-
-  if (tdo->tdo_entry[index].tde_name != NULL)
-    {
-      kmm_free(tdo->tdo_entry[index].tde_name);
-    }
-
-  /* Remove by replacing this entry with the final directory entry */
-
-  tde  = &tdo->tdo_entry[index];
-  to   = tde->tde_object;
-  last = tdo->tdo_nentries - 1;
-
-  if (index != last)
-    {
-      FAR struct tmpfs_dirent_s *oldtde;
-      FAR struct tmpfs_object_s *oldto;
-
-      /* Move the directory entry */
-
-      oldtde           = &tdo->tdo_entry[last];
-      oldto            = oldtde->tde_object;
-
-      tde->tde_object  = oldto;
-      tde->tde_name    = oldtde->tde_name;
-
-      /* Reset the backward link to the directory entry */
 
-      oldto->to_dirent = tde;
-    }
+  /* Remove the directory entry */
 
-  /* And decrement the count of directory entries */
-
-  tdo->tdo_nentries = last;
+  to = tdo->tdo_entry[index].tde_object;
+  tmpfs_delete_dirent(tdo, index);
 
   /* Is this directory entry a file object? */
 
@@ -1279,8 +1588,15 @@ static int tmpfs_free_callout(FAR struct tmpfs_directory_s *tdo,
 
   /* Free the object now */
 
-  nxsem_destroy(&to->to_exclsem.ts_sem);
-  kmm_free(to);
+  if (to->to_type == TMPFS_REGULAR)
+    {
+      tmpfs_free_file((FAR struct tmpfs_file_s *)to);
+    }
+  else
+    {
+      tmpfs_free_directory((FAR struct tmpfs_directory_s *)to);
+    }
+
   return TMPFS_DELETED;
 }
 
@@ -1316,7 +1632,7 @@ static int tmpfs_foreach(FAR struct tmpfs_directory_s *tdo,
            * action will be to delete the directory.
            */
 
-          ret = tmpfs_foreach(next, tmpfs_free_callout, NULL);
+          ret = tmpfs_foreach(next, callout, arg);
           if (ret < 0)
             {
               return -ECANCELED;
@@ -1428,7 +1744,7 @@ static int tmpfs_open(FAR struct file *filep, FAR const char *relpath,
 
           if (tfo->tfo_size > 0)
             {
-              ret = tmpfs_realloc_file(&tfo, 0);
+              ret = tmpfs_realloc_file(tfo, 0);
               if (ret < 0)
                 {
                   goto errout_with_filelock;
@@ -1543,7 +1859,7 @@ static int tmpfs_close(FAR struct file *filep)
        * have any other references.
        */
 
-      kmm_free(tfo);
+      tmpfs_free_file(tfo);
       return OK;
     }
 
@@ -1583,7 +1899,11 @@ static ssize_t tmpfs_read(FAR struct file *filep, FAR char *buffer,
   nread    = buflen;
   endpos   = startpos + buflen;
 
-  if (endpos > tfo->tfo_size)
+  if (startpos >= tfo->tfo_size)
+    {
+      nread  = 0;
+    }
+  else if (endpos > tfo->tfo_size)
     {
       endpos = tfo->tfo_size;
       nread  = endpos - startpos;
@@ -1591,7 +1911,7 @@ static ssize_t tmpfs_read(FAR struct file *filep, FAR char *buffer,
 
   /* Copy data from the memory object to the user buffer */
 
-  memcpy(buffer, &tfo->tfo_data[startpos], nread);
+  tmpfs_read_chunks(tfo, (size_t)startpos, (FAR uint8_t *)buffer, nread);
   filep->f_pos += nread;
 
   /* Release the lock on the file */
@@ -1609,6 +1929,7 @@ static ssize_t tmpfs_write(FAR struct file *filep, FAR const char *buffer,
 {
   FAR struct tmpfs_file_s *tfo;
   ssize_t nwritten;
+  size_t oldsize;
   off_t startpos;
   off_t endpos;
   int ret;
@@ -1631,22 +1952,32 @@ static ssize_t tmpfs_write(FAR struct file *filep, FAR const char *buffer,
   nwritten = buflen;
   endpos   = startpos + buflen;
 
-  if (endpos > tfo->tfo_size)
+  oldsize  = tfo->tfo_size;
+
+  if (endpos > oldsize)
     {
-      /* Reallocate the file to handle the write past the end of the file. */
+      /* Extend the file to handle the write past the end of the file.
+       * This only allocates new chunks; existing data is not moved.
+       */
 
-      ret = tmpfs_realloc_file(&tfo, (size_t)endpos);
+      ret = tmpfs_realloc_file(tfo, (size_t)endpos);
       if (ret < 0)
         {
           goto errout_with_lock;
         }
 
-      filep->f_priv = tfo;
+      /* Zero any gap between the old end of the file and the write */
+
+      if (startpos > oldsize)
+        {
+          tmpfs_write_chunks(tfo, oldsize, NULL, startpos - oldsize);
+        }
     }
 
-  /* Copy data from the memory object to the user buffer */
+  /* Copy data from the user buffer to the memory object */
 
-  memcpy(&tfo->tfo_data[startpos], buffer, nwritten);
+  tmpfs_write_chunks(tfo, (size_t)startpos, (FAR const uint8_t *)buffer,
+                     nwritten);
   filep->f_pos += nwritten;
 
   /* Release the lock on the file */
@@ -1733,20 +2064,31 @@ static int tmpfs_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
 
   /* Recover our private data from the struct file instance */
 
-  tfo = filep->f_inode->i_private;
+  tfo = filep->f_priv;
 
   DEBUGASSERT(tfo != NULL);
 
-  /* Only one ioctl command is supported */
+  /* Only one ioctl command is supported.  File data can only be mapped
+   * directly if it lies in a single, contiguous chunk.  Otherwise, mmap()
+   * will fall back to copying the file into RAM (if CONFIG_FS_RAMMAP is
+   * enabled).
+   */
 
   if (cmd == FIOC_MMAP && ppv != NULL)
     {
-      /* Return the address on the media corresponding to the start of
-       * the file.
-       */
+      int ret = -ENOTTY;
 
-      *ppv = (FAR void *)tfo->tfo_data;
-      return OK;
+      tmpfs_lock_file(tfo);
+      if (tfo->tfo_size > 0 && tfo->tfo_size <= TMPFS_CHUNKSIZE)
+        {
+          /* Return the address of the first (and only) chunk */
+
+          *ppv = (FAR void *)tfo->tfo_chunks[0];
+          ret  = OK;
+        }
+
+      tmpfs_unlock_file(tfo);
+      return ret;
     }
 
   ferr("ERROR: Invalid cmd: %d\n", cmd);
@@ -1850,21 +2192,19 @@ static int tmpfs_truncate(FAR struct file *filep, off_t length)
     {
       /* The size is changing.. up or down.  Reallocate the file memory. */
 
-      ret = tmpfs_realloc_file(&tfo, (size_t)length);
+      ret = tmpfs_realloc_file(tfo, (size_t)length);
       if (ret < 0)
         {
           goto errout_with_lock;
         }
 
-      filep->f_priv = tfo;
-
       /* If the size has increased, then we need to zero the newly added
        * memory.
        */
 
       if (length > oldsize)
         {
-          memset(&tfo->tfo_data[oldsize], 0, length - oldsize);
+          tmpfs_write_chunks(tfo, oldsize, NULL, length - oldsize);
         }
 
       ret = OK;
@@ -2116,8 +2456,7 @@ static int tmpfs_unbind(FAR void *handle, FAR struct inode **blkdriver,
 
   /* Now we can destroy the root file system and the file system itself. */
 
-  nxsem_destroy(&tdo->tdo_exclsem.ts_sem);
-  kmm_free(tdo);
+  tmpfs_free_directory(tdo);
 
   nxsem_destroy(&fs->tfs_exclsem.ts_sem);
   kmm_free(fs);
@@ -2133,6 +2472,7 @@ static int tmpfs_statfs(FAR struct inode *mountpt, FAR struct statfs *buf)
   FAR struct tmpfs_s *fs;
   FAR struct tmpfs_directory_s *tdo;
   struct tmpfs_statfs_s tmpbuf;
+  size_t hashsize;
   size_t inuse;
   size_t avail;
   off_t blkalloc;
@@ -2154,12 +2494,14 @@ static int tmpfs_statfs(FAR struct inode *mountpt, FAR struct statfs *buf)
   /* Set up the memory use for the file system and root directory object */
 
   tdo              = (FAR struct tmpfs_directory_s *)fs->tfs_root.tde_object;
+  hashsize         = tdo->tdo_nbuckets * sizeof(uint16_t);
   inuse            = sizeof(struct tmpfs_s) +
                      SIZEOF_TMPFS_DIRECTORY(tdo->tdo_nentries);
   avail            = sizeof(struct tmpfs_s) +
                      tdo->tdo_alloc - inuse;
+  inuse           += hashsize;
 
-  tmpbuf.tsf_alloc = tdo->tdo_alloc;
+  tmpbuf.tsf_alloc = tdo->tdo_alloc + hashsize;
   tmpbuf.tsf_inuse = inuse;
   tmpbuf.tsf_files = 0;
   tmpbuf.tsf_ffree = avail / sizeof(struct tmpfs_dirent_s);
@@ -2275,8 +2617,7 @@ static int tmpfs_unlink(FAR struct inode *mountpt, FAR const char *relpath)
 
   else
     {
-      nxsem_destroy(&tfo->tfo_exclsem.ts_sem);
-      kmm_free(tfo);
+      tmpfs_free_file(tfo);
     }
 
   /* Release the reference and lock on the parent directory */
@@ -2401,8 +2742,7 @@ static int tmpfs_rmdir(FAR struct inode *mountpt, FAR const char *relpath)
 
   /* Free the directory object */
 
-  nxsem_destroy(&tdo->tdo_exclsem.ts_sem);
-  kmm_free(tdo);
+  tmpfs_free_directory(tdo);
 
   /* Release the reference and lock on the parent directory */
 
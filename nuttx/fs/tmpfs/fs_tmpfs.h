@@ -1,7 +1,7 @@
 /****************************************************************************
  * fs/tmpfs/fs_tmpfs.h
  *
- *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2015, 2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -58,6 +58,17 @@
 
 #define TFO_FLAG_UNLINKED (1 << 0)  /* Bit 0: File is unlinked */
 
+/* Directory entries are indexed with 16-bit values.  This value marks the
+ * end of a hash bucket chain.
+ */
+
+#define TMPFS_NO_DIRENT   0xffff
+
+/* File data is held in fixed size chunks */
+
+#define TMPFS_CHUNKSIZE   CONFIG_FS_TMPFS_CHUNKSIZE
+#define TMPFS_NCHUNKS(n)  (((n) + TMPFS_CHUNKSIZE - 1) / TMPFS_CHUNKSIZE)
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -95,6 +106,8 @@ struct tmpfs_dirent_s
 {
   FAR struct tmpfs_object_s *tde_object;
   FAR char *tde_name;
+  uint32_t tde_hash;     /* Hash of tde_name */
+  uint16_t tde_next;     /* Next entry in the same hash bucket */
 };
 
 /* The generic form of a TMPFS memory object */
@@ -125,6 +138,8 @@ struct tmpfs_directory_s
   /* Remaining fields are unique to a directory object */
 
   uint16_t tdo_nentries; /* Number of directory entries */
+  uint16_t tdo_nbuckets; /* Number of hash buckets (power of two) */
+  FAR uint16_t *tdo_hash; /* Index of the first entry in each hash bucket */
   struct tmpfs_dirent_s tdo_entry[1];
 };
 
@@ -137,6 +152,10 @@ struct tmpfs_directory_s
  * state.  The file memory object also serves as the open file object,
  * saving an allocation.  This has the negative side effect that no per-
  * open state can be retained (such as open flags).
+ *
+ * File data is held in a table of fixed size chunks.  Growing the file
+ * only allocates new chunks (and occasionally grows the chunk table); the
+ * existing file data is never copied and the file object never moves.
  */
 
 struct tmpfs_file_s
@@ -150,15 +169,14 @@ struct tmpfs_file_s
   uint8_t  tfo_type;     /* See enum tmpfs_objtype_e */
   uint8_t  tfo_refs;     /* Reference count */
 
-  /* Remaining fields are unique to a directory object */
+  /* Remaining fields are unique to a file object */
 
   uint8_t  tfo_flags;    /* See TFO_FLAG_* definitions */
   size_t   tfo_size;     /* Valid file size */
-  uint8_t  tfo_data[1];  /* File data starts here */
+  unsigned int tfo_nslots; /* Number of slots in tfo_chunks[] */
+  FAR uint8_t **tfo_chunks; /* Table of TMPFS_CHUNKSIZE data chunks */
 };
 
-#define SIZEOF_TMPFS_FILE(n) (sizeof(struct tmpfs_file_s) + (n) - 1)
-
 /* This structure represents one instance of a TMPFS file system */
 
 struct tmpfs_s
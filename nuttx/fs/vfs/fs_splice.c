@@ -0,0 +1,673 @@
+/****************************************************************************
+ * fs/vfs/fs_splice.c
+ *
+ *   Copyright (C) 2018 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <stdbool.h>
+#include <string.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <assert.h>
+
+#include <nuttx/kmalloc.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/fs/ioctl.h>
+#include <nuttx/mm/iob.h>
+#include <nuttx/net/net.h>
+#include <nuttx/drivers/drivers.h>
+
+#if CONFIG_NFILE_DESCRIPTORS > 0 && defined(CONFIG_DEV_PIPE_SPLICE)
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#if defined(CONFIG_NET) && CONFIG_NSOCKET_DESCRIPTORS > 0
+#  define HAVE_SPLICE_SOCKETS 1
+#endif
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* One end of a splice():  A pipe, some other file, or a socket */
+
+struct splice_end_s
+{
+  FAR struct file   *filep;  /* The open file (NULL if a socket) */
+#ifdef HAVE_SPLICE_SOCKETS
+  FAR struct socket *psock;  /* The socket (NULL if a file) */
+#endif
+  bool               ispipe; /* True if 'filep' is a pipe or FIFO */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: splice_getend
+ *
+ * Description:
+ *   Look up the file or socket referred to by the descriptor 'fd'.
+ *
+ ****************************************************************************/
+
+static int splice_getend(int fd, int oflags, FAR struct splice_end_s *end)
+{
+  int ret;
+
+  memset(end, 0, sizeof(struct splice_end_s));
+
+  if ((unsigned int)fd < CONFIG_NFILE_DESCRIPTORS)
+    {
+      ret = fs_getfilep(fd, &end->filep);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      DEBUGASSERT(end->filep != NULL);
+      if ((end->filep->f_oflags & oflags) == 0)
+        {
+          return -EBADF;
+        }
+
+      end->ispipe = pipe_isfile(end->filep);
+      return OK;
+    }
+
+#ifdef HAVE_SPLICE_SOCKETS
+  end->psock = sockfd_socket(fd);
+  if (end->psock != NULL && end->psock->s_crefs > 0)
+    {
+      return OK;
+    }
+#endif
+
+  return -EBADF;
+}
+
+/****************************************************************************
+ * Name: splice_pipespace
+ *
+ * Description:
+ *   Limit 'len' to the free space in the output pipe so that no more data
+ *   is taken from the input than can be delivered.
+ *
+ ****************************************************************************/
+
+static ssize_t splice_pipespace(FAR struct file *filep, size_t len,
+                                bool nonblock)
+{
+  int nspace = 0;
+
+  (void)file_ioctl(filep, FIONSPACE, (unsigned long)((uintptr_t)&nspace));
+  if (nspace <= 0)
+    {
+      /* The pipe is full.  Unless non-blocking, prepare one I/O buffer of
+       * data and let pipe_splicein() wait for space.
+       */
+
+      if (nonblock)
+        {
+          return -EAGAIN;
+        }
+
+      nspace = CONFIG_IOB_BUFSIZE;
+    }
+
+  return len < (size_t)nspace ? len : (size_t)nspace;
+}
+
+/****************************************************************************
+ * Name: splice_topipe
+ *
+ * Description:
+ *   Add the first 'len' bytes of the I/O buffer chain '*iob' to a pipe,
+ *   waiting for space as necessary (unless non-blocking).
+ *
+ ****************************************************************************/
+
+static ssize_t splice_topipe(FAR struct file *filep, FAR struct iob_s **iob,
+                             size_t len, unsigned int flags)
+{
+  size_t total = 0;
+  ssize_t ret;
+
+  while (total < len)
+    {
+      ret = pipe_splicein(filep, iob, len - total, flags);
+      if (ret < 0)
+        {
+          return total > 0 ? (ssize_t)total : ret;
+        }
+
+      total += ret;
+    }
+
+  return total;
+}
+
+/****************************************************************************
+ * Name: splice_read
+ *
+ * Description:
+ *   Read up to 'len' bytes from a file (other than a pipe) into a new I/O
+ *   buffer chain.  The data is read directly into the I/O buffers.
+ *
+ ****************************************************************************/
+
+static ssize_t splice_read(FAR struct file *filep, FAR off_t *offset,
+                           FAR struct iob_s **iobp, size_t len,
+                           bool nonblock)
+{
+  FAR struct iob_s *head = NULL;
+  FAR struct iob_s *tail = NULL;
+  FAR struct iob_s *iob;
+  ssize_t nread = -EAGAIN;
+  size_t total = 0;
+  size_t chunk;
+
+  while (total < len)
+    {
+      /* Only the first I/O buffer allocation may wait */
+
+      chunk = len - total;
+      iob   = (head == NULL && !nonblock) ? iob_alloc_size(chunk, false) :
+                                            iob_tryalloc_size(chunk, false);
+      if (iob == NULL)
+        {
+          break;
+        }
+
+      if (chunk > IOB_BUFSIZE(iob))
+        {
+          chunk = IOB_BUFSIZE(iob);
+        }
+
+      if (offset != NULL)
+        {
+          nread = file_pread(filep, iob->io_data, chunk, *offset + total);
+        }
+      else
+        {
+          nread = file_read(filep, iob->io_data, chunk);
+        }
+
+      if (nread <= 0)
+        {
+          iob_free(iob);
+          break;
+        }
+
+      iob->io_len = nread;
+      if (head == NULL)
+        {
+          head = iob;
+        }
+      else
+        {
+          tail->io_flink = iob;
+        }
+
+      tail   = iob;
+      total += nread;
+
+      /* Stop at a short read.  Character drivers might block on the next
+       * read, so only regular files are read more than once.
+       */
+
+      if ((size_t)nread < chunk || !INODE_IS_MOUNTPT(filep->f_inode))
+        {
+          break;
+        }
+    }
+
+  if (head == NULL)
+    {
+      return nread;
+    }
+
+  head->io_pktlen = total;
+  *iobp = head;
+  return total;
+}
+
+/****************************************************************************
+ * Name: splice_recv
+ *
+ * Description:
+ *   Take up to 'len' bytes of input from a socket, to be passed on to the
+ *   output pipe.  The data is received into a new I/O buffer.  There is no
+ *   interface to receive directly into an I/O buffer, and datagrams cannot
+ *   be split over several receive calls, so the data passes through an OS
+ *   bounce buffer.
+ *
+ ****************************************************************************/
+
+#ifdef HAVE_SPLICE_SOCKETS
+static ssize_t splice_recv(FAR struct socket *psock,
+                           FAR struct iob_s **iobp, size_t len,
+                           bool nonblock)
+{
+  FAR struct iob_s *iob;
+  FAR uint8_t *buffer;
+  ssize_t ret;
+
+  iob = nonblock ? iob_tryalloc_size(len, false) :
+                   iob_alloc_size(len, false);
+  if (iob == NULL)
+    {
+      return -EAGAIN;
+    }
+
+  /* Data left in a stream socket can be taken by the next call, so do not
+   * take more than fits in this I/O buffer.  A datagram must be taken
+   * whole and may need more I/O buffers to be chained.
+   */
+
+  if (psock->s_type == SOCK_STREAM && len > IOB_FREESPACE(iob))
+    {
+      len = IOB_FREESPACE(iob);
+    }
+
+  buffer = (FAR uint8_t *)kmm_malloc(len);
+  if (buffer == NULL)
+    {
+      iob_free(iob);
+      return -ENOMEM;
+    }
+
+  ret = psock_recvfrom(psock, buffer, len, 0, NULL, NULL);
+  if (ret > 0)
+    {
+      /* Only a datagram can need more I/O buffers here.  Do not wait for
+       * them if the splice is non-blocking.
+       */
+
+      if (!nonblock)
+        {
+          ret = iob_copyin(iob, buffer, ret, 0, false);
+        }
+      else if (iob_trycopyin(iob, buffer, ret, 0, false) < 0)
+        {
+          ret = -EAGAIN;
+        }
+    }
+
+  kmm_free(buffer);
+
+  if (ret <= 0)
+    {
+      iob_free_chain(iob);
+      return ret;
+    }
+
+  *iobp = iob;
+  return ret;
+}
+#endif
+
+/****************************************************************************
+ * Name: splice_write
+ *
+ * Description:
+ *   Write the first 'len' bytes of an I/O buffer chain to a file (other
+ *   than a pipe) or a socket.
+ *
+ ****************************************************************************/
+
+static ssize_t splice_write(FAR struct splice_end_s *out, FAR off_t *offset,
+                            FAR struct iob_s *iob, size_t len)
+{
+  FAR const uint8_t *data;
+  size_t remaining;
+  size_t total = 0;
+  ssize_t nwritten;
+
+  for (; iob != NULL && total < len; iob = iob->io_flink)
+    {
+      data      = IOB_DATA(iob);
+      remaining = iob->io_len;
+      if (remaining > len - total)
+        {
+          remaining = len - total;
+        }
+
+      while (remaining > 0)
+        {
+#ifdef HAVE_SPLICE_SOCKETS
+          if (out->psock != NULL)
+            {
+              nwritten = psock_send(out->psock, data, remaining, 0);
+            }
+          else
+#endif
+          if (offset != NULL)
+            {
+              nwritten = file_pwrite(out->filep, data, remaining,
+                                     *offset + total);
+            }
+          else
+            {
+              nwritten = file_write(out->filep, data, remaining);
+            }
+
+          if (nwritten <= 0)
+            {
+              if (total > 0)
+                {
+                  return total;
+                }
+
+              return nwritten < 0 ? nwritten : -EIO;
+            }
+
+          data      += nwritten;
+          remaining -= nwritten;
+          total     += nwritten;
+        }
+    }
+
+  return total;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: splice
+ *
+ * Description:
+ *   splice() moves data between two file descriptors without copying it
+ *   through a user buffer.  One of the descriptors must refer to a pipe (or
+ *   FIFO); the other may be a pipe, a regular file, a character driver or
+ *   a socket.  The data is carried in I/O buffer chains.  When pipes hold
+ *   their data in I/O buffers (CONFIG_DEV_PIPE_IOB), whole I/O buffers are
+ *   moved between pipes and the rest of the OS without being copied.
+ *
+ *   NOTE: This interface is *not* specified in POSIX.  It is similar to the
+ *   Linux splice() interface.
+ *
+ * Input Parameters:
+ *   fd_in   - The descriptor to read data from
+ *   off_in  - If not NULL, the offset in 'fd_in' to read from.  The file
+ *             position is then not changed; the offset is advanced by the
+ *             number of bytes transferred.  Must be NULL for pipes and
+ *             sockets.
+ *   fd_out  - The descriptor to write data to
+ *   off_out - Same as 'off_in' but for 'fd_out'
+ *   len     - The maximum number of bytes to transfer
+ *   flags   - SPLICE_F_NONBLOCK makes the pipe operations non-blocking.
+ *             The other SPLICE_F_* flags are accepted but ignored.
+ *
+ * Returned Value:
+ *   The number of bytes transferred, zero at end of input, or -1 with
+ *   errno set on failure:
+ *
+ *   EAGAIN - SPLICE_F_NONBLOCK was given (or the pipe is non-blocking) and
+ *            the operation would block.
+ *   EBADF  - A descriptor is not valid or not open for the right access.
+ *   EINVAL - Neither descriptor refers to a pipe, or both refer to the
+ *            same pipe.
+ *   ESPIPE - An offset was given for a pipe or socket.
+ *
+ *   If data was taken from the input but the output then fails, that data
+ *   is lost (except that seekable input files are rewound).
+ *
+ ****************************************************************************/
+
+ssize_t splice(int fd_in, FAR off_t *off_in, int fd_out, FAR off_t *off_out,
+               size_t len, unsigned int flags)
+{
+  struct splice_end_s in;
+  struct splice_end_s out;
+  FAR struct iob_s *iob = NULL;
+  bool nonblock = (flags & SPLICE_F_NONBLOCK) != 0;
+  ssize_t nread;
+  ssize_t ret;
+
+  ret = splice_getend(fd_in, O_RDOK, &in);
+  if (ret >= 0)
+    {
+      ret = splice_getend(fd_out, O_WROK, &out);
+    }
+
+  if (ret < 0)
+    {
+      goto errout;
+    }
+
+  /* One end must be a pipe, but not both ends the same pipe.  Offsets are
+   * only meaningful for regular files.
+   */
+
+  if ((!in.ispipe && !out.ispipe) ||
+      (in.ispipe && out.ispipe && in.filep->f_inode == out.filep->f_inode))
+    {
+      ret = -EINVAL;
+      goto errout;
+    }
+
+  if ((off_in != NULL && (in.ispipe || in.filep == NULL)) ||
+      (off_out != NULL && (out.ispipe || out.filep == NULL)))
+    {
+      ret = -ESPIPE;
+      goto errout;
+    }
+
+  if (len == 0)
+    {
+      return 0;
+    }
+
+  if (out.ispipe)
+    {
+      /* Take no more from the input than the output pipe can hold */
+
+      ret = splice_pipespace(out.filep, len,
+                             nonblock ||
+                             (out.filep->f_oflags & O_NONBLOCK) != 0);
+      if (ret < 0)
+        {
+          goto errout;
+        }
+
+      len = ret;
+    }
+
+  /* Get the data from the input */
+
+  if (in.ispipe)
+    {
+      nread = pipe_spliceout(in.filep, &iob, len, flags, false);
+    }
+#ifdef HAVE_SPLICE_SOCKETS
+  else if (in.psock != NULL)
+    {
+      nread = splice_recv(in.psock, &iob, len, nonblock);
+    }
+#endif
+  else
+    {
+      nread = splice_read(in.filep, off_in, &iob, len, nonblock);
+    }
+
+  if (nread <= 0)
+    {
+      ret = nread;
+      goto errout_with_iob;
+    }
+
+  /* And pass it on to the output */
+
+  if (out.ispipe)
+    {
+      ret = splice_topipe(out.filep, &iob, nread, flags);
+    }
+  else
+    {
+      ret = splice_write(&out, off_out, iob, nread);
+    }
+
+  /* If the output did not take all of the data, put the unused part back
+   * into a seekable input file.  In all other cases it is lost.
+   */
+
+  if (ret < nread && !in.ispipe && in.filep != NULL && off_in == NULL)
+    {
+      (void)file_seek(in.filep, (ret > 0 ? ret : 0) - nread, SEEK_CUR);
+    }
+
+  if (ret > 0)
+    {
+      if (off_in != NULL)
+        {
+          *off_in += ret;
+        }
+
+      if (off_out != NULL)
+        {
+          *off_out += ret;
+        }
+    }
+
+errout_with_iob:
+  if (iob != NULL)
+    {
+      iob_free_chain(iob);
+    }
+
+errout:
+  if (ret < 0)
+    {
+      set_errno(-ret);
+      return ERROR;
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: tee
+ *
+ * Description:
+ *   tee() duplicates up to 'len' bytes of data from the pipe 'fd_in' to
+ *   the pipe 'fd_out' without consuming it, so that it can still be read
+ *   from 'fd_in'.  The data is copied inside of the OS into I/O buffers; it
+ *   is never copied through a user buffer.
+ *
+ *   NOTE: This interface is *not* specified in POSIX.  It is similar to the
+ *   Linux tee() interface.
+ *
+ * Input Parameters:
+ *   fd_in  - The pipe to duplicate data from
+ *   fd_out - The pipe to duplicate data to
+ *   len    - The maximum number of bytes to duplicate
+ *   flags  - SPLICE_F_NONBLOCK makes the pipe operations non-blocking.
+ *
+ * Returned Value:
+ *   The number of bytes duplicated, zero if there is no data and no writer
+ *   on 'fd_in', or -1 with errno set on failure (see splice()).
+ *
+ ****************************************************************************/
+
+ssize_t tee(int fd_in, int fd_out, size_t len, unsigned int flags)
+{
+  struct splice_end_s in;
+  struct splice_end_s out;
+  FAR struct iob_s *iob = NULL;
+  bool nonblock = (flags & SPLICE_F_NONBLOCK) != 0;
+  ssize_t ret;
+
+  ret = splice_getend(fd_in, O_RDOK, &in);
+  if (ret >= 0)
+    {
+      ret = splice_getend(fd_out, O_WROK, &out);
+    }
+
+  if (ret < 0)
+    {
+      goto errout;
+    }
+
+  /* Both ends must be pipes, but not the same pipe */
+
+  if (!in.ispipe || !out.ispipe || in.filep->f_inode == out.filep->f_inode)
+    {
+      ret = -EINVAL;
+      goto errout;
+    }
+
+  if (len == 0)
+    {
+      return 0;
+    }
+
+  ret = splice_pipespace(out.filep, len,
+                         nonblock || (out.filep->f_oflags & O_NONBLOCK) != 0);
+  if (ret > 0)
+    {
+      ret = pipe_spliceout(in.filep, &iob, ret, flags, true);
+      if (ret > 0)
+        {
+          ret = splice_topipe(out.filep, &iob, ret, flags);
+        }
+    }
+
+  if (iob != NULL)
+    {
+      iob_free_chain(iob);
+    }
+
+errout:
+  if (ret < 0)
+    {
+      set_errno(-ret);
+      return ERROR;
+    }
+
+  return ret;
+}
+
+#endif /* CONFIG_NFILE_DESCRIPTORS > 0 && CONFIG_DEV_PIPE_SPLICE */
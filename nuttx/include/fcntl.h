@@ -1,7 +1,7 @@
 /********************************************************************************
  * include/fcntl.h
  *
- *   Copyright (C) 2007-2009, 2012 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007-2009, 2012, 2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -135,6 +135,13 @@
 
 #define creat(path, mode) open(path, O_WRONLY|O_CREAT|O_TRUNC, mode)
 
+/* splice() and tee() flags (non-standard, Linux compatible) */
+
+#define SPLICE_F_MOVE     (1 << 0) /* Move pages instead of copying (hint) */
+#define SPLICE_F_NONBLOCK (1 << 1) /* Do not block on pipe I/O */
+#define SPLICE_F_MORE     (1 << 2) /* More data will be coming (hint) */
+#define SPLICE_F_GIFT     (1 << 3) /* Unused */
+
 /********************************************************************************
  * Public Type Definitions
  ********************************************************************************/
@@ -172,6 +179,14 @@ extern "C"
 int open(const char *path, int oflag, ...);
 int fcntl(int fd, int cmd, ...);
 
+/* Non-standard, Linux compatible interfaces */
+
+#ifdef CONFIG_DEV_PIPE_SPLICE
+ssize_t splice(int fd_in, FAR off_t *off_in, int fd_out, FAR off_t *off_out,
+               size_t len, unsigned int flags);
+ssize_t tee(int fd_in, int fd_out, size_t len, unsigned int flags);
+#endif
+
 #undef EXTERN
 #if defined(__cplusplus)
 }
@@ -1,7 +1,7 @@
 /****************************************************************************
  * include/netinet/tcp.h
  *
- *   Copyright (C) 2017 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2017-2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -51,6 +51,12 @@
  */
 
 #define TCP_NODELAY  __SO_PROTOCOL /* Avoid coalescing of small segments. */
+#define TCP_CORK     (__SO_PROTOCOL + 1) /* Only send full segments. */
+#define TCP_QUICKACK (__SO_PROTOCOL + 2) /* Do not delay ACKs. */
+#define TCP_KEEPIDLE (__SO_PROTOCOL + 3) /* Idle time (sec) before keep-alive probes. */
+#define TCP_KEEPINTVL (__SO_PROTOCOL + 4) /* Time (sec) between keep-alive probes. */
+#define TCP_KEEPCNT  (__SO_PROTOCOL + 5) /* Unanswered probes before dropping. */
+#define TCP_USER_TIMEOUT (__SO_PROTOCOL + 6) /* Max time (msec) data may go unACKed. */
 
 /* "The macro shall be defined in the header. The implementation need not
  *  allow the value of the option to be set via setsockopt() or retrieved via
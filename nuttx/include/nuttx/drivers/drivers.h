@@ -1,7 +1,8 @@
 /****************************************************************************
  * include/nuttx/fs/drivers.h
  *
- *   Copyright (C) 2007-2009, 2011-2013, 2015-2016 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007-2009, 2011-2013, 2015-2016, 2018 Gregory Nutt. All
+ *     rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -280,6 +281,69 @@ int pipe2(int fd[2], size_t bufsize);
 int mkfifo2(FAR const char *pathname, mode_t mode, size_t bufsize);
 #endif
 
+#if defined(CONFIG_PIPES) && defined(CONFIG_DEV_PIPE_SPLICE)
+struct file;   /* Forward reference */
+struct iob_s;  /* Forward reference */
+
+/****************************************************************************
+ * Name: pipe_isfile
+ *
+ * Description:
+ *   Return true if 'filep' refers to an open pipe or FIFO.
+ *
+ ****************************************************************************/
+
+bool pipe_isfile(FAR struct file *filep);
+
+/****************************************************************************
+ * Name: pipe_spliceout
+ *
+ * Description:
+ *   Remove up to 'len' bytes from a pipe and return them as an I/O buffer
+ *   chain.  This is the OS internal interface used by splice() and tee().
+ *
+ * Input Parameters:
+ *   filep - The open pipe
+ *   iob   - Location to return the I/O buffer chain.  The caller must free
+ *           it when done.
+ *   len   - The maximum number of bytes to remove
+ *   flags - SPLICE_F_* flags
+ *   peek  - Copy the data without removing it from the pipe
+ *
+ * Returned Value:
+ *   The number of bytes in the returned chain, zero at end-of-file, or a
+ *   negated errno value on failure.
+ *
+ ****************************************************************************/
+
+ssize_t pipe_spliceout(FAR struct file *filep, FAR struct iob_s **iob,
+                       size_t len, unsigned int flags, bool peek);
+
+/****************************************************************************
+ * Name: pipe_splicein
+ *
+ * Description:
+ *   Add up to 'len' bytes from the I/O buffer chain '*iob' to a pipe.  This
+ *   is the OS internal interface used by splice() and tee().
+ *
+ * Input Parameters:
+ *   filep - The open pipe
+ *   iob   - The I/O buffer chain.  On return, this holds the data that was
+ *           not added to the pipe (or NULL if all of the chain was
+ *           consumed).
+ *   len   - The number of bytes to add (no more than the chain length)
+ *   flags - SPLICE_F_* flags
+ *
+ * Returned Value:
+ *   The number of bytes added to the pipe or a negated errno value on
+ *   failure.
+ *
+ ****************************************************************************/
+
+ssize_t pipe_splicein(FAR struct file *filep, FAR struct iob_s **iob,
+                      size_t len, unsigned int flags);
+#endif
+
 #undef EXTERN
 #if defined(__cplusplus)
 }
@@ -196,6 +196,7 @@
 struct file;   /* Forward reference */
 struct pollfd; /* Forward reference */
 struct inode;  /* Forward reference */
+struct iovec;  /* Forward reference */
 
 struct file_operations
 {
@@ -222,6 +223,17 @@ struct file_operations
 #ifndef CONFIG_DISABLE_PSEUDOFS_OPERATIONS
   int     (*unlink)(FAR struct inode *inode);
 #endif
+
+  /* Optional scatter/gather methods.  These allow a driver to handle all of
+   * the buffers of a readv() or writev() as a single transfer.  If they are
+   * not provided, the read() and write() methods are called once for each
+   * buffer.
+   */
+
+  ssize_t (*readv)(FAR struct file *filep, FAR const struct iovec *iov,
+                   int iovcnt);
+  ssize_t (*writev)(FAR struct file *filep, FAR const struct iovec *iov,
+                    int iovcnt);
 };
 
 /* This structure provides information about the state of a block driver */
@@ -716,6 +728,29 @@ int fs_dupfd2(int fd1, int fd2);
 int file_detach(int fd, FAR struct file *filep);
 #endif
 
+/****************************************************************************
+ * Name: file_attach
+ *
+ * Description:
+ *   This is the inverse of file_detach():  The detached file structure is
+ *   installed in the calling task's list of open files.  Ownership of the
+ *   open file passes to the new file descriptor.
+ *
+ * Input Parameters:
+ *   filep - A pointer to the detached file structure.  It is reset on
+ *           success and may not be used again.
+ *   minfd - The lowest file descriptor number that may be used.
+ *
+ * Returned Value:
+ *   The new file descriptor is returned on success; A negated errno value
+ *   is returned on any failure.
+ *
+ ****************************************************************************/
+
+#if CONFIG_NFILE_DESCRIPTORS > 0
+int file_attach(FAR struct file *filep, int minfd);
+#endif
+
 /****************************************************************************
  * Name: file_close_detached
  *
@@ -968,6 +1003,51 @@ ssize_t file_write(FAR struct file *filep, FAR const void *buf, size_t nbytes);
 
 ssize_t nx_write(int fd, FAR const void *buf, size_t nbytes);
 
+/****************************************************************************
+ * Name: file_readv and file_writev
+ *
+ * Description:
+ *   Equivalent to the standard readv() and writev() functions except that
+ *   they accept a struct file instance instead of a file descriptor, they
+ *   are not cancellation points, and they do not modify the errno
+ *   variable.
+ *
+ *   The driver's readv() or writev() method is used if it provides one;
+ *   otherwise the buffers are transferred one at a time with the read() or
+ *   write() method.
+ *
+ * Input Parameters:
+ *   filep  - File structure instance
+ *   iov    - Array of buffer descriptors
+ *   iovcnt - Number of elements in iov[]
+ *
+ * Returned Value:
+ *   The number of bytes transferred on success; a negated errno value on
+ *   failure.
+ *
+ ****************************************************************************/
+
+#if CONFIG_NFILE_DESCRIPTORS > 0
+ssize_t file_readv(FAR struct file *filep, FAR const struct iovec *iov,
+                   int iovcnt);
+ssize_t file_writev(FAR struct file *filep, FAR const struct iovec *iov,
+                    int iovcnt);
+#endif
+
+/****************************************************************************
+ * Name: nx_readv and nx_writev
+ *
+ * Description:
+ *   Internal OS versions of readv() and writev().  They are functionally
+ *   equivalent to readv() and writev() except that they are not
+ *   cancellation points and do not modify the errno variable.  Socket
+ *   descriptors are handled with psock_recvmsg() and psock_sendmsg().
+ *
+ ****************************************************************************/
+
+ssize_t nx_readv(int fd, FAR const struct iovec *iov, int iovcnt);
+ssize_t nx_writev(int fd, FAR const struct iovec *iov, int iovcnt);
+
 /****************************************************************************
  * Name: file_pread
  *
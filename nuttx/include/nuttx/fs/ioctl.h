@@ -362,6 +362,22 @@
                                              *       (default)
                                              *     1=fre when empty
                                              * OUT: None */
+#define PIPEIOC_RDWATERMARK _PIPEIOC(0x0002) /* Set read watermark
+                                             * IN: unsigned long integer
+                                             *     Number of bytes in the
+                                             *     pipe before blocked
+                                             *     readers are woken up
+                                             *     and POLLIN is reported
+                                             *     (default 1).  A read of
+                                             *     fewer bytes only waits
+                                             *     for that many.
+                                             * OUT: None */
+#define PIPEIOC_WRWATERMARK _PIPEIOC(0x0003) /* Set write watermark
+                                             * IN: unsigned long integer
+                                             *     Free space in the pipe
+                                             *     before blocked writers
+                                             *     are woken up (default 1)
+                                             * OUT: None */
 
 /* RTC driver ioctl definitions *********************************************/
 /* (see nuttx/include/rtc.h */
@@ -1,7 +1,7 @@
 /****************************************************************************
  * include/nuttx/mm/iob.h
  *
- *   Copyright (C) 2014 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2014, 2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -80,10 +80,41 @@
 #  error CONFIG_IOB_NBUFFERS <= CONFIG_IOB_THROTTLE
 #endif
 
+/* The pool may grow from the heap up to this number of I/O buffers */
+
+#ifdef CONFIG_IOB_ELASTIC
+#  if !defined(CONFIG_IOB_MAXBUFFERS)
+#    error CONFIG_IOB_MAXBUFFERS not defined
+#  elif CONFIG_IOB_MAXBUFFERS <= CONFIG_IOB_NBUFFERS
+#    error CONFIG_IOB_MAXBUFFERS <= CONFIG_IOB_NBUFFERS
+#  endif
+#endif
+
+/* Large I/O buffers are a second, separate pool of bigger buffers */
+
+#ifdef CONFIG_IOB_LARGE
+#  if !defined(CONFIG_IOB_LARGE_NBUFFERS) || CONFIG_IOB_LARGE_NBUFFERS < 1
+#    error CONFIG_IOB_LARGE_NBUFFERS is zero
+#  endif
+#  if !defined(CONFIG_IOB_LARGE_BUFSIZE) || \
+      CONFIG_IOB_LARGE_BUFSIZE <= CONFIG_IOB_BUFSIZE
+#    error CONFIG_IOB_LARGE_BUFSIZE <= CONFIG_IOB_BUFSIZE
+#  endif
+#  if CONFIG_IOB_LARGE_BUFSIZE > UINT16_MAX
+#    error CONFIG_IOB_LARGE_BUFSIZE is too large
+#  endif
+#endif
+
 /* IOB helpers */
 
+#ifdef CONFIG_IOB_LARGE
+#  define IOB_BUFSIZE(p) ((p)->io_bufsize)
+#else
+#  define IOB_BUFSIZE(p) CONFIG_IOB_BUFSIZE
+#endif
+
 #define IOB_DATA(p)      (&(p)->io_data[(p)->io_offset])
-#define IOB_FREESPACE(p) (CONFIG_IOB_BUFSIZE - (p)->io_len - (p)->io_offset)
+#define IOB_FREESPACE(p) (IOB_BUFSIZE(p) - (p)->io_len - (p)->io_offset)
 
 #if CONFIG_IOB_NCHAINS > 0
 /* Queue helpers */
@@ -109,7 +140,7 @@ struct iob_s
 
   /* Payload */
 
-#if CONFIG_IOB_BUFSIZE < 256
+#if CONFIG_IOB_BUFSIZE < 256 && !defined(CONFIG_IOB_LARGE)
   uint8_t  io_len;      /* Length of the data in the entry */
   uint8_t  io_offset;   /* Data begins at this offset */
 #else
@@ -118,7 +149,16 @@ struct iob_s
 #endif
   uint16_t io_pktlen;   /* Total length of the packet */
 
+#ifdef CONFIG_IOB_LARGE
+  /* The data lives outside of the structure so that buffers of different
+   * sizes can share the same chain.
+   */
+
+  uint16_t io_bufsize;  /* Size of the data buffer */
+  FAR uint8_t *io_data; /* The data buffer */
+#else
   uint8_t  io_data[CONFIG_IOB_BUFSIZE];
+#endif
 };
 
 #if CONFIG_IOB_NCHAINS > 0
@@ -148,6 +188,26 @@ struct iob_queue_s
 };
 #endif /* CONFIG_IOB_NCHAINS > 0 */
 
+/* I/O buffer usage statistics, as returned by iob_getstats() */
+
+struct iob_stats_s
+{
+  uint16_t ntotal;      /* Number of I/O buffers, pre-allocated and heap */
+  uint16_t nfree;       /* Number of free I/O buffers */
+  uint16_t nheap;       /* Number of I/O buffers allocated from the heap */
+  uint16_t maxused;     /* Most I/O buffers ever in use at the same time */
+  uint16_t nwaiting;    /* Number of threads waiting for an I/O buffer */
+  uint32_t nfailed;     /* Number of allocations that found no I/O buffer */
+#if CONFIG_IOB_NCHAINS > 0
+  uint16_t nqtotal;     /* Number of I/O buffer queue containers */
+  uint16_t nqfree;      /* Number of free I/O buffer queue containers */
+#endif
+#ifdef CONFIG_IOB_LARGE
+  uint16_t nlarge;      /* Number of large I/O buffers */
+  uint16_t nlargefree;  /* Number of free large I/O buffers */
+#endif
+};
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
@@ -183,6 +243,41 @@ FAR struct iob_s *iob_alloc(bool throttled);
 
 FAR struct iob_s *iob_tryalloc(bool throttled);
 
+/****************************************************************************
+ * Name: iob_alloc_size
+ *
+ * Description:
+ *   Allocate an I/O buffer for 'size' bytes of data.  A large I/O buffer is
+ *   used if 'size' does not fit in one normal I/O buffer and a large I/O
+ *   buffer is free.  Otherwise, this is the same as iob_alloc() and the
+ *   caller must be prepared to chain more I/O buffers for the rest of the
+ *   data.  There is never any wait for a large I/O buffer.
+ *
+ ****************************************************************************/
+
+FAR struct iob_s *iob_alloc_size(unsigned int size, bool throttled);
+
+/****************************************************************************
+ * Name: iob_tryalloc_size
+ *
+ * Description:
+ *   Like iob_alloc_size() but without waiting for a buffer to become free.
+ *
+ ****************************************************************************/
+
+FAR struct iob_s *iob_tryalloc_size(unsigned int size, bool throttled);
+
+/****************************************************************************
+ * Name: iob_navail
+ *
+ * Description:
+ *   Return the number of available IOBs.  If 'throttled' is true, the
+ *   number of IOBs reserved for the unthrottled allocator is not counted.
+ *
+ ****************************************************************************/
+
+int iob_navail(bool throttled);
+
 /****************************************************************************
  * Name: iob_free
  *
@@ -277,6 +372,29 @@ FAR struct iob_s *iob_peek_queue(FAR struct iob_queue_s *iobq);
 void iob_free_queue(FAR struct iob_queue_s *qhead);
 #endif /* CONFIG_IOB_NCHAINS > 0 */
 
+/****************************************************************************
+ * Name: iob_get_queue_size
+ *
+ * Description:
+ *   Return the total number of bytes of data in a queue of I/O buffer
+ *   chains.
+ *
+ ****************************************************************************/
+
+#if CONFIG_IOB_NCHAINS > 0
+unsigned int iob_get_queue_size(FAR struct iob_queue_s *queue);
+#endif /* CONFIG_IOB_NCHAINS > 0 */
+
+/****************************************************************************
+ * Name: iob_getstats
+ *
+ * Description:
+ *   Return a snapshot of the I/O buffer usage statistics.
+ *
+ ****************************************************************************/
+
+void iob_getstats(FAR struct iob_stats_s *stats);
+
 /****************************************************************************
  * Name: iob_copyin
  *
@@ -1,7 +1,7 @@
 /****************************************************************************
  * include/nuttx/net/net.h
  *
- *   Copyright (C) 2007, 2009-2014, 2016-2017 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007, 2009-2014, 2016-2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -143,6 +143,7 @@ typedef uint8_t sockcaps_t;
 
 struct socket;  /* Forward reference */
 struct pollfd;  /* Forward reference */
+struct file;    /* Forward reference */
 
 struct sock_intf_s
 {
@@ -175,6 +176,23 @@ struct sock_intf_s
   CODE ssize_t    (*si_recvfrom)(FAR struct socket *psock, FAR void *buf,
                     size_t len, int flags, FAR struct sockaddr *from,
                     FAR socklen_t *fromlen);
+  CODE ssize_t    (*si_sendmsg)(FAR struct socket *psock,
+                    FAR const struct msghdr *msg, int flags);
+  CODE ssize_t    (*si_recvmsg)(FAR struct socket *psock,
+                    FAR struct msghdr *msg, int flags);
+
+  /* Optional batch operations used by sendmmsg() and recvmmsg().
+   * si_sendmmsg() queues as many of the messages as it can and returns the
+   * number queued.  si_recvmmsg() returns the number of messages that were
+   * already queued for the socket; it never waits.
+   */
+
+  CODE int        (*si_sendmmsg)(FAR struct socket *psock,
+                    FAR struct mmsghdr *msgvec, unsigned int vlen,
+                    int flags);
+  CODE int        (*si_recvmmsg)(FAR struct socket *psock,
+                    FAR struct mmsghdr *msgvec, unsigned int vlen,
+                    int flags);
   CODE int        (*si_close)(FAR struct socket *psock);
 };
 
@@ -932,6 +950,186 @@ ssize_t nx_recvfrom(int sockfd, FAR void *buf, size_t len, int flags,
 
 #define nx_recv(psock,buf,len,flags) nx_recvfrom(psock,buf,len,flags,NULL,0)
 
+/****************************************************************************
+ * Name: psock_sendmsg
+ *
+ * Description:
+ *   psock_sendmsg() sends a message gathered from the buffers described by
+ *   msg->msg_iov, optionally to the address msg->msg_name and with the
+ *   ancillary data in msg->msg_control.  This is an internal OS interface.
+ *   It is functionally equivalent to sendmsg() except that:
+ *
+ *   - It is not a cancellation point,
+ *   - It does not modify the errno variable, and
+ *   - I accepts the internal socket structure as an input rather than an
+ *     task-specific socket descriptor.
+ *
+ *   The address family's si_sendmsg() method is used if it has one.
+ *   Otherwise, the buffers are gathered and sent with a single sendto().
+ *
+ * Input Parameters:
+ *   psock - A pointer to a NuttX-specific, internal socket structure
+ *   msg   - The message to send
+ *   flags - Send flags
+ *
+ * Returned Value:
+ *   On success, returns the number of characters sent.  On any failure, a
+ *   negated errno value is returned (See comments with send() for a list
+ *   of the appropriate errno value).
+ *
+ ****************************************************************************/
+
+ssize_t psock_sendmsg(FAR struct socket *psock, FAR const struct msghdr *msg,
+                      int flags);
+
+/****************************************************************************
+ * Name: nx_sendmsg
+ *
+ * Description:
+ *   Internal OS version of sendmsg() that accepts a socket descriptor.  It
+ *   is not a cancellation point and does not modify the errno variable.
+ *
+ ****************************************************************************/
+
+ssize_t nx_sendmsg(int sockfd, FAR const struct msghdr *msg, int flags);
+
+/****************************************************************************
+ * Name: psock_recvmsg
+ *
+ * Description:
+ *   psock_recvmsg() receives a message into the buffers described by
+ *   msg->msg_iov.  The source address and any ancillary data are returned
+ *   in msg->msg_name and msg->msg_control.  This is an internal OS
+ *   interface.  It is functionally equivalent to recvmsg() except that:
+ *
+ *   - It is not a cancellation point,
+ *   - It does not modify the errno variable, and
+ *   - I accepts the internal socket structure as an input rather than an
+ *     task-specific socket descriptor.
+ *
+ *   The address family's si_recvmsg() method is used if it has one.
+ *   Otherwise, the message is received with a single recvfrom() and
+ *   scattered into the buffers.
+ *
+ * Input Parameters:
+ *   psock - A pointer to a NuttX-specific, internal socket structure
+ *   msg   - Describes the buffers and returns the message attributes
+ *   flags - Receive flags
+ *
+ * Returned Value:
+ *   On success, returns the number of characters received.  If no data is
+ *   available to be received and the peer has performed an orderly
+ *   shutdown, zero is returned.  Otherwise, on any failure, a negated errno
+ *   value is returned.
+ *
+ ****************************************************************************/
+
+ssize_t psock_recvmsg(FAR struct socket *psock, FAR struct msghdr *msg,
+                      int flags);
+
+/****************************************************************************
+ * Name: nx_recvmsg
+ *
+ * Description:
+ *   Internal OS version of recvmsg() that accepts a socket descriptor.  It
+ *   is not a cancellation point and does not modify the errno variable.
+ *
+ ****************************************************************************/
+
+ssize_t nx_recvmsg(int sockfd, FAR struct msghdr *msg, int flags);
+
+/****************************************************************************
+ * Name: psock_sendmmsg
+ *
+ * Description:
+ *   psock_sendmmsg() sends up to 'vlen' messages.  The number of bytes sent
+ *   for each message is returned in its msg_len field.  This is an internal
+ *   OS interface.  It is functionally equivalent to sendmmsg() except that:
+ *
+ *   - It is not a cancellation point,
+ *   - It does not modify the errno variable, and
+ *   - I accepts the internal socket structure as an input rather than an
+ *     task-specific socket descriptor.
+ *
+ *   The address family's si_sendmmsg() method is used if it has one.
+ *   Otherwise, each message is sent with psock_sendmsg().
+ *
+ * Input Parameters:
+ *   psock  - A pointer to a NuttX-specific, internal socket structure
+ *   msgvec - The messages to send
+ *   vlen   - The number of messages in 'msgvec'
+ *   flags  - Send flags
+ *
+ * Returned Value:
+ *   The number of messages sent.  If an error occurs before the first
+ *   message is sent, a negated errno value is returned.
+ *
+ ****************************************************************************/
+
+int psock_sendmmsg(FAR struct socket *psock, FAR struct mmsghdr *msgvec,
+                   unsigned int vlen, int flags);
+
+/****************************************************************************
+ * Name: nx_sendmmsg
+ *
+ * Description:
+ *   Internal OS version of sendmmsg() that accepts a socket descriptor.  It
+ *   is not a cancellation point and does not modify the errno variable.
+ *
+ ****************************************************************************/
+
+int nx_sendmmsg(int sockfd, FAR struct mmsghdr *msgvec, unsigned int vlen,
+                int flags);
+
+/****************************************************************************
+ * Name: psock_recvmmsg
+ *
+ * Description:
+ *   psock_recvmmsg() receives up to 'vlen' messages.  The number of bytes
+ *   received for each message is returned in its msg_len field.  This is
+ *   an internal OS interface.  It is functionally equivalent to recvmmsg()
+ *   except that:
+ *
+ *   - It is not a cancellation point,
+ *   - It does not modify the errno variable, and
+ *   - I accepts the internal socket structure as an input rather than an
+ *     task-specific socket descriptor.
+ *
+ *   Messages already queued for the socket are taken in one batch with the
+ *   address family's si_recvmmsg() method, if it has one.  Otherwise, each
+ *   message is received with psock_recvmsg().
+ *
+ * Input Parameters:
+ *   psock   - A pointer to a NuttX-specific, internal socket structure
+ *   msgvec  - Describes the buffers for each message
+ *   vlen    - The number of messages in 'msgvec'
+ *   flags   - Receive flags.  MSG_WAITFORONE:  Do not wait once one message
+ *             has been received.
+ *   timeout - The time limit of the operation (may be NULL).  As with
+ *             Linux, this is only checked after each message is received.
+ *
+ * Returned Value:
+ *   The number of messages received.  If an error occurs before the first
+ *   message is received, a negated errno value is returned.
+ *
+ ****************************************************************************/
+
+int psock_recvmmsg(FAR struct socket *psock, FAR struct mmsghdr *msgvec,
+                   unsigned int vlen, int flags,
+                   FAR struct timespec *timeout);
+
+/****************************************************************************
+ * Name: nx_recvmmsg
+ *
+ * Description:
+ *   Internal OS version of recvmmsg() that accepts a socket descriptor.  It
+ *   is not a cancellation point and does not modify the errno variable.
+ *
+ ****************************************************************************/
+
+int nx_recvmmsg(int sockfd, FAR struct mmsghdr *msgvec, unsigned int vlen,
+                int flags, FAR struct timespec *timeout);
+
 /****************************************************************************
  * Name: psock_getsockopt
  *
@@ -1186,17 +1384,16 @@ int net_clone(FAR struct socket *psock1, FAR struct socket *psock2);
  * Name: net_sendfile
  *
  * Description:
- *   The send() call may be used only when the socket is in a connected state
- *   (so that the intended recipient is known). The only difference between
- *   send() and write() is the presence of flags. With zero flags parameter,
- *   send() is equivalent to write(). Also, send(sockfd,buf,len,flags) is
- *   equivalent to sendto(sockfd,buf,len,flags,NULL,0).
+ *   Send data from a file to a socket.  This is the socket side of
+ *   sendfile():  If the socket address family provides an optimized
+ *   si_sendfile() method, the file data is transferred without copying
+ *   through a user buffer.  Otherwise, the generic lib_sendfile() is used.
  *
  * Parameters:
- *   psock    An instance of the internal socket structure.
- *   buf      Data to send
- *   len      Length of data to send
- *   flags    Send flags
+ *   outfd    The socket descriptor
+ *   infile   The file structure of the input file
+ *   offset   Offset into the input file (or NULL to use the file position)
+ *   count    The number of bytes to send
  *
  * Returned Value:
  *   On success, returns the number of characters sent.  On  error,
@@ -1245,8 +1442,8 @@ int net_clone(FAR struct socket *psock1, FAR struct socket *psock2);
  ****************************************************************************/
 
 #ifdef CONFIG_NET_SENDFILE
-struct file;
-ssize_t net_sendfile(int outfd, struct file *infile, off_t *offset, size_t count);
+ssize_t net_sendfile(int outfd, FAR struct file *infile, FAR off_t *offset,
+                     size_t count);
 #endif
 
 /****************************************************************************
@@ -77,6 +77,34 @@
  * Public Type Definitions
  ****************************************************************************/
 
+/* Link layer address resolution statistics.  A hit or a miss is counted
+ * for each outgoing packet whose destination is (or is not) found in the
+ * ARP or Neighbor table.  The remaining counts are for packets held until
+ * their destination is resolved.
+ */
+
+#ifdef CONFIG_NET_ARP
+struct arp_stats_s
+{
+  net_stats_t hit;        /* Destinations found in the ARP table */
+  net_stats_t miss;       /* Destinations not found in the ARP table */
+  net_stats_t queued;     /* Packets held awaiting an ARP reply */
+  net_stats_t sent;       /* Held packets sent after the reply */
+  net_stats_t drop;       /* Packets that could not be held or timed out */
+};
+#endif
+
+#ifdef CONFIG_NET_IPv6
+struct neighbor_stats_s
+{
+  net_stats_t hit;        /* Destinations found in the Neighbor table */
+  net_stats_t miss;       /* Destinations not found in the Neighbor table */
+  net_stats_t queued;     /* Packets held awaiting a Neighbor Advertisement */
+  net_stats_t sent;       /* Held packets sent after the advertisement */
+  net_stats_t drop;       /* Packets that could not be held or timed out */
+};
+#endif
+
 /* The structure holding the networking statistics that are gathered if
  * CONFIG_NET_STATISTICS is defined.
  */
@@ -91,6 +119,14 @@ struct net_stats_s
   struct ipv6_stats_s ipv6;     /* IPv6 statistics */
 #endif
 
+#ifdef CONFIG_NET_ARP
+  struct arp_stats_s  arp;      /* ARP table statistics */
+#endif
+
+#ifdef CONFIG_NET_IPv6
+  struct neighbor_stats_s neighbor; /* Neighbor table statistics */
+#endif
+
 #ifdef CONFIG_NET_ICMP
   struct icmp_stats_s icmp;     /* ICMP statistics */
 #endif
@@ -6,8 +6,8 @@
  * macros that are used by internal network structures, TCP/IP header
  * structures and function declarations.
  *
- *   Copyright (C) 2007, 2009-2010, 2012-2014 Gregory Nutt. All rights
- *      reserved.
+ *   Copyright (C) 2007, 2009-2010, 2012-2014, 2018 Gregory Nutt. All
+ *     rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * This logic was leveraged from uIP which also has a BSD-style license:
@@ -76,8 +76,16 @@
 #define TCP_OPT_END       0   /* End of TCP options list */
 #define TCP_OPT_NOOP      1   /* "No-operation" TCP option */
 #define TCP_OPT_MSS       2   /* Maximum segment size TCP option */
+#define TCP_OPT_WS        3   /* Window scale TCP option */
+#define TCP_OPT_SACK_PERM 4   /* SACK permitted TCP option */
+#define TCP_OPT_SACK      5   /* SACK TCP option */
+#define TCP_OPT_TS        8   /* Timestamps TCP option */
 
 #define TCP_OPT_MSS_LEN   4   /* Length of TCP MSS option. */
+#define TCP_OPT_WS_LEN    3   /* Length of TCP window scale option */
+#define TCP_OPT_SACK_PERM_LEN 2 /* Length of TCP SACK permitted option */
+#define TCP_OPT_TS_LEN    10  /* Length of TCP timestamps option */
+#define TCP_OPT_SACK_LEN(n) (2 + ((n) << 3)) /* Length of SACK with n blocks */
 
 /* The TCP states used in the struct tcp_conn_s tcpstateflags field */
 
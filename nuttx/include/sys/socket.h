@@ -1,7 +1,7 @@
 /****************************************************************************
  * include/sys/socket.h
  *
- *   Copyright (C) 2007, 2009, 2011, 2015-2016 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007, 2009, 2011, 2015-2016, 2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -41,6 +41,7 @@
  ****************************************************************************/
 
 #include <sys/types.h>
+#include <sys/uio.h>
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -109,6 +110,7 @@
 #define MSG_ERRQUEUE   0x2000 /* Fetch message from error queue.  */
 #define MSG_NOSIGNAL   0x4000 /* Do not generate SIGPIPE.  */
 #define MSG_MORE       0x8000 /* Sender will send more.  */
+#define MSG_WAITFORONE 0x10000 /* recvmmsg(): Wait for one message only. */
 
 /* Protocol levels supported by get/setsockopt(): */
 
@@ -159,6 +161,33 @@
 #define SHUT_WR        2  /* Bit 1: Disables further send operations */
 #define SHUT_RDWR      3  /* Bits 0+1: Disables further send and receive operations */
 
+/* Socket-level control message types (cmsg_type with cmsg_level ==
+ * SOL_SOCKET).
+ */
+
+#define SCM_RIGHTS     1  /* Pass an array of open file descriptors (int) */
+
+/* Control message access macros */
+
+#define CMSG_ALIGN(len) \
+  (((len) + sizeof(size_t) - 1) & ~(sizeof(size_t) - 1))
+#define CMSG_SPACE(len) \
+  (CMSG_ALIGN(sizeof(struct cmsghdr)) + CMSG_ALIGN(len))
+#define CMSG_LEN(len) \
+  (CMSG_ALIGN(sizeof(struct cmsghdr)) + (len))
+#define CMSG_DATA(cmsg) \
+  ((FAR unsigned char *)(cmsg) + CMSG_ALIGN(sizeof(struct cmsghdr)))
+#define CMSG_FIRSTHDR(msg) \
+  ((msg)->msg_controllen >= sizeof(struct cmsghdr) ? \
+   (FAR struct cmsghdr *)(msg)->msg_control : (FAR struct cmsghdr *)NULL)
+#define CMSG_NXTHDR(msg, cmsg) \
+  (((FAR unsigned char *)(cmsg) + CMSG_ALIGN((cmsg)->cmsg_len) + \
+    sizeof(struct cmsghdr) > \
+    (FAR unsigned char *)(msg)->msg_control + (msg)->msg_controllen) ? \
+   (FAR struct cmsghdr *)NULL : \
+   (FAR struct cmsghdr *)((FAR unsigned char *)(cmsg) + \
+                          CMSG_ALIGN((cmsg)->cmsg_len)))
+
 /****************************************************************************
  * Type Definitions
  ****************************************************************************/
@@ -195,6 +224,36 @@ struct sockaddr
   char        sa_data[14];     /* 14-bytes of address data */
 };
 
+/* Used with sendmsg() and recvmsg() */
+
+struct msghdr
+{
+  FAR void *msg_name;          /* Optional address */
+  socklen_t msg_namelen;       /* Size of address */
+  FAR struct iovec *msg_iov;   /* Scatter/gather array */
+  int msg_iovlen;              /* Number of elements in msg_iov */
+  FAR void *msg_control;       /* Ancillary data (see CMSG_* macros) */
+  socklen_t msg_controllen;    /* Ancillary data buffer length */
+  int msg_flags;               /* Flags on received message */
+};
+
+/* The header of each ancillary data object in msg_control */
+
+struct cmsghdr
+{
+  socklen_t cmsg_len;          /* Data byte count, including the header */
+  int cmsg_level;              /* Originating protocol */
+  int cmsg_type;               /* Protocol-specific type */
+};
+
+/* Used with sendmmsg() and recvmmsg() */
+
+struct mmsghdr
+{
+  struct msghdr msg_hdr;       /* The message */
+  unsigned int msg_len;        /* Number of bytes sent or received */
+};
+
 /* Used with the SO_LINGER socket option */
 
 struct linger
@@ -203,6 +262,8 @@ struct linger
   int  l_linger;  /* Linger time, in seconds. */
 };
 
+struct timespec; /* Forward reference (see time.h) */
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
@@ -231,6 +292,13 @@ ssize_t recv(int sockfd, FAR void *buf, size_t len, int flags);
 ssize_t recvfrom(int sockfd, FAR void *buf, size_t len, int flags,
                  FAR struct sockaddr *from, FAR socklen_t *fromlen);
 
+ssize_t sendmsg(int sockfd, FAR const struct msghdr *msg, int flags);
+ssize_t recvmsg(int sockfd, FAR struct msghdr *msg, int flags);
+int sendmmsg(int sockfd, FAR struct mmsghdr *msgvec, unsigned int vlen,
+             int flags);
+int recvmmsg(int sockfd, FAR struct mmsghdr *msgvec, unsigned int vlen,
+             int flags, FAR struct timespec *timeout);
+
 int shutdown(int sockfd, int how);
 
 int setsockopt(int sockfd, int level, int option,
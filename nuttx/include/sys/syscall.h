@@ -286,14 +286,16 @@
 #  define SYS_write                    (__SYS_descriptors+3)
 #  define SYS_pread                    (__SYS_descriptors+4)
 #  define SYS_pwrite                   (__SYS_descriptors+5)
+#  define SYS_readv                    (__SYS_descriptors+6)
+#  define SYS_writev                   (__SYS_descriptors+7)
 #  ifdef CONFIG_FS_AIO
-#    define SYS_aio_read               (__SYS_descriptors+6)
-#    define SYS_aio_write              (__SYS_descriptors+7)
-#    define SYS_aio_fsync              (__SYS_descriptors+8)
-#    define SYS_aio_cancel             (__SYS_descriptors+9)
-#    define __SYS_poll                 (__SYS_descriptors+10)
+#    define SYS_aio_read               (__SYS_descriptors+8)
+#    define SYS_aio_write              (__SYS_descriptors+9)
+#    define SYS_aio_fsync              (__SYS_descriptors+10)
+#    define SYS_aio_cancel             (__SYS_descriptors+11)
+#    define __SYS_poll                 (__SYS_descriptors+12)
 #  else
-#    define __SYS_poll                 (__SYS_descriptors+6)
+#    define __SYS_poll                 (__SYS_descriptors+8)
 #  endif
 #  ifndef CONFIG_DISABLE_POLL
 #    define SYS_poll                   __SYS_poll
@@ -373,9 +375,17 @@
 
 #  if defined(CONFIG_NET_SENDFILE)
 #    define SYS_sendfile,              __SYS_sendfile
-#    define __SYS_mountpoint           (__SYS_sendfile+1)
+#    define __SYS_splice               (__SYS_sendfile+1)
 #  else
-#    define __SYS_mountpoint           __SYS_sendfile
+#    define __SYS_splice               __SYS_sendfile
+#  endif
+
+#  if defined(CONFIG_PIPES) && defined(CONFIG_DEV_PIPE_SPLICE)
+#    define SYS_splice                 (__SYS_splice+0)
+#    define SYS_tee                    (__SYS_splice+1)
+#    define __SYS_mountpoint           (__SYS_splice+2)
+#  else
+#    define __SYS_mountpoint           __SYS_splice
 #  endif
 
 #  if !defined(CONFIG_DISABLE_MOUNTPOINT)
@@ -526,7 +536,11 @@
 #  define SYS_sendto                   (__SYS_network+8)
 #  define SYS_setsockopt               (__SYS_network+9)
 #  define SYS_socket                   (__SYS_network+10)
-#  define SYS_nnetsocket               (__SYS_network+11)
+#  define SYS_recvmsg                  (__SYS_network+11)
+#  define SYS_sendmsg                  (__SYS_network+12)
+#  define SYS_recvmmsg                 (__SYS_network+13)
+#  define SYS_sendmmsg                 (__SYS_network+14)
+#  define SYS_nnetsocket               (__SYS_network+15)
 #else
 #  define SYS_nnetsocket               __SYS_network
 #endif
@@ -1,7 +1,7 @@
 /****************************************************************************
  * include/sys/uio.h
  *
- *   Copyright (C) 2017 Grefory Nutt. All rights reserved.
+ *   Copyright (C) 2017-2018 Grefory Nutt. All rights reserved.
  *   Copyright (C) 2015 Stavros Polymenis. All rights reserved.
  *   Author: Stavros Polymenis <sp@orbitalfox.com>
  *           Gregory Nutt <gnutt@nuttx.org>
@@ -38,6 +38,12 @@
 #ifndef __INCLUDE_SYS_UIO_H
 #define __INCLUDE_SYS_UIO_H
 
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <sys/types.h>
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
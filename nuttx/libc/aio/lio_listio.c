@@ -42,6 +42,7 @@
 #include <unistd.h>
 #include <signal.h>
 #include <aio.h>
+#include <string.h>
 #include <assert.h>
 #include <errno.h>
 
@@ -59,7 +60,7 @@
 struct lio_sighand_s
 {
   FAR struct aiocb * const *list;  /* List of I/O operations */
-  FAR struct sigevent *sig;        /* Describes how to signal the caller */
+  struct sigevent sig;             /* Describes how to signal the caller */
   int nent;                        /* Number or elements in list[] */
   pid_t pid;                       /* ID of client */
   sigset_t oprocmask;              /* sigprocmask to restore */
@@ -136,6 +137,53 @@ static int lio_checkio(FAR struct aiocb * const *list, int nent)
   return ret;
 }
 
+/****************************************************************************
+ * Name: lio_notify
+ *
+ * Description:
+ *   Notify the client that all of the I/O in the list has completed.
+ *
+ * Input Parameters:
+ *   pid - The ID of the client task
+ *   sig - Describes how to notify the client
+ *
+ * Returned Value:
+ *  Zero (OK) is returned on success; a negated errno value is returned on
+ *  any failure.
+ *
+ ****************************************************************************/
+
+static int lio_notify(pid_t pid, FAR struct sigevent *sig)
+{
+  int ret = OK;
+
+  DEBUGASSERT(sig != NULL);
+
+  if (sig->sigev_notify == SIGEV_SIGNAL)
+    {
+#ifdef CONFIG_CAN_PASS_STRUCTS
+      ret = sigqueue(pid, sig->sigev_signo, sig->sigev_value);
+#else
+      ret = sigqueue(pid, sig->sigev_signo, sig->sigev_value.sival_ptr);
+#endif
+      if (ret < 0)
+        {
+          ret = -get_errno();
+        }
+    }
+
+#ifdef CONFIG_SIG_EVTHREAD
+  /* Notify the client via a function call */
+
+  else if (sig->sigev_notify == SIGEV_THREAD)
+    {
+      ret = nxsig_notification(pid, sig);
+    }
+#endif
+
+  return ret;
+}
+
 /****************************************************************************
  * Name: lio_sighandler
  *
@@ -191,25 +239,7 @@ static void lio_sighandler(int signo, siginfo_t *info, void *ucontext)
 
       /* Signal the client */
 
-      if (sighand->sig->sigev_notify == SIGEV_SIGNAL)
-        {
-#ifdef CONFIG_CAN_PASS_STRUCTS
-          DEBUGASSERT(sigqueue(sighand->pid, sighand->sig->sigev_signo,
-                               sighand->sig->sigev_value));
-#else
-          DEBUGASSERT(sigqueue(sighand->pid, sighand->sig->sigev_signo,
-                               sighand->sig->sigev_value.sival_ptr));
-#endif
-        }
-
-#ifdef CONFIG_SIG_EVTHREAD
-      /* Notify the client via a function call */
-
-      else if (ighand->sig->sigev_notify == SIGEV_THREAD)
-        {
-          DEBUGASSERT(nxsig_notification(sighand->pid, &sighand->sig));
-        }
-#endif
+      (void)lio_notify(sighand->pid, &sighand->sig);
 
       /* And free the container */
 
@@ -262,10 +292,15 @@ static int lio_sigsetup(FAR struct aiocb * const *list, int nent,
   /* Initialize the allocated structure */
 
   sighand->list = list;
-  sighand->sig  = sig;
   sighand->nent = nent;
   sighand->pid  = getpid();
 
+  /* Keep a copy of the notification.  The caller's instance of struct
+   * sigevent need not persist after lio_listio() returns.
+   */
+
+  memcpy(&sighand->sig, sig, sizeof(struct sigevent));
+
   /* Save this structure as the private data attached to each aiocb */
 
   for (i = 0; i < nent; i++)
@@ -303,7 +338,6 @@ static int lio_sigsetup(FAR struct aiocb * const *list, int nent,
 
   /* Attach our signal handler */
 
-  printf("waiter_main: Registering signal handler\n");
   act.sa_sigaction = lio_sighandler;
   act.sa_flags = SA_SIGINFO;
 
@@ -550,7 +584,9 @@ int lio_listio(int mode, FAR struct aiocb *const list[], int nent,
 
   /* Lock the scheduler so that no I/O events can complete on the worker
    * thread until we set our wait set up.  Pre-emption will, of course, be
-   * re-enabled while we are waiting for the signal.
+   * re-enabled while we are waiting for the signal.  This also assures that
+   * the entire list is queued before any of the I/O is started so that
+   * adjacent requests may be merged by the AIO worker threads.
    */
 
   sched_lock();
@@ -670,61 +706,35 @@ int lio_listio(int mode, FAR struct aiocb *const list[], int nent,
    *   caller ourself?
    */
 
-  else if (sig && sig->sigev_notify == SIGEV_SIGNAL)
+  else if (sig && (sig->sigev_notify == SIGEV_SIGNAL
+#ifdef CONFIG_SIG_EVTHREAD
+                   || sig->sigev_notify == SIGEV_THREAD
+#endif
+                  ))
     {
       if (nqueued > 0)
         {
           /* Setup a signal handler to detect when until all I/O completes. */
 
           status = lio_sigsetup(list, nent, sig);
-          if (status < 0 && ret == OK)
-            {
-              /* Something bad happened while setting up the signal and this
-               * is the first error to be reported.
-               */
-
-              retcode = -status;
-              ret     = ERROR;
-            }
         }
       else
         {
-#ifdef CONFIG_CAN_PASS_STRUCTS
-          status = sigqueue(getpid(), sig->sigev_signo,
-                            sig->sigev_value);
-#else
-          status = sigqueue(getpid(), sig->sigev_signo,
-                            sig->sigev_value.sival_ptr);
-#endif
-          if (status < 0 && ret == OK)
-            {
-              /* Something bad happened while signalling ourself and this is
-               * the first error to be reported.
-               */
+          /* Nothing was queued.  Notify the caller now. */
 
-              retcode = get_errno();
-              ret     = ERROR;
-            }
+          status = lio_notify(getpid(), sig);
         }
-    }
-
-#ifdef CONFIG_SIG_EVTHREAD
-  /* Notify the client via a function call */
 
-  else if (sig && sig->sigev_notify == SIGEV_THREAD)
-    {
-      status = nxsig_notification(sighand->pid, &sighand->sig);
       if (status < 0 && ret == OK)
         {
-         /* Something bad happened while performing the notification
-          * and this is the first error to be reported.
-          */
+          /* Something bad happened while setting up the notification and
+           * this is the first error to be reported.
+           */
 
           retcode = -status;
           ret     = ERROR;
         }
     }
-#endif
 
   /* Case 3: mode == LIO_NOWAIT and sig == NULL
    *
@@ -1,7 +1,7 @@
 /****************************************************************************
  * libc/libc.h
  *
- *   Copyright (C) 2007-2014, 2016-2017 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007-2014, 2016-2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -156,6 +156,12 @@ char *__dtoa(double d, int mode, int ndigits, int *decpt, int *sign,
              char **rve);
 #endif
 
+/* Defined in lib_strtod.c */
+
+#if defined(CONFIG_HAVE_DOUBLE) && defined(CONFIG_HAVE_LONG_LONG)
+int lib_strtodcmp(FAR const char *str, double value);
+#endif
+
 /* Defined in lib_fopen.c */
 
 int lib_mode2oflags(FAR const char *mode);
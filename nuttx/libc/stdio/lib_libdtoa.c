@@ -46,6 +46,8 @@
 
 #include <nuttx/config.h>
 
+#include <stdint.h>
+#include <string.h>
 #include <math.h>
 #include <assert.h>
 
@@ -59,6 +61,14 @@
 
 #define MAX_PREC 16
 
+/* lib_dtoa_fixed() handles precisions up to this many digits.  Its digit
+ * buffer holds up to 20 integer digits, one digit of rounding carry, the
+ * fraction digits and a NUL terminator.
+ */
+
+#define FIXED_MAXPREC  40
+#define FIXED_BUFSIZE  (20 + 1 + FIXED_MAXPREC + 1)
+
 #ifndef MIN
 #  define MIN(a,b) (a < b ? a : b)
 #endif
@@ -81,11 +91,20 @@
 
 static void zeroes(FAR struct lib_outstream_s *obj, int nzeroes)
 {
-  int i;
+  static const char zeros[16] =
+  {
+    '0', '0', '0', '0', '0', '0', '0', '0',
+    '0', '0', '0', '0', '0', '0', '0', '0'
+  };
 
-  for (i = nzeroes; i > 0; i--)
+  for (; nzeroes > 16; nzeroes -= 16)
     {
-      obj->put(obj, '0');
+      vsprintf_puts(obj, zeros, 16);
+    }
+
+  if (nzeroes > 0)
+    {
+      vsprintf_puts(obj, zeros, nzeroes);
     }
 }
 
@@ -99,11 +118,234 @@ static void zeroes(FAR struct lib_outstream_s *obj, int nzeroes)
 
 static void lib_dtoa_string(FAR struct lib_outstream_s *obj, const char *str)
 {
-  while (*str)
+  vsprintf_puts(obj, str, strlen(str));
+}
+
+/****************************************************************************
+ * Name: lib_dtoa_fixed
+ *
+ * Description:
+ *   Convert a positive, non-zero value to 'prec' digits past the decimal
+ *   point.  The result is the same as __dtoa(value, 3, prec, ...):  The
+ *   correctly rounded digits with leading and trailing zeroes suppressed
+ *   and the position of the decimal point in 'expt'.
+ *
+ *   The value is exactly mant * 2^exp2.  The integer part is converted
+ *   with integer arithmetic and the fractional part is held as an exact
+ *   128-bit binary fraction that is multiplied by ten for each digit.
+ *   Unlike __dtoa(), no multiple precision arithmetic or heap allocation
+ *   is needed.
+ *
+ * Input Parameters:
+ *   value  - The value to convert
+ *   prec   - The number of digits to the right of the decimal point
+ *   digits - The returned digit string, FIXED_BUFSIZE bytes in size
+ *   expt   - The returned position of the decimal point
+ *
+ * Returned Value:
+ *   The number of digits returned or -1 if the value or the precision is
+ *   out of the range handled here.  In that case, __dtoa() must be used.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_HAVE_LONG_LONG
+static int lib_dtoa_fixed(double value, int prec, FAR char *digits,
+                          FAR int *expt)
+{
+  union
+  {
+    double d;
+    uint32_t w[2];
+  } u;
+
+  unsigned long long mant;
+  unsigned long long ipart;
+  unsigned long long fpart;
+  unsigned long long carry;
+  uint32_t frac[4];
+  uint32_t ipart32;
+  int exp2;
+  int shift;
+  int nint;
+  int ndigits;
+  int i;
+  int j;
+
+  /* Get the 53-bit mantissa and the binary exponent */
+
+  u.d = value;
+#ifdef CONFIG_ENDIAN_BIG
+  mant = ((unsigned long long)(u.w[0] & 0x000fffff) << 32) | u.w[1];
+  exp2 = (u.w[0] >> 20) & 0x7ff;
+#else
+  mant = ((unsigned long long)(u.w[1] & 0x000fffff) << 32) | u.w[0];
+  exp2 = (u.w[1] >> 20) & 0x7ff;
+#endif
+
+  /* Only normal values in the range 2^-76 <= value < 2^64 are handled. */
+
+  if (exp2 == 0 || prec < 0 || prec > FIXED_MAXPREC)
+    {
+      return -1;
+    }
+
+  mant |= 1ull << 52;
+  exp2 -= 1075;
+
+  if (exp2 > 11 || exp2 < -128)
+    {
+      return -1;
+    }
+
+  /* Separate the integer part from the fractional part. */
+
+  if (exp2 >= 0)
+    {
+      ipart = mant << exp2;
+      fpart = 0;
+    }
+  else if (exp2 > -64)
+    {
+      ipart = mant >> -exp2;
+      fpart = mant & ((1ull << -exp2) - 1);
+    }
+  else
+    {
+      ipart = 0;
+      fpart = mant;
+    }
+
+  /* Left-align the fraction in a 128-bit fixed point value, most
+   * significant word first:  fraction = frac / 2^128.
+   */
+
+  memset(frac, 0, sizeof(frac));
+  if (exp2 < 0)
+    {
+      shift = 128 + exp2;
+      if (shift >= 64)
+        {
+          fpart <<= shift - 64;
+          frac[0]  = (uint32_t)(fpart >> 32);
+          frac[1]  = (uint32_t)fpart;
+        }
+      else
+        {
+          carry    = shift > 0 ? fpart >> (64 - shift) : 0;
+          frac[0]  = (uint32_t)(carry >> 32);
+          frac[1]  = (uint32_t)carry;
+          fpart  <<= shift;
+          frac[2]  = (uint32_t)(fpart >> 32);
+          frac[3]  = (uint32_t)fpart;
+        }
+    }
+
+  /* Convert the integer part, least significant digit first, then reverse
+   * the digits in place.
+   */
+
+  nint = 0;
+  while (ipart > 0xffffffff)
     {
-      obj->put(obj, *str++);
+      digits[nint++] = (char)(ipart % 10) + '0';
+      ipart         /= 10;
     }
+
+  for (ipart32 = (uint32_t)ipart; ipart32 > 0; ipart32 /= 10)
+    {
+      digits[nint++] = (char)(ipart32 % 10) + '0';
+    }
+
+  for (i = 0, j = nint - 1; i < j; i++, j--)
+    {
+      char tmp  = digits[i];
+      digits[i] = digits[j];
+      digits[j] = tmp;
+    }
+
+  /* Generate the fraction digits.  Each multiplication by ten shifts the
+   * next decimal digit out of the top of the fraction.
+   */
+
+  ndigits = nint;
+  for (i = 0; i < prec; i++)
+    {
+      for (carry = 0, j = 3; j >= 0; j--)
+        {
+          carry   += (unsigned long long)frac[j] * 10;
+          frac[j]  = (uint32_t)carry;
+          carry  >>= 32;
+        }
+
+      digits[ndigits++] = (char)carry + '0';
+    }
+
+  /* Round the last digit using the remaining fraction.  Ties go to the
+   * even digit, as __dtoa() does.
+   */
+
+  if (frac[0] > 0x80000000 ||
+      (frac[0] == 0x80000000 &&
+       (frac[1] != 0 || frac[2] != 0 || frac[3] != 0 ||
+        (ndigits > 0 && (digits[ndigits - 1] & 1) != 0))))
+    {
+      for (i = ndigits - 1; i >= 0 && digits[i] == '9'; i--)
+        {
+          digits[i] = '0';
+        }
+
+      if (i >= 0)
+        {
+          digits[i]++;
+        }
+      else
+        {
+          /* Carry out of the most significant digit */
+
+          memmove(&digits[1], digits, ndigits);
+          digits[0] = '1';
+          ndigits++;
+          nint++;
+        }
+    }
+
+  /* Suppress leading zeroes (there are none if there is an integer part)
+   * and trailing zeroes.
+   */
+
+  i = 0;
+  while (i < ndigits && digits[i] == '0')
+    {
+      i++;
+    }
+
+  if (i >= ndigits)
+    {
+      /* The value rounds to zero.  __dtoa() returns "0" in this case. */
+
+      digits[0] = '0';
+      digits[1] = '\0';
+      *expt     = 1;
+      return 1;
+    }
+
+  if (i > 0)
+    {
+      ndigits -= i;
+      nint    -= i;
+      memmove(digits, &digits[i], ndigits);
+    }
+
+  while (digits[ndigits - 1] == '0')
+    {
+      ndigits--;
+    }
+
+  digits[ndigits] = '\0';
+  *expt           = nint;
+  return ndigits;
 }
+#endif
 
 /****************************************************************************
  * Name: lib_dtoa
@@ -130,13 +372,15 @@ static void lib_dtoa_string(FAR struct lib_outstream_s *obj, const char *str)
 static void lib_dtoa(FAR struct lib_outstream_s *obj, int fmt, int prec,
                      uint8_t flags, double value)
 {
+#ifdef CONFIG_HAVE_LONG_LONG
+  char fixed[FIXED_BUFSIZE]; /* Digits returned by lib_dtoa_fixed */
+#endif
   FAR char *digits;     /* String returned by __dtoa */
   FAR char *rve;        /* Points to the end of the return value */
   int  expt;            /* Integer value of exponent */
   int  numlen;          /* Actual number of digits returned by cvt */
   int  nchars;          /* Number of characters to print */
   int  dsgn;            /* Unused sign indicator */
-  int  i;
 
 #if defined(CONFIG_BUILD_FLAT) || defined(__KERNEL__)
   /* This function may *NOT* be called within interrupt level logic.  That is
@@ -176,10 +420,22 @@ static void lib_dtoa(FAR struct lib_outstream_s *obj, int fmt, int prec,
       SET_NEGATE(flags);
     }
 
-  /* Perform the conversion */
+  /* Perform the conversion.  Use the fast, exact fixed-point conversion if
+   * possible; fall back to the multiple precision __dtoa() if not.
+   */
 
-  digits   = __dtoa(value, 3, prec, &expt, &dsgn, &rve);
-  numlen   = rve - digits;
+#ifdef CONFIG_HAVE_LONG_LONG
+  numlen = value != 0 ? lib_dtoa_fixed(value, prec, fixed, &expt) : -1;
+  if (numlen >= 0)
+    {
+      digits = fixed;
+    }
+  else
+#endif
+    {
+      digits   = __dtoa(value, 3, prec, &expt, &dsgn, &rve);
+      numlen   = rve - digits;
+    }
 
   /* Avoid precision error from missing trailing zeroes */
 
@@ -255,18 +511,10 @@ static void lib_dtoa(FAR struct lib_outstream_s *obj, int fmt, int prec,
         {
           /* Print the integer part to the left of the decimal point */
 
-          for (i = expt; i > 0; i--)
-            {
-              if (*digits != '\0')
-                {
-                  obj->put(obj, *digits);
-                  digits++;
-                }
-              else
-                {
-                  obj->put(obj, '0');
-                }
-            }
+          nchars = MIN(expt, (int)strlen(digits));
+          vsprintf_puts(obj, digits, nchars);
+          digits += nchars;
+          zeroes(obj, expt - nchars);
 
           /* Get the length of the fractional part */
 
@@ -306,11 +554,7 @@ static void lib_dtoa(FAR struct lib_outstream_s *obj, int fmt, int prec,
 
       /* Print the fractional part to the right of the decimal point */
 
-      for (i = nchars; i > 0; i--)
-        {
-          obj->put(obj, *digits);
-          digits++;
-        }
+      vsprintf_puts(obj, digits, nchars);
 
       /* Decrement to get the number of trailing zeroes to print */
 
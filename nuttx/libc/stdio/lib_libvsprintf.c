@@ -1,7 +1,7 @@
 /****************************************************************************
  * libc/stdio/lib_libvsprintf.c
  *
- *   Copyright (C) 2007-2012 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007-2012, 2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -62,6 +62,20 @@
 #  define CONFIG_LIBC_FIXEDPRECISION 3
 #endif
 
+/* Sizes of the on-stack buffers that integers are converted into before
+ * being output as a single block.  3 * sizeof(t) is enough to hold the
+ * decimal representation of any unsigned type t.
+ */
+
+#define DECBUFSIZE(t)            (3 * sizeof(t))
+#define HEXBUFSIZE(t)            (2 * sizeof(t))
+#define OCTBUFSIZE(t)            ((8 * sizeof(t) + 2) / 3)
+#define BINBUFSIZE(t)            (8 * sizeof(t))
+
+/* Padding is output in blocks of this size */
+
+#define PADBUFSIZE               16
+
 #define FLAG_SHOWPLUS            0x01
 #define FLAG_ALTFORM             0x02
 #define FLAG_HASDOT              0x04
@@ -214,10 +228,75 @@ static void postjustify(FAR struct lib_outstream_s *obj, uint8_t fmt,
 
 static const char g_nullstring[] = "(null)";
 
+/* Pairs of decimal digits "00" through "99".  Integers are converted to
+ * decimal two digits (and one division) at a time using this table.
+ */
+
+static const char g_decpairs[200] =
+{
+  "0001020304050607080910111213141516171819"
+  "2021222324252627282930313233343536373839"
+  "4041424344454647484950515253545556575859"
+  "6061626364656667686970717273747576777879"
+  "8081828384858687888990919293949596979899"
+};
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: vsprintf_puts
+ *
+ * Description:
+ *   Output a block of characters, using the bulk puts method of the stream
+ *   if it has one.
+ *
+ ****************************************************************************/
+
+static void vsprintf_puts(FAR struct lib_outstream_s *obj,
+                          FAR const char *buffer, int buflen)
+{
+  if (obj->puts != NULL)
+    {
+      obj->puts(obj, buffer, buflen);
+    }
+  else
+    {
+      for (; buflen > 0; buflen--)
+        {
+          obj->put(obj, *buffer++);
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: vsprintf_pad
+ *
+ * Description:
+ *   Output 'count' copies of the fill character 'ch'.
+ *
+ ****************************************************************************/
+
+#ifndef CONFIG_NOPRINTF_FIELDWIDTH
+static void vsprintf_pad(FAR struct lib_outstream_s *obj, int ch, int count)
+{
+  char buffer[PADBUFSIZE];
+  int nfill;
+
+  if (count > 0)
+    {
+      memset(buffer, ch, count < PADBUFSIZE ? count : PADBUFSIZE);
+
+      for (; count > 0; count -= nfill)
+        {
+          nfill = count < PADBUFSIZE ? count : PADBUFSIZE;
+          vsprintf_puts(obj, buffer, nfill);
+        }
+    }
+}
+#endif
+
 /* Include floating point functions */
 
 #ifdef CONFIG_LIBC_FLOATINGPOINT
@@ -237,6 +316,8 @@ static void ptohex(FAR struct lib_outstream_s *obj, uint8_t flags,
     uint32_t  dw;
     FAR void *p;
   } u;
+  char buffer[HEXBUFSIZE(FAR void *)];
+  FAR char *ptr;
   uint8_t bits;
 
   /* Check for alternate form */
@@ -252,18 +333,20 @@ static void ptohex(FAR struct lib_outstream_s *obj, uint8_t flags,
   u.dw = 0;
   u.p  = p;
 
-  for (bits = 8*sizeof(void *); bits > 0; bits -= 4)
+  for (bits = 8*sizeof(void *), ptr = buffer; bits > 0; bits -= 4)
     {
       uint8_t nibble = (uint8_t)((u.dw >> (bits - 4)) & 0xf);
       if (nibble < 10)
         {
-          obj->put(obj, nibble + '0');
+          *ptr++ = nibble + '0';
         }
       else
         {
-          obj->put(obj, nibble + 'a' - 10);
+          *ptr++ = nibble + 'a' - 10;
         }
     }
+
+  vsprintf_puts(obj, buffer, ptr - buffer);
 }
 
 /****************************************************************************
@@ -289,15 +372,32 @@ static int getpsize(uint8_t flags, FAR void *p)
 
 static void utodec(FAR struct lib_outstream_s *obj, unsigned int n)
 {
-  unsigned int remainder = n % 10;
-  unsigned int dividend  = n / 10;
+  char buffer[DECBUFSIZE(unsigned int)];
+  FAR char *ptr = &buffer[sizeof(buffer)];
+  unsigned int pair;
+
+  /* Convert from the least significant end, two digits at a time */
+
+  while (n >= 100)
+    {
+      pair   = (unsigned int)(n % 100) << 1;
+      n     /= 100;
+      *--ptr = g_decpairs[pair + 1];
+      *--ptr = g_decpairs[pair];
+    }
 
-  if (dividend)
+  if (n >= 10)
+    {
+      pair   = (unsigned int)n << 1;
+      *--ptr = g_decpairs[pair + 1];
+      *--ptr = g_decpairs[pair];
+    }
+  else
     {
-      utodec(obj, dividend);
+      *--ptr = (unsigned int)n + '0';
     }
 
-  obj->put(obj, (remainder + (unsigned int)'0'));
+  vsprintf_puts(obj, ptr, &buffer[sizeof(buffer)] - ptr);
 }
 
 /****************************************************************************
@@ -307,31 +407,27 @@ static void utodec(FAR struct lib_outstream_s *obj, unsigned int n)
 static void utohex(FAR struct lib_outstream_s *obj, unsigned int n,
                    uint8_t a)
 {
-  bool    nonzero = false;
-  uint8_t bits;
+  char buffer[HEXBUFSIZE(unsigned int)];
+  FAR char *ptr = &buffer[sizeof(buffer)];
+  uint8_t nibble;
 
-  for (bits = 8*sizeof(unsigned int); bits > 0; bits -= 4)
+  do
     {
-      uint8_t nibble = (uint8_t)((n >> (bits - 4)) & 0xf);
-      if (nibble || nonzero)
+      nibble = (uint8_t)(n & 0xf);
+      if (nibble < 10)
         {
-          nonzero = true;
-
-          if (nibble < 10)
-            {
-              obj->put(obj, nibble + '0');
-            }
-          else
-            {
-              obj->put(obj, nibble + a - 10);
-            }
+          *--ptr = nibble + '0';
+        }
+      else
+        {
+          *--ptr = nibble + a - 10;
         }
-    }
 
-  if (!nonzero)
-    {
-      obj->put(obj, '0');
+      n >>= 4;
     }
+  while (n != 0);
+
+  vsprintf_puts(obj, ptr, &buffer[sizeof(buffer)] - ptr);
 }
 
 /****************************************************************************
@@ -340,15 +436,17 @@ static void utohex(FAR struct lib_outstream_s *obj, unsigned int n,
 
 static void utooct(FAR struct lib_outstream_s *obj, unsigned int n)
 {
-  unsigned int remainder = n & 0x7;
-  unsigned int dividend = n >> 3;
+  char buffer[OCTBUFSIZE(unsigned int)];
+  FAR char *ptr = &buffer[sizeof(buffer)];
 
-  if (dividend)
+  do
     {
-      utooct(obj, dividend);
+      *--ptr = (unsigned int)(n & 0x7) + '0';
+      n    >>= 3;
     }
+  while (n != 0);
 
-  obj->put(obj, (remainder + (unsigned int)'0'));
+  vsprintf_puts(obj, ptr, &buffer[sizeof(buffer)] - ptr);
 }
 
 /****************************************************************************
@@ -357,15 +455,17 @@ static void utooct(FAR struct lib_outstream_s *obj, unsigned int n)
 
 static void utobin(FAR struct lib_outstream_s *obj, unsigned int n)
 {
-  unsigned int remainder = n & 1;
-  unsigned int dividend = n >> 1;
+  char buffer[BINBUFSIZE(unsigned int)];
+  FAR char *ptr = &buffer[sizeof(buffer)];
 
-  if (dividend)
+  do
     {
-      utobin(obj, dividend);
+      *--ptr = (unsigned int)(n & 1) + '0';
+      n    >>= 1;
     }
+  while (n != 0);
 
-  obj->put(obj, (remainder + (unsigned int)'0'));
+  vsprintf_puts(obj, ptr, &buffer[sizeof(buffer)] - ptr);
 }
 
 /****************************************************************************
@@ -559,15 +659,32 @@ static int getdblsize(uint8_t fmt, int trunc, uint8_t flags, double n)
 
 static void lutodec(FAR struct lib_outstream_s *obj, unsigned long n)
 {
-  unsigned int  remainder = n % 10;
-  unsigned long dividend  = n / 10;
+  char buffer[DECBUFSIZE(unsigned long)];
+  FAR char *ptr = &buffer[sizeof(buffer)];
+  unsigned int pair;
+
+  /* Convert from the least significant end, two digits at a time */
 
-  if (dividend)
+  while (n >= 100)
     {
-      lutodec(obj, dividend);
+      pair   = (unsigned int)(n % 100) << 1;
+      n     /= 100;
+      *--ptr = g_decpairs[pair + 1];
+      *--ptr = g_decpairs[pair];
     }
 
-  obj->put(obj, (remainder + (unsigned int)'0'));
+  if (n >= 10)
+    {
+      pair   = (unsigned int)n << 1;
+      *--ptr = g_decpairs[pair + 1];
+      *--ptr = g_decpairs[pair];
+    }
+  else
+    {
+      *--ptr = (unsigned int)n + '0';
+    }
+
+  vsprintf_puts(obj, ptr, &buffer[sizeof(buffer)] - ptr);
 }
 
 /****************************************************************************
@@ -577,31 +694,27 @@ static void lutodec(FAR struct lib_outstream_s *obj, unsigned long n)
 static void lutohex(FAR struct lib_outstream_s *obj, unsigned long n,
                     uint8_t a)
 {
-  bool    nonzero = false;
-  uint8_t bits;
+  char buffer[HEXBUFSIZE(unsigned long)];
+  FAR char *ptr = &buffer[sizeof(buffer)];
+  uint8_t nibble;
 
-  for (bits = 8*sizeof(unsigned long); bits > 0; bits -= 4)
+  do
     {
-      uint8_t nibble = (uint8_t)((n >> (bits - 4)) & 0xf);
-      if (nibble || nonzero)
+      nibble = (uint8_t)(n & 0xf);
+      if (nibble < 10)
         {
-          nonzero = true;
-
-          if (nibble < 10)
-            {
-              obj->put(obj, nibble + '0');
-            }
-          else
-            {
-              obj->put(obj, nibble + a - 10);
-            }
+          *--ptr = nibble + '0';
+        }
+      else
+        {
+          *--ptr = nibble + a - 10;
         }
-    }
 
-  if (!nonzero)
-    {
-      obj->put(obj, '0');
+      n >>= 4;
     }
+  while (n != 0);
+
+  vsprintf_puts(obj, ptr, &buffer[sizeof(buffer)] - ptr);
 }
 
 /****************************************************************************
@@ -610,15 +723,17 @@ static void lutohex(FAR struct lib_outstream_s *obj, unsigned long n,
 
 static void lutooct(FAR struct lib_outstream_s *obj, unsigned long n)
 {
-  unsigned int  remainder = n & 0x7;
-  unsigned long dividend  = n >> 3;
+  char buffer[OCTBUFSIZE(unsigned long)];
+  FAR char *ptr = &buffer[sizeof(buffer)];
 
-  if (dividend)
+  do
     {
-      lutooct(obj, dividend);
+      *--ptr = (unsigned int)(n & 0x7) + '0';
+      n    >>= 3;
     }
+  while (n != 0);
 
-  obj->put(obj, (remainder + (unsigned int)'0'));
+  vsprintf_puts(obj, ptr, &buffer[sizeof(buffer)] - ptr);
 }
 
 /****************************************************************************
@@ -627,15 +742,17 @@ static void lutooct(FAR struct lib_outstream_s *obj, unsigned long n)
 
 static void lutobin(FAR struct lib_outstream_s *obj, unsigned long n)
 {
-  unsigned int  remainder = n & 1;
-  unsigned long dividend  = n >> 1;
+  char buffer[BINBUFSIZE(unsigned long)];
+  FAR char *ptr = &buffer[sizeof(buffer)];
 
-  if (dividend)
+  do
     {
-      lutobin(obj, dividend);
+      *--ptr = (unsigned int)(n & 1) + '0';
+      n    >>= 1;
     }
+  while (n != 0);
 
-  obj->put(obj, (remainder + (unsigned int)'0'));
+  vsprintf_puts(obj, ptr, &buffer[sizeof(buffer)] - ptr);
 }
 
 /****************************************************************************
@@ -811,15 +928,32 @@ static int getlusize(uint8_t fmt, uint8_t flags, unsigned long ln)
 
 static void llutodec(FAR struct lib_outstream_s *obj, unsigned long long n)
 {
-  unsigned int remainder = n % 10;
-  unsigned long long dividend = n / 10;
+  char buffer[DECBUFSIZE(unsigned long long)];
+  FAR char *ptr = &buffer[sizeof(buffer)];
+  unsigned int pair;
 
-  if (dividend)
+  /* Convert from the least significant end, two digits at a time */
+
+  while (n >= 100)
     {
-      llutodec(obj, dividend);
+      pair   = (unsigned int)(n % 100) << 1;
+      n     /= 100;
+      *--ptr = g_decpairs[pair + 1];
+      *--ptr = g_decpairs[pair];
     }
 
-  obj->put(obj, (remainder + (unsigned int)'0'));
+  if (n >= 10)
+    {
+      pair   = (unsigned int)n << 1;
+      *--ptr = g_decpairs[pair + 1];
+      *--ptr = g_decpairs[pair];
+    }
+  else
+    {
+      *--ptr = (unsigned int)n + '0';
+    }
+
+  vsprintf_puts(obj, ptr, &buffer[sizeof(buffer)] - ptr);
 }
 
 /****************************************************************************
@@ -829,31 +963,27 @@ static void llutodec(FAR struct lib_outstream_s *obj, unsigned long long n)
 static void llutohex(FAR struct lib_outstream_s *obj, unsigned long long n,
                      uint8_t a)
 {
-  bool    nonzero = false;
-  uint8_t bits;
+  char buffer[HEXBUFSIZE(unsigned long long)];
+  FAR char *ptr = &buffer[sizeof(buffer)];
+  uint8_t nibble;
 
-  for (bits = 8*sizeof(unsigned long long); bits > 0; bits -= 4)
+  do
     {
-      uint8_t nibble = (uint8_t)((n >> (bits - 4)) & 0xf);
-      if (nibble || nonzero)
+      nibble = (uint8_t)(n & 0xf);
+      if (nibble < 10)
         {
-          nonzero = true;
-
-          if (nibble < 10)
-            {
-              obj->put(obj, (nibble + '0'));
-            }
-          else
-            {
-              obj->put(obj, (nibble + a - 10));
-            }
+          *--ptr = nibble + '0';
+        }
+      else
+        {
+          *--ptr = nibble + a - 10;
         }
-    }
 
-  if (!nonzero)
-    {
-      obj->put(obj, '0');
+      n >>= 4;
     }
+  while (n != 0);
+
+  vsprintf_puts(obj, ptr, &buffer[sizeof(buffer)] - ptr);
 }
 
 /****************************************************************************
@@ -862,15 +992,17 @@ static void llutohex(FAR struct lib_outstream_s *obj, unsigned long long n,
 
 static void llutooct(FAR struct lib_outstream_s *obj, unsigned long long n)
 {
-  unsigned int remainder = n & 0x7;
-  unsigned long long dividend = n >> 3;
+  char buffer[OCTBUFSIZE(unsigned long long)];
+  FAR char *ptr = &buffer[sizeof(buffer)];
 
-  if (dividend)
+  do
     {
-      llutooct(obj, dividend);
+      *--ptr = (unsigned int)(n & 0x7) + '0';
+      n    >>= 3;
     }
+  while (n != 0);
 
-  obj->put(obj, (remainder + (unsigned int)'0'));
+  vsprintf_puts(obj, ptr, &buffer[sizeof(buffer)] - ptr);
 }
 
 /****************************************************************************
@@ -879,15 +1011,17 @@ static void llutooct(FAR struct lib_outstream_s *obj, unsigned long long n)
 
 static void llutobin(FAR struct lib_outstream_s *obj, unsigned long long n)
 {
-  unsigned int remainder = n & 1;
-  unsigned long long dividend = n >> 1;
+  char buffer[BINBUFSIZE(unsigned long long)];
+  FAR char *ptr = &buffer[sizeof(buffer)];
 
-  if (dividend)
+  do
     {
-      llutobin(obj, dividend);
+      *--ptr = (unsigned int)(n & 1) + '0';
+      n    >>= 1;
     }
+  while (n != 0);
 
-  obj->put(obj, (remainder + (unsigned int)'0'));
+  vsprintf_puts(obj, ptr, &buffer[sizeof(buffer)] - ptr);
 }
 
 /****************************************************************************
@@ -1065,8 +1199,6 @@ static int getllusize(uint8_t fmt, uint8_t flags, unsigned long long lln)
 static void prejustify(FAR struct lib_outstream_s *obj, uint8_t fmt,
                        uint8_t flags, int fieldwidth, int valwidth)
 {
-  int i;
-
   switch (fmt)
     {
       default:
@@ -1076,10 +1208,7 @@ static void prejustify(FAR struct lib_outstream_s *obj, uint8_t fmt,
             valwidth++;
           }
 
-        for (i = fieldwidth - valwidth; i > 0; i--)
-          {
-            obj->put(obj, ' ');
-          }
+        vsprintf_pad(obj, ' ', fieldwidth - valwidth);
 
         if (IS_NEGATE(flags))
           {
@@ -1103,10 +1232,7 @@ static void prejustify(FAR struct lib_outstream_s *obj, uint8_t fmt,
             valwidth++;
           }
 
-        for (i = fieldwidth - valwidth; i > 0; i--)
-          {
-            obj->put(obj, '0');
-          }
+        vsprintf_pad(obj, '0', fieldwidth - valwidth);
         break;
 
       case FMT_LJUST:
@@ -1131,8 +1257,6 @@ static void prejustify(FAR struct lib_outstream_s *obj, uint8_t fmt,
 static void postjustify(FAR struct lib_outstream_s *obj, uint8_t fmt,
                         uint8_t flags, int fieldwidth, int valwidth)
 {
-  int i;
-
   /* Apply field justification to the integer value. */
 
   switch (fmt)
@@ -1148,10 +1272,7 @@ static void postjustify(FAR struct lib_outstream_s *obj, uint8_t fmt,
             valwidth++;
           }
 
-        for (i = fieldwidth - valwidth; i > 0; i--)
-          {
-            obj->put(obj, ' ');
-          }
+        vsprintf_pad(obj, ' ', fieldwidth - valwidth);
         break;
     }
 }
@@ -1185,9 +1306,25 @@ int lib_vsprintf(FAR struct lib_outstream_s *obj, FAR const IPTR char *src,
 
       if (FMT_CHAR != '%')
         {
+#ifdef CONFIG_ARCH_ROMGETC
            /* Output the character */
 
            obj->put(obj, FMT_CHAR);
+#else
+           FAR const char *start = src;
+
+           /* Output the whole run of regular characters up to the next
+            * format specifier as one block.  Stop after a newline so that
+            * the stream can still be flushed there.
+            */
+
+           while (*src != '\n' && src[1] != '\0' && src[1] != '%')
+             {
+               src++;
+             }
+
+           vsprintf_puts(obj, start, src - start + 1);
+#endif
 
            /* Flush the buffer if a newline is encountered */
 
@@ -1353,7 +1490,6 @@ int lib_vsprintf(FAR struct lib_outstream_s *obj, FAR const IPTR char *src,
         {
 #ifndef CONFIG_NOPRINTF_FIELDWIDTH
           int swidth;
-          int left;
 #endif
           /* Get the string to output */
 
@@ -1371,21 +1507,14 @@ int lib_vsprintf(FAR struct lib_outstream_s *obj, FAR const IPTR char *src,
           swidth = (IS_HASDOT(flags) && trunc >= 0)
                       ? strnlen(ptmp, trunc) : strlen(ptmp);
           prejustify(obj, fmt, 0, width, swidth);
-          left = swidth;
 #endif
           /* Concatenate the string into the output */
 
-          while (*ptmp)
-            {
 #ifndef CONFIG_NOPRINTF_FIELDWIDTH
-              if (left-- <= 0)
-                {
-                  break;
-                }
+          vsprintf_puts(obj, ptmp, swidth);
+#else
+          vsprintf_puts(obj, ptmp, strlen(ptmp));
 #endif
-              obj->put(obj, *ptmp);
-              ptmp++;
-            }
 
           /* Perform left-justification operations. */
 
@@ -4,6 +4,7 @@
  *
  *   Copyright (C) 2002 Michael Ringgaard. All rights reserved.
  *   Copyright (C) 2006-2007 H. Peter Anvin.
+ *   Copyright (C) 2018 Gregory Nutt. All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
  * modification, are permitted provided that the following conditions
@@ -40,8 +41,12 @@
 #include <nuttx/config.h>
 #include <nuttx/compiler.h>
 
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include <ctype.h>
+#include <assert.h>
 #include <errno.h>
 
 #ifdef CONFIG_HAVE_DOUBLE
@@ -50,21 +55,132 @@
  * Pre-processor definitions
  ****************************************************************************/
 
-/* These are predefined with GCC, but could be issues for other compilers. If
- * not defined, an arbitrary big number is put in for now.  These should be
- * added to nuttx/compiler for your compiler.
+/* The significant digits are accumulated in an integer.  Only this many of
+ * them are kept; any further digits only affect the exponent.  Integers up
+ * to MANT_EXACT_MAX are exactly representable as a double.  (18 digits
+ * leaves room to double the mantissa in strtod_cmphalf()).
  */
 
-#if !defined(__DBL_MIN_EXP__) || !defined(__DBL_MAX_EXP__)
-#  ifdef CONFIG_CPP_HAVE_WARNING
-#    warning "Size of exponent is unknown"
-#  endif
-#  undef  __DBL_MIN_EXP__
-#  define __DBL_MIN_EXP__ (-1021)
-#  undef  __DBL_MAX_EXP__
-#  define __DBL_MAX_EXP__ (1024)
+#ifdef CONFIG_HAVE_LONG_LONG
+#  define MANT_DIGITS    18
+#  define MANT_EXACT_MAX (1ull << 53)
+#else
+#  define MANT_DIGITS    9
+#  define MANT_EXACT_MAX 0xffffffffUL
 #endif
 
+/* The largest power of ten that is exactly representable as a double */
+
+#define POW10_EXACT_MAX  22
+
+/* Decimal exponent limits:  A value of 10^DEXP_MAX or more overflows and a
+ * value below 10^DEXP_MIN rounds to zero.
+ */
+
+#define DEXP_MAX         309
+#define DEXP_MIN         (-324)
+
+/* lib_strtodcmp() compares up to CMP_DIGITS significant digits.  Every
+ * float and every point halfway between two floats has fewer.  Decimal
+ * numbers of 10^FLT_DEXP_MAX or more are larger, and numbers below
+ * 10^FLT_DEXP_MIN smaller, than any such value.
+ */
+
+#define CMP_DIGITS       120
+#define FLT_DEXP_MAX     39
+#define FLT_DEXP_MIN     (-46)
+
+/* Size of the integers used to compare the decimal input against a
+ * floating point value exactly.  With the limits above, neither side of
+ * the comparison needs more than about 900 bits.
+ */
+
+#define BIG_NWORDS       36
+
+/* The bit pattern of +Infinity */
+
+#define DBL_INF_BITS     0x7ff0000000000000ull
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+#ifdef CONFIG_HAVE_LONG_LONG
+typedef unsigned long long strtod_mant_t;
+#else
+typedef unsigned long strtod_mant_t;
+#endif
+
+/* A simple unsigned big integer, least significant word first */
+
+struct strtod_big_s
+{
+  int      nwords;
+  uint32_t words[BIG_NWORDS];
+};
+
+/* A decimal number as parsed by strtod_parse():
+ * (mant + inexact/2) * 10^exponent
+ */
+
+struct strtod_num_s
+{
+  strtod_mant_t mant;              /* Up to MANT_DIGITS significant digits */
+  int  exponent;                   /* Power of ten */
+  int  num_sig;                    /* Number of significant digits in mant */
+  int  num_digits;                 /* Number of digits in the mantissa */
+  bool negative;                   /* True if there is a '-' sign */
+  bool inexact;                    /* Non-zero digits were discarded */
+};
+
+/* Access to the bits of a double */
+
+union strtod_bits_u
+{
+  double   d;
+  uint32_t w[2];
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* Exact powers of ten, 1e0 through 1e22 */
+
+static const double g_pow10[POW10_EXACT_MAX + 1] =
+{
+  1e0,
+  1e1,
+  1e2,
+  1e3,
+  1e4,
+  1e5,
+  1e6,
+  1e7,
+  1e8,
+  1e9,
+  1e10,
+  1e11,
+  1e12,
+  1e13,
+  1e14,
+  1e15,
+  1e16,
+  1e17,
+  1e18,
+  1e19,
+  1e20,
+  1e21,
+  1e22
+};
+
+/* 1e16, 1e32, 1e64, 1e128, 1e256 */
+
+static const double g_bigpow10[] =
+{
+  1e16, 1e32, 1e64, 1e128, 1e256
+};
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -75,29 +191,279 @@ static inline int is_real(double x)
   return (x < infinite) && (x >= -infinite);
 }
 
+#ifdef CONFIG_HAVE_LONG_LONG
 /****************************************************************************
- * Public Functions
+ * Name: big_mul
+ *
+ * Description:
+ *   big = big * mul + add
+ *
  ****************************************************************************/
 
-/***************************************************(************************
- * Name: strtod
+static void big_mul(FAR struct strtod_big_s *big, uint32_t mul, uint32_t add)
+{
+  unsigned long long carry = add;
+  int i;
+
+  for (i = 0; i < big->nwords; i++)
+    {
+      carry          += (unsigned long long)big->words[i] * mul;
+      big->words[i]   = (uint32_t)carry;
+      carry         >>= 32;
+    }
+
+  if (carry != 0)
+    {
+      DEBUGASSERT(big->nwords < BIG_NWORDS);
+      big->words[big->nwords++] = (uint32_t)carry;
+    }
+}
+
+/****************************************************************************
+ * Name: big_scale
  *
  * Description:
- *   Convert a string to a double value
+ *   big = big * 5^pow5 * 2^pow2
  *
  ****************************************************************************/
 
-double strtod(FAR const char *str, FAR char **endptr)
+static void big_scale(FAR struct strtod_big_s *big, int pow5, int pow2)
+{
+  uint32_t mul;
+  int shift;
+  int i;
+
+  /* Multiply by the power of five, up to 5^13 at a time */
+
+  for (; pow5 > 0; pow5 -= 13)
+    {
+      for (mul = 1, i = pow5 < 13 ? pow5 : 13; i > 0; i--)
+        {
+          mul *= 5;
+        }
+
+      big_mul(big, mul, 0);
+    }
+
+  /* Shift left by whole words, then by the remaining bits */
+
+  if (big->nwords > 0 && pow2 > 0)
+    {
+      shift = pow2 >> 5;
+      if (shift > 0)
+        {
+          DEBUGASSERT(big->nwords + shift <= BIG_NWORDS);
+          memmove(&big->words[shift], big->words,
+                  big->nwords * sizeof(uint32_t));
+          memset(big->words, 0, shift * sizeof(uint32_t));
+          big->nwords += shift;
+        }
+
+      if ((pow2 & 31) != 0)
+        {
+          big_mul(big, (uint32_t)1 << (pow2 & 31), 0);
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: big_init
+ *
+ * Description:
+ *   big = value * 5^pow5 * 2^pow2
+ *
+ ****************************************************************************/
+
+static void big_init(FAR struct strtod_big_s *big, unsigned long long value,
+                     int pow5, int pow2)
+{
+  big->nwords = 0;
+  for (; value != 0; value >>= 32)
+    {
+      big->words[big->nwords++] = (uint32_t)value;
+    }
+
+  big_scale(big, pow5, pow2);
+}
+
+/****************************************************************************
+ * Name: big_cmp
+ ****************************************************************************/
+
+static int big_cmp(FAR const struct strtod_big_s *a,
+                   FAR const struct strtod_big_s *b)
+{
+  int i;
+
+  if (a->nwords != b->nwords)
+    {
+      return a->nwords < b->nwords ? -1 : 1;
+    }
+
+  for (i = a->nwords - 1; i >= 0; i--)
+    {
+      if (a->words[i] != b->words[i])
+        {
+          return a->words[i] < b->words[i] ? -1 : 1;
+        }
+    }
+
+  return 0;
+}
+
+/****************************************************************************
+ * Name: strtod_bits, strtod_frombits
+ *
+ * Description:
+ *   Get or set the bits of a double
+ *
+ ****************************************************************************/
+
+static unsigned long long strtod_bits(double x)
+{
+  union strtod_bits_u u;
+
+  u.d = x;
+#ifdef CONFIG_ENDIAN_BIG
+  return ((unsigned long long)u.w[0] << 32) | u.w[1];
+#else
+  return ((unsigned long long)u.w[1] << 32) | u.w[0];
+#endif
+}
+
+static double strtod_frombits(unsigned long long bits)
+{
+  union strtod_bits_u u;
+
+#ifdef CONFIG_ENDIAN_BIG
+  u.w[0] = (uint32_t)(bits >> 32);
+  u.w[1] = (uint32_t)bits;
+#else
+  u.w[1] = (uint32_t)(bits >> 32);
+  u.w[0] = (uint32_t)bits;
+#endif
+  return u.d;
+}
+
+/****************************************************************************
+ * Name: strtod_cmp
+ *
+ * Description:
+ *   Compare the decimal value (mant + half/2) * 10^exponent with the
+ *   binary value bmant * 2^bexp.  'half' is one if non-zero digits were
+ *   discarded from the mantissa; the value is then taken to be halfway
+ *   between mant and mant + 1.
+ *
+ * Returned Value:
+ *   Less than, equal to, or greater than zero if the decimal value is less
+ *   than, equal to, or greater than the binary value.
+ *
+ ****************************************************************************/
+
+static int strtod_cmp(unsigned long long mant, int half, int exponent,
+                      unsigned long long bmant, int bexp)
+{
+  struct strtod_big_s lhs;
+  struct strtod_big_s rhs;
+  int pow2l;
+  int pow2r;
+  int pow2;
+
+  /* Compare (2 * mant + half) * 5^exponent * 2^(exponent - 1) with
+   * bmant * 2^bexp.  Negative powers are moved to the other side, then the
+   * common power of two is cancelled.
+   */
+
+  pow2l = exponent - 1;
+  pow2r = bexp;
+  if (exponent < 0)
+    {
+      pow2l  = -1;
+      pow2r -= exponent;
+    }
+
+  pow2   = pow2l < pow2r ? pow2l : pow2r;
+  pow2l -= pow2;
+  pow2r -= pow2;
+
+  big_init(&lhs, 2 * mant + half, exponent > 0 ? exponent : 0, pow2l);
+  big_init(&rhs, bmant, exponent < 0 ? -exponent : 0, pow2r);
+
+  return big_cmp(&lhs, &rhs);
+}
+
+/****************************************************************************
+ * Name: strtod_unpack
+ *
+ * Description:
+ *   Split the non-negative, finite double with the bit pattern 'xbits'
+ *   into xmant * 2^xexp.
+ *
+ ****************************************************************************/
+
+static unsigned long long strtod_unpack(unsigned long long xbits,
+                                        FAR int *xexp)
+{
+  unsigned long long xmant = xbits & 0x000fffffffffffffull;
+  int biased = (int)(xbits >> 52);
+
+  if (biased == 0)
+    {
+      *xexp = -1074;
+      return xmant;
+    }
+
+  *xexp = biased - 1075;
+  return xmant | (1ull << 52);
+}
+
+/****************************************************************************
+ * Name: strtod_cmphalf
+ *
+ * Description:
+ *   Compare the decimal value (mant + half/2) * 10^exponent with the point
+ *   halfway between the non-negative double with the bit pattern 'xbits'
+ *   and the next larger double.
+ *
+ * Returned Value:
+ *   Less than, equal to, or greater than zero if the decimal value is less
+ *   than, equal to, or greater than the halfway point.
+ *
+ ****************************************************************************/
+
+static int strtod_cmphalf(unsigned long long mant, int half, int exponent,
+                          unsigned long long xbits)
+{
+  unsigned long long xmant;
+  int xexp;
+
+  /* The double is xmant * 2^xexp and the halfway point is
+   * (2 * xmant + 1) * 2^(xexp - 1).
+   */
+
+  xmant = strtod_unpack(xbits, &xexp);
+  return strtod_cmp(mant, half, exponent, 2 * xmant + 1, xexp - 1);
+}
+#endif /* CONFIG_HAVE_LONG_LONG */
+
+/****************************************************************************
+ * Name: strtod_parse
+ *
+ * Description:
+ *   Parse the decimal number at the beginning of 'str'.
+ *
+ * Returned Value:
+ *   A pointer to the character following the number.
+ *
+ ****************************************************************************/
+
+static FAR char *strtod_parse(FAR const char *str,
+                              FAR struct strtod_num_s *num)
 {
-  double number;
-  int exponent;
-  int negative;
   FAR char *p = (FAR char *) str;
-  double p10;
+  bool expneg;
+  int digit;
   int n;
-  int num_digits;
-  int num_decimals;
-  const double infinite = 1.0/0.0;
 
   /* Skip leading whitespace */
 
@@ -108,11 +474,11 @@ double strtod(FAR const char *str, FAR char **endptr)
 
   /* Handle optional sign */
 
-  negative = 0;
+  num->negative = false;
   switch (*p)
     {
     case '-':
-      negative = 1; /* Fall through to increment position */
+      num->negative = true; /* Fall through to increment position */
       /* FALLTHROUGH */
     case '+':
       p++;
@@ -121,18 +487,32 @@ double strtod(FAR const char *str, FAR char **endptr)
       break;
     }
 
-  number       = 0.;
-  exponent     = 0;
-  num_digits   = 0;
-  num_decimals = 0;
+  num->mant       = 0;
+  num->exponent   = 0;
+  num->num_digits = 0;
+  num->num_sig    = 0;
+  num->inexact    = false;
 
-  /* Process string of digits */
+  /* Process string of digits.  Leading zeroes are not significant. */
 
   while (isdigit(*p))
     {
-      number = number * 10. + (*p - '0');
-      p++;
-      num_digits++;
+      digit = *p++ - '0';
+      num->num_digits++;
+
+      if (num->num_sig < MANT_DIGITS)
+        {
+          num->mant = num->mant * 10 + digit;
+          if (num->mant != 0)
+            {
+              num->num_sig++;
+            }
+        }
+      else
+        {
+          num->exponent++;
+          num->inexact |= (digit != 0);
+        }
     }
 
   /* Process decimal part */
@@ -143,105 +523,239 @@ double strtod(FAR const char *str, FAR char **endptr)
 
       while (isdigit(*p))
         {
-          number = number * 10. + (*p - '0');
-          p++;
-          num_digits++;
-          num_decimals++;
-        }
+          digit = *p++ - '0';
+          num->num_digits++;
 
-      exponent -= num_decimals;
-    }
-
-  if (num_digits == 0)
-    {
-      set_errno(ERANGE);
-      number = 0.0;
-      goto errout;
+          if (num->num_sig < MANT_DIGITS)
+            {
+              num->mant = num->mant * 10 + digit;
+              num->exponent--;
+              if (num->mant != 0)
+                {
+                  num->num_sig++;
+                }
+            }
+          else
+            {
+              num->inexact |= (digit != 0);
+            }
+        }
     }
 
-  /* Correct for sign */
+  /* Not a number unless there are digits in the mantissa */
 
-  if (negative)
+  if (num->num_digits == 0)
     {
-      number = -number;
+      return p;
     }
 
-  /* Process an exponent string */
+  /* Process an exponent string, if there are digits in it */
 
-  if (*p == 'e' || *p == 'E')
+  if ((*p == 'e' || *p == 'E') &&
+      (isdigit(p[1]) ||
+       ((p[1] == '-' || p[1] == '+') && isdigit(p[2]))))
     {
       /* Handle optional sign */
 
-      negative = 0;
-      switch (*++p)
+      p++;
+      expneg = (*p == '-');
+      if (*p == '-' || *p == '+')
         {
-        case '-':
-          negative = 1;   /* Fall through to increment pos */
-          /* FALLTHROUGH */
-        case '+':
           p++;
-          /* FALLTHROUGH */
-        default:
-          break;
         }
 
-      /* Process string of digits */
+      /* Process string of digits, saturating absurdly large exponents */
 
       n = 0;
       while (isdigit(*p))
         {
-          n = n * 10 + (*p - '0');
+          if (n < 100000)
+            {
+              n = n * 10 + (*p - '0');
+            }
+
           p++;
         }
 
-      if (negative)
-        {
-          exponent -= n;
-        }
-      else
-        {
-          exponent += n;
-        }
+      num->exponent += expneg ? -n : n;
     }
 
-  if (exponent < __DBL_MIN_EXP__ ||
-      exponent > __DBL_MAX_EXP__)
+  return p;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/***************************************************(************************
+ * Name: strtod
+ *
+ * Description:
+ *   Convert a string to a double value.
+ *
+ *   Up to MANT_DIGITS significant digits are accumulated exactly in an
+ *   integer.  If the mantissa and the decimal exponent are small enough
+ *   that both are exact doubles, a single multiplication or division gives
+ *   the correctly rounded result.  That covers most numbers seen in
+ *   practice.  Otherwise, the mantissa is scaled by powers of ten to get
+ *   an estimate, which is then corrected by comparing the exact decimal
+ *   value with the halfway points to the neighbouring doubles.
+ *
+ *   The result is correctly rounded (to even on ties) except that, if
+ *   there are more than MANT_DIGITS significant digits, the discarded
+ *   digits are only taken into account as a value halfway between two
+ *   MANT_DIGITS numbers.  Without CONFIG_HAVE_LONG_LONG the estimate is
+ *   not corrected and may be off by a few units in the last place.
+ *
+ ****************************************************************************/
+
+double strtod(FAR const char *str, FAR char **endptr)
+{
+  struct strtod_num_s num;
+  strtod_mant_t mant;
+  double number;
+  bool inexact;
+#ifdef CONFIG_HAVE_LONG_LONG
+  unsigned long long bits;
+#endif
+  FAR char *p;
+  int exponent;
+  int num_sig;
+  int n;
+  int i;
+
+  p = strtod_parse(str, &num);
+  if (num.num_digits == 0)
     {
       set_errno(ERANGE);
-      number = infinite;
+      number = 0.0;
       goto errout;
     }
 
+  mant     = num.mant;
+  exponent = num.exponent;
+  num_sig  = num.num_sig;
+  inexact  = num.inexact;
+
   /* Scale the result */
 
-  p10 = 10.;
-  n = exponent;
-  if (n < 0)
+  number = (double)mant;
+  if (mant == 0)
+    {
+      /* Zero, whatever the exponent */
+    }
+  else if (!inexact && mant <= MANT_EXACT_MAX &&
+           exponent >= -POW10_EXACT_MAX && exponent <= POW10_EXACT_MAX)
+    {
+      /* Both operands are exact, so the one rounding in this operation
+       * gives the correctly rounded result.
+       */
+
+      if (exponent < 0)
+        {
+          number /= g_pow10[-exponent];
+        }
+      else
+        {
+          number *= g_pow10[exponent];
+        }
+    }
+  else if (exponent + num_sig > DEXP_MAX)
     {
-      n = -n;
+      /* Certain overflow */
+
+      number = 1.0/0.0;
+      set_errno(ERANGE);
     }
+  else if (exponent + num_sig < DEXP_MIN)
+    {
+      /* Certain underflow */
 
-  while (n)
+      number = 0.0;
+      set_errno(ERANGE);
+    }
+  else
     {
-      if (n & 1)
+      /* Get an estimate within a few units in the last place by scaling
+       * with the tables of powers of ten.
+       */
+
+      n = exponent < 0 ? -exponent : exponent;
+      if (exponent < 0)
         {
-          if (exponent < 0)
+          number /= g_pow10[n & 15];
+          for (n >>= 4, i = 0; n != 0; n >>= 1, i++)
             {
-              number /= p10;
+              if ((n & 1) != 0)
+                {
+                  number /= g_bigpow10[i];
+                }
             }
-          else
+        }
+      else
+        {
+          number *= g_pow10[n & 15];
+          for (n >>= 4, i = 0; n != 0; n >>= 1, i++)
+            {
+              if ((n & 1) != 0)
+                {
+                  number *= g_bigpow10[i];
+                }
+            }
+        }
+
+#ifdef CONFIG_HAVE_LONG_LONG
+      /* Then correct the estimate by comparing the exact decimal value
+       * with the halfway points to the neighbouring doubles.  Exact ties
+       * are rounded to the even neighbour.
+       */
+
+      bits = strtod_bits(number);
+      if (bits >= DBL_INF_BITS)
+        {
+          bits = DBL_INF_BITS - 1;
+        }
+      else if (bits == 0)
+        {
+          bits = 1;
+        }
+
+      for (n = 0; bits < DBL_INF_BITS; n++)
+        {
+          i = strtod_cmphalf(mant, inexact, exponent, bits);
+          if (i < 0 || (i == 0 && (bits & 1) == 0))
+            {
+              break;
+            }
+
+          bits++;
+        }
+
+      while (n == 0 && bits > 0)
+        {
+          i = strtod_cmphalf(mant, inexact, exponent, bits - 1);
+          if (i > 0 || (i == 0 && (bits & 1) == 0))
             {
-              number *= p10;
+              break;
             }
+
+          bits--;
         }
 
-      n >>= 1;
-      p10 *= p10;
+      number = strtod_frombits(bits);
+#endif
+
+      if (!is_real(number) || number == 0.0)
+        {
+          set_errno(ERANGE);
+        }
     }
 
-  if (!is_real(number))
+  /* Correct for sign */
+
+  if (num.negative)
     {
-      set_errno(ERANGE);
+      number = -number;
     }
 
 errout:
@@ -253,4 +767,128 @@ errout:
   return number;
 }
 
+/****************************************************************************
+ * Name: lib_strtodcmp
+ *
+ * Description:
+ *   Compare the magnitude of the decimal number at the beginning of 'str'
+ *   exactly with the magnitude of 'value'.  This is used by strtof() to
+ *   round correctly when the double nearest to the decimal number lies
+ *   exactly halfway between two floats.  Unlike strtod(), all significant
+ *   digits are used, up to CMP_DIGITS.
+ *
+ * Input Parameters:
+ *   str   - The string that was converted by strtod()
+ *   value - A non-zero double within the range of float:  Any float or any
+ *           point halfway between two floats.
+ *
+ * Returned Value:
+ *   Less than, equal to, or greater than zero if the magnitude of the
+ *   decimal number is less than, equal to, or greater than that of value.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_HAVE_LONG_LONG
+int lib_strtodcmp(FAR const char *str, double value)
+{
+  struct strtod_num_s num;
+  struct strtod_big_s lhs;
+  struct strtod_big_s rhs;
+  FAR const char *p = str;
+  unsigned long long vmant;
+  bool sticky;
+  bool dot;
+  int ndigits;
+  int exponent;
+  int vexp;
+  int pow2l;
+  int pow2r;
+  int pow2;
+  int ret;
+
+  /* The position of the leading digit comes from strtod_parse() */
+
+  (void)strtod_parse(str, &num);
+  if (num.mant == 0)
+    {
+      return -1;
+    }
+
+  exponent = num.exponent + num.num_sig;
+  if (exponent > FLT_DEXP_MAX)
+    {
+      return 1;
+    }
+  else if (exponent < FLT_DEXP_MIN)
+    {
+      return -1;
+    }
+
+  /* Collect the significant digits in lhs.  Any non-zero digits beyond
+   * CMP_DIGITS only make the number larger than the digits collected.
+   */
+
+  while (isspace(*p) || *p == '-' || *p == '+')
+    {
+      p++;
+    }
+
+  lhs.nwords = 0;
+  ndigits    = 0;
+  sticky     = false;
+
+  for (dot = false; isdigit(*p) || (*p == '.' && !dot); p++)
+    {
+      if (*p == '.')
+        {
+          dot = true;
+          continue;
+        }
+
+      if (ndigits < CMP_DIGITS)
+        {
+          big_mul(&lhs, 10, *p - '0');
+          if (lhs.nwords > 0)
+            {
+              ndigits++;
+            }
+        }
+      else
+        {
+          sticky |= (*p != '0');
+        }
+    }
+
+  /* Compare lhs * 5^exponent * 2^exponent with vmant * 2^vexp, moving
+   * negative powers to the other side and cancelling the common power of
+   * two.
+   */
+
+  exponent -= ndigits;
+  vmant     = strtod_unpack(strtod_bits(value) & ~(1ull << 63), &vexp);
+
+  pow2l = exponent;
+  pow2r = vexp;
+  if (exponent < 0)
+    {
+      pow2l  = 0;
+      pow2r -= exponent;
+    }
+
+  pow2   = pow2l < pow2r ? pow2l : pow2r;
+  pow2l -= pow2;
+  pow2r -= pow2;
+
+  big_scale(&lhs, exponent > 0 ? exponent : 0, pow2l);
+  big_init(&rhs, vmant, exponent < 0 ? -exponent : 0, pow2r);
+
+  /* The value has fewer than CMP_DIGITS significant digits, so the
+   * discarded digits can only matter if the rest is equal.
+   */
+
+  ret = big_cmp(&lhs, &rhs);
+  return ret == 0 && sticky ? 1 : ret;
+}
+#endif
+
 #endif /* CONFIG_HAVE_DOUBLE */
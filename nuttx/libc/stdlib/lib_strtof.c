@@ -2,7 +2,7 @@
  * libc/stdlib/lib_strtof.c
  * Convert string to float
  *
- *   Copyright (C) 2016 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2016, 2018 Gregory Nutt. All rights reserved.
  *
  * A pretty straight forward conversion fo strtod():
  *
@@ -44,10 +44,14 @@
 #include <nuttx/config.h>
 #include <nuttx/compiler.h>
 
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <ctype.h>
 #include <errno.h>
 
+#include "libc.h"
+
 /****************************************************************************
  * Pre-processor definitions
  ****************************************************************************/
@@ -67,6 +71,57 @@
 #  define __FLT_MAX_EXP__ (128)
 #endif
 
+/* Up to this many significant digits are accumulated in an unsigned long.
+ * Integers up to MANT_EXACT_MAX are exactly representable as a float.
+ */
+
+#define MANT_DIGITS      9
+#define MANT_EXACT_MAX   (1ul << 24)
+
+/* The largest power of ten that is exactly representable as a float */
+
+#define POW10_EXACT_MAX  10
+
+/* The bit pattern of +Infinity and 2^128, the value that it replaces when
+ * rounding
+ */
+
+#define FLT_INF_BITS     0x7f800000
+#define FLT_INF_VALUE    340282366920938463463374607431768211456.0
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* Access to the bits of a float */
+
+union strtof_bits_u
+{
+  float    f;
+  uint32_t w;
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* Exact powers of ten, 1e0 through 1e10 */
+
+static const float g_pow10f[POW10_EXACT_MAX + 1] =
+{
+  1e0F,
+  1e1F,
+  1e2F,
+  1e3F,
+  1e4F,
+  1e5F,
+  1e6F,
+  1e7F,
+  1e8F,
+  1e9F,
+  1e10F
+};
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -77,6 +132,67 @@ static inline int is_real(float x)
   return (x < infinite) && (x >= -infinite);
 }
 
+/****************************************************************************
+ * Name: strtof_round
+ *
+ * Description:
+ *   Round the double nearest to the decimal number in 'str' to float.
+ *
+ *   Rounding the double is not always the same as rounding the decimal
+ *   number:  If the double lies exactly halfway between two floats, the
+ *   decimal number may lie slightly above or below that point.  In that
+ *   case the decimal number is compared with the double exactly.
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_HAVE_DOUBLE) && defined(CONFIG_HAVE_LONG_LONG)
+static float strtof_round(FAR const char *str, double dnumber)
+{
+  union strtof_bits_u lo;
+  union strtof_bits_u hi;
+  double dlo;
+  double dhi;
+  double mag;
+  int cmp;
+
+  mag = dnumber < 0.0 ? -dnumber : dnumber;
+  lo.f = (float)mag;
+  if ((double)lo.f == mag)
+    {
+      return (float)dnumber;
+    }
+
+  /* Get the floats on either side of the double */
+
+  if ((double)lo.f > mag)
+    {
+      lo.w--;
+    }
+
+  hi.w = lo.w + 1;
+  dlo  = (double)lo.f;
+  dhi  = hi.w == FLT_INF_BITS ? FLT_INF_VALUE : (double)hi.f;
+
+  /* Only the halfway point is a problem.  The sum is exact in double. */
+
+  if (mag != (dlo + dhi) / 2.0)
+    {
+      return (float)dnumber;
+    }
+
+  cmp = lib_strtodcmp(str, mag);
+  if (cmp == 0)
+    {
+      /* A true tie:  Round to even */
+
+      cmp = (lo.w & 1) != 0 ? 1 : -1;
+    }
+
+  mag = cmp > 0 ? (double)hi.f : dlo;
+  return dnumber < 0.0 ? -(float)mag : (float)mag;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -85,21 +201,39 @@ static inline int is_real(float x)
  * Name: strtof
  *
  * Description:
- *   Convert a string to a float value
+ *   Convert a string to a float value.
+ *
+ *   If there are no more than MANT_DIGITS significant digits and the
+ *   mantissa and the power of ten are both exact floats, a single
+ *   multiplication or division gives the correctly rounded result.
+ *   Otherwise, the value is converted by strtod() and rounded to float.
+ *   Rounding twice can give the wrong result when the double lies exactly
+ *   halfway between two floats; the decimal number is then compared
+ *   exactly with the halfway point.  That correction requires
+ *   CONFIG_HAVE_LONG_LONG.  Without CONFIG_HAVE_DOUBLE, the value is
+ *   scaled in single precision and may be off by a few units in the last
+ *   place.
  *
  ****************************************************************************/
 
 float strtof(FAR const char *str, FAR char **endptr)
 {
+  unsigned long mant;
   float number;
-  int exponent;
-  int negative;
+  bool negative;
+  bool inexact;
+  bool expneg;
   FAR char *p = (FAR char *) str;
-  float p10;
-  int n;
+  int exponent;
   int num_digits;
-  int num_decimals;
-  const float infinite = 1.0F/0.0F;
+  int num_sig;
+  int digit;
+  int n;
+#ifdef CONFIG_HAVE_DOUBLE
+  double dnumber;
+#else
+  float p10;
+#endif
 
   /* Skip leading whitespace */
 
@@ -110,11 +244,11 @@ float strtof(FAR const char *str, FAR char **endptr)
 
   /* Handle optional sign */
 
-  negative = 0;
+  negative = false;
   switch (*p)
     {
     case '-':
-      negative = 1; /* Fall through to increment position */
+      negative = true; /* Fall through to increment position */
       /* FALLTHROUGH */
     case '+':
       p++;
@@ -123,18 +257,32 @@ float strtof(FAR const char *str, FAR char **endptr)
       break;
     }
 
-  number       = 0.0F;
-  exponent     = 0;
-  num_digits   = 0;
-  num_decimals = 0;
+  mant       = 0;
+  exponent   = 0;
+  num_digits = 0;
+  num_sig    = 0;
+  inexact    = false;
 
-  /* Process string of digits */
+  /* Process string of digits.  Leading zeroes are not significant. */
 
   while (isdigit(*p))
     {
-      number = number * 10.0F + (float)(*p - '0');
-      p++;
+      digit = *p++ - '0';
       num_digits++;
+
+      if (num_sig < MANT_DIGITS)
+        {
+          mant = mant * 10 + digit;
+          if (mant != 0)
+            {
+              num_sig++;
+            }
+        }
+      else
+        {
+          exponent++;
+          inexact |= (digit != 0);
+        }
     }
 
   /* Process decimal part */
@@ -145,13 +293,23 @@ float strtof(FAR const char *str, FAR char **endptr)
 
       while (isdigit(*p))
         {
-          number = number * 10.0F + (float)(*p - '0');
-          p++;
+          digit = *p++ - '0';
           num_digits++;
-          num_decimals++;
-        }
 
-      exponent -= num_decimals;
+          if (num_sig < MANT_DIGITS)
+            {
+              mant = mant * 10 + digit;
+              exponent--;
+              if (mant != 0)
+                {
+                  num_sig++;
+                }
+            }
+          else
+            {
+              inexact |= (digit != 0);
+            }
+        }
     }
 
   if (num_digits == 0)
@@ -161,89 +319,126 @@ float strtof(FAR const char *str, FAR char **endptr)
       goto errout;
     }
 
-  /* Correct for sign */
-
-  if (negative)
-    {
-      number = -number;
-    }
-
-  /* Process an exponent string */
+  /* Process an exponent string, if there are digits in it */
 
-  if (*p == 'e' || *p == 'E')
+  if ((*p == 'e' || *p == 'E') &&
+      (isdigit(p[1]) ||
+       ((p[1] == '-' || p[1] == '+') && isdigit(p[2]))))
     {
       /* Handle optional sign */
 
-      negative = 0;
-      switch (*++p)
+      p++;
+      expneg = (*p == '-');
+      if (*p == '-' || *p == '+')
         {
-        case '-':
-          negative = 1;   /* Fall through to increment pos */
-          /* FALLTHROUGH */
-        case '+':
           p++;
-          /* FALLTHROUGH */
-        default:
-          break;
         }
 
-      /* Process string of digits */
+      /* Process string of digits, saturating absurdly large exponents */
 
       n = 0;
       while (isdigit(*p))
         {
-          n = n * 10 + (*p - '0');
+          if (n < 100000)
+            {
+              n = n * 10 + (*p - '0');
+            }
+
           p++;
         }
 
-      if (negative)
+      exponent += expneg ? -n : n;
+    }
+
+  if (mant == 0)
+    {
+      number = 0.0F;
+    }
+  else if (!inexact && mant <= MANT_EXACT_MAX &&
+           exponent >= -POW10_EXACT_MAX && exponent <= POW10_EXACT_MAX)
+    {
+      /* Both operands are exact, so the one rounding in this operation
+       * gives the correctly rounded result.
+       */
+
+      number = (float)mant;
+      if (exponent < 0)
         {
-          exponent -= n;
+          number /= g_pow10f[-exponent];
         }
       else
         {
-          exponent += n;
+          number *= g_pow10f[exponent];
         }
     }
-
-  if (exponent < __FLT_MIN_EXP__ ||
-      exponent > __FLT_MAX_EXP__)
+  else
     {
-      set_errno(ERANGE);
-      number = infinite;
-      goto errout;
-    }
-
-  /* Scale the result */
+#ifdef CONFIG_HAVE_DOUBLE
+      /* Let strtod() do the work and round its result to float */
+
+      dnumber = strtod(str, endptr);
+#ifdef CONFIG_HAVE_LONG_LONG
+      number  = strtof_round(str, dnumber);
+#else
+      number  = (float)dnumber;
+#endif
 
-  p10 = 10.0F;
-  n = exponent;
-  if (n < 0)
-    {
-      n = -n;
-    }
+      if (!is_real(number) || (number == 0.0F && dnumber != 0.0))
+        {
+          set_errno(ERANGE);
+        }
 
-  while (n)
-    {
-      if (n & 1)
+      return number;
+#else
+      if (exponent < __FLT_MIN_EXP__ ||
+          exponent > __FLT_MAX_EXP__)
         {
-          if (exponent < 0)
+          set_errno(ERANGE);
+          number = 1.0F/0.0F;
+        }
+      else
+        {
+          /* Scale the result */
+
+          number = (float)mant;
+          p10 = 10.0F;
+          n = exponent;
+          if (n < 0)
             {
-              number /= p10;
+              n = -n;
             }
-          else
+
+          while (n)
             {
-              number *= p10;
+              if (n & 1)
+                {
+                  if (exponent < 0)
+                    {
+                      number /= p10;
+                    }
+                  else
+                    {
+                      number *= p10;
+                    }
+                }
+
+              n >>= 1;
+              p10 *= p10;
             }
-        }
 
-      n >>= 1;
-      p10 *= p10;
+          if (!is_real(number))
+            {
+              set_errno(ERANGE);
+            }
+        }
+#endif
     }
 
-  if (!is_real(number))
+  /* Correct for sign */
+
+  if (negative)
     {
-      set_errno(ERANGE);
+      number = -number;
     }
 
 errout:
@@ -1,7 +1,7 @@
 /****************************************************************************
  * libc/string/lib_memchr.c
  *
- *   Copyright (C) 2012 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2012, 2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -39,8 +39,11 @@
 
 #include <nuttx/config.h>
 
+#include <stdint.h>
 #include <string.h>
 
+#include "string/lib_string.h"
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -65,6 +68,29 @@ FAR void *memchr(FAR const void *s, int c, size_t n)
 
   if (s)
     {
+#ifdef CONFIG_LIBC_STRING_OPTSPEED
+      uintptr_t mask = LIB_REPEAT(c);
+
+      /* Check byte-by-byte up to the first word boundary */
+
+      for (; !LIB_ALIGNED(p) && n > 0; p++, n--)
+        {
+          if (*p == (unsigned char)c)
+            {
+              return (FAR void *)p;
+            }
+        }
+
+      /* Then skip over whole words that do not contain the byte */
+
+      while (n >= LIB_WORDSIZE &&
+             !LIB_HASZERO(*(FAR const uintptr_t *)p ^ mask))
+        {
+          p += LIB_WORDSIZE;
+          n -= LIB_WORDSIZE;
+        }
+#endif
+
       while (n--)
         {
           if (*p == (unsigned char)c)
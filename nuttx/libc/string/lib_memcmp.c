@@ -1,7 +1,7 @@
 /****************************************************************************
  * libc/string/lib_memcmp.c
  *
- *   Copyright (C) 2007, 2011-2012 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007, 2011-2012, 2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -39,8 +39,12 @@
 
 #include <nuttx/config.h>
 #include <sys/types.h>
+
+#include <stdint.h>
 #include <string.h>
 
+#include "string/lib_string.h"
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -48,8 +52,36 @@
 #ifndef CONFIG_LIBC_ARCH_MEMCMP
 int memcmp(FAR const void *s1, FAR const void *s2, size_t n)
 {
-  unsigned char *p1 = (unsigned char *)s1;
-  unsigned char *p2 = (unsigned char *)s2;
+  FAR const unsigned char *p1 = (FAR const unsigned char *)s1;
+  FAR const unsigned char *p2 = (FAR const unsigned char *)s2;
+
+#ifdef CONFIG_LIBC_STRING_OPTSPEED
+  /* If both buffers can be aligned, skip over the leading equal bytes a
+   * word at a time.  The byte loop below then locates the first differing
+   * byte (if any).
+   */
+
+  if (n >= LIB_WORDSIZE && LIB_COALIGNED(p1, p2))
+    {
+      while (!LIB_ALIGNED(p1) && *p1 == *p2)
+        {
+          p1++;
+          p2++;
+          n--;
+        }
+
+      if (LIB_ALIGNED(p1))
+        {
+          while (n >= LIB_WORDSIZE &&
+                 *(FAR const uintptr_t *)p1 == *(FAR const uintptr_t *)p2)
+            {
+              p1 += LIB_WORDSIZE;
+              p2 += LIB_WORDSIZE;
+              n  -= LIB_WORDSIZE;
+            }
+        }
+    }
+#endif
 
   while (n-- > 0)
     {
@@ -1,7 +1,7 @@
 /****************************************************************************
  * libc/string/lib_memcpy.c
  *
- *   Copyright (C) 2007, 2011 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007, 2011, 2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -39,8 +39,12 @@
 
 #include <nuttx/config.h>
 #include <sys/types.h>
+
+#include <stdint.h>
 #include <string.h>
 
+#include "string/lib_string.h"
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -54,6 +58,96 @@ FAR void *memcpy(FAR void *dest, FAR const void *src, size_t n)
 {
   FAR unsigned char *pout = (FAR unsigned char *)dest;
   FAR unsigned char *pin  = (FAR unsigned char *)src;
+
+#ifdef CONFIG_LIBC_STRING_OPTSPEED
+  /* Short copies are not worth the set-up overhead of the word copies */
+
+  if (n >= 2 * LIB_WORDSIZE)
+    {
+      FAR const uintptr_t *win;
+      FAR uintptr_t *wout;
+
+      /* Align the source to a word boundary.  This leaves more than one
+       * word to be copied.
+       */
+
+      while (!LIB_ALIGNED(pin))
+        {
+          *pout++ = *pin++;
+          n--;
+        }
+
+      win = (FAR const uintptr_t *)pin;
+
+      if (LIB_ALIGNED(pout))
+        {
+          /* Source and destination are both aligned:  Copy whole words,
+           * four at a time as long as possible.
+           */
+
+          wout = (FAR uintptr_t *)pout;
+
+          while (n >= 4 * LIB_WORDSIZE)
+            {
+              wout[0] = win[0];
+              wout[1] = win[1];
+              wout[2] = win[2];
+              wout[3] = win[3];
+              wout   += 4;
+              win    += 4;
+              n      -= 4 * LIB_WORDSIZE;
+            }
+
+          while (n >= LIB_WORDSIZE)
+            {
+              *wout++ = *win++;
+              n      -= LIB_WORDSIZE;
+            }
+
+          pout = (FAR unsigned char *)wout;
+          pin  = (FAR unsigned char *)win;
+        }
+      else
+        {
+          /* The destination is misaligned with respect to the source.
+           * Copy the 'skip' bytes needed to align the destination, then
+           * build each aligned destination word from the two aligned
+           * source words that it straddles.  All loads and stores are
+           * aligned and no byte outside of the source buffer is read.
+           */
+
+          unsigned int skip = LIB_WORDSIZE - ((uintptr_t)pout & LIB_WORDMASK);
+          unsigned int down = 8 * skip;
+          unsigned int up   = 8 * (LIB_WORDSIZE - skip);
+          uintptr_t prev;
+          uintptr_t next;
+
+          prev = *win++;
+          n   -= skip;
+
+          while (skip-- > 0)
+            {
+              *pout++ = *pin++;
+            }
+
+          wout = (FAR uintptr_t *)pout;
+
+          while (n >= 2 * LIB_WORDSIZE)
+            {
+              next    = *win++;
+              *wout++ = LIB_SHIFTDOWN(prev, down) | LIB_SHIFTUP(next, up);
+              prev    = next;
+              n      -= LIB_WORDSIZE;
+            }
+
+          pin  += (FAR unsigned char *)wout - pout;
+          pout  = (FAR unsigned char *)wout;
+        }
+    }
+#endif
+
+  /* Copy the remaining bytes (or all bytes if optimized for size) */
+
   while (n-- > 0) *pout++ = *pin++;
   return dest;
 }
@@ -1,7 +1,7 @@
 /****************************************************************************
  * libc/string/lib_memmove.c
  *
- *   Copyright (C) 2007, 2011 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007, 2011, 2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -39,8 +39,12 @@
 
 #include <nuttx/config.h>
 #include <sys/types.h>
+
+#include <stdint.h>
 #include <string.h>
 
+#include "string/lib_string.h"
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -51,11 +55,45 @@ FAR void *memmove(FAR void *dest, FAR const void *src, size_t count)
   FAR char *tmp;
   FAR char *s;
 
+#ifdef CONFIG_LIBC_STRING_OPTSPEED
+  /* Regions that do not overlap can be handled by memcpy() */
+
+  if ((FAR char *)dest + count <= (FAR char *)src ||
+      (FAR char *)src + count <= (FAR char *)dest)
+    {
+      return memcpy(dest, src, count);
+    }
+#endif
+
   if (dest <= src)
     {
       tmp = (FAR char *) dest;
       s   = (FAR char *) src;
 
+#ifdef CONFIG_LIBC_STRING_OPTSPEED
+      /* Move whole words if the source and destination can both be
+       * aligned.  Each word is read before any byte of it can be
+       * overwritten, so this is safe for overlapping regions.
+       */
+
+      if (count >= LIB_WORDSIZE && LIB_COALIGNED(tmp, s))
+        {
+          while (!LIB_ALIGNED(tmp))
+            {
+              *tmp++ = *s++;
+              count--;
+            }
+
+          while (count >= LIB_WORDSIZE)
+            {
+              *(FAR uintptr_t *)tmp = *(FAR uintptr_t *)s;
+              tmp   += LIB_WORDSIZE;
+              s     += LIB_WORDSIZE;
+              count -= LIB_WORDSIZE;
+            }
+        }
+#endif
+
       while (count--)
         {
           *tmp++ = *s++;
@@ -66,6 +104,27 @@ FAR void *memmove(FAR void *dest, FAR const void *src, size_t count)
       tmp = (FAR char *) dest + count;
       s   = (FAR char *) src + count;
 
+#ifdef CONFIG_LIBC_STRING_OPTSPEED
+      /* Same as above, but moving backward from the end */
+
+      if (count >= LIB_WORDSIZE && LIB_COALIGNED(tmp, s))
+        {
+          while (!LIB_ALIGNED(tmp))
+            {
+              *--tmp = *--s;
+              count--;
+            }
+
+          while (count >= LIB_WORDSIZE)
+            {
+              tmp   -= LIB_WORDSIZE;
+              s     -= LIB_WORDSIZE;
+              count -= LIB_WORDSIZE;
+              *(FAR uintptr_t *)tmp = *(FAR uintptr_t *)s;
+            }
+        }
+#endif
+
       while (count--)
         {
           *--tmp = *--s;
@@ -1,7 +1,7 @@
 /****************************************************************************
  * libc/string/lib_strchr.c
  *
- *   Copyright (C) 2007, 2009, 2011-2012 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007, 2009, 2011-2012, 2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -39,8 +39,11 @@
 
 #include <nuttx/config.h>
 
+#include <stdint.h>
 #include <string.h>
 
+#include "string/lib_string.h"
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -64,9 +67,46 @@ FAR char *strchr(FAR const char *s, int c)
 {
   if (s)
     {
+#ifdef CONFIG_LIBC_STRING_OPTSPEED
+      FAR const uintptr_t *ws;
+      uintptr_t mask = LIB_REPEAT(c);
+      uintptr_t w;
+
+      /* Check byte-by-byte up to the first word boundary */
+
+      for (; !LIB_ALIGNED(s); s++)
+        {
+          if (*s == (char)c)
+            {
+              return (FAR char *)s;
+            }
+
+          if (!*s)
+            {
+              return NULL;
+            }
+        }
+
+      /* Then skip over whole words that contain neither the character nor
+       * the terminator.  The byte loop below finishes the search within
+       * the word where this stops.
+       */
+
+      for (ws = (FAR const uintptr_t *)s; ; ws++)
+        {
+          w = *ws;
+          if (LIB_HASZERO(w) || LIB_HASZERO(w ^ mask))
+            {
+              break;
+            }
+        }
+
+      s = (FAR const char *)ws;
+#endif
+
       for (; ; s++)
         {
-          if (*s == c)
+          if (*s == (char)c)
             {
               return (FAR char *)s;
             }
@@ -0,0 +1,98 @@
+/****************************************************************************
+ * libc/string/lib_string.h
+ *
+ *   Copyright (C) 2018 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __LIBC_STRING_LIB_STRING_H
+#define __LIBC_STRING_LIB_STRING_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+
+#ifdef CONFIG_LIBC_STRING_OPTSPEED
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The speed-optimized string functions operate on naturally aligned machine
+ * words.  uintptr_t is used as the word type since it is always the native
+ * register width of the architecture.
+ */
+
+#define LIB_WORDSIZE        sizeof(uintptr_t)
+#define LIB_WORDMASK        (LIB_WORDSIZE - 1)
+
+/* Non-zero if the address 'p' is aligned to a word boundary */
+
+#define LIB_ALIGNED(p)      (((uintptr_t)(p) & LIB_WORDMASK) == 0)
+
+/* Non-zero if the addresses 'p1' and 'p2' have the same word alignment */
+
+#define LIB_COALIGNED(p1,p2) \
+  ((((uintptr_t)(p1) ^ (uintptr_t)(p2)) & LIB_WORDMASK) == 0)
+
+/* Replicate the byte 'c' into every byte of a word */
+
+#define LIB_ONES            ((uintptr_t)-1 / 0xff)
+#define LIB_HIGHS           (LIB_ONES << 7)
+#define LIB_REPEAT(c)       (LIB_ONES * (uint8_t)(c))
+
+/* Non-zero if any byte of the word 'w' is zero.  This is exact:  The result
+ * is non-zero if and only if some byte of 'w' is zero (although only the
+ * high bit of the first zero byte is guaranteed to be set).
+ */
+
+#define LIB_HASZERO(w)      (((w) - LIB_ONES) & ~(w) & LIB_HIGHS)
+
+/* Shift a word loaded from memory so that the byte at the higher address
+ * moves towards the lower address (LIB_SHIFTDOWN) or vice versa
+ * (LIB_SHIFTUP).  Used to merge two aligned source words into one
+ * misaligned destination word.
+ */
+
+#ifdef CONFIG_ENDIAN_BIG
+#  define LIB_SHIFTDOWN(w,b) ((w) << (b))
+#  define LIB_SHIFTUP(w,b)   ((w) >> (b))
+#else
+#  define LIB_SHIFTDOWN(w,b) ((w) >> (b))
+#  define LIB_SHIFTUP(w,b)   ((w) << (b))
+#endif
+
+#endif /* CONFIG_LIBC_STRING_OPTSPEED */
+#endif /* __LIBC_STRING_LIB_STRING_H */
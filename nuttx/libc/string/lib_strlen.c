@@ -1,7 +1,7 @@
 /****************************************************************************
  * libc/string/lib_strlen.c
  *
- *   Copyright (C) 2007, 2008, 2011 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007, 2008, 2011, 2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -39,8 +39,12 @@
 
 #include <nuttx/config.h>
 #include <sys/types.h>
+
+#include <stdint.h>
 #include <string.h>
 
+#include "string/lib_string.h"
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -49,7 +53,33 @@
 size_t strlen(const char *s)
 {
   const char *sc;
+
+#ifdef CONFIG_LIBC_STRING_OPTSPEED
+  FAR const uintptr_t *ws;
+
+  /* Check byte-by-byte up to the first word boundary */
+
+  for (sc = s; !LIB_ALIGNED(sc); sc++)
+    {
+      if (*sc == '\0')
+        {
+          return sc - s;
+        }
+    }
+
+  /* Then search for the word holding the terminator.  An aligned word
+   * never straddles a memory region boundary, so the bytes following the
+   * terminator in that word are always safe to read.
+   */
+
+  for (ws = (FAR const uintptr_t *)sc; !LIB_HASZERO(*ws); ws++);
+
+  /* And finally locate the terminator within that word */
+
+  for (sc = (FAR const char *)ws; *sc != '\0'; ++sc);
+#else
   for (sc = s; *sc != '\0'; ++sc);
+#endif
   return sc - s;
 }
 #endif
@@ -1,7 +1,7 @@
 /****************************************************************************
  * mm/iob/iob.h
  *
- *   Copyright (C) 2014, 2017 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2014, 2017-2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -83,10 +83,29 @@
 #endif
 #endif /* CONFIG_DEBUG_FEATURES && CONFIG_IOB_DEBUG */
 
+/* True if the I/O buffer was allocated from the heap and is not one of the
+ * pre-allocated I/O buffers.
+ */
+
+#ifdef CONFIG_IOB_ELASTIC
+#  define IOB_ISHEAP(iob) \
+     ((iob) < &g_iob_pool[0] || (iob) >= &g_iob_pool[CONFIG_IOB_NBUFFERS])
+#endif
+
+/* True if the I/O buffer is one of the large I/O buffers */
+
+#ifdef CONFIG_IOB_LARGE
+#  define IOB_ISLARGE(iob) ((iob)->io_bufsize > CONFIG_IOB_BUFSIZE)
+#endif
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
 
+/* The pool of pre-allocated I/O buffers */
+
+extern struct iob_s g_iob_pool[CONFIG_IOB_NBUFFERS];
+
 /* A list of all free, unallocated I/O buffers */
 
 extern FAR struct iob_s *g_iob_freelist;
@@ -95,6 +114,15 @@ extern FAR struct iob_s *g_iob_freelist;
 
 extern FAR struct iob_s *g_iob_committed;
 
+#ifdef CONFIG_IOB_LARGE
+/* A list of all free large I/O buffers and the number of them.  Protected
+ * by the critical section.  There is no waiting for large I/O buffers.
+ */
+
+extern FAR struct iob_s *g_iob_largefreelist;
+extern uint16_t g_iob_nlargefree;
+#endif
+
 #if CONFIG_IOB_NCHAINS > 0
 /* A list of all free, unallocated I/O buffer queue containers */
 
@@ -115,6 +143,14 @@ extern sem_t g_throttle_sem;  /* Counts available I/O buffers when throttled */
 extern sem_t g_qentry_sem;    /* Counts free I/O buffer queue containers */
 #endif
 
+/* I/O buffer usage statistics.  Protected by the critical section. */
+
+#ifdef CONFIG_IOB_ELASTIC
+extern uint16_t g_iob_nheap;  /* I/O buffers allocated from the heap */
+#endif
+extern uint16_t g_iob_maxused; /* Most I/O buffers in use at one time */
+extern uint32_t g_iob_nfailed; /* Allocations that found no I/O buffer */
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
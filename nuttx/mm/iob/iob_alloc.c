@@ -1,7 +1,7 @@
 /****************************************************************************
  * mm/iob/iob_alloc.c
  *
- *   Copyright (C) 2014, 2016-2017 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2014, 2016-2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -46,6 +46,7 @@
 #include <nuttx/irq.h>
 #include <nuttx/arch.h>
 #include <nuttx/sched.h>
+#include <nuttx/kmalloc.h>
 #include <nuttx/mm/iob.h>
 
 #include "iob.h"
@@ -54,6 +55,143 @@
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: iob_updatestats
+ *
+ * Description:
+ *   Record the number of I/O buffers in use after an allocation.  Must be
+ *   called from within the critical section.
+ *
+ ****************************************************************************/
+
+static inline void iob_updatestats(void)
+{
+  int inuse = CONFIG_IOB_NBUFFERS;
+
+#ifdef CONFIG_IOB_ELASTIC
+  inuse += g_iob_nheap;
+#endif
+  if (g_iob_sem.semcount > 0)
+    {
+      inuse -= g_iob_sem.semcount;
+    }
+
+  if (inuse > g_iob_maxused)
+    {
+      g_iob_maxused = (uint16_t)inuse;
+    }
+}
+
+/****************************************************************************
+ * Name: iob_tryalloc_heap
+ *
+ * Description:
+ *   Grow the I/O buffer pool by allocating a new I/O buffer from the heap.
+ *   Throttled allocations may not take the last CONFIG_IOB_THROTTLE
+ *   buffers that the pool may grow by.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_IOB_ELASTIC
+static FAR struct iob_s *iob_tryalloc_heap(bool throttled)
+{
+  FAR struct iob_s *iob;
+  irqstate_t flags;
+  int limit = CONFIG_IOB_MAXBUFFERS - CONFIG_IOB_NBUFFERS;
+
+#if CONFIG_IOB_THROTTLE > 0
+  if (throttled)
+    {
+      limit -= CONFIG_IOB_THROTTLE;
+    }
+#endif
+
+  /* The heap cannot be used from interrupt handlers or the IDLE thread */
+
+  if (up_interrupt_context() || sched_idletask())
+    {
+      return NULL;
+    }
+
+  /* Reserve the I/O buffer before allocating it */
+
+  flags = enter_critical_section();
+  if ((int)g_iob_nheap >= limit)
+    {
+      leave_critical_section(flags);
+      return NULL;
+    }
+
+  g_iob_nheap++;
+  leave_critical_section(flags);
+
+#ifdef CONFIG_IOB_LARGE
+  /* The data follows the I/O buffer structure in the same allocation */
+
+  iob = (FAR struct iob_s *)kmm_malloc(sizeof(struct iob_s) +
+                                       CONFIG_IOB_BUFSIZE);
+  if (iob != NULL)
+    {
+      iob->io_bufsize = CONFIG_IOB_BUFSIZE;
+      iob->io_data    = (FAR uint8_t *)(iob + 1);
+    }
+#else
+  iob = (FAR struct iob_s *)kmm_malloc(sizeof(struct iob_s));
+#endif
+
+  flags = enter_critical_section();
+  if (iob == NULL)
+    {
+      g_iob_nheap--;
+    }
+  else
+    {
+      iob_updatestats();
+    }
+
+  leave_critical_section(flags);
+  return iob;
+}
+#endif
+
+/****************************************************************************
+ * Name: iob_tryalloc_large
+ *
+ * Description:
+ *   Try to allocate one of the large I/O buffers.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_IOB_LARGE
+static FAR struct iob_s *iob_tryalloc_large(void)
+{
+  FAR struct iob_s *iob;
+  irqstate_t flags;
+
+  flags = enter_critical_section();
+  iob   = g_iob_largefreelist;
+  if (iob != NULL)
+    {
+      g_iob_largefreelist = iob->io_flink;
+      g_iob_nlargefree--;
+    }
+
+  leave_critical_section(flags);
+
+  if (iob != NULL)
+    {
+      /* Put the I/O buffer in a known state */
+
+      iob->io_flink  = NULL; /* Not in a chain */
+      iob->io_len    = 0;    /* Length of the data in the entry */
+      iob->io_offset = 0;    /* Offset to the beginning of data */
+      iob->io_pktlen = 0;    /* Total length of the packet */
+    }
+
+  return iob;
+}
+#endif
+
 /****************************************************************************
  * Name: iob_alloc_committed
  *
@@ -287,6 +425,7 @@ FAR struct iob_s *iob_tryalloc(bool throttled)
           g_throttle_sem.semcount--;
           DEBUGASSERT(g_throttle_sem.semcount >= -CONFIG_IOB_THROTTLE);
 #endif
+          iob_updatestats();
           leave_critical_section(flags);
 
           /* Put the I/O buffer in a known state */
@@ -300,5 +439,73 @@ FAR struct iob_s *iob_tryalloc(bool throttled)
     }
 
   leave_critical_section(flags);
+
+#ifdef CONFIG_IOB_ELASTIC
+  /* There is no free I/O buffer for this allocation.  Try to grow the
+   * pool.
+   */
+
+  iob = iob_tryalloc_heap(throttled);
+  if (iob != NULL)
+    {
+      iob->io_flink  = NULL; /* Not in a chain */
+      iob->io_len    = 0;    /* Length of the data in the entry */
+      iob->io_offset = 0;    /* Offset to the beginning of data */
+      iob->io_pktlen = 0;    /* Total length of the packet */
+      return iob;
+    }
+#endif
+
+  g_iob_nfailed++;
   return NULL;
 }
+
+/****************************************************************************
+ * Name: iob_alloc_size
+ *
+ * Description:
+ *   Allocate an I/O buffer for 'size' bytes of data.  A large I/O buffer is
+ *   used if 'size' does not fit in one normal I/O buffer and a large I/O
+ *   buffer is free.  Otherwise, this is the same as iob_alloc().
+ *
+ ****************************************************************************/
+
+FAR struct iob_s *iob_alloc_size(unsigned int size, bool throttled)
+{
+#ifdef CONFIG_IOB_LARGE
+  if (size > CONFIG_IOB_BUFSIZE)
+    {
+      FAR struct iob_s *iob = iob_tryalloc_large();
+      if (iob != NULL)
+        {
+          return iob;
+        }
+    }
+#endif
+
+  return iob_alloc(throttled);
+}
+
+/****************************************************************************
+ * Name: iob_tryalloc_size
+ *
+ * Description:
+ *   Like iob_alloc_size() but without waiting for a buffer to become free.
+ *
+ ****************************************************************************/
+
+FAR struct iob_s *iob_tryalloc_size(unsigned int size, bool throttled)
+{
+#ifdef CONFIG_IOB_LARGE
+  if (size > CONFIG_IOB_BUFSIZE)
+    {
+      FAR struct iob_s *iob = iob_tryalloc_large();
+      if (iob != NULL)
+        {
+          return iob;
+        }
+    }
+#endif
+
+  return iob_tryalloc(throttled);
+}
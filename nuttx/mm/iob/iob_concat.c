@@ -1,7 +1,7 @@
 /****************************************************************************
  * mm/iob/iob_concat.c
  *
- *   Copyright (C) 2014 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2014, 2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -59,18 +59,20 @@
 
 void iob_concat(FAR struct iob_s *iob1, FAR struct iob_s *iob2)
 {
+  FAR struct iob_s *tail = iob1;
+
   /* Find the last buffer in the iob1 buffer chain */
 
-  while (iob1->io_flink)
+  while (tail->io_flink)
     {
-      iob1 = iob1->io_flink;
+      tail = tail->io_flink;
     }
 
   /* Then connect iob2 buffer chain to the end of the iob1 chain */
 
-  iob1->io_flink = iob2;
+  tail->io_flink = iob2;
 
-  /* Combine the total packet size */
+  /* Combine the total packet size in the head of the chain */
 
   iob1->io_pktlen += iob2->io_pktlen;
 }
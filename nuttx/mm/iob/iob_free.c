@@ -1,7 +1,7 @@
 /****************************************************************************
  * mm/iob/iob_free.c
  *
- *   Copyright (C) 2014, 2016-2017 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2014, 2016-2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -45,6 +45,7 @@
 
 #include <nuttx/irq.h>
 #include <nuttx/arch.h>
+#include <nuttx/kmalloc.h>
 #include <nuttx/mm/iob.h>
 
 #include "iob.h"
@@ -109,6 +110,39 @@ FAR struct iob_s *iob_free(FAR struct iob_s *iob)
 
   flags = enter_critical_section();
 
+#ifdef CONFIG_IOB_LARGE
+  /* Large I/O buffers go back to their own free list.  Nothing ever waits
+   * for them.
+   */
+
+  if (IOB_ISLARGE(iob))
+    {
+      iob->io_flink       = g_iob_largefreelist;
+      g_iob_largefreelist = iob;
+      g_iob_nlargefree++;
+
+      leave_critical_section(flags);
+      return next;
+    }
+#endif
+
+#ifdef CONFIG_IOB_ELASTIC
+  /* Return an I/O buffer that came from the heap to the heap, unless some
+   * task may be waiting for it (or the throttled allocator would have to
+   * wait).  The heap cannot be used from interrupt handlers.
+   */
+
+  if (IOB_ISHEAP(iob) && g_iob_sem.semcount >= CONFIG_IOB_THROTTLE &&
+      !up_interrupt_context())
+    {
+      g_iob_nheap--;
+      leave_critical_section(flags);
+
+      kmm_free(iob);
+      return next;
+    }
+#endif
+
   /* Which list?  If there is a task waiting for an IOB, then put
    * the IOB on either the free list or on the committed list where
    * it is reserved for that allocation (and not available to
@@ -0,0 +1,112 @@
+/****************************************************************************
+ * mm/iob/iob_getstats.c
+ *
+ *   Copyright (C) 2018 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <string.h>
+
+#include <nuttx/irq.h>
+#include <nuttx/mm/iob.h>
+
+#include "iob.h"
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: iob_getstats
+ *
+ * Description:
+ *   Return a snapshot of the I/O buffer usage statistics.
+ *
+ * Input Parameters:
+ *   stats - The location to return the statistics
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void iob_getstats(FAR struct iob_stats_s *stats)
+{
+  irqstate_t flags;
+  int semcount;
+
+  memset(stats, 0, sizeof(struct iob_stats_s));
+
+  flags = enter_critical_section();
+
+  stats->ntotal  = CONFIG_IOB_NBUFFERS;
+#ifdef CONFIG_IOB_ELASTIC
+  stats->nheap   = g_iob_nheap;
+  stats->ntotal += g_iob_nheap;
+#endif
+
+  /* A negative count is the number of threads waiting for an I/O buffer */
+
+  semcount = g_iob_sem.semcount;
+  if (semcount >= 0)
+    {
+      stats->nfree    = (uint16_t)semcount;
+    }
+  else
+    {
+      stats->nwaiting = (uint16_t)-semcount;
+    }
+
+  stats->maxused = g_iob_maxused;
+  stats->nfailed = g_iob_nfailed;
+
+#if CONFIG_IOB_NCHAINS > 0
+  stats->nqtotal = CONFIG_IOB_NCHAINS;
+  if (g_qentry_sem.semcount > 0)
+    {
+      stats->nqfree = (uint16_t)g_qentry_sem.semcount;
+    }
+#endif
+
+#ifdef CONFIG_IOB_LARGE
+  stats->nlarge     = CONFIG_IOB_LARGE_NBUFFERS;
+  stats->nlargefree = g_iob_nlargefree;
+#endif
+
+  leave_critical_section(flags);
+}
@@ -1,7 +1,7 @@
 /****************************************************************************
  * mm/iob/iob_initialize.c
  *
- *   Copyright (C) 2014, 2017 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2014, 2017-2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -39,6 +39,7 @@
 
 #include <nuttx/config.h>
 
+#include <stdint.h>
 #include <stdbool.h>
 
 #include <nuttx/semaphore.h>
@@ -54,13 +55,31 @@
 #  define NULL ((FAR void *)0)
 #endif
 
+/* Round a number of bytes up to a whole number of 32-bit words.  Keeps the
+ * separate I/O buffer data aligned.
+ */
+
+#define IOB_NWORDS(n) (((n) + sizeof(uint32_t) - 1) / sizeof(uint32_t))
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
 
-/* This is a pool of pre-allocated I/O buffers */
+#ifdef CONFIG_IOB_LARGE
+/* The data for the pre-allocated I/O buffers */
+
+static uint32_t g_iob_buffers[CONFIG_IOB_NBUFFERS]
+                             [IOB_NWORDS(CONFIG_IOB_BUFSIZE)];
+
+/* The pool of pre-allocated large I/O buffers and their data */
+
+static struct iob_s g_iob_largepool[CONFIG_IOB_LARGE_NBUFFERS];
+static uint32_t g_iob_largebuffers[CONFIG_IOB_LARGE_NBUFFERS]
+                                  [IOB_NWORDS(CONFIG_IOB_LARGE_BUFSIZE)];
+#endif
+
+/* This is a pool of pre-allocated I/O buffer chain queue containers */
 
-static struct iob_s        g_iob_pool[CONFIG_IOB_NBUFFERS];
 #if CONFIG_IOB_NCHAINS > 0
 static struct iob_qentry_s g_iob_qpool[CONFIG_IOB_NCHAINS];
 #endif
@@ -69,6 +88,10 @@ static struct iob_qentry_s g_iob_qpool[CONFIG_IOB_NCHAINS];
  * Public Data
  ****************************************************************************/
 
+/* This is a pool of pre-allocated I/O buffers */
+
+struct iob_s g_iob_pool[CONFIG_IOB_NBUFFERS];
+
 /* A list of all free, unallocated I/O buffers */
 
 FAR struct iob_s *g_iob_freelist;
@@ -77,6 +100,13 @@ FAR struct iob_s *g_iob_freelist;
 
 FAR struct iob_s *g_iob_committed;
 
+#ifdef CONFIG_IOB_LARGE
+/* A list of all free large I/O buffers and the number of them */
+
+FAR struct iob_s *g_iob_largefreelist;
+uint16_t g_iob_nlargefree;
+#endif
+
 #if CONFIG_IOB_NCHAINS > 0
 /* A list of all free, unallocated I/O buffer queue containers */
 
@@ -97,6 +127,14 @@ sem_t g_throttle_sem;       /* Counts available I/O buffers when throttled */
 sem_t g_qentry_sem;         /* Counts free I/O buffer queue containers */
 #endif
 
+/* I/O buffer usage statistics */
+
+#ifdef CONFIG_IOB_ELASTIC
+uint16_t g_iob_nheap;       /* I/O buffers allocated from the heap */
+#endif
+uint16_t g_iob_maxused;     /* Most I/O buffers in use at one time */
+uint32_t g_iob_nfailed;     /* Allocations that found no I/O buffer */
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -124,6 +162,11 @@ void iob_initialize(void)
         {
           FAR struct iob_s *iob = &g_iob_pool[i];
 
+#ifdef CONFIG_IOB_LARGE
+          iob->io_bufsize = CONFIG_IOB_BUFSIZE;
+          iob->io_data    = (FAR uint8_t *)g_iob_buffers[i];
+#endif
+
           /* Add the pre-allocate I/O buffer to the head of the free list */
 
           iob->io_flink  = g_iob_freelist;
@@ -132,6 +175,22 @@ void iob_initialize(void)
 
       g_iob_committed = NULL;
 
+#ifdef CONFIG_IOB_LARGE
+      /* Add each large I/O buffer to the large free list */
+
+      for (i = 0; i < CONFIG_IOB_LARGE_NBUFFERS; i++)
+        {
+          FAR struct iob_s *iob = &g_iob_largepool[i];
+
+          iob->io_bufsize     = CONFIG_IOB_LARGE_BUFSIZE;
+          iob->io_data        = (FAR uint8_t *)g_iob_largebuffers[i];
+          iob->io_flink       = g_iob_largefreelist;
+          g_iob_largefreelist = iob;
+        }
+
+      g_iob_nlargefree = CONFIG_IOB_LARGE_NBUFFERS;
+#endif
+
       nxsem_init(&g_iob_sem, 0, CONFIG_IOB_NBUFFERS);
 #if CONFIG_IOB_THROTTLE > 0
       nxsem_init(&g_throttle_sem, 0, CONFIG_IOB_NBUFFERS - CONFIG_IOB_THROTTLE);
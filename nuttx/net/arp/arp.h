@@ -1,7 +1,7 @@
 /****************************************************************************
  * net/arp/arp.h
  *
- *   Copyright (C) 2014-2016 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2014-2016, 2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -279,7 +279,7 @@ int arp_send(in_addr_t ipaddr);
  *
  * Assumptions:
  *   This function is called from the MAC device driver indirectly through
- *   devif_poll() and devif_timer().  The network must be locked.
+ *   devif_poll().  The network must be locked.
  *
  ****************************************************************************/
 
@@ -453,6 +453,63 @@ int arp_update(in_addr_t ipaddr, FAR uint8_t *ethaddr);
 
 void arp_hdr_update(FAR uint16_t *pipaddr, FAR uint8_t *ethaddr);
 
+/****************************************************************************
+ * Name: arp_queue
+ *
+ * Description:
+ *   Keep a copy of the outgoing IPv4 packet in d_buf so that it can be
+ *   sent when the ARP request for 'ipaddr' is answered.
+ *
+ * Input Parameters:
+ *   dev    - The device that the packet is being sent on
+ *   ipaddr - The IP address being resolved
+ *
+ * Returned Value:
+ *   Zero (OK) if the packet is held; a negated errno value if it is dropped.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_ARP_QUEUE
+int arp_queue(FAR struct net_driver_s *dev, in_addr_t ipaddr);
+#endif
+
+/****************************************************************************
+ * Name: arp_queue_notify
+ *
+ * Description:
+ *   Called when a new address mapping is added to the ARP table.  If
+ *   packets are held for the address, ask the device to poll for them.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_ARP_QUEUE
+void arp_queue_notify(in_addr_t ipaddr);
+#endif
+
+/****************************************************************************
+ * Name: arp_queue_poll
+ *
+ * Description:
+ *   Send the packets held for this device whose destination has been
+ *   resolved and drop those that have waited too long.
+ *
+ * Assumptions:
+ *   This function is called from the MAC device driver indirectly through
+ *   devif_poll().  The network must be locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_ARP_QUEUE
+int arp_queue_poll(FAR struct net_driver_s *dev,
+                   devif_poll_callback_t callback);
+#endif
+
 /****************************************************************************
  * Name: arp_dump
  *
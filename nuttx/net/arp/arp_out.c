@@ -1,7 +1,7 @@
 /****************************************************************************
  * net/arp/arp_out.c
  *
- *   Copyright (C) 2007-2011, 2014-2015, 2017 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007-2011, 2014-2015, 2017-2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Based on uIP which also has a BSD style license:
@@ -47,6 +47,7 @@
 #include <debug.h>
 
 #include <nuttx/net/netdev.h>
+#include <nuttx/net/netstats.h>
 #include <nuttx/net/arp.h>
 
 #include "route/route.h"
@@ -126,7 +127,8 @@ static const uint8_t g_multicast_ethaddr[3] =
  *   packet in the d_buf is replaced by an ARP request packet for the
  *   IP address. The IP packet is dropped and it is assumed that the
  *   higher level protocols (e.g., TCP) eventually will retransmit the
- *   dropped packet.
+ *   dropped packet.  With CONFIG_NET_ARP_QUEUE, a copy of the IP packet
+ *   is held instead and sent when the ARP reply arrives.
  *
  *   Upon return in either the case, a packet to be sent is present in the
  *   d_buf buffer and the d_len field holds the length of the Ethernet
@@ -254,6 +256,16 @@ void arp_out(FAR struct net_driver_s *dev)
     {
       ninfo("ARP request for IP %08lx\n", (unsigned long)ipaddr);
 
+#ifdef CONFIG_NET_STATISTICS
+      g_netstats.arp.miss++;
+#endif
+
+#ifdef CONFIG_NET_ARP_QUEUE
+      /* Keep a copy of the IP packet to send when the ARP reply arrives */
+
+      (void)arp_queue(dev, ipaddr);
+#endif
+
       /* The destination address was not in our ARP table, so we overwrite
        * the IP packet with an ARP request.
        */
@@ -263,6 +275,10 @@ void arp_out(FAR struct net_driver_s *dev)
       return;
     }
 
+#ifdef CONFIG_NET_STATISTICS
+  g_netstats.arp.hit++;
+#endif
+
   /* Build an Ethernet header. */
 
   memcpy(peth->dest, tabptr->at_ethaddr.ether_addr_octet, ETHER_ADDR_LEN);
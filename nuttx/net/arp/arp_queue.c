@@ -0,0 +1,364 @@
+/****************************************************************************
+ * net/arp/arp_queue.c
+ * Hold outgoing IPv4 packets until their ARP request is answered
+ *
+ *   Copyright (C) 2018 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <net/if.h>
+
+#include <nuttx/clock.h>
+#include <nuttx/mm/iob.h>
+#include <nuttx/net/netdev.h>
+#include <nuttx/net/netstats.h>
+#include <nuttx/net/arp.h>
+#include <nuttx/net/ip.h>
+
+#include "netdev/netdev.h"
+#include "arp/arp.h"
+
+#ifdef CONFIG_NET_ARP_QUEUE
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define ARP_QUEUE_TIMEOUT  MSEC2TICK(CONFIG_NET_ARP_QUEUE_TIMEOUT)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* The packets held for one unresolved IP address.  The entry is unused
+ * when no packets are held.
+ */
+
+struct arp_queue_s
+{
+  FAR struct net_driver_s *aq_dev;   /* The device to send the packets on */
+  in_addr_t aq_ipaddr;               /* The IP address */
+  systime_t aq_time;                 /* Time that the first packet was held */
+  uint8_t   aq_npkts;                /* Number of packets held */
+  FAR struct iob_s *aq_pkts[CONFIG_NET_ARP_QUEUE_MAXPKTS];
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct arp_queue_s g_arpqueue[CONFIG_NET_ARP_QUEUE_NENTRIES];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: arp_queue_remove
+ *
+ * Description:
+ *   Remove the oldest packet from an entry.
+ *
+ ****************************************************************************/
+
+static FAR struct iob_s *arp_queue_remove(FAR struct arp_queue_s *aq)
+{
+  FAR struct iob_s *iob = aq->aq_pkts[0];
+
+  aq->aq_npkts--;
+  memmove(&aq->aq_pkts[0], &aq->aq_pkts[1],
+          aq->aq_npkts * sizeof(FAR struct iob_s *));
+
+  return iob;
+}
+
+/****************************************************************************
+ * Name: arp_queue_discard
+ *
+ * Description:
+ *   Drop all of the packets held in an entry and free the entry.
+ *
+ ****************************************************************************/
+
+static void arp_queue_discard(FAR struct arp_queue_s *aq)
+{
+  while (aq->aq_npkts > 0)
+    {
+      iob_free_chain(arp_queue_remove(aq));
+
+#ifdef CONFIG_NET_STATISTICS
+      g_netstats.arp.drop++;
+#endif
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: arp_queue
+ *
+ * Description:
+ *   Keep a copy of the outgoing IPv4 packet in d_buf so that it can be
+ *   sent when the ARP request for 'ipaddr' is answered.  If too many
+ *   packets are already held for 'ipaddr', the oldest is dropped.
+ *
+ * Input Parameters:
+ *   dev    - The device that the packet is being sent on.  The IPv4
+ *            packet follows the Ethernet header in d_buf and d_len is its
+ *            length.
+ *   ipaddr - The IP address being resolved
+ *
+ * Returned Value:
+ *   Zero (OK) if the packet is held.  Otherwise, a negated errno value is
+ *   returned and the packet is simply dropped, as it would be without this
+ *   option.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+int arp_queue(FAR struct net_driver_s *dev, in_addr_t ipaddr)
+{
+  FAR struct arp_queue_s *aq = NULL;
+  FAR struct arp_queue_s *avail = NULL;
+  FAR struct arp_queue_s *tmp;
+  FAR struct iob_s *iob;
+  systime_t now = clock_systimer();
+  int ret;
+  int i;
+
+  /* Find the entry for this address, discarding stale entries on the way */
+
+  for (i = 0; i < CONFIG_NET_ARP_QUEUE_NENTRIES; i++)
+    {
+      tmp = &g_arpqueue[i];
+      if (tmp->aq_npkts > 0 && now - tmp->aq_time >= ARP_QUEUE_TIMEOUT)
+        {
+          arp_queue_discard(tmp);
+        }
+
+      if (tmp->aq_npkts == 0)
+        {
+          if (avail == NULL)
+            {
+              avail = tmp;
+            }
+        }
+      else if (tmp->aq_dev == dev &&
+               net_ipv4addr_cmp(tmp->aq_ipaddr, ipaddr))
+        {
+          aq = tmp;
+        }
+    }
+
+  if (aq == NULL && avail == NULL)
+    {
+      ret = -ENOMEM;
+      goto errout;
+    }
+
+  /* Copy the packet into throttled I/O buffers so that held packets
+   * cannot use up the buffers needed by the rest of the network.
+   */
+
+  iob = iob_tryalloc_size(dev->d_len, true);
+  if (iob == NULL)
+    {
+      ret = -ENOMEM;
+      goto errout;
+    }
+
+  ret = iob_trycopyin(iob, &dev->d_buf[ETH_HDRLEN], dev->d_len, 0, true);
+  if (ret < 0)
+    {
+      iob_free_chain(iob);
+      goto errout;
+    }
+
+  if (aq == NULL)
+    {
+      aq            = avail;
+      aq->aq_dev    = dev;
+      aq->aq_ipaddr = ipaddr;
+      aq->aq_time   = now;
+      aq->aq_npkts  = 0;
+    }
+  else if (aq->aq_npkts >= CONFIG_NET_ARP_QUEUE_MAXPKTS)
+    {
+      iob_free_chain(arp_queue_remove(aq));
+
+#ifdef CONFIG_NET_STATISTICS
+      g_netstats.arp.drop++;
+#endif
+    }
+
+  aq->aq_pkts[aq->aq_npkts++] = iob;
+
+#ifdef CONFIG_NET_STATISTICS
+  g_netstats.arp.queued++;
+#endif
+  return OK;
+
+errout:
+  ninfo("Dropping packet for %08lx: %d\n", (unsigned long)ipaddr, ret);
+
+#ifdef CONFIG_NET_STATISTICS
+  g_netstats.arp.drop++;
+#endif
+  return ret;
+}
+
+/****************************************************************************
+ * Name: arp_queue_notify
+ *
+ * Description:
+ *   Called when a new address mapping is added to the ARP table.  If
+ *   packets are held for the address, ask the device to poll for them.
+ *
+ * Input Parameters:
+ *   ipaddr - The IP address that was resolved
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+void arp_queue_notify(in_addr_t ipaddr)
+{
+  int i;
+
+  for (i = 0; i < CONFIG_NET_ARP_QUEUE_NENTRIES; i++)
+    {
+      if (g_arpqueue[i].aq_npkts > 0 &&
+          net_ipv4addr_cmp(g_arpqueue[i].aq_ipaddr, ipaddr))
+        {
+          netdev_txnotify_dev(g_arpqueue[i].aq_dev);
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: arp_queue_poll
+ *
+ * Description:
+ *   Send the packets held for this device whose destination has been
+ *   resolved.  Each packet is returned to the driver as an IPv4 packet
+ *   without an Ethernet header, so the driver's call to arp_out() adds the
+ *   header just as for any other outgoing packet.  Packets whose ARP
+ *   request has not been answered in time are dropped.
+ *
+ * Input Parameters:
+ *   dev      - The device being polled
+ *   callback - The driver's poll callback
+ *
+ * Returned Value:
+ *   The non-zero value returned by the callback if it stopped the poll;
+ *   zero otherwise.
+ *
+ * Assumptions:
+ *   This function is called from the MAC device driver indirectly through
+ *   devif_poll().  The network must be locked.
+ *
+ ****************************************************************************/
+
+int arp_queue_poll(FAR struct net_driver_s *dev,
+                   devif_poll_callback_t callback)
+{
+  FAR struct arp_queue_s *aq;
+  FAR struct iob_s *iob;
+  systime_t now = clock_systimer();
+  int bstop;
+  int i;
+
+  for (i = 0; i < CONFIG_NET_ARP_QUEUE_NENTRIES; i++)
+    {
+      aq = &g_arpqueue[i];
+      if (aq->aq_npkts == 0 || aq->aq_dev != dev)
+        {
+          continue;
+        }
+
+      if (arp_find(aq->aq_ipaddr) == NULL)
+        {
+          /* Not yet resolved.  Give up if it is taking too long. */
+
+          if (now - aq->aq_time >= ARP_QUEUE_TIMEOUT)
+            {
+              arp_queue_discard(aq);
+            }
+
+          continue;
+        }
+
+      while (aq->aq_npkts > 0)
+        {
+          iob = arp_queue_remove(aq);
+
+          dev->d_len    = iob->io_pktlen;
+          dev->d_sndlen = 0;
+          (void)iob_copyout(&dev->d_buf[ETH_HDRLEN], iob, iob->io_pktlen, 0);
+          iob_free_chain(iob);
+
+          IFF_SET_IPv4(dev->d_flags);
+
+#ifdef CONFIG_NET_STATISTICS
+          g_netstats.arp.sent++;
+#endif
+
+          bstop = callback(dev);
+          if (bstop)
+            {
+              return bstop;
+            }
+        }
+    }
+
+  return 0;
+}
+
+#endif /* CONFIG_NET_ARP_QUEUE */
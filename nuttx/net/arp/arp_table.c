@@ -2,7 +2,7 @@
  * net/arp/arp_table.c
  * Implementation of the ARP Address Resolution Protocol.
  *
- *   Copyright (C) 2007-2009, 2011, 2014 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007-2009, 2011, 2014, 2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Based originally on uIP which also has a BSD style license:
@@ -62,15 +62,98 @@
 
 #ifdef CONFIG_NET_ARP
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The ARP table is indexed by a hash of the IP address with (on average)
+ * one entry per hash bucket.
+ */
+
+#define ARP_HASHSIZE   CONFIG_NET_ARPTAB_SIZE
+#define ARP_NOBUCKET   0xffff
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* One entry in the ARP table, as kept in the hash table */
+
+struct arp_table_entry_s
+{
+  struct arp_entry entry;                /* The entry (must be first) */
+  FAR struct arp_table_entry_s *flink;   /* Next entry in the hash bucket */
+  uint16_t bucket;                       /* Hash bucket of the entry */
+};
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
 
 /* The table of known address mappings */
 
-static struct arp_entry g_arptable[CONFIG_NET_ARPTAB_SIZE];
+static struct arp_table_entry_s g_arptable[CONFIG_NET_ARPTAB_SIZE];
 static uint8_t g_arptime;
 
+/* The hash table.  Entries are only moved to another bucket when they are
+ * re-used for a new address, so deleted and expired entries (at_ipaddr ==
+ * 0) remain in their old bucket until then.  That keeps arp_timer() and
+ * arp_delete() from having to change the hash chains.
+ */
+
+static FAR struct arp_table_entry_s *g_arphash[ARP_HASHSIZE];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: arp_hash
+ *
+ * Description:
+ *   Return the hash bucket for an IP address.
+ *
+ ****************************************************************************/
+
+static inline unsigned int arp_hash(in_addr_t ipaddr)
+{
+  /* Multiplicative hashing mixes all bytes of the address into the upper
+   * bits of the product.
+   */
+
+  return (((uint32_t)ipaddr * 2654435761u) >> 16) % ARP_HASHSIZE;
+}
+
+/****************************************************************************
+ * Name: arp_lookup
+ *
+ * Description:
+ *   Find the ARP table entry for an IP address.
+ *
+ ****************************************************************************/
+
+static FAR struct arp_table_entry_s *arp_lookup(in_addr_t ipaddr)
+{
+  FAR struct arp_table_entry_s *tabptr;
+
+  if (ipaddr == 0)
+    {
+      return NULL;
+    }
+
+  for (tabptr = g_arphash[arp_hash(ipaddr)];
+       tabptr != NULL;
+       tabptr = tabptr->flink)
+    {
+      if (net_ipv4addr_cmp(ipaddr, tabptr->entry.at_ipaddr))
+        {
+          return tabptr;
+        }
+    }
+
+  return NULL;
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -89,8 +172,12 @@ void arp_reset(void)
 
   for (i = 0; i < CONFIG_NET_ARPTAB_SIZE; ++i)
     {
-      memset(&g_arptable[i].at_ipaddr, 0, sizeof(in_addr_t));
+      memset(&g_arptable[i].entry.at_ipaddr, 0, sizeof(in_addr_t));
+      g_arptable[i].flink  = NULL;
+      g_arptable[i].bucket = ARP_NOBUCKET;
     }
+
+  memset(g_arphash, 0, sizeof(g_arphash));
 }
 
 /****************************************************************************
@@ -112,7 +199,7 @@ void arp_timer(void)
   ++g_arptime;
   for (i = 0; i < CONFIG_NET_ARPTAB_SIZE; ++i)
     {
-      tabptr = &g_arptable[i];
+      tabptr = &g_arptable[i].entry;
 
       if (tabptr->at_ipaddr != 0 &&
           g_arptime - tabptr->at_time >= CONFIG_NET_ARP_MAXAGE)
@@ -144,44 +231,31 @@ void arp_timer(void)
 
 int arp_update(in_addr_t ipaddr, FAR uint8_t *ethaddr)
 {
-  struct arp_entry *tabptr = NULL;
-  int               i;
+  FAR struct arp_table_entry_s *tabptr;
+  FAR struct arp_table_entry_s **pprev;
+  unsigned int bucket;
+  int i;
 
-  /* Walk through the ARP mapping table and try to find an entry to
-   * update. If none is found, the IP -> MAC address mapping is
-   * inserted in the ARP table.
+  /* Check if there is already an entry for this IP address.  If so, just
+   * update it.
    */
 
-  for (i = 0; i < CONFIG_NET_ARPTAB_SIZE; ++i)
+  tabptr = arp_lookup(ipaddr);
+  if (tabptr != NULL)
     {
-      tabptr = &g_arptable[i];
-
-      /* Only check those entries that are actually in use. */
-
-      if (tabptr->at_ipaddr != 0)
-        {
-          /* Check if the source IP address of the incoming packet matches
-           * the IP address in this ARP table entry.
-           */
-
-          if (net_ipv4addr_cmp(ipaddr, tabptr->at_ipaddr))
-            {
-              /* An old entry found, update this and return. */
-
-              memcpy(tabptr->at_ethaddr.ether_addr_octet, ethaddr, ETHER_ADDR_LEN);
-              tabptr->at_time = g_arptime;
-              return OK;
-            }
-        }
+      memcpy(tabptr->entry.at_ethaddr.ether_addr_octet, ethaddr,
+             ETHER_ADDR_LEN);
+      tabptr->entry.at_time = g_arptime;
+      return OK;
     }
 
-  /* If we get here, no existing ARP table entry was found, so we create one. */
-  /* First, we try to find an unused entry in the ARP table. */
+  /* If we get here, no existing ARP table entry was found, so we create one.
+   * First, we try to find an unused entry in the ARP table.
+   */
 
   for (i = 0; i < CONFIG_NET_ARPTAB_SIZE; ++i)
     {
-      tabptr = &g_arptable[i];
-      if (tabptr->at_ipaddr == 0)
+      if (g_arptable[i].entry.at_ipaddr == 0)
         {
           break;
         }
@@ -198,25 +272,46 @@ int arp_update(in_addr_t ipaddr, FAR uint8_t *ethaddr)
 
       for (i = 0; i < CONFIG_NET_ARPTAB_SIZE; ++i)
         {
-          tabptr = &g_arptable[i];
-          if (g_arptime - tabptr->at_time > tmpage)
+          if ((uint8_t)(g_arptime - g_arptable[i].entry.at_time) > tmpage)
             {
-              tmpage = g_arptime - tabptr->at_time;
+              tmpage = g_arptime - g_arptable[i].entry.at_time;
               j = i;
             }
         }
 
       i = j;
-      tabptr = &g_arptable[i];
     }
 
   /* Now, i is the ARP table entry which we will fill with the new
-   * information.
+   * information.  Move it from its old hash bucket (if any) to the bucket
+   * for the new address.
    */
 
-  tabptr->at_ipaddr = ipaddr;
-  memcpy(tabptr->at_ethaddr.ether_addr_octet, ethaddr, ETHER_ADDR_LEN);
-  tabptr->at_time = g_arptime;
+  tabptr = &g_arptable[i];
+  if (tabptr->bucket != ARP_NOBUCKET)
+    {
+      for (pprev = &g_arphash[tabptr->bucket];
+           *pprev != tabptr;
+           pprev = &(*pprev)->flink);
+
+      *pprev = tabptr->flink;
+    }
+
+  bucket            = arp_hash(ipaddr);
+  tabptr->flink     = g_arphash[bucket];
+  tabptr->bucket    = bucket;
+  g_arphash[bucket] = tabptr;
+
+  tabptr->entry.at_ipaddr = ipaddr;
+  memcpy(tabptr->entry.at_ethaddr.ether_addr_octet, ethaddr, ETHER_ADDR_LEN);
+  tabptr->entry.at_time = g_arptime;
+
+#ifdef CONFIG_NET_ARP_QUEUE
+  /* Send any packets that were held waiting for this address */
+
+  arp_queue_notify(ipaddr);
+#endif
+
   return OK;
 }
 
@@ -266,19 +361,10 @@ void arp_hdr_update(FAR uint16_t *pipaddr, FAR uint8_t *ethaddr)
 
 FAR struct arp_entry *arp_find(in_addr_t ipaddr)
 {
-  FAR struct arp_entry *tabptr;
-  int i;
+  FAR struct arp_table_entry_s *tabptr;
 
-  for (i = 0; i < CONFIG_NET_ARPTAB_SIZE; ++i)
-    {
-      tabptr = &g_arptable[i];
-      if (net_ipv4addr_cmp(ipaddr, tabptr->at_ipaddr))
-        {
-          return tabptr;
-        }
-    }
-
-  return NULL;
+  tabptr = arp_lookup(ipaddr);
+  return tabptr != NULL ? &tabptr->entry : NULL;
 }
 
 #endif /* CONFIG_NET_ARP */
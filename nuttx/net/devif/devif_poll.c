@@ -546,6 +546,19 @@ int devif_poll(FAR struct net_driver_s *dev, devif_poll_callback_t callback)
    * action.
    */
 
+#ifdef CONFIG_NET_ARP_QUEUE
+  /* Send packets that were held until their destination was resolved */
+
+  bstop = arp_queue_poll(dev, callback);
+  if (!bstop)
+#endif
+#ifdef CONFIG_NET_IPv6_NQUEUE
+    {
+      bstop = neighbor_queue_poll(dev, callback);
+    }
+
+  if (!bstop)
+#endif
 #ifdef CONFIG_NET_ARP_SEND
   /* Check for pending ARP requests */
 
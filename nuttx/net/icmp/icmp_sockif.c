@@ -103,6 +103,10 @@ const struct sock_intf_s g_icmp_sockif =
   NULL,             /* si_sendfile */
 #endif
   icmp_recvfrom,    /* si_recvfrom */
+  NULL,             /* si_sendmsg */
+  NULL,             /* si_recvmsg */
+  NULL,             /* si_sendmmsg */
+  NULL,             /* si_recvmmsg */
   icmp_close        /* si_close */
 };
 
@@ -103,6 +103,10 @@ const struct sock_intf_s g_icmpv6_sockif =
   NULL,               /* si_sendfile */
 #endif
   icmpv6_recvfrom,    /* si_recvfrom */
+  NULL,               /* si_sendmsg */
+  NULL,               /* si_recvmsg */
+  NULL,               /* si_sendmmsg */
+  NULL,               /* si_recvmmsg */
   icmpv6_close        /* si_close */
 };
 
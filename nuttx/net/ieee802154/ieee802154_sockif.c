@@ -107,6 +107,10 @@ const struct sock_intf_s g_ieee802154_sockif =
   NULL,                   /* si_sendfile */
 #endif
   ieee802154_recvfrom,    /* si_recvfrom */
+  NULL,                   /* si_sendmsg */
+  NULL,                   /* si_recvmsg */
+  NULL,                   /* si_sendmmsg */
+  NULL,                   /* si_recvmmsg */
   ieee802154_close        /* si_close */
 };
 
@@ -1,7 +1,7 @@
 /****************************************************************************
  * net/inet/inet.h
  *
- *   Copyright (C) 2007-2009, 2011-2014 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007-2009, 2011-2014, 2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -206,6 +206,51 @@ ssize_t inet_recvfrom(FAR struct socket *psock, FAR void *buf, size_t len,
                       int flags, FAR struct sockaddr *from,
                       FAR socklen_t *fromlen);
 
+/****************************************************************************
+ * Name: inet_recvmmsg
+ *
+ * Description:
+ *   Implements the si_recvmmsg() batch receive method for the case of the
+ *   AF_INET and AF_INET6 address families.  All of the UDP datagrams that
+ *   are waiting in the read-ahead queue (up to 'vlen') are returned with a
+ *   single acquisition of the network lock.  This never waits for data.
+ *
+ * Parameters:
+ *   psock    A pointer to a NuttX-specific, internal socket structure
+ *   msgvec   Describes the buffers for each message
+ *   vlen     The number of messages in 'msgvec'
+ *   flags    Receive flags
+ *
+ * Returned Value:
+ *   The number of messages returned (possibly zero); a negated errno value
+ *   if the first message is invalid.
+ *
+ ****************************************************************************/
+
+int inet_recvmmsg(FAR struct socket *psock, FAR struct mmsghdr *msgvec,
+                  unsigned int vlen, int flags);
+
+/****************************************************************************
+ * Name: inet_sendto_checkaddr
+ *
+ * Description:
+ *   Verify the destination address given to sendto() or in the msg_name of
+ *   a message sent with sendmmsg() on an AF_INET or AF_INET6 socket.
+ *
+ * Parameters:
+ *   psock    A pointer to a NuttX-specific, internal socket structure
+ *   to       Address of recipient
+ *   tolen    The length of the address structure
+ *
+ * Returned Value:
+ *   Zero (OK) if the address may be used; otherwise a negated errno value
+ *   (EAFNOSUPPORT, EBADF or EISCONN).
+ *
+ ****************************************************************************/
+
+int inet_sendto_checkaddr(FAR struct socket *psock,
+                          FAR const struct sockaddr *to, socklen_t tolen);
+
 /****************************************************************************
  * Name: inet_close
  *
@@ -1,7 +1,7 @@
 /****************************************************************************
  * net/inet/inet_close.c
  *
- *   Copyright (C) 2007-2017 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007-2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -365,6 +365,15 @@ static inline int tcp_close_disconnect(FAR struct socket *psock)
   psock->s_sndcb = NULL;
 #endif
 
+#ifdef CONFIG_NET_TCP_NAGLE
+  /* Any data still queued must go out before the FIN.  Stop holding back
+   * partial segments.
+   */
+
+  conn->sndflags |= TCP_SNDF_NODELAY;
+  conn->sndflags &= ~TCP_SNDF_CORK;
+#endif
+
   /* Check for the case where the host beat us and disconnected first */
 
   if (conn->tcpstateflags == TCP_ESTABLISHED &&
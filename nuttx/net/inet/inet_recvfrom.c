@@ -1,7 +1,7 @@
 /****************************************************************************
  * net/inet/inet_recvfrom.c
  *
- *   Copyright (C) 2007-2009, 2011-2017 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007-2009, 2011-2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -43,6 +43,7 @@
 
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <stdint.h>
 #include <string.h>
 #include <errno.h>
@@ -345,6 +346,7 @@ static inline void inet_tcp_readahead(struct inet_recvfrom_s *pstate)
        * beginning of the I/O buffer chain.
        */
 
+      conn->rcvqueued -= recvlen;
       if (recvlen >= iob->io_pktlen)
         {
           FAR struct iob_s *tmp;
@@ -457,9 +459,105 @@ out:
 
       /* And free the I/O buffer chain */
 
+      conn->rcvqueued -= iob->io_pktlen;
       (void)iob_free_chain(iob);
     }
 }
+
+/****************************************************************************
+ * Name: inet_udp_readahead_msg
+ *
+ * Description:
+ *   Remove the oldest datagram from the UDP read-ahead queue and scatter
+ *   it into the buffers of 'msg'.  The sender's address is returned in
+ *   msg->msg_name (if not NULL).  MSG_TRUNC is set if the datagram did not
+ *   fit.
+ *
+ * Returned Value:
+ *   The number of bytes returned; -EAGAIN if there is no datagram in the
+ *   read-ahead queue, or -EINVAL if the datagram at the head of the queue
+ *   was malformed and has been discarded.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+static ssize_t inet_udp_readahead_msg(FAR struct udp_conn_s *conn,
+                                      FAR struct msghdr *msg)
+{
+  FAR struct iob_s *iob;
+  FAR struct iob_s *tmp;
+  uint8_t src_addr_size;
+  unsigned int offset;
+  socklen_t addrlen;
+  ssize_t ret = 0;
+  int ncopy;
+  int i;
+
+  iob = iob_peek_queue(&conn->readahead);
+  if (iob == NULL)
+    {
+      return -EAGAIN;
+    }
+
+  /* The datagram is preceded by the size of the sender's address and the
+   * address itself.
+   */
+
+  if (iob_copyout(&src_addr_size, iob, sizeof(uint8_t), 0) !=
+      sizeof(uint8_t) ||
+      sizeof(uint8_t) + src_addr_size > iob->io_pktlen)
+    {
+      ret = -EINVAL;
+      goto out;
+    }
+
+  if (msg->msg_name != NULL)
+    {
+      addrlen = msg->msg_namelen;
+      if (addrlen > src_addr_size)
+        {
+          addrlen = src_addr_size;
+        }
+
+      (void)iob_copyout((FAR uint8_t *)msg->msg_name, iob, addrlen,
+                        sizeof(uint8_t));
+      msg->msg_namelen = src_addr_size;
+    }
+
+  /* Scatter the data into the user buffers */
+
+  offset = sizeof(uint8_t) + src_addr_size;
+  for (i = 0; i < msg->msg_iovlen && offset < iob->io_pktlen; i++)
+    {
+      ncopy = iob_copyout((FAR uint8_t *)msg->msg_iov[i].iov_base, iob,
+                          msg->msg_iov[i].iov_len, offset);
+      offset += ncopy;
+      ret    += ncopy;
+    }
+
+  if (offset < iob->io_pktlen)
+    {
+      msg->msg_flags |= MSG_TRUNC;
+    }
+
+  ninfo("Received %d bytes (of %d)\n",
+        (int)ret, iob->io_pktlen - sizeof(uint8_t) - src_addr_size);
+
+out:
+  /* Remove the I/O buffer chain from the head of the read-ahead queue and
+   * free it.
+   */
+
+  tmp = iob_remove_queue(&conn->readahead);
+  DEBUGASSERT(tmp == iob);
+  UNUSED(tmp);
+
+  conn->rcvqueued -= iob->io_pktlen;
+  (void)iob_free_chain(iob);
+  return ret;
+}
 #endif
 
 /****************************************************************************
@@ -1178,6 +1276,7 @@ static ssize_t inet_recvfrom_result(int result, struct inet_recvfrom_s *pstate)
  *   buf    Buffer to receive data
  *   len    Length of buffer
  *   from   INET address of source (may be NULL)
+ *   nonblock  True:  Do not wait for data (O_NONBLOCK or MSG_DONTWAIT)
  *
  * Returned Value:
  *   On success, returns the number of characters received.  On  error,
@@ -1189,7 +1288,8 @@ static ssize_t inet_recvfrom_result(int result, struct inet_recvfrom_s *pstate)
 
 #ifdef NET_UDP_HAVE_STACK
 static ssize_t inet_udp_recvfrom(FAR struct socket *psock, FAR void *buf, size_t len,
-                                 FAR struct sockaddr *from, FAR socklen_t *fromlen)
+                                 FAR struct sockaddr *from, FAR socklen_t *fromlen,
+                                 bool nonblock)
 {
   FAR struct udp_conn_s *conn = (FAR struct udp_conn_s *)psock->s_conn;
   FAR struct net_driver_s *dev;
@@ -1234,7 +1334,7 @@ static ssize_t inet_udp_recvfrom(FAR struct socket *psock, FAR void *buf, size_t
 #endif
 
 #ifdef CONFIG_NET_UDP_READAHEAD
-  if (_SS_ISNONBLOCK(psock->s_flags))
+  if (nonblock)
     {
       /* Return the number of bytes read from the read-ahead buffer if
        * something was received (already in 'ret'); EAGAIN if not.
@@ -1314,6 +1414,7 @@ errout_with_state:
  *   buf    Buffer to receive data
  *   len    Length of buffer
  *   from   INET address of source (may be NULL)
+ *   nonblock  True:  Do not wait for data (O_NONBLOCK or MSG_DONTWAIT)
  *
  * Returned Value:
  *   On success, returns the number of characters received.  On  error,
@@ -1325,7 +1426,8 @@ errout_with_state:
 
 #ifdef NET_TCP_HAVE_STACK
 static ssize_t inet_tcp_recvfrom(FAR struct socket *psock, FAR void *buf, size_t len,
-                                 FAR struct sockaddr *from, FAR socklen_t *fromlen)
+                                 FAR struct sockaddr *from, FAR socklen_t *fromlen,
+                                 bool nonblock)
 {
   struct inet_recvfrom_s state;
   int               ret;
@@ -1394,13 +1496,13 @@ static ssize_t inet_tcp_recvfrom(FAR struct socket *psock, FAR void *buf, size_t
 
   /* In general, this implementation will not support non-blocking socket
    * operations... except in a few cases:  Here for TCP receive with read-ahead
-   * enabled.  If this socket is configured as non-blocking then return EAGAIN
-   * if no data was obtained from the read-ahead buffers.
+   * enabled.  If the socket is non-blocking or MSG_DONTWAIT was given, then
+   * return EAGAIN if no data was obtained from the read-ahead buffers.
    */
 
   else
 #ifdef CONFIG_NET_TCP_READAHEAD
-  if (_SS_ISNONBLOCK(psock->s_flags))
+  if (nonblock)
     {
       /* Return the number of bytes read from the read-ahead buffer if
        * something was received (already in 'ret'); EAGAIN if not.
@@ -1520,6 +1622,7 @@ ssize_t inet_recvfrom(FAR struct socket *psock, FAR void *buf, size_t len,
                       int flags, FAR struct sockaddr *from,
                       FAR socklen_t *fromlen)
 {
+  bool nonblock;
   ssize_t ret;
 
   /* If a 'from' address has been provided, verify that it is large
@@ -1561,6 +1664,10 @@ ssize_t inet_recvfrom(FAR struct socket *psock, FAR void *buf, size_t len,
         }
     }
 
+  /* MSG_DONTWAIT makes this one operation non-blocking */
+
+  nonblock = _SS_ISNONBLOCK(psock->s_flags) || (flags & MSG_DONTWAIT) != 0;
+
   /* Read from the network interface driver buffer */
   /* Or perform the TCP/IP or UDP recv() operation */
 
@@ -1570,7 +1677,7 @@ ssize_t inet_recvfrom(FAR struct socket *psock, FAR void *buf, size_t len,
     case SOCK_STREAM:
       {
 #ifdef NET_TCP_HAVE_STACK
-        ret = inet_tcp_recvfrom(psock, buf, len, from, fromlen);
+        ret = inet_tcp_recvfrom(psock, buf, len, from, fromlen, nonblock);
 #else
         ret = -ENOSYS;
 #endif
@@ -1582,7 +1689,7 @@ ssize_t inet_recvfrom(FAR struct socket *psock, FAR void *buf, size_t len,
     case SOCK_DGRAM:
       {
 #ifdef NET_UDP_HAVE_STACK
-        ret = inet_udp_recvfrom(psock, buf, len, from, fromlen);
+        ret = inet_udp_recvfrom(psock, buf, len, from, fromlen, nonblock);
 #else
         ret = -ENOSYS;
 #endif
@@ -1601,4 +1708,77 @@ ssize_t inet_recvfrom(FAR struct socket *psock, FAR void *buf, size_t len,
   return ret;
 }
 
+/****************************************************************************
+ * Name: inet_recvmmsg
+ *
+ * Description:
+ *   Implements the si_recvmmsg() batch receive method for the case of the
+ *   AF_INET and AF_INET6 address families.  All of the UDP datagrams that
+ *   are waiting in the read-ahead queue (up to 'vlen') are returned with a
+ *   single acquisition of the network lock.  This never waits for data.
+ *
+ * Parameters:
+ *   psock    A pointer to a NuttX-specific, internal socket structure
+ *   msgvec   Describes the buffers for each message
+ *   vlen     The number of messages in 'msgvec'
+ *   flags    Receive flags
+ *
+ * Returned Value:
+ *   The number of messages returned (possibly zero); a negated errno value
+ *   if the first message is invalid.
+ *
+ ****************************************************************************/
+
+int inet_recvmmsg(FAR struct socket *psock, FAR struct mmsghdr *msgvec,
+                  unsigned int vlen, int flags)
+{
+#if defined(NET_UDP_HAVE_STACK) && defined(CONFIG_NET_UDP_READAHEAD)
+  FAR struct udp_conn_s *conn;
+  FAR struct msghdr *msg;
+  unsigned int nrecvd = 0;
+  ssize_t ret;
+
+  if (psock->s_type != SOCK_DGRAM)
+    {
+      return 0;
+    }
+
+  conn = (FAR struct udp_conn_s *)psock->s_conn;
+  DEBUGASSERT(conn != NULL);
+
+  net_lock();
+  while (nrecvd < vlen)
+    {
+      msg = &msgvec[nrecvd].msg_hdr;
+      if (msg->msg_iovlen < 0 ||
+          (msg->msg_iov == NULL && msg->msg_iovlen > 0))
+        {
+          net_unlock();
+          return nrecvd > 0 ? (int)nrecvd : -EINVAL;
+        }
+
+      msg->msg_flags      = 0;
+      msg->msg_controllen = 0;
+
+      ret = inet_udp_readahead_msg(conn, msg);
+      if (ret == -EAGAIN)
+        {
+          break;
+        }
+      else if (ret >= 0)
+        {
+          msgvec[nrecvd].msg_len = ret;
+          nrecvd++;
+        }
+    }
+
+  net_unlock();
+  return nrecvd;
+#else
+  /* Nothing is buffered that could be returned in a batch */
+
+  return 0;
+#endif
+}
+
 #endif /* CONFIG_NET */
@@ -1,7 +1,7 @@
 /****************************************************************************
  * net/inet/inet_sockif.c
  *
- *   Copyright (C) 2017 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2017-2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -88,6 +88,14 @@ static ssize_t    inet_sendto(FAR struct socket *psock, FAR const void *buf,
 static ssize_t    inet_sendfile(FAR struct socket *psock, FAR struct file *infile,
                     FAR off_t *offset, size_t count);
 #endif
+static ssize_t    inet_sendmsg(FAR struct socket *psock,
+                    FAR const struct msghdr *msg, int flags);
+#if defined(NET_UDP_HAVE_STACK) && defined(CONFIG_NET_UDP_WRITE_BUFFERS) && \
+   !defined(CONFIG_NET_6LOWPAN)
+static int        inet_sendmmsg(FAR struct socket *psock,
+                    FAR struct mmsghdr *msgvec, unsigned int vlen,
+                    int flags);
+#endif
 
 /****************************************************************************
  * Private Data
@@ -112,6 +120,15 @@ static const struct sock_intf_s g_inet_sockif =
   inet_sendfile,    /* si_sendfile */
 #endif
   inet_recvfrom,    /* si_recvfrom */
+  inet_sendmsg,     /* si_sendmsg */
+  NULL,             /* si_recvmsg */
+#if defined(NET_UDP_HAVE_STACK) && defined(CONFIG_NET_UDP_WRITE_BUFFERS) && \
+   !defined(CONFIG_NET_6LOWPAN)
+  inet_sendmmsg,    /* si_sendmmsg */
+#else
+  NULL,             /* si_sendmmsg */
+#endif
+  inet_recvmmsg,    /* si_recvmmsg */
   inet_close        /* si_close */
 };
 
@@ -1110,45 +1127,17 @@ static ssize_t inet_sendto(FAR struct socket *psock, FAR const void *buf,
                            size_t len, int flags, FAR const struct sockaddr *to,
                            socklen_t tolen)
 {
-  socklen_t minlen;
   ssize_t nsent;
 
   /* Verify that a valid address has been provided */
 
-  switch (to->sa_family)
-    {
-#ifdef CONFIG_NET_IPv4
-    case AF_INET:
-      minlen = sizeof(struct sockaddr_in);
-      break;
-#endif
-
-#ifdef CONFIG_NET_IPv6
-    case AF_INET6:
-      minlen = sizeof(struct sockaddr_in6);
-      break;
-#endif
-
-    default:
-      nerr("ERROR: Unrecognized address family: %d\n", to->sa_family);
-      return -EAFNOSUPPORT;
-    }
-
-  if (tolen < minlen)
+  nsent = inet_sendto_checkaddr(psock, to, tolen);
+  if (nsent < 0)
     {
-      nerr("ERROR: Invalid address length: %d < %d\n", tolen, minlen);
-      return -EBADF;
+      return nsent;
     }
 
 #ifdef CONFIG_NET_UDP
-  /* If this is a connected socket, then return EISCONN */
-
-  if (psock->s_type != SOCK_DGRAM)
-    {
-      nerr("ERROR: Connected socket\n");
-      return -EBADF;
-    }
-
   /* Now handle the INET sendto() operation */
 
 #if defined(CONFIG_NET_6LOWPAN)
@@ -1187,9 +1176,9 @@ static ssize_t inet_sendto(FAR struct socket *psock, FAR const void *buf,
  *
  * Parameters:
  *   psock    An instance of the internal socket structure.
- *   buf      Data to send
- *   len      Length of data to send
- *   flags    Send flags
+ *   infile   The file structure of the input file
+ *   offset   Offset into the input file (or NULL to use the file position)
+ *   count    The number of bytes to send
  *
  * Returned Value:
  *   On success, returns the number of characters sent.  On  error,
@@ -1204,17 +1193,171 @@ static ssize_t inet_sendfile(FAR struct socket *psock,
                              size_t count)
 {
 #if defined(CONFIG_NET_TCP) && !defined(CONFIG_NET_TCP_NO_STACK)
-  return tcp_sendfile(psock, infile, offset, size_t count);
+  return tcp_sendfile(psock, infile, offset, count);
 #else
   return -ENOSYS;
 #endif
 }
 #endif
 
+/****************************************************************************
+ * Name: inet_sendmsg
+ *
+ * Description:
+ *   Implements the sendmsg() operation for the case of the AF_INET and
+ *   AF_INET6 sockets.  Buffered TCP copies all of the buffers into one
+ *   write buffer.  Other sockets gather the buffers and send them with one
+ *   sendto() so that a datagram, or a header and its payload, still go out
+ *   in a single packet.
+ *
+ * Parameters:
+ *   psock    A pointer to a NuttX-specific, internal socket structure
+ *   msg      The message to send
+ *   flags    Send flags
+ *
+ * Returned Value:
+ *   On success, returns the number of characters sent.  On  error,
+ *   a negated errno value is returned.  See sendmsg() for a list
+ *   appropriate error return values.
+ *
+ ****************************************************************************/
+
+static ssize_t inet_sendmsg(FAR struct socket *psock,
+                            FAR const struct msghdr *msg, int flags)
+{
+#if defined(NET_TCP_HAVE_STACK) && defined(CONFIG_NET_TCP_WRITE_BUFFERS) && \
+   !defined(CONFIG_NET_6LOWPAN)
+  if (psock->s_type == SOCK_STREAM && msg->msg_controllen == 0 &&
+      (msg->msg_name == NULL || msg->msg_namelen == 0))
+    {
+      return psock_tcp_sendv(psock, msg->msg_iov, msg->msg_iovlen);
+    }
+#endif
+
+  return psock_sendmsg_gather(psock, msg, flags);
+}
+
+/****************************************************************************
+ * Name: inet_sendmmsg
+ *
+ * Description:
+ *   Implements the si_sendmmsg() batch send method.  UDP datagrams are
+ *   queued in write buffers with a single acquisition of the network lock.
+ *   Messages on other socket types are sent one at a time.
+ *
+ * Input Parameters:
+ *   psock  - A pointer to a NuttX-specific, internal socket structure
+ *   msgvec - The messages to send
+ *   vlen   - The number of messages in 'msgvec'
+ *   flags  - Send flags
+ *
+ * Returned Value:
+ *   The number of messages sent.  If the first message cannot be sent, a
+ *   negated errno value is returned.
+ *
+ ****************************************************************************/
+
+#if defined(NET_UDP_HAVE_STACK) && defined(CONFIG_NET_UDP_WRITE_BUFFERS) && \
+   !defined(CONFIG_NET_6LOWPAN)
+static int inet_sendmmsg(FAR struct socket *psock,
+                         FAR struct mmsghdr *msgvec, unsigned int vlen,
+                         int flags)
+{
+  unsigned int nsent;
+  ssize_t ret;
+
+  if (psock->s_type == SOCK_DGRAM)
+    {
+      return psock_udp_sendmmsg(psock, msgvec, vlen, flags);
+    }
+
+  for (nsent = 0; nsent < vlen; nsent++)
+    {
+      ret = psock_sendmsg(psock, &msgvec[nsent].msg_hdr, flags);
+      if (ret < 0)
+        {
+          return nsent > 0 ? (int)nsent : (int)ret;
+        }
+
+      msgvec[nsent].msg_len = ret;
+    }
+
+  return nsent;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: inet_sendto_checkaddr
+ *
+ * Description:
+ *   Verify the destination address given to sendto() or in the msg_name of
+ *   a message sent with sendmmsg() on an AF_INET or AF_INET6 socket.
+ *
+ * Input Parameters:
+ *   psock - A pointer to a NuttX-specific, internal socket structure
+ *   to    - Address of recipient
+ *   tolen - The length of the address structure
+ *
+ * Returned Value:
+ *   Zero (OK) if the address may be used; otherwise a negated errno value:
+ *
+ *   EAFNOSUPPORT - The address family is not supported.
+ *   EBADF        - The address is too short for its family.
+ *   EISCONN      - The socket is connection-mode (not SOCK_DGRAM).
+ *
+ ****************************************************************************/
+
+int inet_sendto_checkaddr(FAR struct socket *psock,
+                          FAR const struct sockaddr *to, socklen_t tolen)
+{
+  socklen_t minlen;
+
+  if (tolen < sizeof(sa_family_t))
+    {
+      nerr("ERROR: Invalid address length: %d\n", tolen);
+      return -EBADF;
+    }
+
+  switch (to->sa_family)
+    {
+#ifdef CONFIG_NET_IPv4
+    case AF_INET:
+      minlen = sizeof(struct sockaddr_in);
+      break;
+#endif
+
+#ifdef CONFIG_NET_IPv6
+    case AF_INET6:
+      minlen = sizeof(struct sockaddr_in6);
+      break;
+#endif
+
+    default:
+      nerr("ERROR: Unrecognized address family: %d\n", to->sa_family);
+      return -EAFNOSUPPORT;
+    }
+
+  if (tolen < minlen)
+    {
+      nerr("ERROR: Invalid address length: %d < %d\n", tolen, minlen);
+      return -EBADF;
+    }
+
+  /* A destination cannot be given for a connection-mode socket */
+
+  if (psock->s_type != SOCK_DGRAM)
+    {
+      nerr("ERROR: Connected socket\n");
+      return -EISCONN;
+    }
+
+  return OK;
+}
+
 /****************************************************************************
  * Name: inet_sockif
  *
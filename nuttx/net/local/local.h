@@ -1,7 +1,7 @@
 /****************************************************************************
  * net/local/loal.h
  *
- *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2015, 2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -64,6 +64,11 @@
 #ifndef CONFIG_DISABLE_POLL
 #  define HAVE_LOCAL_POLL 1
 #  define LOCAL_ACCEPT_NPOLLWAITERS 2
+#  define LOCAL_RING_NPOLLWAITERS 2
+#endif
+
+#ifndef CONFIG_NET_LOCAL_RING_SIZE
+#  define CONFIG_NET_LOCAL_RING_SIZE 2048
 #endif
 
 /* Packet format in FIFO:
@@ -111,6 +116,37 @@ enum local_state_s
   LOCAL_STATE_DISCONNECTED     /* Peer disconnected */
 };
 
+#ifdef CONFIG_NET_LOCAL_RING
+/* The ring buffer used to receive on a connected SOCK_STREAM peer or a
+ * bound SOCK_DGRAM socket.  The ring belongs to the receiving socket.
+ * Senders hold a reference to it while they send (SOCK_DGRAM) or for the
+ * life of the connection (SOCK_STREAM).
+ */
+
+struct local_ring_s
+{
+  sem_t    lr_exclsem;         /* Mutually exclusive access to the ring */
+  sem_t    lr_rdsem;           /* Empty ring - Receiver waits for data */
+  sem_t    lr_wrsem;           /* Full ring - Senders wait for space */
+  uint16_t lr_size;            /* Size of lr_buffer in bytes */
+  uint16_t lr_rdndx;           /* Offset of the oldest record in lr_buffer */
+  uint16_t lr_nbytes;          /* Number of bytes of records in lr_buffer */
+  uint8_t  lr_nwriters;        /* Number of sender references */
+  uint8_t  lr_flags;           /* See LOCAL_RING_* definitions */
+
+#ifdef HAVE_LOCAL_POLL
+  /* The following are lists of poll structures of threads waiting for
+   * input (receiver) or output (senders) events.
+   */
+
+  struct pollfd *lr_rdfds[LOCAL_RING_NPOLLWAITERS];
+  struct pollfd *lr_wrfds[LOCAL_RING_NPOLLWAITERS];
+#endif
+
+  uint8_t  lr_buffer[1];       /* Ring buffer (allocated with the structure) */
+};
+#endif
+
 /* Representation of a local connection.  There are four types of
  * connection structures:
  *
@@ -144,8 +180,13 @@ struct local_conn_s
   uint8_t lc_proto;            /* SOCK_STREAM or SOCK_DGRAM */
   uint8_t lc_type;             /* See enum local_type_e */
   uint8_t lc_state;            /* See enum local_state_e */
+#ifdef CONFIG_NET_LOCAL_RING
+  FAR struct local_ring_s *lc_rxring; /* Receive ring (peers, bound SOCK_DGRAM) */
+  FAR struct local_ring_s *lc_txring; /* The peer's receive ring (peers) */
+#else
   struct file lc_infile;       /* File for read-only FIFO (peers) */
   struct file lc_outfile;      /* File descriptor of write-only FIFO (peers) */
+#endif
   char lc_path[UNIX_PATH_MAX]; /* Path assigned by bind() */
   int32_t lc_instance_id;      /* Connection instance ID for stream
                                 * server<->client connection pair */
@@ -218,12 +259,20 @@ EXTERN const struct sock_intf_s g_local_sockif;
 EXTERN dq_queue_t g_local_listeners;
 #endif
 
+#if defined(CONFIG_NET_LOCAL_RING) && defined(CONFIG_NET_LOCAL_DGRAM)
+/* A list of all bound SOCK_DGRAM connections */
+
+EXTERN dq_queue_t g_local_dgrams;
+#endif
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
 
 struct sockaddr; /* Forward reference */
 struct socket;   /* Forward reference */
+struct iovec;    /* Forward reference */
+struct msghdr;   /* Forward reference */
 
 /****************************************************************************
  * Name: local_initialize
@@ -418,6 +467,48 @@ ssize_t psock_local_sendto(FAR struct socket *psock, FAR const void *buf,
                            socklen_t tolen);
 #endif
 
+/****************************************************************************
+ * Name: local_dgram_findring
+ *
+ * Description:
+ *   Find the bound SOCK_DGRAM socket with the path 'path' and add a sender
+ *   reference to its receive ring.  The caller must release the reference
+ *   with local_ring_release().
+ *
+ * Returned Value:
+ *   The ring on success; NULL if there is no such socket.
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_NET_LOCAL_DGRAM) && defined(CONFIG_NET_LOCAL_RING)
+FAR struct local_ring_s *local_dgram_findring(FAR const char *path);
+#endif
+
+/****************************************************************************
+ * Name: psock_local_sendmsg
+ *
+ * Description:
+ *   Implements the Unix domain-specific logic of the sendmsg() socket
+ *   operation.  The data in all of the buffers of the message is queued
+ *   as a single message in the receiver's ring.  Open files may be passed
+ *   to the receiver with SOL_SOCKET/SCM_RIGHTS control messages.
+ *
+ * Input Parameters:
+ *   psock    A pointer to a NuttX-specific, internal socket structure
+ *   msg      The message to send
+ *   flags    Send flags
+ *
+ * Returned Value:
+ *   On success, returns the number of bytes sent.  On  error, a negated
+ *   errno value is returned.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_LOCAL_RING
+ssize_t psock_local_sendmsg(FAR struct socket *psock,
+                            FAR const struct msghdr *msg, int flags);
+#endif
+
 /****************************************************************************
  * Name: local_send_packet
  *
@@ -435,8 +526,10 @@ ssize_t psock_local_sendto(FAR struct socket *psock, FAR const void *buf,
  *
  ****************************************************************************/
 
+#ifndef CONFIG_NET_LOCAL_RING
 int local_send_packet(FAR struct file *filep, FAR const uint8_t *buf,
                       size_t len);
+#endif
 
 /****************************************************************************
  * Name: local_recvfrom
@@ -470,6 +563,31 @@ ssize_t local_recvfrom(FAR struct socket *psock, FAR void *buf,
                        size_t len, int flags, FAR struct sockaddr *from,
                        FAR socklen_t *fromlen);
 
+/****************************************************************************
+ * Name: psock_local_recvmsg
+ *
+ * Description:
+ *   Implements the Unix domain-specific logic of the recvmsg() socket
+ *   operation.  The data is received directly into the buffers of the
+ *   message.  Files passed by the sender are installed as new file
+ *   descriptors and returned in a SOL_SOCKET/SCM_RIGHTS control message.
+ *
+ * Input Parameters:
+ *   psock    A pointer to a NuttX-specific, internal socket structure
+ *   msg      The message to receive into
+ *   flags    Receive flags
+ *
+ * Returned Value:
+ *   On success, returns the number of bytes received.  Zero is returned
+ *   at the end of a stream.  On  error, a negated errno value is returned.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_LOCAL_RING
+ssize_t psock_local_recvmsg(FAR struct socket *psock,
+                            FAR struct msghdr *msg, int flags);
+#endif
+
 /****************************************************************************
  * Name: local_fifo_read
  *
@@ -490,7 +608,9 @@ ssize_t local_recvfrom(FAR struct socket *psock, FAR void *buf,
  *
  ****************************************************************************/
 
+#ifndef CONFIG_NET_LOCAL_RING
 int local_fifo_read(FAR struct file *filep, FAR uint8_t *buf, size_t *len);
+#endif
 
 /****************************************************************************
  * Name: local_getaddr
@@ -527,7 +647,9 @@ int local_getaddr(FAR struct local_conn_s *conn, FAR struct sockaddr *addr,
  *
  ****************************************************************************/
 
+#ifndef CONFIG_NET_LOCAL_RING
 int local_sync(FAR struct file *filep);
+#endif
 
 /****************************************************************************
  * Name: local_create_fifos
@@ -537,7 +659,7 @@ int local_sync(FAR struct file *filep);
  *
  ****************************************************************************/
 
-#ifdef CONFIG_NET_LOCAL_STREAM
+#if defined(CONFIG_NET_LOCAL_STREAM) && !defined(CONFIG_NET_LOCAL_RING)
 int local_create_fifos(FAR struct local_conn_s *conn);
 #endif
 
@@ -549,7 +671,7 @@ int local_create_fifos(FAR struct local_conn_s *conn);
  *
  ****************************************************************************/
 
-#ifdef CONFIG_NET_LOCAL_DGRAM
+#if defined(CONFIG_NET_LOCAL_DGRAM) && !defined(CONFIG_NET_LOCAL_RING)
 int local_create_halfduplex(FAR struct local_conn_s *conn,
                             FAR const char *path);
 #endif
@@ -562,7 +684,7 @@ int local_create_halfduplex(FAR struct local_conn_s *conn,
  *
  ****************************************************************************/
 
-#ifdef CONFIG_NET_LOCAL_STREAM
+#if defined(CONFIG_NET_LOCAL_STREAM) && !defined(CONFIG_NET_LOCAL_RING)
 int local_release_fifos(FAR struct local_conn_s *conn);
 #endif
 
@@ -574,7 +696,7 @@ int local_release_fifos(FAR struct local_conn_s *conn);
  *
  ****************************************************************************/
 
-#ifdef CONFIG_NET_LOCAL_DGRAM
+#if defined(CONFIG_NET_LOCAL_DGRAM) && !defined(CONFIG_NET_LOCAL_RING)
 int local_release_halfduplex(FAR struct local_conn_s *conn);
 #endif
 
@@ -586,7 +708,7 @@ int local_release_halfduplex(FAR struct local_conn_s *conn);
  *
  ****************************************************************************/
 
-#ifdef CONFIG_NET_LOCAL_STREAM
+#if defined(CONFIG_NET_LOCAL_STREAM) && !defined(CONFIG_NET_LOCAL_RING)
 int local_open_client_rx(FAR struct local_conn_s *client, bool nonblock);
 #endif
 
@@ -598,7 +720,7 @@ int local_open_client_rx(FAR struct local_conn_s *client, bool nonblock);
  *
  ****************************************************************************/
 
-#ifdef CONFIG_NET_LOCAL_STREAM
+#if defined(CONFIG_NET_LOCAL_STREAM) && !defined(CONFIG_NET_LOCAL_RING)
 int local_open_client_tx(FAR struct local_conn_s *client, bool nonblock);
 #endif
 
@@ -610,7 +732,7 @@ int local_open_client_tx(FAR struct local_conn_s *client, bool nonblock);
  *
  ****************************************************************************/
 
-#ifdef CONFIG_NET_LOCAL_STREAM
+#if defined(CONFIG_NET_LOCAL_STREAM) && !defined(CONFIG_NET_LOCAL_RING)
 int local_open_server_rx(FAR struct local_conn_s *server, bool nonblock);
 #endif
 
@@ -622,7 +744,7 @@ int local_open_server_rx(FAR struct local_conn_s *server, bool nonblock);
  *
  ****************************************************************************/
 
-#ifdef CONFIG_NET_LOCAL_STREAM
+#if defined(CONFIG_NET_LOCAL_STREAM) && !defined(CONFIG_NET_LOCAL_RING)
 int local_open_server_tx(FAR struct local_conn_s *server, bool nonblock);
 #endif
 
@@ -634,7 +756,7 @@ int local_open_server_tx(FAR struct local_conn_s *server, bool nonblock);
  *
  ****************************************************************************/
 
-#ifdef CONFIG_NET_LOCAL_DGRAM
+#if defined(CONFIG_NET_LOCAL_DGRAM) && !defined(CONFIG_NET_LOCAL_RING)
 int local_open_receiver(FAR struct local_conn_s *conn, bool nonblock);
 #endif
 
@@ -646,11 +768,118 @@ int local_open_receiver(FAR struct local_conn_s *conn, bool nonblock);
  *
  ****************************************************************************/
 
-#ifdef CONFIG_NET_LOCAL_DGRAM
+#if defined(CONFIG_NET_LOCAL_DGRAM) && !defined(CONFIG_NET_LOCAL_RING)
 int local_open_sender(FAR struct local_conn_s *conn, FAR const char *path,
                       bool nonblock);
 #endif
 
+/****************************************************************************
+ * Name: local_ring_alloc
+ *
+ * Description:
+ *   Allocate a new receive ring.  The caller holds the receiver reference.
+ *   'stream' selects byte stream (SOCK_STREAM) rather than datagram
+ *   (SOCK_DGRAM) semantics.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_LOCAL_RING
+FAR struct local_ring_s *local_ring_alloc(bool stream);
+#endif
+
+/****************************************************************************
+ * Name: local_ring_addwriter
+ *
+ * Description:
+ *   Add a sender reference to the ring.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_LOCAL_RING
+void local_ring_addwriter(FAR struct local_ring_s *ring);
+#endif
+
+/****************************************************************************
+ * Name: local_ring_release
+ *
+ * Description:
+ *   Release the receiver reference (writer == false) or a sender reference
+ *   (writer == true) to the ring.  The ring is freed when the last
+ *   reference is released.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_LOCAL_RING
+void local_ring_release(FAR struct local_ring_s *ring, bool writer);
+#endif
+
+/****************************************************************************
+ * Name: local_ring_send
+ *
+ * Description:
+ *   Queue a message, optionally with detached files to pass to the
+ *   receiver, in the ring.
+ *
+ * Input Parameters:
+ *   ring     - The receiver's ring
+ *   iov      - The I/O vector describing the data to send
+ *   iovcnt   - The number of buffers in 'iov'
+ *   files    - Detached files to pass with the message (may be NULL)
+ *   nfiles   - The number of files in 'files'
+ *   nonblock - True: Do not wait for space in the ring
+ *
+ * Returned Value:
+ *   The number of bytes queued on success; a negated errno value on
+ *   failure.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_LOCAL_RING
+ssize_t local_ring_send(FAR struct local_ring_s *ring,
+                        FAR const struct iovec *iov, int iovcnt,
+                        FAR struct file *files, int nfiles, bool nonblock);
+#endif
+
+/****************************************************************************
+ * Name: local_ring_recv
+ *
+ * Description:
+ *   Remove data, and any files passed with it, from the ring.
+ *
+ * Input Parameters:
+ *   ring     - The receiver's ring
+ *   iov      - The I/O vector describing where to return the data
+ *   iovcnt   - The number of buffers in 'iov'
+ *   files    - The location to return passed files (may be NULL)
+ *   nfiles   - In: The capacity of 'files'; Out: The number returned
+ *   nonblock - True: Do not wait for data
+ *
+ * Returned Value:
+ *   The number of bytes received on success, zero at the end of a stream,
+ *   or a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_LOCAL_RING
+ssize_t local_ring_recv(FAR struct local_ring_s *ring,
+                        FAR const struct iovec *iov, int iovcnt,
+                        FAR struct file *files, FAR int *nfiles,
+                        bool nonblock);
+#endif
+
+/****************************************************************************
+ * Name: local_ring_poll
+ *
+ * Description:
+ *   Set up or tear down monitoring of the ring on behalf of the receiver
+ *   (POLLIN) or a sender (POLLOUT).
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_NET_LOCAL_RING) && defined(HAVE_LOCAL_POLL)
+int local_ring_poll(FAR struct local_ring_s *ring, FAR struct pollfd *fds,
+                    bool reader, bool setup);
+#endif
 
 /****************************************************************************
  * Name: local_accept_pollnotify
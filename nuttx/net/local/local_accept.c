@@ -1,7 +1,7 @@
 /****************************************************************************
  * net/local/local_accept.c
  *
- *   Copyright (C) 2015, 2017 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2015, 2017-2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -184,6 +184,29 @@ int local_accept(FAR struct socket *psock, FAR struct sockaddr *addr,
               conn->lc_path[UNIX_PATH_MAX-1] = '\0';
               conn->lc_instance_id = client->lc_instance_id;
 
+#ifdef CONFIG_NET_LOCAL_RING
+              /* Allocate the ring that the server side receives on.  Then
+               * cross-connect the two sides:  Each sends on the ring of
+               * the other.
+               */
+
+              conn->lc_rxring = local_ring_alloc(true);
+              if (conn->lc_rxring == NULL)
+                {
+                  nerr("ERROR: Failed to allocate ring for %s\n",
+                       conn->lc_path);
+                  ret = -ENOMEM;
+                }
+              else
+                {
+                  conn->lc_txring = client->lc_rxring;
+                  local_ring_addwriter(conn->lc_txring);
+
+                  client->lc_txring = conn->lc_rxring;
+                  local_ring_addwriter(client->lc_txring);
+                  ret = OK;
+                }
+#else
               /* Open the server-side write-only FIFO.  This should not
                * block.
                */
@@ -195,8 +218,10 @@ int local_accept(FAR struct socket *psock, FAR struct sockaddr *addr,
                    nerr("ERROR: Failed to open write-only FIFOs for %s: %d\n",
                         conn->lc_path, ret);
                 }
+#endif
             }
 
+#ifndef CONFIG_NET_LOCAL_RING
           /* Do we have a connection?  Is the write-side FIFO opened? */
 
           if (ret == OK)
@@ -217,11 +242,15 @@ int local_accept(FAR struct socket *psock, FAR struct sockaddr *addr,
                 }
             }
 
+#endif
+
           /* Do we have a connection?  Are the FIFOs opened? */
 
           if (ret == OK)
             {
+#ifndef CONFIG_NET_LOCAL_RING
               DEBUGASSERT(conn->lc_infile.f_inode != NULL);
+#endif
 
               /* Return the address family */
 
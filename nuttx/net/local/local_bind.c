@@ -1,7 +1,7 @@
 /****************************************************************************
  * net/local/local_bind.c
  *
- *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2015, 2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -42,12 +42,73 @@
 
 #include <sys/socket.h>
 #include <string.h>
+#include <errno.h>
+#include <queue.h>
 #include <assert.h>
 
 #include <nuttx/net/net.h>
 
 #include "local/local.h"
 
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+#if defined(CONFIG_NET_LOCAL_RING) && defined(CONFIG_NET_LOCAL_DGRAM)
+/* A list of all bound SOCK_DGRAM connections */
+
+dq_queue_t g_local_dgrams;
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: local_dgram_bind
+ *
+ * Description:
+ *   Give a SOCK_DGRAM socket that is bound to a path a receive ring and
+ *   make it visible to senders.
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_NET_LOCAL_RING) && defined(CONFIG_NET_LOCAL_DGRAM)
+static int local_dgram_bind(FAR struct local_conn_s *conn,
+                            FAR const char *path)
+{
+  FAR struct local_conn_s *other;
+
+  if (conn->lc_rxring != NULL)
+    {
+      return -EINVAL;
+    }
+
+  net_lock();
+  for (other = (FAR struct local_conn_s *)g_local_dgrams.head;
+       other != NULL;
+       other = (FAR struct local_conn_s *)dq_next(&other->lc_node))
+    {
+      if (strncmp(other->lc_path, path, UNIX_PATH_MAX-1) == 0)
+        {
+          net_unlock();
+          return -EADDRINUSE;
+        }
+    }
+
+  conn->lc_rxring = local_ring_alloc(false);
+  if (conn->lc_rxring == NULL)
+    {
+      net_unlock();
+      return -ENOMEM;
+    }
+
+  dq_addlast(&conn->lc_node, &g_local_dgrams);
+  net_unlock();
+  return OK;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -103,6 +164,17 @@ int psock_local_bind(FAR struct socket *psock,
         {
           /* This is an normal, pathname Unix domain socket */
 
+#if defined(CONFIG_NET_LOCAL_RING) && defined(CONFIG_NET_LOCAL_DGRAM)
+          if (psock->s_type == SOCK_DGRAM)
+            {
+              int ret = local_dgram_bind(conn, unaddr->sun_path);
+              if (ret < 0)
+                {
+                  return ret;
+                }
+            }
+#endif
+
           conn->lc_type = LOCAL_TYPE_PATHNAME;
 
           /* Copy the path into the connection structure */
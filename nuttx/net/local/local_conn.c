@@ -1,7 +1,7 @@
 /****************************************************************************
  * net/local/local_conn.c
  *
- *   Copyright (C) 2015-2016 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2015-2016, 2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -70,6 +70,9 @@ void local_initialize(void)
 #ifdef CONFIG_NET_LOCAL_STREAM
   dq_init(&g_local_listeners);
 #endif
+#if defined(CONFIG_NET_LOCAL_RING) && defined(CONFIG_NET_LOCAL_DGRAM)
+  dq_init(&g_local_dgrams);
+#endif
 }
 
 /****************************************************************************
@@ -91,8 +94,10 @@ FAR struct local_conn_s *local_alloc(void)
     {
       /* Initialize non-zero elements the new connection structure */
 
+#ifndef CONFIG_NET_LOCAL_RING
       conn->lc_infile.f_inode  = NULL;
       conn->lc_outfile.f_inode = NULL;
+#endif
 
 #ifdef CONFIG_NET_LOCAL_STREAM
       /* This semaphore is used for signaling and, hence, should not have
@@ -124,6 +129,25 @@ void local_free(FAR struct local_conn_s *conn)
 {
   DEBUGASSERT(conn != NULL);
 
+#ifdef CONFIG_NET_LOCAL_RING
+  /* Release the receive ring and our reference to the peer's ring */
+
+  if (conn->lc_rxring != NULL)
+    {
+      local_ring_release(conn->lc_rxring, false);
+      conn->lc_rxring = NULL;
+    }
+
+  if (conn->lc_txring != NULL)
+    {
+      local_ring_release(conn->lc_txring, true);
+      conn->lc_txring = NULL;
+    }
+
+#ifdef CONFIG_NET_LOCAL_STREAM
+  nxsem_destroy(&conn->lc_waitsem);
+#endif
+#else
   /* Make sure that the read-only FIFO is closed */
 
   if (conn->lc_infile.f_inode != NULL)
@@ -146,6 +170,7 @@ void local_free(FAR struct local_conn_s *conn)
   local_release_fifos(conn);
   nxsem_destroy(&conn->lc_waitsem);
 #endif
+#endif /* CONFIG_NET_LOCAL_RING */
 
   /* And free the connection structure */
 
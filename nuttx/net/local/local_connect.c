@@ -1,7 +1,7 @@
 /****************************************************************************
  * net/local/local_connnect.c
  *
- *   Copyright (C) 2015-2017 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2015-2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -156,6 +156,20 @@ static int inline local_stream_connect(FAR struct local_conn_s *client,
   server->u.server.lc_pending++;
   DEBUGASSERT(server->u.server.lc_pending != 0);
 
+#ifdef CONFIG_NET_LOCAL_RING
+  /* Allocate the ring that the client will receive on.  The server will
+   * give us a reference to its ring when it accepts the connection.
+   */
+
+  client->lc_rxring = local_ring_alloc(true);
+  if (client->lc_rxring == NULL)
+    {
+      nerr("ERROR: Failed to allocate ring for %s\n", client->lc_path);
+
+      net_unlock();
+      return -ENOMEM;
+    }
+#else
   /* Create the FIFOs needed for the connection */
 
   ret = local_create_fifos(client);
@@ -183,6 +197,7 @@ static int inline local_stream_connect(FAR struct local_conn_s *client,
     }
 
   DEBUGASSERT(client->lc_outfile.f_inode != NULL);
+#endif /* CONFIG_NET_LOCAL_RING */
 
   /* Add ourself to the list of waiting connections and notify the server. */
 
@@ -212,9 +227,23 @@ static int inline local_stream_connect(FAR struct local_conn_s *client,
   if (ret < 0)
     {
       nerr("ERROR: Failed to connect: %d\n", ret);
+#ifdef CONFIG_NET_LOCAL_RING
+      local_ring_release(client->lc_rxring, false);
+      client->lc_rxring = NULL;
+      client->lc_state  = LOCAL_STATE_BOUND;
+      return ret;
+#else
       goto errout_with_outfd;
+#endif
     }
 
+#ifdef CONFIG_NET_LOCAL_RING
+  /* Yes.. The server has given us its ring to send on */
+
+  DEBUGASSERT(client->lc_txring != NULL);
+  client->lc_state = LOCAL_STATE_CONNECTED;
+  return OK;
+#else
   /* Yes.. open the read-only FIFO */
 
   ret = local_open_client_rx(client, nonblock);
@@ -237,6 +266,7 @@ errout_with_fifos:
   (void)local_release_fifos(client);
   client->lc_state = LOCAL_STATE_BOUND;
   return ret;
+#endif /* CONFIG_NET_LOCAL_RING */
 }
 
 /****************************************************************************
@@ -1,7 +1,7 @@
 /****************************************************************************
  * net/local/local_netpoll.c
  *
- *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2015, 2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -129,6 +129,71 @@ errout:
 }
 #endif
 
+/****************************************************************************
+ * Name: local_ring_pollsetup
+ *
+ * Description:
+ *   Set up or tear down monitoring of a socket that receives on a ring.
+ *   POLLIN is monitored on the socket's own receive ring and POLLOUT on the
+ *   peer's ring (SOCK_STREAM).  A SOCK_DGRAM socket can always send.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_LOCAL_RING
+static int local_ring_pollsetup(FAR struct local_conn_s *conn,
+                                FAR struct pollfd *fds, bool setup)
+{
+  int ret = OK;
+
+  if (!setup)
+    {
+      if (fds->priv == NULL)
+        {
+          return OK;
+        }
+
+      (void)local_ring_poll(conn->lc_rxring, fds, true, false);
+      if (conn->lc_txring != NULL)
+        {
+          (void)local_ring_poll(conn->lc_txring, fds, false, false);
+        }
+
+      fds->priv = NULL;
+      return OK;
+    }
+
+  if ((fds->events & POLLIN) != 0)
+    {
+      ret = local_ring_poll(conn->lc_rxring, fds, true, true);
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+
+  if ((fds->events & POLLOUT) != 0)
+    {
+      if (conn->lc_txring != NULL)
+        {
+          ret = local_ring_poll(conn->lc_txring, fds, false, true);
+          if (ret < 0)
+            {
+              (void)local_ring_poll(conn->lc_rxring, fds, true, false);
+              return ret;
+            }
+        }
+      else
+        {
+          fds->revents |= POLLOUT;
+          nxsem_post(fds->sem);
+        }
+    }
+
+  fds->priv = conn;
+  return OK;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -182,6 +247,17 @@ int local_pollsetup(FAR struct socket *psock, FAR struct pollfd *fds)
 
   conn = (FAR struct local_conn_s *)psock->s_conn;
 
+#ifdef CONFIG_NET_LOCAL_RING
+  /* Connected SOCK_STREAM peers and bound SOCK_DGRAM sockets receive on a
+   * ring.
+   */
+
+  if (conn->lc_rxring != NULL)
+    {
+      return local_ring_pollsetup(conn, fds, true);
+    }
+#endif
+
   if (conn->lc_proto == SOCK_DGRAM)
     {
       return ret;
@@ -200,6 +276,12 @@ int local_pollsetup(FAR struct socket *psock, FAR struct pollfd *fds)
       goto pollerr;
     }
 
+#ifdef CONFIG_NET_LOCAL_RING
+  /* The socket is not connected */
+
+  fds->priv = NULL;
+  goto pollerr;
+#else
   switch (fds->events & (POLLIN | POLLOUT))
     {
       case (POLLIN | POLLOUT):
@@ -289,7 +371,8 @@ int local_pollsetup(FAR struct socket *psock, FAR struct pollfd *fds)
         ret = OK;
         break;
     }
-#endif
+#endif /* CONFIG_NET_LOCAL_RING */
+#endif /* CONFIG_NET_LOCAL_STREAM */
 
   return ret;
 
@@ -323,6 +406,13 @@ int local_pollteardown(FAR struct socket *psock, FAR struct pollfd *fds)
 
   conn = (FAR struct local_conn_s *)psock->s_conn;
 
+#ifdef CONFIG_NET_LOCAL_RING
+  if (conn->lc_rxring != NULL)
+    {
+      return local_ring_pollsetup(conn, fds, false);
+    }
+#endif
+
   if (conn->lc_proto == SOCK_DGRAM)
     {
       return ret;
@@ -340,6 +430,7 @@ int local_pollteardown(FAR struct socket *psock, FAR struct pollfd *fds)
       return OK;
     }
 
+#ifndef CONFIG_NET_LOCAL_RING
   switch (fds->events & (POLLIN | POLLOUT))
     {
       case (POLLIN | POLLOUT):
@@ -396,7 +487,8 @@ int local_pollteardown(FAR struct socket *psock, FAR struct pollfd *fds)
       default:
         break;
     }
-#endif
+#endif /* !CONFIG_NET_LOCAL_RING */
+#endif /* CONFIG_NET_LOCAL_STREAM */
 
   return status;
 }
@@ -1,7 +1,7 @@
 /****************************************************************************
  * net/local/local_recvfrom.c
  *
- *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2015, 2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -42,6 +42,7 @@
 
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 #include <errno.h>
 #include <assert.h>
@@ -64,6 +65,7 @@
  * Private Functions
  ****************************************************************************/
 
+#ifndef CONFIG_NET_LOCAL_RING
 /****************************************************************************
  * Name: psock_fifo_read
  *
@@ -118,6 +120,7 @@ static int psock_fifo_read(FAR struct socket *psock, FAR void *buf,
 
   return OK;
 }
+#endif /* !CONFIG_NET_LOCAL_RING */
 
 /****************************************************************************
  * Name: psock_stream_recvfrom
@@ -148,6 +151,9 @@ psock_stream_recvfrom(FAR struct socket *psock, FAR void *buf, size_t len,
                       FAR socklen_t *fromlen)
 {
   FAR struct local_conn_s *conn = (FAR struct local_conn_s *)psock->s_conn;
+#ifdef CONFIG_NET_LOCAL_RING
+  struct iovec iov;
+#endif
   size_t readlen;
   int ret;
 
@@ -159,6 +165,26 @@ psock_stream_recvfrom(FAR struct socket *psock, FAR void *buf, size_t len,
       return -ENOTCONN;
     }
 
+#ifdef CONFIG_NET_LOCAL_RING
+  /* Take as much of the queued data as will fit.  Zero is returned when
+   * the peer has closed its socket and all of the data has been received.
+   */
+
+  DEBUGASSERT(conn->lc_rxring != NULL);
+
+  iov.iov_base = buf;
+  iov.iov_len  = len;
+
+  ret = local_ring_recv(conn->lc_rxring, &iov, 1, NULL, NULL,
+                        _SS_ISNONBLOCK(psock->s_flags) ||
+                        (flags & MSG_DONTWAIT) != 0);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  readlen = ret;
+#else
   /* The incoming FIFO should be open */
 
   DEBUGASSERT(conn->lc_infile.f_inode != NULL);
@@ -199,6 +225,7 @@ psock_stream_recvfrom(FAR struct socket *psock, FAR void *buf, size_t len,
 
   DEBUGASSERT(readlen <= conn->u.peer.lc_remaining);
   conn->u.peer.lc_remaining -= readlen;
+#endif /* CONFIG_NET_LOCAL_RING */
 
   /* Return the address family */
 
@@ -243,7 +270,11 @@ psock_dgram_recvfrom(FAR struct socket *psock, FAR void *buf, size_t len,
                      FAR socklen_t *fromlen)
 {
   FAR struct local_conn_s *conn = (FAR struct local_conn_s *)psock->s_conn;
+#ifdef CONFIG_NET_LOCAL_RING
+  struct iovec iov;
+#else
   uint16_t pktlen;
+#endif
   size_t readlen;
   int ret;
 
@@ -263,6 +294,30 @@ psock_dgram_recvfrom(FAR struct socket *psock, FAR void *buf, size_t len,
       return -EISCONN;
     }
 
+#ifdef CONFIG_NET_LOCAL_RING
+  /* Only sockets bound to a path have a receive ring */
+
+  if (conn->lc_rxring == NULL)
+    {
+      nerr("ERROR: Not bound to a path\n");
+      return -EINVAL;
+    }
+
+  /* Receive one datagram.  Any part that does not fit is discarded. */
+
+  iov.iov_base = buf;
+  iov.iov_len  = len;
+
+  ret = local_ring_recv(conn->lc_rxring, &iov, 1, NULL, NULL,
+                        _SS_ISNONBLOCK(psock->s_flags) ||
+                        (flags & MSG_DONTWAIT) != 0);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  readlen = ret;
+#else
   /* The incoming FIFO should not be open */
 
   DEBUGASSERT(conn->lc_infile.f_inode == NULL);
@@ -331,8 +386,8 @@ psock_dgram_recvfrom(FAR struct socket *psock, FAR void *buf, size_t len,
         {
           /* Read 32 bytes into the bit bucket */
 
-          readlen = MIN(remaining, 32);
-          ret     = psock_fifo_read(psock, bitbucket, &tmplen);
+          tmplen = MIN(remaining, 32);
+          ret    = psock_fifo_read(psock, bitbucket, &tmplen);
           if (ret < 0)
             {
               goto errout_with_infd;
@@ -354,6 +409,7 @@ psock_dgram_recvfrom(FAR struct socket *psock, FAR void *buf, size_t len,
   /* Release our reference to the half duplex FIFO */
 
   (void)local_release_halfduplex(conn);
+#endif /* CONFIG_NET_LOCAL_RING */
 
   /* Return the address family */
 
@@ -368,6 +424,7 @@ psock_dgram_recvfrom(FAR struct socket *psock, FAR void *buf, size_t len,
 
   return readlen;
 
+#ifndef CONFIG_NET_LOCAL_RING
 errout_with_infd:
   /* Close the read-only file descriptor */
 
@@ -379,8 +436,9 @@ errout_with_halfduplex:
 
   (void)local_release_halfduplex(conn);
   return ret;
+#endif /* !CONFIG_NET_LOCAL_RING */
 }
-#endif /* CONFIG_NET_LOCAL_STREAM */
+#endif /* CONFIG_NET_LOCAL_DGRAM */
 
 /****************************************************************************
  * Public Functions
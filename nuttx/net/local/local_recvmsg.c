@@ -0,0 +1,244 @@
+/****************************************************************************
+ * net/local/local_recvmsg.c
+ *
+ *   Copyright (C) 2018 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+#if defined(CONFIG_NET) && defined(CONFIG_NET_LOCAL_RING)
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <errno.h>
+#include <assert.h>
+#include <debug.h>
+
+#include <nuttx/fs/fs.h>
+#include <nuttx/net/net.h>
+
+#include "socket/socket.h"
+#include "local/local.h"
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: local_recvmsg_files
+ *
+ * Description:
+ *   Install the files passed with a message as new file descriptors of the
+ *   calling task and return them in a SOL_SOCKET/SCM_RIGHTS control
+ *   message.  Files that cannot be returned are closed and MSG_CTRUNC is
+ *   set in the message flags.
+ *
+ * Input Parameters:
+ *   msg    - The message being received
+ *   files  - The detached files received with the message
+ *   nfiles - The number of files in 'files'
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+static void local_recvmsg_files(FAR struct msghdr *msg,
+                                FAR struct file *files, int nfiles)
+{
+  FAR struct cmsghdr *cmsg = NULL;
+  FAR int *fds = NULL;
+  socklen_t space;
+  int maxfds = 0;
+  int nfds = 0;
+  int fd;
+  int i;
+
+  space = msg->msg_control != NULL ? msg->msg_controllen : 0;
+  msg->msg_controllen = 0;
+
+  if (nfiles == 0)
+    {
+      return;
+    }
+
+  /* How many descriptors fit in the control buffer? */
+
+  if (space >= CMSG_LEN(sizeof(int)))
+    {
+      cmsg   = (FAR struct cmsghdr *)msg->msg_control;
+      fds    = (FAR int *)CMSG_DATA(cmsg);
+      maxfds = (space - CMSG_LEN(0)) / sizeof(int);
+    }
+
+  for (i = 0; i < nfiles; i++)
+    {
+      if (nfds < maxfds)
+        {
+          fd = file_attach(&files[i], 0);
+          if (fd >= 0)
+            {
+              fds[nfds++] = fd;
+              continue;
+            }
+        }
+
+      /* There is no room for the descriptor (or no descriptor could be
+       * allocated).  Drop the file.
+       */
+
+      (void)file_close_detached(&files[i]);
+      msg->msg_flags |= MSG_CTRUNC;
+    }
+
+  if (nfds > 0)
+    {
+      cmsg->cmsg_len      = CMSG_LEN(nfds * sizeof(int));
+      cmsg->cmsg_level    = SOL_SOCKET;
+      cmsg->cmsg_type     = SCM_RIGHTS;
+      msg->msg_controllen = cmsg->cmsg_len;
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: psock_local_recvmsg
+ *
+ * Description:
+ *   Implements the Unix domain-specific logic of the recvmsg() socket
+ *   operation.  The data is received directly into the buffers of the
+ *   message.  Files passed by the sender are installed as new file
+ *   descriptors and returned in a SOL_SOCKET/SCM_RIGHTS control message.
+ *
+ * Input Parameters:
+ *   psock    A pointer to a NuttX-specific, internal socket structure
+ *   msg      The message to receive into
+ *   flags    Receive flags
+ *
+ * Returned Value:
+ *   On success, returns the number of bytes received.  Zero is returned
+ *   at the end of a stream.  On  error, a negated errno value is returned.
+ *
+ ****************************************************************************/
+
+ssize_t psock_local_recvmsg(FAR struct socket *psock,
+                            FAR struct msghdr *msg, int flags)
+{
+  FAR struct local_conn_s *conn = (FAR struct local_conn_s *)psock->s_conn;
+  struct file files[CONFIG_NET_LOCAL_NFILES];
+  int nfiles = CONFIG_NET_LOCAL_NFILES;
+  ssize_t nrecvd;
+  int ret;
+
+  DEBUGASSERT(conn != NULL && msg != NULL);
+
+#ifdef CONFIG_NET_LOCAL_STREAM
+  if (psock->s_type == SOCK_STREAM)
+    {
+      /* Verify that this is a connected peer socket */
+
+      if (conn->lc_state != LOCAL_STATE_CONNECTED)
+        {
+          nerr("ERROR: not connected\n");
+          return -ENOTCONN;
+        }
+    }
+  else
+#endif
+#ifdef CONFIG_NET_LOCAL_DGRAM
+  if (psock->s_type == SOCK_DGRAM)
+    {
+      /* Verify that this is a bound, un-connected socket with a receive
+       * ring.
+       */
+
+      if (conn->lc_state != LOCAL_STATE_BOUND)
+        {
+          nerr("ERROR: Connected or not bound\n");
+          return -EISCONN;
+        }
+    }
+  else
+#endif
+    {
+      return -EINVAL;
+    }
+
+  if (conn->lc_rxring == NULL)
+    {
+      nerr("ERROR: No receive ring\n");
+      return -EINVAL;
+    }
+
+  /* Receive directly into the caller's buffers */
+
+  nrecvd = local_ring_recv(conn->lc_rxring, msg->msg_iov, msg->msg_iovlen,
+                           files, &nfiles,
+                           _SS_ISNONBLOCK(psock->s_flags) ||
+                           (flags & MSG_DONTWAIT) != 0);
+  if (nrecvd < 0)
+    {
+      return nrecvd;
+    }
+
+  /* Return any passed files as new descriptors */
+
+  local_recvmsg_files(msg, files, nfiles);
+
+  /* Return the address, as recvfrom() does */
+
+  if (psock->s_type == SOCK_DGRAM && msg->msg_name != NULL)
+    {
+      ret = local_getaddr(conn, (FAR struct sockaddr *)msg->msg_name,
+                          &msg->msg_namelen);
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+  else
+    {
+      msg->msg_namelen = 0;
+    }
+
+  return nrecvd;
+}
+
+#endif /* CONFIG_NET && CONFIG_NET_LOCAL_RING */
@@ -1,7 +1,7 @@
 /****************************************************************************
  * net/local/local_recvpacket.c
  *
- *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2015, 2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -57,6 +57,7 @@
  * Public Functions
  ****************************************************************************/
 
+#ifndef CONFIG_NET_LOCAL_RING
 /****************************************************************************
  * Name: local_fifo_read
  *
@@ -188,6 +189,7 @@ int local_sync(FAR struct file *filep)
   ret     = local_fifo_read(filep, (FAR uint8_t *)&pktlen, &readlen);
   return ret < 0 ? ret : pktlen;
 }
+#endif /* !CONFIG_NET_LOCAL_RING */
 
 /****************************************************************************
  * Name: local_getaddr
@@ -1,7 +1,7 @@
 /****************************************************************************
  * net/local/local_release.c
  *
- *   Copyright (C) 2015, 2017 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2015, 2017-2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -119,6 +119,17 @@ int local_release(FAR struct local_conn_s *conn)
     }
 #endif /* CONFIG_NET_LOCAL_STREAM */
 
+#if defined(CONFIG_NET_LOCAL_RING) && defined(CONFIG_NET_LOCAL_DGRAM)
+  /* Is the socket a bound SOCK_DGRAM socket that receives on a ring? */
+
+  if (conn->lc_proto == SOCK_DGRAM && conn->lc_rxring != NULL)
+    {
+      /* Remove it from the list of bound datagram sockets */
+
+      dq_rem(&conn->lc_node, &g_local_dgrams);
+    }
+#endif
+
   /* For the remaining states (LOCAL_STATE_UNBOUND and LOCAL_STATE_UNBOUND),
    * we simply free the connection structure.
    */
@@ -0,0 +1,1017 @@
+/****************************************************************************
+ * net/local/local_ring.c
+ *
+ *   Copyright (C) 2018 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+#if defined(CONFIG_NET) && defined(CONFIG_NET_LOCAL_RING)
+
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sched.h>
+#include <errno.h>
+#include <assert.h>
+#include <debug.h>
+
+#include <nuttx/kmalloc.h>
+#include <nuttx/semaphore.h>
+#include <nuttx/fs/fs.h>
+
+#include "local/local.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Ring record format:
+ *
+ * 1. Record header (struct local_rechdr_s)
+ * 2. lh_nfiles detached file structures (struct file)
+ * 3. lh_len bytes of message data
+ *
+ * A record may wrap around the end of the ring buffer.
+ */
+
+#define LOCAL_RECHDR_SIZE  sizeof(struct local_rechdr_s)
+#define LOCAL_FILES_SIZE(n) ((n) * sizeof(struct file))
+
+/* lr_flags bit definitions */
+
+#define LOCAL_RING_STREAM  (1 << 0) /* Bit 0: Byte stream (not datagrams) */
+#define LOCAL_RING_READER  (1 << 1) /* Bit 1: The receiver is attached */
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* The header that precedes each message in the ring */
+
+struct local_rechdr_s
+{
+  uint16_t lh_len;             /* Number of bytes of message data */
+  uint8_t  lh_nfiles;          /* Number of files passed with the message */
+  uint8_t  lh_reserved;
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: local_ring_semtake
+ ****************************************************************************/
+
+static void local_ring_semtake(FAR sem_t *sem)
+{
+  int ret;
+
+  do
+    {
+      /* Take the semaphore (perhaps waiting) */
+
+      ret = nxsem_wait(sem);
+
+      /* The only case that an error should occur here is if the wait was
+       * awakened by a signal.
+       */
+
+      DEBUGASSERT(ret == OK || ret == -EINTR);
+    }
+  while (ret == -EINTR);
+}
+
+/****************************************************************************
+ * Name: local_ring_wait
+ *
+ * Description:
+ *   Release the ring, wait on 'sem' for the other side and then take the
+ *   ring again.
+ *
+ * Returned Value:
+ *   Zero (OK) on success with the ring held; a negated errno value (-EINTR)
+ *   if the wait was interrupted in which case the ring is not held.
+ *
+ ****************************************************************************/
+
+static int local_ring_wait(FAR struct local_ring_s *ring, FAR sem_t *sem)
+{
+  int ret;
+
+  sched_lock();
+  nxsem_post(&ring->lr_exclsem);
+  ret = nxsem_wait(sem);
+  sched_unlock();
+
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  local_ring_semtake(&ring->lr_exclsem);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: local_ring_copyin
+ *
+ * Description:
+ *   Copy 'len' bytes into the ring buffer at offset 'ndx', wrapping around
+ *   at the end of the buffer.  Returns the offset following the data.
+ *
+ ****************************************************************************/
+
+static uint16_t local_ring_copyin(FAR struct local_ring_s *ring,
+                                  uint16_t ndx, FAR const void *buf,
+                                  size_t len)
+{
+  size_t nfirst = ring->lr_size - ndx;
+
+  if (nfirst > len)
+    {
+      memcpy(&ring->lr_buffer[ndx], buf, len);
+      return ndx + len;
+    }
+
+  memcpy(&ring->lr_buffer[ndx], buf, nfirst);
+  memcpy(ring->lr_buffer, (FAR const uint8_t *)buf + nfirst, len - nfirst);
+  return len - nfirst;
+}
+
+/****************************************************************************
+ * Name: local_ring_copyout
+ *
+ * Description:
+ *   Copy 'len' bytes out of the ring buffer at offset 'ndx', wrapping around
+ *   at the end of the buffer.  Returns the offset following the data.
+ *
+ ****************************************************************************/
+
+static uint16_t local_ring_copyout(FAR struct local_ring_s *ring,
+                                   uint16_t ndx, FAR void *buf, size_t len)
+{
+  size_t nfirst = ring->lr_size - ndx;
+
+  if (nfirst > len)
+    {
+      memcpy(buf, &ring->lr_buffer[ndx], len);
+      return ndx + len;
+    }
+
+  memcpy(buf, &ring->lr_buffer[ndx], nfirst);
+  memcpy((FAR uint8_t *)buf + nfirst, ring->lr_buffer, len - nfirst);
+  return len - nfirst;
+}
+
+/****************************************************************************
+ * Name: local_ring_copyiniov
+ *
+ * Description:
+ *   Copy 'len' bytes, starting 'offset' bytes into the data described by
+ *   the I/O vector 'iov', into the ring buffer at offset 'ndx'.  Returns the
+ *   ring offset following the data.
+ *
+ ****************************************************************************/
+
+static uint16_t local_ring_copyiniov(FAR struct local_ring_s *ring,
+                                     uint16_t ndx,
+                                     FAR const struct iovec *iov,
+                                     size_t offset, size_t len)
+{
+  size_t ncopy;
+
+  /* Skip over the buffers that have already been sent */
+
+  while (len > 0 && offset >= iov->iov_len)
+    {
+      offset -= iov->iov_len;
+      iov++;
+    }
+
+  while (len > 0)
+    {
+      ncopy = iov->iov_len - offset;
+      if (ncopy > len)
+        {
+          ncopy = len;
+        }
+
+      ndx     = local_ring_copyin(ring, ndx,
+                                  (FAR const uint8_t *)iov->iov_base +
+                                  offset, ncopy);
+      len    -= ncopy;
+      offset  = 0;
+      iov++;
+    }
+
+  return ndx;
+}
+
+/****************************************************************************
+ * Name: local_ring_copyoutiov
+ *
+ * Description:
+ *   Copy 'len' bytes out of the ring buffer at offset 'ndx' into the
+ *   buffers described by the I/O vector 'iov', starting 'offset' bytes into
+ *   that data.
+ *
+ ****************************************************************************/
+
+static void local_ring_copyoutiov(FAR struct local_ring_s *ring,
+                                  uint16_t ndx, FAR const struct iovec *iov,
+                                  size_t offset, size_t len)
+{
+  size_t ncopy;
+
+  /* Skip over the buffers that have already been filled */
+
+  while (len > 0 && offset >= iov->iov_len)
+    {
+      offset -= iov->iov_len;
+      iov++;
+    }
+
+  while (len > 0)
+    {
+      ncopy = iov->iov_len - offset;
+      if (ncopy > len)
+        {
+          ncopy = len;
+        }
+
+      ndx     = local_ring_copyout(ring, ndx,
+                                   (FAR uint8_t *)iov->iov_base + offset,
+                                   ncopy);
+      len    -= ncopy;
+      offset  = 0;
+      iov++;
+    }
+}
+
+/****************************************************************************
+ * Name: local_ring_offset
+ *
+ * Description:
+ *   Return the ring buffer offset 'len' bytes after offset 'ndx'.
+ *
+ ****************************************************************************/
+
+static uint16_t local_ring_offset(FAR struct local_ring_s *ring,
+                                  uint16_t ndx, size_t len)
+{
+  size_t offset = ndx + len;
+
+  if (offset >= ring->lr_size)
+    {
+      offset -= ring->lr_size;
+    }
+
+  return offset;
+}
+
+/****************************************************************************
+ * Name: local_ring_advance
+ *
+ * Description:
+ *   Remove 'len' bytes from the head of the ring.
+ *
+ ****************************************************************************/
+
+static void local_ring_advance(FAR struct local_ring_s *ring, size_t len)
+{
+  size_t ndx = ring->lr_rdndx + len;
+
+  DEBUGASSERT(len <= ring->lr_nbytes);
+
+  if (ndx >= ring->lr_size)
+    {
+      ndx -= ring->lr_size;
+    }
+
+  ring->lr_rdndx   = ndx;
+  ring->lr_nbytes -= len;
+}
+
+/****************************************************************************
+ * Name: local_ring_takefiles
+ *
+ * Description:
+ *   Remove the files passed with the oldest message from the ring and
+ *   return them in 'files' (up to 'maxfiles' of them).  Files that do not
+ *   fit are closed.  The record header is moved up to the message data.
+ *
+ * Returned Value:
+ *   The number of files returned in 'files'.
+ *
+ ****************************************************************************/
+
+static int local_ring_takefiles(FAR struct local_ring_s *ring,
+                                FAR struct local_rechdr_s *hdr,
+                                FAR struct file *files, int maxfiles)
+{
+  struct file tmp;
+  uint16_t ndx;
+  int nfiles = 0;
+  int i;
+
+  ndx = local_ring_offset(ring, ring->lr_rdndx, LOCAL_RECHDR_SIZE);
+  for (i = 0; i < hdr->lh_nfiles; i++)
+    {
+      ndx = local_ring_copyout(ring, ndx, &tmp, sizeof(struct file));
+      if (files != NULL && nfiles < maxfiles)
+        {
+          files[nfiles++] = tmp;
+        }
+      else
+        {
+          (void)file_close_detached(&tmp);
+        }
+    }
+
+  /* The header now precedes the data directly */
+
+  local_ring_advance(ring, LOCAL_FILES_SIZE(hdr->lh_nfiles));
+  hdr->lh_nfiles = 0;
+  (void)local_ring_copyin(ring, ring->lr_rdndx, hdr, LOCAL_RECHDR_SIZE);
+  return nfiles;
+}
+
+/****************************************************************************
+ * Name: local_ring_pollnotify
+ ****************************************************************************/
+
+#ifdef HAVE_LOCAL_POLL
+static void local_ring_pollnotify(FAR struct pollfd **slots,
+                                  pollevent_t eventset)
+{
+  FAR struct pollfd *fds;
+  int i;
+
+  for (i = 0; i < LOCAL_RING_NPOLLWAITERS; i++)
+    {
+      fds = slots[i];
+      if (fds != NULL)
+        {
+          fds->revents |= eventset & (fds->events | POLLERR | POLLHUP);
+          if (fds->revents != 0)
+            {
+              ninfo("Report events: %02x\n", fds->revents);
+              nxsem_post(fds->sem);
+            }
+        }
+    }
+}
+#else
+#  define local_ring_pollnotify(slots,eventset)
+#endif
+
+/****************************************************************************
+ * Name: local_ring_rdnotify
+ *
+ * Description:
+ *   Wake up receivers waiting for data and notify poll() waiters.
+ *
+ ****************************************************************************/
+
+static void local_ring_rdnotify(FAR struct local_ring_s *ring,
+                                pollevent_t eventset)
+{
+  int sval;
+
+  while (nxsem_getvalue(&ring->lr_rdsem, &sval) == 0 && sval < 0)
+    {
+      nxsem_post(&ring->lr_rdsem);
+    }
+
+  local_ring_pollnotify(ring->lr_rdfds, eventset);
+}
+
+/****************************************************************************
+ * Name: local_ring_wrnotify
+ *
+ * Description:
+ *   Wake up senders waiting for space and notify poll() waiters.
+ *
+ ****************************************************************************/
+
+static void local_ring_wrnotify(FAR struct local_ring_s *ring,
+                                pollevent_t eventset)
+{
+  int sval;
+
+  while (nxsem_getvalue(&ring->lr_wrsem, &sval) == 0 && sval < 0)
+    {
+      nxsem_post(&ring->lr_wrsem);
+    }
+
+  local_ring_pollnotify(ring->lr_wrfds, eventset);
+}
+
+/****************************************************************************
+ * Name: local_ring_free
+ *
+ * Description:
+ *   Free a ring that has no remaining users.  Files still queued in the
+ *   ring are closed.
+ *
+ ****************************************************************************/
+
+static void local_ring_free(FAR struct local_ring_s *ring)
+{
+  struct local_rechdr_s hdr;
+
+  while (ring->lr_nbytes > 0)
+    {
+      (void)local_ring_copyout(ring, ring->lr_rdndx, &hdr,
+                               LOCAL_RECHDR_SIZE);
+      if (hdr.lh_nfiles > 0)
+        {
+          (void)local_ring_takefiles(ring, &hdr, NULL, 0);
+        }
+
+      local_ring_advance(ring, LOCAL_RECHDR_SIZE + hdr.lh_len);
+    }
+
+  nxsem_destroy(&ring->lr_exclsem);
+  nxsem_destroy(&ring->lr_rdsem);
+  nxsem_destroy(&ring->lr_wrsem);
+  kmm_free(ring);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: local_ring_alloc
+ *
+ * Description:
+ *   Allocate a new receive ring.  The caller holds the receiver reference.
+ *
+ * Input Parameters:
+ *   stream - True if the ring carries a byte stream (SOCK_STREAM), false if
+ *            it carries datagrams (SOCK_DGRAM).
+ *
+ * Returned Value:
+ *   The new ring on success; NULL if memory could not be allocated.
+ *
+ ****************************************************************************/
+
+FAR struct local_ring_s *local_ring_alloc(bool stream)
+{
+  FAR struct local_ring_s *ring;
+
+  ring = (FAR struct local_ring_s *)
+    kmm_zalloc(sizeof(struct local_ring_s) + CONFIG_NET_LOCAL_RING_SIZE - 1);
+
+  if (ring != NULL)
+    {
+      nxsem_init(&ring->lr_exclsem, 0, 1);
+      nxsem_init(&ring->lr_rdsem, 0, 0);
+      nxsem_init(&ring->lr_wrsem, 0, 0);
+
+      /* The read/write wait semaphores are used for signaling and, hence,
+       * should not have priority inheritance enabled.
+       */
+
+      nxsem_setprotocol(&ring->lr_rdsem, SEM_PRIO_NONE);
+      nxsem_setprotocol(&ring->lr_wrsem, SEM_PRIO_NONE);
+
+      ring->lr_size  = CONFIG_NET_LOCAL_RING_SIZE;
+      ring->lr_flags = LOCAL_RING_READER;
+
+      if (stream)
+        {
+          ring->lr_flags |= LOCAL_RING_STREAM;
+        }
+    }
+
+  return ring;
+}
+
+/****************************************************************************
+ * Name: local_ring_addwriter
+ *
+ * Description:
+ *   Add a sender reference to the ring.
+ *
+ ****************************************************************************/
+
+void local_ring_addwriter(FAR struct local_ring_s *ring)
+{
+  local_ring_semtake(&ring->lr_exclsem);
+  DEBUGASSERT(ring->lr_nwriters < UINT8_MAX);
+  ring->lr_nwriters++;
+  nxsem_post(&ring->lr_exclsem);
+}
+
+/****************************************************************************
+ * Name: local_ring_release
+ *
+ * Description:
+ *   Release the receiver reference (writer == false) or a sender reference
+ *   (writer == true) to the ring.  The other side is notified and the ring
+ *   is freed when the last reference is released.
+ *
+ ****************************************************************************/
+
+void local_ring_release(FAR struct local_ring_s *ring, bool writer)
+{
+  bool unused;
+
+  local_ring_semtake(&ring->lr_exclsem);
+
+  if (writer)
+    {
+      DEBUGASSERT(ring->lr_nwriters > 0);
+      ring->lr_nwriters--;
+
+      /* The end of a stream is reached when the sender is gone */
+
+      if (ring->lr_nwriters == 0 &&
+          (ring->lr_flags & LOCAL_RING_STREAM) != 0)
+        {
+          local_ring_rdnotify(ring, POLLHUP);
+        }
+    }
+  else
+    {
+      DEBUGASSERT((ring->lr_flags & LOCAL_RING_READER) != 0);
+      ring->lr_flags &= ~LOCAL_RING_READER;
+
+      /* Senders waiting for space will now fail */
+
+      local_ring_wrnotify(ring, POLLERR);
+    }
+
+  unused = ring->lr_nwriters == 0 &&
+           (ring->lr_flags & LOCAL_RING_READER) == 0;
+  nxsem_post(&ring->lr_exclsem);
+
+  if (unused)
+    {
+      local_ring_free(ring);
+    }
+}
+
+/****************************************************************************
+ * Name: local_ring_send
+ *
+ * Description:
+ *   Queue a message in the ring.
+ *
+ *   For a stream, the data is queued in as many records as needed, each as
+ *   large as the free space allows.  Unless 'nonblock' is true, this waits
+ *   until all of the data has been queued.  Otherwise the number of bytes
+ *   queued before the ring became full is returned.
+ *
+ *   A datagram is queued as a single record.  It is never truncated.
+ *
+ * Input Parameters:
+ *   ring     - The receiver's ring
+ *   iov      - The I/O vector describing the data to send
+ *   iovcnt   - The number of buffers in 'iov'
+ *   files    - Detached files to pass with the message (may be NULL).  The
+ *              ring takes ownership of the files once the first record has
+ *              been queued.
+ *   nfiles   - The number of files in 'files'
+ *   nonblock - True: Do not wait for space in the ring
+ *
+ * Returned Value:
+ *   The number of bytes queued on success; a negated errno value on
+ *   failure:
+ *
+ *   EAGAIN   - 'nonblock' is true and there is no space in the ring
+ *   EPIPE    - The receiver has closed its socket
+ *   EMSGSIZE - The datagram (with its files), or the files passed with
+ *              stream data, cannot fit in the ring
+ *   EINTR    - The wait for space was interrupted by a signal
+ *
+ ****************************************************************************/
+
+ssize_t local_ring_send(FAR struct local_ring_s *ring,
+                        FAR const struct iovec *iov, int iovcnt,
+                        FAR struct file *files, int nfiles, bool nonblock)
+{
+  struct local_rechdr_s hdr;
+  size_t overhead;
+  size_t nspace;
+  size_t nsent = 0;
+  size_t ncopy;
+  size_t len = 0;
+  bool stream;
+  uint16_t ndx;
+  int ret;
+  int i;
+
+  DEBUGASSERT(ring != NULL && (iov != NULL || iovcnt == 0));
+  DEBUGASSERT(nfiles >= 0 && nfiles <= UINT8_MAX);
+
+  for (i = 0; i < iovcnt; i++)
+    {
+      len += iov[i].iov_len;
+    }
+
+  stream   = (ring->lr_flags & LOCAL_RING_STREAM) != 0;
+  overhead = LOCAL_RECHDR_SIZE + LOCAL_FILES_SIZE(nfiles);
+
+  /* Fail now if the first record can never fit in the ring:  Waiting for
+   * space would never end.  A datagram is a single record.  The first
+   * record of a stream carries the files and at least one byte of data.
+   */
+
+  if (overhead + (stream ? (len > 0 ? 1 : 0) : len) > ring->lr_size)
+    {
+      return -EMSGSIZE;
+    }
+
+  if (stream && len == 0 && nfiles == 0)
+    {
+      return 0;
+    }
+
+  local_ring_semtake(&ring->lr_exclsem);
+
+  for (; ; )
+    {
+      if ((ring->lr_flags & LOCAL_RING_READER) == 0)
+        {
+          ret = -EPIPE;
+          break;
+        }
+
+      /* How much of the message can be queued now?  A stream record must
+       * carry at least one byte of data (unless it only carries files).
+       */
+
+      nspace = ring->lr_size - ring->lr_nbytes;
+      if (nspace > overhead)
+        {
+          ncopy = nspace - overhead;
+          if (ncopy > len - nsent)
+            {
+              ncopy = len - nsent;
+            }
+        }
+      else
+        {
+          ncopy = 0;
+        }
+
+      if (nspace >= overhead &&
+          (stream ? (ncopy > 0 || len == nsent) : ncopy == len))
+        {
+          /* Queue one record:  The header, the files, then the data */
+
+          hdr.lh_len      = ncopy;
+          hdr.lh_nfiles   = nfiles;
+          hdr.lh_reserved = 0;
+
+          ndx = local_ring_offset(ring, ring->lr_rdndx, ring->lr_nbytes);
+          ndx = local_ring_copyin(ring, ndx, &hdr, LOCAL_RECHDR_SIZE);
+
+          for (i = 0; i < nfiles; i++)
+            {
+              ndx = local_ring_copyin(ring, ndx, &files[i],
+                                      sizeof(struct file));
+            }
+
+          (void)local_ring_copyiniov(ring, ndx, iov, nsent, ncopy);
+
+          ring->lr_nbytes += overhead + ncopy;
+          nsent           += ncopy;
+
+          /* The files travel only with the first record */
+
+          nfiles   = 0;
+          overhead = LOCAL_RECHDR_SIZE;
+
+          local_ring_rdnotify(ring, POLLIN);
+
+          if (nsent >= len)
+            {
+              ret = OK;
+              break;
+            }
+        }
+
+      /* There is no space for (the rest of) the message.  Return what was
+       * sent or wait for the receiver to make space.
+       */
+
+      if (nonblock)
+        {
+          ret = -EAGAIN;
+          break;
+        }
+
+      ret = local_ring_wait(ring, &ring->lr_wrsem);
+      if (ret < 0)
+        {
+          return nsent > 0 ? (ssize_t)nsent : ret;
+        }
+    }
+
+  nxsem_post(&ring->lr_exclsem);
+
+  /* Report partial success if any data (or the files) were queued */
+
+  if (nsent > 0 || (ret == OK))
+    {
+      return nsent;
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: local_ring_recv
+ *
+ * Description:
+ *   Remove data from the ring.
+ *
+ *   For a stream, consecutive records are merged until 'len' bytes have
+ *   been received.  A record carrying files is never merged with data that
+ *   precedes it so that the files are returned with the data they were
+ *   sent with.
+ *
+ *   For datagrams, exactly one record is removed.  If 'len' is smaller than
+ *   the datagram, the rest of the datagram is discarded.
+ *
+ * Input Parameters:
+ *   ring     - The receiver's ring
+ *   iov      - The I/O vector describing where to return the data
+ *   iovcnt   - The number of buffers in 'iov'
+ *   files    - The location to return passed files (may be NULL)
+ *   nfiles   - On input, the capacity of 'files'.  On return, the number of
+ *              files returned.  Files that do not fit are closed.  May be
+ *              NULL if 'files' is NULL.
+ *   nonblock - True: Do not wait for data
+ *
+ * Returned Value:
+ *   The number of bytes received on success, zero at the end of a stream,
+ *   or a negated errno value on failure (EAGAIN, EINTR).
+ *
+ ****************************************************************************/
+
+ssize_t local_ring_recv(FAR struct local_ring_s *ring,
+                        FAR const struct iovec *iov, int iovcnt,
+                        FAR struct file *files, FAR int *nfiles,
+                        bool nonblock)
+{
+  struct local_rechdr_s hdr;
+  size_t nrecvd = 0;
+  size_t ncopy;
+  size_t len = 0;
+  bool stream;
+  int maxfiles = 0;
+  int ntaken = 0;
+  int ret;
+  int i;
+
+  DEBUGASSERT(ring != NULL && (iov != NULL || iovcnt == 0));
+
+  for (i = 0; i < iovcnt; i++)
+    {
+      len += iov[i].iov_len;
+    }
+
+  if (nfiles != NULL)
+    {
+      maxfiles = *nfiles;
+      *nfiles  = 0;
+    }
+
+  stream = (ring->lr_flags & LOCAL_RING_STREAM) != 0;
+
+  local_ring_semtake(&ring->lr_exclsem);
+
+  /* Wait for something to be queued */
+
+  while (ring->lr_nbytes == 0)
+    {
+      /* The end of the stream has been reached if there is no sender */
+
+      if (stream && ring->lr_nwriters == 0)
+        {
+          nxsem_post(&ring->lr_exclsem);
+          return 0;
+        }
+
+      if (nonblock)
+        {
+          nxsem_post(&ring->lr_exclsem);
+          return -EAGAIN;
+        }
+
+      ret = local_ring_wait(ring, &ring->lr_rdsem);
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+
+  do
+    {
+      (void)local_ring_copyout(ring, ring->lr_rdndx, &hdr,
+                               LOCAL_RECHDR_SIZE);
+
+      if (hdr.lh_nfiles > 0)
+        {
+          /* Do not merge files into data already received */
+
+          if (nrecvd > 0 || ntaken > 0)
+            {
+              break;
+            }
+
+          ntaken = local_ring_takefiles(ring, &hdr, files, maxfiles);
+        }
+
+      /* Copy the data */
+
+      ncopy = hdr.lh_len;
+      if (ncopy > len - nrecvd)
+        {
+          ncopy = len - nrecvd;
+        }
+
+      local_ring_copyoutiov(ring,
+                            local_ring_offset(ring, ring->lr_rdndx,
+                                              LOCAL_RECHDR_SIZE),
+                            iov, nrecvd, ncopy);
+      nrecvd += ncopy;
+
+      if (ncopy < hdr.lh_len && stream)
+        {
+          /* Only part of the stream record was received.  Move the header
+           * up to the remaining data.
+           */
+
+          local_ring_advance(ring, ncopy);
+          hdr.lh_len -= ncopy;
+          (void)local_ring_copyin(ring, ring->lr_rdndx, &hdr,
+                                  LOCAL_RECHDR_SIZE);
+        }
+      else
+        {
+          /* Remove the whole record (discarding any unread part of a
+           * datagram).
+           */
+
+          local_ring_advance(ring, LOCAL_RECHDR_SIZE + hdr.lh_len);
+        }
+    }
+  while (stream && nrecvd < len && ring->lr_nbytes > 0);
+
+  /* Notify the senders that there is space in the ring */
+
+  local_ring_wrnotify(ring, POLLOUT);
+  nxsem_post(&ring->lr_exclsem);
+
+  if (nfiles != NULL)
+    {
+      *nfiles = ntaken;
+    }
+
+  return nrecvd;
+}
+
+/****************************************************************************
+ * Name: local_ring_poll
+ *
+ * Description:
+ *   Set up or tear down monitoring of the ring on behalf of the receiver
+ *   (POLLIN) or a sender (POLLOUT).
+ *
+ * Input Parameters:
+ *   ring   - The ring of interest
+ *   fds    - The structure describing the events to be monitored
+ *   reader - True:  Monitor as the receiver; False: As a sender
+ *   setup  - True:  Set up; False: Tear down
+ *
+ * Returned Value:
+ *   Zero (OK) on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+#ifdef HAVE_LOCAL_POLL
+int local_ring_poll(FAR struct local_ring_s *ring, FAR struct pollfd *fds,
+                    bool reader, bool setup)
+{
+  FAR struct pollfd **slots;
+  pollevent_t eventset = 0;
+  int ret = OK;
+  int i;
+
+  slots = reader ? ring->lr_rdfds : ring->lr_wrfds;
+
+  local_ring_semtake(&ring->lr_exclsem);
+
+  if (setup)
+    {
+      /* Find an available slot for the poll structure reference */
+
+      for (i = 0; i < LOCAL_RING_NPOLLWAITERS; i++)
+        {
+          if (slots[i] == NULL)
+            {
+              slots[i] = fds;
+              break;
+            }
+        }
+
+      if (i >= LOCAL_RING_NPOLLWAITERS)
+        {
+          ret = -EBUSY;
+          goto errout;
+        }
+
+      /* Report the events that are already true */
+
+      if (reader)
+        {
+          if (ring->lr_nbytes > 0)
+            {
+              eventset |= POLLIN;
+            }
+
+          if ((ring->lr_flags & LOCAL_RING_STREAM) != 0 &&
+              ring->lr_nwriters == 0)
+            {
+              eventset |= POLLHUP;
+            }
+        }
+      else
+        {
+          if ((ring->lr_flags & LOCAL_RING_READER) == 0)
+            {
+              eventset |= POLLERR;
+            }
+          else if (ring->lr_size - ring->lr_nbytes > LOCAL_RECHDR_SIZE)
+            {
+              eventset |= POLLOUT;
+            }
+        }
+
+      if (eventset != 0)
+        {
+          local_ring_pollnotify(slots, eventset);
+        }
+    }
+  else
+    {
+      /* Remove all memory of the poll setup */
+
+      for (i = 0; i < LOCAL_RING_NPOLLWAITERS; i++)
+        {
+          if (slots[i] == fds)
+            {
+              slots[i] = NULL;
+            }
+        }
+    }
+
+errout:
+  nxsem_post(&ring->lr_exclsem);
+  return ret;
+}
+#endif /* HAVE_LOCAL_POLL */
+
+#endif /* CONFIG_NET && CONFIG_NET_LOCAL_RING */
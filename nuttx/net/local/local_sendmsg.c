@@ -0,0 +1,287 @@
+/****************************************************************************
+ * net/local/local_sendmsg.c
+ *
+ *   Copyright (C) 2018 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+#if defined(CONFIG_NET) && defined(CONFIG_NET_LOCAL_RING)
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <string.h>
+#include <errno.h>
+#include <assert.h>
+#include <debug.h>
+
+#include <nuttx/fs/fs.h>
+#include <nuttx/net/net.h>
+
+#include "socket/socket.h"
+#include "local/local.h"
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: local_sendmsg_files
+ *
+ * Description:
+ *   Parse the SOL_SOCKET/SCM_RIGHTS control messages of 'msg' and make a
+ *   detached copy of each open file that they refer to.  The detached
+ *   copies hold their own reference to the file so that the sender may
+ *   close its descriptors as soon as sendmsg() returns.
+ *
+ * Input Parameters:
+ *   msg   - The message being sent
+ *   files - The location to return the detached files.  There must be
+ *           room for CONFIG_NET_LOCAL_NFILES files.
+ *
+ * Returned Value:
+ *   The number of files returned on success; a negated errno value on
+ *   failure:
+ *
+ *   EINVAL       - An unsupported or malformed control message
+ *   EBADF        - A descriptor is not an open file descriptor
+ *   ETOOMANYREFS - More than CONFIG_NET_LOCAL_NFILES files were passed
+ *
+ ****************************************************************************/
+
+static int local_sendmsg_files(FAR const struct msghdr *msg,
+                               FAR struct file *files)
+{
+  FAR struct cmsghdr *cmsg;
+  FAR struct file *filep;
+  FAR uint8_t *end;
+  FAR int *fds;
+  int nfiles = 0;
+  int nfds;
+  int ret;
+  int i;
+
+  end = (FAR uint8_t *)msg->msg_control + msg->msg_controllen;
+
+  for (cmsg = CMSG_FIRSTHDR(msg);
+       cmsg != NULL;
+       cmsg = CMSG_NXTHDR(msg, cmsg))
+    {
+      /* Only the passing of open files is supported */
+
+      if (cmsg->cmsg_len < CMSG_LEN(0) ||
+          (FAR uint8_t *)cmsg + cmsg->cmsg_len > end ||
+          cmsg->cmsg_level != SOL_SOCKET ||
+          cmsg->cmsg_type != SCM_RIGHTS)
+        {
+          ret = -EINVAL;
+          goto errout_with_files;
+        }
+
+      fds  = (FAR int *)CMSG_DATA(cmsg);
+      nfds = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+
+      for (i = 0; i < nfds; i++)
+        {
+          if (nfiles >= CONFIG_NET_LOCAL_NFILES)
+            {
+              ret = -ETOOMANYREFS;
+              goto errout_with_files;
+            }
+
+          /* Only file descriptors (not socket descriptors) may be passed */
+
+          ret = fs_getfilep(fds[i], &filep);
+          if (ret < 0)
+            {
+              goto errout_with_files;
+            }
+
+          memset(&files[nfiles], 0, sizeof(struct file));
+          ret = file_dup2(filep, &files[nfiles]);
+          if (ret < 0)
+            {
+              goto errout_with_files;
+            }
+
+          nfiles++;
+        }
+    }
+
+  return nfiles;
+
+errout_with_files:
+  while (nfiles > 0)
+    {
+      (void)file_close_detached(&files[--nfiles]);
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: psock_local_sendmsg
+ *
+ * Description:
+ *   Implements the Unix domain-specific logic of the sendmsg() socket
+ *   operation.  The data in all of the buffers of the message is queued
+ *   as a single message in the receiver's ring.  Open files may be passed
+ *   to the receiver with SOL_SOCKET/SCM_RIGHTS control messages.
+ *
+ * Input Parameters:
+ *   psock    A pointer to a NuttX-specific, internal socket structure
+ *   msg      The message to send
+ *   flags    Send flags
+ *
+ * Returned Value:
+ *   On success, returns the number of bytes sent.  On  error, a negated
+ *   errno value is returned.
+ *
+ ****************************************************************************/
+
+ssize_t psock_local_sendmsg(FAR struct socket *psock,
+                            FAR const struct msghdr *msg, int flags)
+{
+  FAR struct local_conn_s *conn = (FAR struct local_conn_s *)psock->s_conn;
+  struct file files[CONFIG_NET_LOCAL_NFILES];
+  bool nonblock;
+  ssize_t nsent;
+  int nfiles = 0;
+
+  DEBUGASSERT(conn != NULL && msg != NULL);
+
+  /* Take a reference to each file that is passed with the message */
+
+  if (msg->msg_control != NULL && msg->msg_controllen > 0)
+    {
+      nfiles = local_sendmsg_files(msg, files);
+      if (nfiles < 0)
+        {
+          return nfiles;
+        }
+    }
+
+  nonblock = _SS_ISNONBLOCK(psock->s_flags) || (flags & MSG_DONTWAIT) != 0;
+
+#ifdef CONFIG_NET_LOCAL_STREAM
+  if (psock->s_type == SOCK_STREAM)
+    {
+      /* Verify that this is a connected peer socket */
+
+      if (conn->lc_state != LOCAL_STATE_CONNECTED ||
+          conn->lc_txring == NULL)
+        {
+          nerr("ERROR: not connected\n");
+          nsent = -ENOTCONN;
+          goto errout_with_files;
+        }
+
+      nsent = local_ring_send(conn->lc_txring, msg->msg_iov,
+                              msg->msg_iovlen, files, nfiles, nonblock);
+    }
+  else
+#endif
+#ifdef CONFIG_NET_LOCAL_DGRAM
+  if (psock->s_type == SOCK_DGRAM)
+    {
+      FAR struct sockaddr_un *unaddr =
+        (FAR struct sockaddr_un *)msg->msg_name;
+      FAR struct local_ring_s *ring;
+
+      /* A datagram socket is never connected so an address is required */
+
+      if (unaddr == NULL)
+        {
+          nsent = -EDESTADDRREQ;
+          goto errout_with_files;
+        }
+
+      if (msg->msg_namelen < sizeof(sa_family_t) + 2)
+        {
+          nsent = -EFAULT;
+          goto errout_with_files;
+        }
+
+      if (conn->lc_state != LOCAL_STATE_UNBOUND &&
+          conn->lc_state != LOCAL_STATE_BOUND)
+        {
+          nerr("ERROR: Connected state\n");
+          nsent = -EISCONN;
+          goto errout_with_files;
+        }
+
+      /* Find the receive ring of the socket bound to the address */
+
+      ring = local_dgram_findring(unaddr->sun_path);
+      if (ring == NULL)
+        {
+          nerr("ERROR: No socket bound to %s\n", unaddr->sun_path);
+          nsent = -ECONNREFUSED;
+          goto errout_with_files;
+        }
+
+      nsent = local_ring_send(ring, msg->msg_iov, msg->msg_iovlen,
+                              files, nfiles, nonblock);
+      local_ring_release(ring, true);
+    }
+  else
+#endif
+    {
+      nsent = -EINVAL;
+    }
+
+  /* The ring owns the files once anything has been queued */
+
+  if (nsent >= 0)
+    {
+      return nsent;
+    }
+
+errout_with_files:
+  while (nfiles > 0)
+    {
+      (void)file_close_detached(&files[--nfiles]);
+    }
+
+  return nsent;
+}
+
+#endif /* CONFIG_NET && CONFIG_NET_LOCAL_RING */
@@ -1,7 +1,7 @@
 /****************************************************************************
  * net/local/local_sendto.c
  *
- *   Copyright (C) 2015, 2017 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2015, 2017-2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -42,7 +42,10 @@
 
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
+#include <string.h>
+#include <queue.h>
 #include <errno.h>
 #include <assert.h>
 #include <debug.h>
@@ -56,6 +59,42 @@
  * Public Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: local_dgram_findring
+ *
+ * Description:
+ *   Find the bound SOCK_DGRAM socket with the path 'path' and add a sender
+ *   reference to its receive ring.
+ *
+ * Returned Value:
+ *   The ring on success; NULL if there is no such socket.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_LOCAL_RING
+FAR struct local_ring_s *local_dgram_findring(FAR const char *path)
+{
+  FAR struct local_conn_s *conn;
+  FAR struct local_ring_s *ring = NULL;
+
+  net_lock();
+  for (conn = (FAR struct local_conn_s *)g_local_dgrams.head;
+       conn != NULL;
+       conn = (FAR struct local_conn_s *)dq_next(&conn->lc_node))
+    {
+      if (strncmp(conn->lc_path, path, UNIX_PATH_MAX-1) == 0)
+        {
+          ring = conn->lc_rxring;
+          local_ring_addwriter(ring);
+          break;
+        }
+    }
+
+  net_unlock();
+  return ring;
+}
+#endif
+
 /****************************************************************************
  * Name: psock_local_sendto
  *
@@ -87,8 +126,14 @@ ssize_t psock_local_sendto(FAR struct socket *psock, FAR const void *buf,
 {
   FAR struct local_conn_s *conn = (FAR struct local_conn_s *)psock->s_conn;
   FAR struct sockaddr_un *unaddr = (FAR struct sockaddr_un *)to;
+#ifdef CONFIG_NET_LOCAL_RING
+  FAR struct local_ring_s *ring;
+  struct iovec iov;
+#endif
   ssize_t nsent;
+#ifndef CONFIG_NET_LOCAL_RING
   int ret;
+#endif
 
   /* We keep packet sizes in a uint16_t, so there is a upper limit to the
    * 'len' that can be supported.
@@ -110,9 +155,11 @@ ssize_t psock_local_sendto(FAR struct socket *psock, FAR const void *buf,
       return -EISCONN;
     }
 
+#ifndef CONFIG_NET_LOCAL_RING
   /* The outgoing FIFO should not be open */
 
   DEBUGASSERT(conn->lc_outfile.f_inode == 0);
+#endif
 
   /* At present, only standard pathname type address are support */
 
@@ -123,6 +170,28 @@ ssize_t psock_local_sendto(FAR struct socket *psock, FAR const void *buf,
      return -EFAULT;
     }
 
+#ifdef CONFIG_NET_LOCAL_RING
+  /* Find the receive ring of the socket bound to the address */
+
+  ring = local_dgram_findring(unaddr->sun_path);
+  if (ring == NULL)
+    {
+      nerr("ERROR: No socket bound to %s\n", unaddr->sun_path);
+      return -ECONNREFUSED;
+    }
+
+  /* Queue the datagram and release the ring */
+
+  iov.iov_base = (FAR void *)buf;
+  iov.iov_len  = len;
+
+  nsent = local_ring_send(ring, &iov, 1, NULL, 0,
+                          _SS_ISNONBLOCK(psock->s_flags) ||
+                          (flags & MSG_DONTWAIT) != 0);
+  local_ring_release(ring, true);
+  return nsent;
+#else
+
   /* Make sure that half duplex FIFO has been created.
    * REVISIT:  Or should be just make sure that it already exists?
    */
@@ -172,6 +241,7 @@ errout_with_halfduplex:
 
   (void)local_release_halfduplex(conn);
   return nsent;
+#endif /* CONFIG_NET_LOCAL_RING */
 }
 
 #endif /* CONFIG_NET && CONFIG_NET_LOCAL_DGRAM */
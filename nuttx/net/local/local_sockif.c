@@ -1,7 +1,7 @@
 /****************************************************************************
  * net/local/local_sockif.c
  *
- *   Copyright (C) 2017 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2017-2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -111,6 +111,15 @@ const struct sock_intf_s g_local_sockif =
   NULL,              /* si_sendfile */
 #endif
   local_recvfrom,    /* si_recvfrom */
+#ifdef CONFIG_NET_LOCAL_RING
+  psock_local_sendmsg, /* si_sendmsg */
+  psock_local_recvmsg, /* si_recvmsg */
+#else
+  NULL,              /* si_sendmsg */
+  NULL,              /* si_recvmsg */
+#endif
+  NULL,              /* si_sendmmsg */
+  NULL,              /* si_recvmmsg */
   local_close        /* si_close */
 };
 
@@ -3,7 +3,7 @@
  * Header file for database of link-local neighbors, used by IPv6 code and
  * to be used by future ARP code.
  *
- *   Copyright (C) 2007-2009, 2015, 2017 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007-2009, 2015, 2017-2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * A leverage of logic from uIP which also has a BSD style license
@@ -66,6 +66,12 @@
 
 #define NEIGHBOR_MAXTIME 128
 
+/* The Neighbor table is indexed by a hash of the IPv6 address with (on
+ * average) one entry per hash bucket.
+ */
+
+#define NEIGHBOR_HASHSIZE CONFIG_NET_IPv6_NCONF_ENTRIES
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -94,6 +100,7 @@ struct neighbor_addr_s
 
 struct neighbor_entry
 {
+  FAR struct neighbor_entry *ne_flink; /* Next entry in the hash bucket */
   net_ipv6addr_t         ne_ipaddr;  /* IPv6 address of the Neighbor */
   struct neighbor_addr_s ne_addr;    /* Link layer address of the Neighbor */
   uint8_t                ne_time;    /* For aging, units of half seconds */
@@ -109,6 +116,13 @@ struct neighbor_entry
 
 extern struct neighbor_entry g_neighbors[CONFIG_NET_IPv6_NCONF_ENTRIES];
 
+/* Hash table of the entries in the Neighbor table.  An entry is in the
+ * bucket of its ne_ipaddr from when it is first added until it is re-used
+ * for another address.
+ */
+
+extern FAR struct neighbor_entry *g_neighbor_hash[NEIGHBOR_HASHSIZE];
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
@@ -134,6 +148,22 @@ struct net_driver_s; /* Forward reference */
 
 void neighbor_initialize(void);
 
+/****************************************************************************
+ * Name: neighbor_hash
+ *
+ * Description:
+ *   Return the hash bucket of an IPv6 address.
+ *
+ * Input Parameters:
+ *   ipaddr - The IPv6 address
+ *
+ * Returned Value:
+ *   The index of the hash bucket in g_neighbor_hash.
+ *
+ ****************************************************************************/
+
+unsigned int neighbor_hash(const net_ipv6addr_t ipaddr);
+
 /****************************************************************************
  * Name: neighbor_findentry
  *
@@ -225,6 +255,64 @@ void neighbor_update(const net_ipv6addr_t ipaddr);
 
 void neighbor_periodic(int hsec);
 
+/****************************************************************************
+ * Name: neighbor_queue
+ *
+ * Description:
+ *   Keep a copy of the outgoing IPv6 packet in d_buf so that it can be
+ *   sent when the Neighbor Solicitation for 'ipaddr' is answered.
+ *
+ * Input Parameters:
+ *   dev    - The device that the packet is being sent on
+ *   ipaddr - The IPv6 address being resolved
+ *
+ * Returned Value:
+ *   Zero (OK) if the packet is held; a negated errno value if it is dropped.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_IPv6_NQUEUE
+int neighbor_queue(FAR struct net_driver_s *dev,
+                   const net_ipv6addr_t ipaddr);
+#endif
+
+/****************************************************************************
+ * Name: neighbor_queue_notify
+ *
+ * Description:
+ *   Called when a new address mapping is added to the Neighbor table.  If
+ *   packets are held for the address, ask the device to poll for them.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_IPv6_NQUEUE
+void neighbor_queue_notify(const net_ipv6addr_t ipaddr);
+#endif
+
+/****************************************************************************
+ * Name: neighbor_queue_poll
+ *
+ * Description:
+ *   Send the packets held for this device whose destination has been
+ *   resolved and drop those that have waited too long.
+ *
+ * Assumptions:
+ *   This function is called from the MAC device driver indirectly through
+ *   devif_poll().  The network must be locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_IPv6_NQUEUE
+int neighbor_queue_poll(FAR struct net_driver_s *dev,
+                        devif_poll_callback_t callback);
+#endif
+
 /****************************************************************************
  * Name: neighbor_dumpentry
  *
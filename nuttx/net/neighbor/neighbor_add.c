@@ -1,7 +1,7 @@
 /****************************************************************************
  * net/neighbor/neighbor_add.c
  *
- *   Copyright (C) 2007-2009, 2015, 2017 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007-2009, 2015, 2017-2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * A leverage of logic from uIP which also has a BSD style license
@@ -80,6 +80,9 @@
 void neighbor_add(FAR struct net_driver_s *dev, FAR net_ipv6addr_t ipaddr,
                   FAR uint8_t *addr)
 {
+  FAR struct neighbor_entry *neighbor;
+  FAR struct neighbor_entry **pprev;
+  unsigned int bucket;
   uint8_t lltype;
   uint8_t oldest_time;
   int     oldest_ndx;
@@ -87,48 +90,81 @@ void neighbor_add(FAR struct net_driver_s *dev, FAR net_ipv6addr_t ipaddr,
 
   DEBUGASSERT(dev != NULL && addr != NULL);
 
-  /* Find the first unused entry or the oldest used entry. */
+  /* Check if there is already an entry for this address */
 
-  oldest_time = 0;
-  oldest_ndx  = 0;
-  lltype      = dev->d_lltype;
+  lltype = dev->d_lltype;
+  bucket = neighbor_hash(ipaddr);
 
-  for (i = 0; i < CONFIG_NET_IPv6_NCONF_ENTRIES; ++i)
+  for (neighbor = g_neighbor_hash[bucket];
+       neighbor != NULL;
+       neighbor = neighbor->ne_flink)
     {
-      if (g_neighbors[i].ne_time == NEIGHBOR_MAXTIME)
+      if (neighbor->ne_addr.na_lltype == lltype &&
+          net_ipv6addr_cmp(neighbor->ne_ipaddr, ipaddr))
         {
-          oldest_ndx = i;
           break;
         }
+    }
+
+  if (neighbor == NULL)
+    {
+      /* No.. Find the first unused entry or the oldest used entry. */
 
-      if (g_neighbors[i].ne_addr.na_lltype == lltype &&
-          net_ipv6addr_cmp(g_neighbors[i].ne_ipaddr, ipaddr))
+      oldest_time = 0;
+      oldest_ndx  = 0;
+
+      for (i = 0; i < CONFIG_NET_IPv6_NCONF_ENTRIES; ++i)
         {
-          oldest_ndx = i;
-          break;
+          if (g_neighbors[i].ne_time == NEIGHBOR_MAXTIME)
+            {
+              oldest_ndx = i;
+              break;
+            }
+
+          if (g_neighbors[i].ne_time > oldest_time)
+            {
+              oldest_ndx = i;
+              oldest_time = g_neighbors[i].ne_time;
+            }
         }
 
-      if (g_neighbors[i].ne_time > oldest_time)
+      /* Move the oldest or first free entry (either pointed to by the
+       * "oldest_ndx" variable) from the hash bucket of its old address, if
+       * it is in one, to the bucket of the new address.
+       */
+
+      neighbor = &g_neighbors[oldest_ndx];
+
+      for (pprev = &g_neighbor_hash[neighbor_hash(neighbor->ne_ipaddr)];
+           *pprev != NULL;
+           pprev = &(*pprev)->ne_flink)
         {
-          oldest_ndx = i;
-          oldest_time = g_neighbors[i].ne_time;
+          if (*pprev == neighbor)
+            {
+              *pprev = neighbor->ne_flink;
+              break;
+            }
         }
-    }
 
-  /* Use the oldest or first free entry (either pointed to by the
-   * "oldest_ndx" variable).
-   */
+      neighbor->ne_flink      = g_neighbor_hash[bucket];
+      g_neighbor_hash[bucket] = neighbor;
+      net_ipv6addr_copy(neighbor->ne_ipaddr, ipaddr);
+    }
 
-  g_neighbors[oldest_ndx].ne_time = 0;
-  net_ipv6addr_copy(g_neighbors[oldest_ndx].ne_ipaddr, ipaddr);
+  neighbor->ne_time = 0;
 
-  g_neighbors[oldest_ndx].ne_addr.na_lltype = lltype;
-  g_neighbors[oldest_ndx].ne_addr.na_llsize = netdev_dev_lladdrsize(dev);
+  neighbor->ne_addr.na_lltype = lltype;
+  neighbor->ne_addr.na_llsize = netdev_dev_lladdrsize(dev);
 
-  memcpy(&g_neighbors[oldest_ndx].ne_addr.u, addr,
-         g_neighbors[oldest_ndx].ne_addr.na_llsize);
+  memcpy(&neighbor->ne_addr.u, addr, neighbor->ne_addr.na_llsize);
 
   /* Dump the contents of the new entry */
 
-  neighbor_dumpentry("Added entry", &g_neighbors[oldest_ndx]);
+  neighbor_dumpentry("Added entry", neighbor);
+
+#ifdef CONFIG_NET_IPv6_NQUEUE
+  /* Send any packets that were held waiting for this address */
+
+  neighbor_queue_notify(ipaddr);
+#endif
 }
@@ -1,7 +1,7 @@
 /****************************************************************************
  * net/neighbor/neighbor_ethernet_out.c
  *
- *   Copyright (C) 2015, 2017 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2015, 2017-2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -44,6 +44,7 @@
 
 #include <nuttx/net/arp.h>
 #include <nuttx/net/netdev.h>
+#include <nuttx/net/netstats.h>
 
 #include "route/route.h"
 #include "icmpv6/icmpv6.h"
@@ -123,7 +124,9 @@ static const uint8_t g_multicast_ethaddr[3] =
  *   the packet in the d_buf is replaced by an ICMPv6 Neighbor Solicit
  *   request packet for the IPv6 address. The IPv6 packet is dropped and
  *   it is assumed that the higher level protocols (e.g., TCP) eventually
- *   will retransmit the dropped packet.
+ *   will retransmit the dropped packet.  With CONFIG_NET_IPv6_NQUEUE, a
+ *   copy of the IPv6 packet is held instead and sent when the Neighbor
+ *   Advertisement arrives.
  *
  *   Upon return in either the case, a packet to be sent is present in the
  *   d_buf buffer and the d_len field holds the length of the Ethernet
@@ -229,6 +232,18 @@ void neighbor_out(FAR struct net_driver_s *dev)
         {
            ninfo("IPv6 Neighbor solicitation for IPv6\n");
 
+#ifdef CONFIG_NET_STATISTICS
+          g_netstats.neighbor.miss++;
+#endif
+
+#ifdef CONFIG_NET_IPv6_NQUEUE
+          /* Keep a copy of the IPv6 packet to send when the Neighbor
+           * Advertisement arrives.
+           */
+
+          (void)neighbor_queue(dev, ipaddr);
+#endif
+
           /* The destination address was not in our Neighbor Table, so we
            * overwrite the IPv6 packet with an ICMDv6 Neighbor Solicitation
            * message.
@@ -238,6 +253,10 @@ void neighbor_out(FAR struct net_driver_s *dev)
           return;
         }
 
+#ifdef CONFIG_NET_STATISTICS
+      g_netstats.neighbor.hit++;
+#endif
+
       /* Build an Ethernet header. */
 
       memcpy(eth->dest, naddr->u.na_ethernet.ether_addr_octet, ETHER_ADDR_LEN);
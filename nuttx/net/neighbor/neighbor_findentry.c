@@ -1,7 +1,7 @@
 /****************************************************************************
  * net/neighbor/neighbor_findentry.c
  *
- *   Copyright (C) 2007-2009, 2015, 2017 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007-2009, 2015, 2017-2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * A leverage of logic from uIP which also has a BSD style license
@@ -43,6 +43,7 @@
 
 #include <nuttx/config.h>
 
+#include <stdint.h>
 #include <string.h>
 #include <debug.h>
 
@@ -52,6 +53,35 @@
  * Public Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: neighbor_hash
+ *
+ * Description:
+ *   Return the hash bucket of an IPv6 address.
+ *
+ * Input Parameters:
+ *   ipaddr - The IPv6 address
+ *
+ * Returned Value:
+ *   The index of the hash bucket in g_neighbor_hash.
+ *
+ ****************************************************************************/
+
+unsigned int neighbor_hash(const net_ipv6addr_t ipaddr)
+{
+  uint32_t hash;
+
+  /* Neighbors usually share the prefix, so the interface identifier (the
+   * low 64 bits) carries most of the differences.  Fold it and mix it
+   * into the upper bits with multiplicative hashing.
+   */
+
+  hash  = ((uint32_t)ipaddr[4] << 16 | ipaddr[5]) ^
+          ((uint32_t)ipaddr[6] << 16 | ipaddr[7]);
+  hash ^= (uint32_t)ipaddr[2] << 16 | ipaddr[3];
+  return ((hash * 2654435761u) >> 16) % NEIGHBOR_HASHSIZE;
+}
+
 /****************************************************************************
  * Name: neighbor_findentry
  *
@@ -70,12 +100,12 @@
 
 FAR struct neighbor_entry *neighbor_findentry(const net_ipv6addr_t ipaddr)
 {
-  int i;
+  FAR struct neighbor_entry *neighbor;
 
-  for (i = 0; i < CONFIG_NET_IPv6_NCONF_ENTRIES; ++i)
+  for (neighbor = g_neighbor_hash[neighbor_hash(ipaddr)];
+       neighbor != NULL;
+       neighbor = neighbor->ne_flink)
     {
-      FAR struct neighbor_entry *neighbor = &g_neighbors[i];
-
       if (net_ipv6addr_cmp(neighbor->ne_ipaddr, ipaddr))
         {
           neighbor_dumpentry("Entry found", neighbor);
@@ -1,7 +1,7 @@
 /****************************************************************************
  * net/neighbor/neighbor_initialize.c
  *
- *   Copyright (C) 2007-2009, 2015 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007-2009, 2015, 2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * A leverage of logic from uIP which also has a BSD style license
@@ -42,6 +42,9 @@
  ****************************************************************************/
 
 #include <nuttx/config.h>
+
+#include <string.h>
+
 #include <nuttx/clock.h>
 
 #include "neighbor/neighbor.h"
@@ -56,6 +59,10 @@
 
 struct neighbor_entry g_neighbors[CONFIG_NET_IPv6_NCONF_ENTRIES];
 
+/* Hash table of the entries in the Neighbor table */
+
+FAR struct neighbor_entry *g_neighbor_hash[NEIGHBOR_HASHSIZE];
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -83,6 +90,9 @@ void neighbor_initialize(void)
 
   for (i = 0; i < CONFIG_NET_IPv6_NCONF_ENTRIES; ++i)
     {
-      g_neighbors[i].ne_time = NEIGHBOR_MAXTIME;
+      g_neighbors[i].ne_flink = NULL;
+      g_neighbors[i].ne_time  = NEIGHBOR_MAXTIME;
     }
+
+  memset(g_neighbor_hash, 0, sizeof(g_neighbor_hash));
 }
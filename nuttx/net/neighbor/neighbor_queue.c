@@ -0,0 +1,363 @@
+/****************************************************************************
+ * net/neighbor/neighbor_queue.c
+ * Hold outgoing IPv6 packets until their Neighbor Solicitation is answered
+ *
+ *   Copyright (C) 2018 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <net/if.h>
+
+#include <nuttx/clock.h>
+#include <nuttx/mm/iob.h>
+#include <nuttx/net/netdev.h>
+#include <nuttx/net/netstats.h>
+#include <nuttx/net/ip.h>
+
+#include "netdev/netdev.h"
+#include "neighbor/neighbor.h"
+
+#ifdef CONFIG_NET_IPv6_NQUEUE
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define NEIGHBOR_QUEUE_TIMEOUT  MSEC2TICK(CONFIG_NET_IPv6_NQUEUE_TIMEOUT)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* The packets held for one unresolved IPv6 address.  The entry is unused
+ * when no packets are held.
+ */
+
+struct neighbor_queue_s
+{
+  FAR struct net_driver_s *nq_dev;   /* The device to send the packets on */
+  net_ipv6addr_t nq_ipaddr;          /* The IPv6 address */
+  systime_t nq_time;                 /* Time that the first packet was held */
+  uint8_t   nq_npkts;                /* Number of packets held */
+  FAR struct iob_s *nq_pkts[CONFIG_NET_IPv6_NQUEUE_MAXPKTS];
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct neighbor_queue_s
+  g_neighborqueue[CONFIG_NET_IPv6_NQUEUE_NENTRIES];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: neighbor_queue_remove
+ *
+ * Description:
+ *   Remove the oldest packet from an entry.
+ *
+ ****************************************************************************/
+
+static FAR struct iob_s *
+  neighbor_queue_remove(FAR struct neighbor_queue_s *nq)
+{
+  FAR struct iob_s *iob = nq->nq_pkts[0];
+
+  nq->nq_npkts--;
+  memmove(&nq->nq_pkts[0], &nq->nq_pkts[1],
+          nq->nq_npkts * sizeof(FAR struct iob_s *));
+
+  return iob;
+}
+
+/****************************************************************************
+ * Name: neighbor_queue_discard
+ *
+ * Description:
+ *   Drop all of the packets held in an entry and free the entry.
+ *
+ ****************************************************************************/
+
+static void neighbor_queue_discard(FAR struct neighbor_queue_s *nq)
+{
+  while (nq->nq_npkts > 0)
+    {
+      iob_free_chain(neighbor_queue_remove(nq));
+
+#ifdef CONFIG_NET_STATISTICS
+      g_netstats.neighbor.drop++;
+#endif
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: neighbor_queue
+ *
+ * Description:
+ *   Keep a copy of the outgoing IPv6 packet in d_buf so that it can be
+ *   sent when the Neighbor Solicitation for 'ipaddr' is answered.  If too
+ *   many packets are already held for 'ipaddr', the oldest is dropped.
+ *
+ * Input Parameters:
+ *   dev    - The device that the packet is being sent on.  The IPv6
+ *            packet follows the link layer header in d_buf and d_len is
+ *            its length.
+ *   ipaddr - The IPv6 address being resolved
+ *
+ * Returned Value:
+ *   Zero (OK) if the packet is held.  Otherwise, a negated errno value is
+ *   returned and the packet is simply dropped, as it would be without this
+ *   option.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+int neighbor_queue(FAR struct net_driver_s *dev,
+                   const net_ipv6addr_t ipaddr)
+{
+  FAR struct neighbor_queue_s *nq = NULL;
+  FAR struct neighbor_queue_s *avail = NULL;
+  FAR struct neighbor_queue_s *tmp;
+  FAR struct iob_s *iob;
+  systime_t now = clock_systimer();
+  int ret;
+  int i;
+
+  /* Find the entry for this address, discarding stale entries on the way */
+
+  for (i = 0; i < CONFIG_NET_IPv6_NQUEUE_NENTRIES; i++)
+    {
+      tmp = &g_neighborqueue[i];
+      if (tmp->nq_npkts > 0 && now - tmp->nq_time >= NEIGHBOR_QUEUE_TIMEOUT)
+        {
+          neighbor_queue_discard(tmp);
+        }
+
+      if (tmp->nq_npkts == 0)
+        {
+          if (avail == NULL)
+            {
+              avail = tmp;
+            }
+        }
+      else if (tmp->nq_dev == dev &&
+               net_ipv6addr_cmp(tmp->nq_ipaddr, ipaddr))
+        {
+          nq = tmp;
+        }
+    }
+
+  if (nq == NULL && avail == NULL)
+    {
+      ret = -ENOMEM;
+      goto errout;
+    }
+
+  /* Copy the packet into throttled I/O buffers, as arp_queue() does */
+
+  iob = iob_tryalloc_size(dev->d_len, true);
+  if (iob == NULL)
+    {
+      ret = -ENOMEM;
+      goto errout;
+    }
+
+  ret = iob_trycopyin(iob, &dev->d_buf[NET_LL_HDRLEN(dev)], dev->d_len,
+                      0, true);
+  if (ret < 0)
+    {
+      iob_free_chain(iob);
+      goto errout;
+    }
+
+  if (nq == NULL)
+    {
+      nq           = avail;
+      nq->nq_dev   = dev;
+      nq->nq_time  = now;
+      nq->nq_npkts = 0;
+      net_ipv6addr_copy(nq->nq_ipaddr, ipaddr);
+    }
+  else if (nq->nq_npkts >= CONFIG_NET_IPv6_NQUEUE_MAXPKTS)
+    {
+      iob_free_chain(neighbor_queue_remove(nq));
+
+#ifdef CONFIG_NET_STATISTICS
+      g_netstats.neighbor.drop++;
+#endif
+    }
+
+  nq->nq_pkts[nq->nq_npkts++] = iob;
+
+#ifdef CONFIG_NET_STATISTICS
+  g_netstats.neighbor.queued++;
+#endif
+  return OK;
+
+errout:
+  ninfo("Dropping packet: %d\n", ret);
+
+#ifdef CONFIG_NET_STATISTICS
+  g_netstats.neighbor.drop++;
+#endif
+  return ret;
+}
+
+/****************************************************************************
+ * Name: neighbor_queue_notify
+ *
+ * Description:
+ *   Called when a new address mapping is added to the Neighbor table.  If
+ *   packets are held for the address, ask the device to poll for them.
+ *
+ * Input Parameters:
+ *   ipaddr - The IPv6 address that was resolved
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+void neighbor_queue_notify(const net_ipv6addr_t ipaddr)
+{
+  int i;
+
+  for (i = 0; i < CONFIG_NET_IPv6_NQUEUE_NENTRIES; i++)
+    {
+      if (g_neighborqueue[i].nq_npkts > 0 &&
+          net_ipv6addr_cmp(g_neighborqueue[i].nq_ipaddr, ipaddr))
+        {
+          netdev_txnotify_dev(g_neighborqueue[i].nq_dev);
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: neighbor_queue_poll
+ *
+ * Description:
+ *   The IPv6 counterpart of arp_queue_poll().  Each held packet is returned
+ *   to the driver without a link layer header, which neighbor_out() adds.
+ *
+ * Input Parameters:
+ *   dev      - The device being polled
+ *   callback - The driver's poll callback
+ *
+ * Returned Value:
+ *   The non-zero value returned by the callback if it stopped the poll;
+ *   zero otherwise.
+ *
+ * Assumptions:
+ *   This function is called from the MAC device driver indirectly through
+ *   devif_poll().  The network must be locked.
+ *
+ ****************************************************************************/
+
+int neighbor_queue_poll(FAR struct net_driver_s *dev,
+                        devif_poll_callback_t callback)
+{
+  FAR struct neighbor_queue_s *nq;
+  FAR struct iob_s *iob;
+  systime_t now = clock_systimer();
+  int bstop;
+  int i;
+
+  for (i = 0; i < CONFIG_NET_IPv6_NQUEUE_NENTRIES; i++)
+    {
+      nq = &g_neighborqueue[i];
+      if (nq->nq_npkts == 0 || nq->nq_dev != dev)
+        {
+          continue;
+        }
+
+      if (neighbor_lookup(nq->nq_ipaddr) == NULL)
+        {
+          /* Not yet resolved.  Give up if it is taking too long. */
+
+          if (now - nq->nq_time >= NEIGHBOR_QUEUE_TIMEOUT)
+            {
+              neighbor_queue_discard(nq);
+            }
+
+          continue;
+        }
+
+      while (nq->nq_npkts > 0)
+        {
+          iob = neighbor_queue_remove(nq);
+
+          dev->d_len    = iob->io_pktlen;
+          dev->d_sndlen = 0;
+          (void)iob_copyout(&dev->d_buf[NET_LL_HDRLEN(dev)], iob,
+                            iob->io_pktlen, 0);
+          iob_free_chain(iob);
+
+          IFF_SET_IPv6(dev->d_flags);
+
+#ifdef CONFIG_NET_STATISTICS
+          g_netstats.neighbor.sent++;
+#endif
+
+          bstop = callback(dev);
+          if (bstop)
+            {
+              return bstop;
+            }
+        }
+    }
+
+  return 0;
+}
+
+#endif /* CONFIG_NET_IPv6_NQUEUE */
@@ -105,6 +105,10 @@ const struct sock_intf_s g_pkt_sockif =
   NULL,            /* si_sendfile */
 #endif
   pkt_recvfrom,    /* si_recvfrom */
+  NULL,            /* si_sendmsg */
+  NULL,            /* si_recvmsg */
+  NULL,            /* si_sendmmsg */
+  NULL,            /* si_recvmmsg */
   pkt_close        /* si_close */
 };
 
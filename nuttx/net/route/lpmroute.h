@@ -0,0 +1,173 @@
+/****************************************************************************
+ * net/route/lpmroute.h
+ *
+ *   Copyright (C) 2018 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __NET_ROUTE_LPMROUTE_H
+#define __NET_ROUTE_LPMROUTE_H 1
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include "route/route.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The longest-prefix-match trie indexes the in-memory routing tables */
+
+#ifdef CONFIG_ROUTE_LPM
+#  ifdef CONFIG_ROUTE_IPv4_RAMROUTE
+#    define HAVE_LPM_IPv4 1
+#  endif
+#  ifdef CONFIG_ROUTE_IPv6_RAMROUTE
+#    define HAVE_LPM_IPv6 1
+#  endif
+#endif
+
+#if defined(HAVE_LPM_IPv4) || defined(HAVE_LPM_IPv6)
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: net_init_lpmroute
+ *
+ * Description:
+ *   Initialize the longest-prefix-match tries
+ *
+ * Parameters:
+ *   None
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   Called early in initialization so that no special protection is needed.
+ *
+ ****************************************************************************/
+
+void net_init_lpmroute(void);
+
+/****************************************************************************
+ * Name: lpmroute_ipv4_add and lpmroute_ipv6_add
+ *
+ * Description:
+ *   Add a route from the in-memory routing table to the trie.  If there is
+ *   already a route for the same network, that route is kept:  Like the
+ *   linear search, lookups find the route that was added first.
+ *
+ * Parameters:
+ *   route - The route to add.  It must remain valid until it is removed.
+ *
+ * Returned Value:
+ *   OK on success; Negated errno on failure:  -EINVAL if the network mask
+ *   is not contiguous.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+#ifdef HAVE_LPM_IPv4
+int lpmroute_ipv4_add(FAR struct net_route_ipv4_s *route);
+#endif
+
+#ifdef HAVE_LPM_IPv6
+int lpmroute_ipv6_add(FAR struct net_route_ipv6_s *route);
+#endif
+
+/****************************************************************************
+ * Name: lpmroute_ipv4_del and lpmroute_ipv6_del
+ *
+ * Description:
+ *   Remove a route from the trie.
+ *
+ * Parameters:
+ *   route       - The route being removed from the routing table
+ *   replacement - Another route for the same network that is still in the
+ *                 routing table, or NULL if there is none.
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+#ifdef HAVE_LPM_IPv4
+void lpmroute_ipv4_del(FAR struct net_route_ipv4_s *route,
+                       FAR struct net_route_ipv4_s *replacement);
+#endif
+
+#ifdef HAVE_LPM_IPv6
+void lpmroute_ipv6_del(FAR struct net_route_ipv6_s *route,
+                       FAR struct net_route_ipv6_s *replacement);
+#endif
+
+/****************************************************************************
+ * Name: net_lpmroute_ipv4 and net_lpmroute_ipv6
+ *
+ * Description:
+ *   Visit the routes whose networks contain the target address, the most
+ *   specific (longest prefix) first.
+ *
+ * Parameters:
+ *   target  - The address to be routed
+ *   handler - Will be called for each matching route
+ *   arg     - An arbitrary value that will be passed to the handler.
+ *
+ * Returned Value:
+ *   Zero (OK) if all matching routes were visited.  Otherwise, the
+ *   non-zero value returned by the handler that terminated the search.
+ *
+ ****************************************************************************/
+
+#ifdef HAVE_LPM_IPv4
+int net_lpmroute_ipv4(in_addr_t target, route_handler_ipv4_t handler,
+                      FAR void *arg);
+#endif
+
+#ifdef HAVE_LPM_IPv6
+int net_lpmroute_ipv6(FAR const net_ipv6addr_t target,
+                      route_handler_ipv6_t handler, FAR void *arg);
+#endif
+
+#endif /* HAVE_LPM_IPv4 || HAVE_LPM_IPv6 */
+#endif /* __NET_ROUTE_LPMROUTE_H */
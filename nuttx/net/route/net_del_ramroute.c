@@ -1,7 +1,7 @@
 /****************************************************************************
  * net/route/net_del_ramroute.c
  *
- *   Copyright (C) 2013, 2015, 2017 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2013, 2015, 2017-2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -48,6 +48,7 @@
 #include <nuttx/net/ip.h>
 
 #include "route/ramroute.h"
+#include "route/lpmroute.h"
 #include "route/route.h"
 
 #if defined(CONFIG_ROUTE_IPv4_RAMROUTE) || defined(CONFIG_ROUTE_IPv6_RAMROUTE)
@@ -78,6 +79,62 @@ struct route_match_ipv6_s
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: net_replacement_ipv4 and net_replacement_ipv6
+ *
+ * Description:
+ *   Find the route that takes the place of a deleted route in the
+ *   longest-prefix-match trie:  The first remaining route for the same
+ *   network.
+ *
+ * Parameters:
+ *   route - The route that was removed from the routing table
+ *
+ * Returned Value:
+ *   The replacement route or NULL if there is none.
+ *
+ ****************************************************************************/
+
+#ifdef HAVE_LPM_IPv4
+static FAR struct net_route_ipv4_s *
+  net_replacement_ipv4(FAR struct net_route_ipv4_s *route)
+{
+  FAR struct net_route_ipv4_entry_s *entry;
+
+  for (entry = g_ipv4_routes.head; entry != NULL; entry = entry->flink)
+    {
+      if (net_ipv4addr_maskcmp(entry->entry.target, route->target,
+                               route->netmask) &&
+          net_ipv4addr_cmp(entry->entry.netmask, route->netmask))
+        {
+          return &entry->entry;
+        }
+    }
+
+  return NULL;
+}
+#endif
+
+#ifdef HAVE_LPM_IPv6
+static FAR struct net_route_ipv6_s *
+  net_replacement_ipv6(FAR struct net_route_ipv6_s *route)
+{
+  FAR struct net_route_ipv6_entry_s *entry;
+
+  for (entry = g_ipv6_routes.head; entry != NULL; entry = entry->flink)
+    {
+      if (net_ipv6addr_maskcmp(entry->entry.target, route->target,
+                               route->netmask) &&
+          net_ipv6addr_cmp(entry->entry.netmask, route->netmask))
+        {
+          return &entry->entry;
+        }
+    }
+
+  return NULL;
+}
+#endif
+
 /****************************************************************************
  * Name: net_match_ipv4
  *
@@ -122,6 +179,12 @@ static int net_match_ipv4(FAR struct net_route_ipv4_s *route, FAR void *arg)
           (void)ramroute_ipv4_remfirst(&g_ipv4_routes);
         }
 
+#ifdef HAVE_LPM_IPv4
+      /* Remove it from the longest-prefix-match trie as well */
+
+      lpmroute_ipv4_del(route, net_replacement_ipv4(route));
+#endif
+
       /* And free the routing table entry by adding it to the free list */
 
       net_freeroute_ipv4(route);
@@ -175,6 +238,12 @@ static int net_match_ipv6(FAR struct net_route_ipv6_s *route, FAR void *arg)
           (void)ramroute_ipv6_remfirst(&g_ipv6_routes);
         }
 
+#ifdef HAVE_LPM_IPv6
+      /* Remove it from the longest-prefix-match trie as well */
+
+      lpmroute_ipv6_del(route, net_replacement_ipv6(route));
+#endif
+
       /* And free the routing table entry by adding it to the free list */
 
       net_freeroute_ipv6(route);
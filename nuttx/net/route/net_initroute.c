@@ -1,7 +1,7 @@
 /****************************************************************************
  * net/route/net_initroute.c
  *
- *   Copyright (C) 2017 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2017-2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -42,6 +42,7 @@
 #include "route/ramroute.h"
 #include "route/fileroute.h"
 #include "route/cacheroute.h"
+#include "route/lpmroute.h"
 #include "route/route.h"
 
 #ifdef CONFIG_NET_ROUTE
@@ -70,6 +71,10 @@ void net_init_route(void)
   net_init_ramroute();
 #endif
 
+#if defined(HAVE_LPM_IPv4) || defined(HAVE_LPM_IPv6)
+  net_init_lpmroute();
+#endif
+
 #if defined(CONFIG_ROUTE_IPv4_FILEROUTE) || defined(CONFIG_ROUTE_IPv6_FILEROUTE)
   net_init_fileroute();
 #endif
@@ -0,0 +1,732 @@
+/****************************************************************************
+ * net/route/net_lpmroute.c
+ *
+ *   Copyright (C) 2018 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/net/net.h>
+#include <nuttx/net/ip.h>
+
+#include "route/lpmroute.h"
+#include "route/route.h"
+
+#if defined(HAVE_LPM_IPv4) || defined(HAVE_LPM_IPv6)
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Size of the largest key (in bytes) */
+
+#ifdef HAVE_LPM_IPv6
+#  define LPM_KEYLEN       16
+#else
+#  define LPM_KEYLEN       4
+#endif
+
+/* Every route needs at most one node of its own plus one branch node */
+
+#define LPM_IPv4_NNODES    (2 * CONFIG_ROUTE_MAX_IPv4_RAMROUTES)
+#define LPM_IPv6_NNODES    (2 * CONFIG_ROUTE_MAX_IPv6_RAMROUTES)
+
+/* Bit 'n' of a key, counting from the most significant bit of the first
+ * byte (network order).
+ */
+
+#define LPM_BIT(key, n)    (((key)[(n) >> 3] >> (7 - ((n) & 7))) & 1)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* One node of the trie.  The trie is path-compressed:  A node only exists
+ * if it holds a route or if it is where two branches part.  Prefix lengths
+ * strictly increase along every path, so a lookup visits at most 33 (IPv4)
+ * or 129 (IPv6) nodes, and usually only a few.
+ */
+
+struct lpm_node_s
+{
+  FAR struct lpm_node_s *parent;    /* Parent node, NULL for the root */
+  FAR struct lpm_node_s *child[2];  /* Children by the bit after the prefix */
+  FAR void *route;                  /* Route for this prefix, NULL if none */
+  uint8_t plen;                     /* Prefix length in bits */
+  uint8_t key[LPM_KEYLEN];          /* The prefix; bits after plen are zero */
+};
+
+/* One trie, per address family */
+
+struct lpm_trie_s
+{
+  FAR struct lpm_node_s *root;      /* The root of the trie */
+  FAR struct lpm_node_s *freelist;  /* Unused nodes */
+  uint8_t keylen;                   /* Key size in bytes */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+#ifdef HAVE_LPM_IPv4
+static struct lpm_trie_s g_ipv4_trie;
+static struct lpm_node_s g_ipv4_nodes[LPM_IPv4_NNODES];
+#endif
+
+#ifdef HAVE_LPM_IPv6
+static struct lpm_trie_s g_ipv6_trie;
+static struct lpm_node_s g_ipv6_nodes[LPM_IPv6_NNODES];
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: lpm_init
+ *
+ * Description:
+ *   Initialize a trie and put all of its nodes on the free list.
+ *
+ ****************************************************************************/
+
+static void lpm_init(FAR struct lpm_trie_s *trie,
+                     FAR struct lpm_node_s *nodes, int nnodes, int keylen)
+{
+  int i;
+
+  trie->root     = NULL;
+  trie->freelist = NULL;
+  trie->keylen   = keylen;
+
+  for (i = 0; i < nnodes; i++)
+    {
+      nodes[i].child[0] = trie->freelist;
+      trie->freelist    = &nodes[i];
+    }
+}
+
+/****************************************************************************
+ * Name: lpm_alloc and lpm_free
+ *
+ * Description:
+ *   Take a node from, or return a node to, the free list.
+ *
+ ****************************************************************************/
+
+static FAR struct lpm_node_s *lpm_alloc(FAR struct lpm_trie_s *trie)
+{
+  FAR struct lpm_node_s *node = trie->freelist;
+
+  if (node != NULL)
+    {
+      trie->freelist = node->child[0];
+      memset(node, 0, sizeof(struct lpm_node_s));
+    }
+
+  return node;
+}
+
+static void lpm_free(FAR struct lpm_trie_s *trie,
+                     FAR struct lpm_node_s *node)
+{
+  node->child[0] = trie->freelist;
+  trie->freelist = node;
+}
+
+/****************************************************************************
+ * Name: lpm_masklen
+ *
+ * Description:
+ *   Return the prefix length of a network mask, or -EINVAL if the mask is
+ *   not contiguous.
+ *
+ ****************************************************************************/
+
+static int lpm_masklen(FAR const uint8_t *mask, int keylen)
+{
+  int plen = 0;
+  int i;
+
+  /* Count the leading one bits */
+
+  for (i = 0; i < keylen && mask[i] == 0xff; i++)
+    {
+      plen += 8;
+    }
+
+  if (i < keylen)
+    {
+      uint8_t byte = mask[i];
+
+      while ((byte & 0x80) != 0)
+        {
+          byte <<= 1;
+          plen++;
+        }
+
+      /* Everything that follows must be zero */
+
+      if (byte != 0)
+        {
+          return -EINVAL;
+        }
+
+      for (i++; i < keylen; i++)
+        {
+          if (mask[i] != 0)
+            {
+              return -EINVAL;
+            }
+        }
+    }
+
+  return plen;
+}
+
+/****************************************************************************
+ * Name: lpm_setkey
+ *
+ * Description:
+ *   Set the key of a node to the first 'plen' bits of 'key'.
+ *
+ ****************************************************************************/
+
+static void lpm_setkey(FAR struct lpm_node_s *node, FAR const uint8_t *key,
+                       int plen)
+{
+  int nbytes = plen >> 3;
+
+  memset(node->key, 0, LPM_KEYLEN);
+  memcpy(node->key, key, nbytes);
+  if ((plen & 7) != 0)
+    {
+      node->key[nbytes] = key[nbytes] & (uint8_t)(0xff << (8 - (plen & 7)));
+    }
+
+  node->plen = plen;
+}
+
+/****************************************************************************
+ * Name: lpm_common
+ *
+ * Description:
+ *   Return the number of leading bits, up to 'maxbits', that two keys have
+ *   in common.
+ *
+ ****************************************************************************/
+
+static int lpm_common(FAR const uint8_t *key1, FAR const uint8_t *key2,
+                      int maxbits)
+{
+  uint8_t diff;
+  int nbits = 0;
+  int i;
+
+  for (i = 0; nbits < maxbits; i++)
+    {
+      diff = key1[i] ^ key2[i];
+      if (diff != 0)
+        {
+          while ((diff & 0x80) == 0)
+            {
+              diff <<= 1;
+              nbits++;
+            }
+
+          break;
+        }
+
+      nbits += 8;
+    }
+
+  return nbits < maxbits ? nbits : maxbits;
+}
+
+/****************************************************************************
+ * Name: lpm_replace
+ *
+ * Description:
+ *   Put 'newnode' (which may be NULL) in the place of 'oldnode' under
+ *   'parent' (which is NULL if 'oldnode' is the root).
+ *
+ ****************************************************************************/
+
+static void lpm_replace(FAR struct lpm_trie_s *trie,
+                        FAR struct lpm_node_s *parent,
+                        FAR struct lpm_node_s *oldnode,
+                        FAR struct lpm_node_s *newnode)
+{
+  if (parent == NULL)
+    {
+      trie->root = newnode;
+    }
+  else if (parent->child[0] == oldnode)
+    {
+      parent->child[0] = newnode;
+    }
+  else
+    {
+      parent->child[1] = newnode;
+    }
+
+  if (newnode != NULL)
+    {
+      newnode->parent = parent;
+    }
+}
+
+/****************************************************************************
+ * Name: lpm_insert
+ *
+ * Description:
+ *   Add a route for the network 'key'/'plen' to a trie.
+ *
+ ****************************************************************************/
+
+static int lpm_insert(FAR struct lpm_trie_s *trie, FAR const uint8_t *key,
+                      int plen, FAR void *route)
+{
+  FAR struct lpm_node_s *parent = NULL;
+  FAR struct lpm_node_s *node   = trie->root;
+  FAR struct lpm_node_s *newnode;
+  FAR struct lpm_node_s *branch;
+  int common = 0;
+
+  /* Descend while the prefix of the node is a prefix of the new network */
+
+  while (node != NULL)
+    {
+      common = lpm_common(node->key, key,
+                          node->plen < plen ? node->plen : plen);
+      if (common < node->plen)
+        {
+          break;
+        }
+
+      if (node->plen == plen)
+        {
+          /* There is already a node for this network.  Keep the first
+           * route for it.
+           */
+
+          if (node->route == NULL)
+            {
+              node->route = route;
+            }
+
+          return OK;
+        }
+
+      parent = node;
+      node   = node->child[LPM_BIT(key, node->plen)];
+    }
+
+  /* Get all of the nodes that are needed before changing anything */
+
+  newnode = lpm_alloc(trie);
+  branch  = NULL;
+
+  if (newnode != NULL && node != NULL && common < plen)
+    {
+      branch = lpm_alloc(trie);
+      if (branch == NULL)
+        {
+          lpm_free(trie, newnode);
+          newnode = NULL;
+        }
+    }
+
+  if (newnode == NULL)
+    {
+      nerr("ERROR: No free trie nodes\n");
+      return -ENOMEM;
+    }
+
+  lpm_setkey(newnode, key, plen);
+  newnode->route = route;
+
+  if (node == NULL)
+    {
+      /* Add the new node as a leaf */
+
+      if (parent == NULL)
+        {
+          trie->root = newnode;
+        }
+      else
+        {
+          parent->child[LPM_BIT(key, parent->plen)] = newnode;
+        }
+
+      newnode->parent = parent;
+    }
+  else if (branch == NULL)
+    {
+      /* The new network contains the network of 'node'.  Insert the new
+       * node above it.
+       */
+
+      lpm_replace(trie, parent, node, newnode);
+      newnode->child[LPM_BIT(node->key, plen)] = node;
+      node->parent = newnode;
+    }
+  else
+    {
+      /* The networks part after 'common' bits.  Add a branch node there. */
+
+      lpm_setkey(branch, key, common);
+      lpm_replace(trie, parent, node, branch);
+
+      branch->child[LPM_BIT(key, common)]       = newnode;
+      branch->child[LPM_BIT(node->key, common)] = node;
+      newnode->parent = branch;
+      node->parent    = branch;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: lpm_remove
+ *
+ * Description:
+ *   Remove a route for the network 'key'/'plen' from a trie, replacing it
+ *   with another route for the same network if there is one.
+ *
+ ****************************************************************************/
+
+static void lpm_remove(FAR struct lpm_trie_s *trie, FAR const uint8_t *key,
+                       int plen, FAR void *route, FAR void *replacement)
+{
+  FAR struct lpm_node_s *node = trie->root;
+  FAR struct lpm_node_s *parent;
+  FAR struct lpm_node_s *child;
+
+  /* Find the node for the network */
+
+  while (node != NULL && node->plen < plen &&
+         lpm_common(node->key, key, node->plen) == node->plen)
+    {
+      node = node->child[LPM_BIT(key, node->plen)];
+    }
+
+  if (node == NULL || node->plen != plen || node->route != route ||
+      lpm_common(node->key, key, plen) != plen)
+    {
+      /* This route is not in the trie.  It may be a later duplicate of a
+       * route that is.
+       */
+
+      return;
+    }
+
+  if (replacement != NULL)
+    {
+      node->route = replacement;
+      return;
+    }
+
+  node->route = NULL;
+
+  /* A node that still parts two branches stays */
+
+  if (node->child[0] != NULL && node->child[1] != NULL)
+    {
+      return;
+    }
+
+  /* Otherwise, move the only child (if any) up into its place */
+
+  parent = node->parent;
+  child  = node->child[0] != NULL ? node->child[0] : node->child[1];
+  lpm_replace(trie, parent, node, child);
+  lpm_free(trie, node);
+
+  /* That may leave the parent as a branch node with nothing to part */
+
+  if (parent != NULL && parent->route == NULL &&
+      (parent->child[0] == NULL || parent->child[1] == NULL))
+    {
+      child = parent->child[0] != NULL ? parent->child[0] : parent->child[1];
+      lpm_replace(trie, parent->parent, parent, child);
+      lpm_free(trie, parent);
+    }
+}
+
+/****************************************************************************
+ * Name: lpm_lookup
+ *
+ * Description:
+ *   Return the deepest node whose prefix matches 'key'.  Its ancestors are
+ *   the less specific matches.
+ *
+ ****************************************************************************/
+
+static FAR struct lpm_node_s *lpm_lookup(FAR struct lpm_trie_s *trie,
+                                         FAR const uint8_t *key)
+{
+  FAR struct lpm_node_s *node = trie->root;
+  FAR struct lpm_node_s *best = NULL;
+  int keybits = 8 * trie->keylen;
+
+  while (node != NULL && lpm_common(node->key, key, node->plen) == node->plen)
+    {
+      best = node;
+      if (node->plen >= keybits)
+        {
+          break;
+        }
+
+      node = node->child[LPM_BIT(key, node->plen)];
+    }
+
+  return best;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: net_init_lpmroute
+ *
+ * Description:
+ *   Initialize the longest-prefix-match tries
+ *
+ * Parameters:
+ *   None
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   Called early in initialization so that no special protection is needed.
+ *
+ ****************************************************************************/
+
+void net_init_lpmroute(void)
+{
+#ifdef HAVE_LPM_IPv4
+  lpm_init(&g_ipv4_trie, g_ipv4_nodes, LPM_IPv4_NNODES, sizeof(in_addr_t));
+#endif
+
+#ifdef HAVE_LPM_IPv6
+  lpm_init(&g_ipv6_trie, g_ipv6_nodes, LPM_IPv6_NNODES,
+           sizeof(net_ipv6addr_t));
+#endif
+}
+
+/****************************************************************************
+ * Name: lpmroute_ipv4_add and lpmroute_ipv6_add
+ *
+ * Description:
+ *   Add a route from the in-memory routing table to the trie.
+ *
+ * Parameters:
+ *   route - The route to add.  It must remain valid until it is removed.
+ *
+ * Returned Value:
+ *   OK on success; Negated errno on failure.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+#ifdef HAVE_LPM_IPv4
+int lpmroute_ipv4_add(FAR struct net_route_ipv4_s *route)
+{
+  int plen;
+
+  plen = lpm_masklen((FAR const uint8_t *)&route->netmask,
+                     sizeof(in_addr_t));
+  if (plen < 0)
+    {
+      nerr("ERROR: Netmask is not contiguous\n");
+      return plen;
+    }
+
+  return lpm_insert(&g_ipv4_trie, (FAR const uint8_t *)&route->target,
+                    plen, route);
+}
+#endif
+
+#ifdef HAVE_LPM_IPv6
+int lpmroute_ipv6_add(FAR struct net_route_ipv6_s *route)
+{
+  int plen;
+
+  plen = lpm_masklen((FAR const uint8_t *)route->netmask,
+                     sizeof(net_ipv6addr_t));
+  if (plen < 0)
+    {
+      nerr("ERROR: Netmask is not contiguous\n");
+      return plen;
+    }
+
+  return lpm_insert(&g_ipv6_trie, (FAR const uint8_t *)route->target,
+                    plen, route);
+}
+#endif
+
+/****************************************************************************
+ * Name: lpmroute_ipv4_del and lpmroute_ipv6_del
+ *
+ * Description:
+ *   Remove a route from the trie.
+ *
+ * Parameters:
+ *   route       - The route being removed from the routing table
+ *   replacement - Another route for the same network that is still in the
+ *                 routing table, or NULL if there is none.
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+#ifdef HAVE_LPM_IPv4
+void lpmroute_ipv4_del(FAR struct net_route_ipv4_s *route,
+                       FAR struct net_route_ipv4_s *replacement)
+{
+  int plen;
+
+  plen = lpm_masklen((FAR const uint8_t *)&route->netmask,
+                     sizeof(in_addr_t));
+  if (plen >= 0)
+    {
+      lpm_remove(&g_ipv4_trie, (FAR const uint8_t *)&route->target, plen,
+                 route, replacement);
+    }
+}
+#endif
+
+#ifdef HAVE_LPM_IPv6
+void lpmroute_ipv6_del(FAR struct net_route_ipv6_s *route,
+                       FAR struct net_route_ipv6_s *replacement)
+{
+  int plen;
+
+  plen = lpm_masklen((FAR const uint8_t *)route->netmask,
+                     sizeof(net_ipv6addr_t));
+  if (plen >= 0)
+    {
+      lpm_remove(&g_ipv6_trie, (FAR const uint8_t *)route->target, plen,
+                 route, replacement);
+    }
+}
+#endif
+
+/****************************************************************************
+ * Name: net_lpmroute_ipv4 and net_lpmroute_ipv6
+ *
+ * Description:
+ *   Visit the routes whose networks contain the target address, the most
+ *   specific (longest prefix) first.
+ *
+ * Parameters:
+ *   target  - The address to be routed
+ *   handler - Will be called for each matching route
+ *   arg     - An arbitrary value that will be passed to the handler.
+ *
+ * Returned Value:
+ *   Zero (OK) if all matching routes were visited.  Otherwise, the
+ *   non-zero value returned by the handler that terminated the search.
+ *
+ ****************************************************************************/
+
+#ifdef HAVE_LPM_IPv4
+int net_lpmroute_ipv4(in_addr_t target, route_handler_ipv4_t handler,
+                      FAR void *arg)
+{
+  FAR struct lpm_node_s *node;
+  int ret = 0;
+
+  /* Prevent concurrent access to the routing table */
+
+  net_lock();
+
+  node = lpm_lookup(&g_ipv4_trie, (FAR const uint8_t *)&target);
+  for (; ret == 0 && node != NULL; node = node->parent)
+    {
+      if (node->route != NULL)
+        {
+          ret = handler((FAR struct net_route_ipv4_s *)node->route, arg);
+        }
+    }
+
+  net_unlock();
+  return ret;
+}
+#endif
+
+#ifdef HAVE_LPM_IPv6
+int net_lpmroute_ipv6(FAR const net_ipv6addr_t target,
+                      route_handler_ipv6_t handler, FAR void *arg)
+{
+  FAR struct lpm_node_s *node;
+  int ret = 0;
+
+  /* Prevent concurrent access to the routing table */
+
+  net_lock();
+
+  node = lpm_lookup(&g_ipv6_trie, (FAR const uint8_t *)target);
+  for (; ret == 0 && node != NULL; node = node->parent)
+    {
+      if (node->route != NULL)
+        {
+          ret = handler((FAR struct net_route_ipv6_s *)node->route, arg);
+        }
+    }
+
+  net_unlock();
+  return ret;
+}
+#endif
+
+#endif /* HAVE_LPM_IPv4 || HAVE_LPM_IPv6 */
@@ -1,7 +1,7 @@
 /****************************************************************************
  * net/sixlowpan/sixlowpan_tcpsend.c
  *
- *   Copyright (C) 2017 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2017-2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -254,6 +254,10 @@ static int sixlowpan_tcp_header(FAR struct tcp_conn_s *conn,
   memcpy(ipv6tcp->tcp.ackno, conn->rcvseq, 4);    /* ACK number */
   memcpy(ipv6tcp->tcp.seqno, conn->sndseq, 4);    /* Sequence number */
 
+#ifdef CONFIG_NET_TCP_DELAYED_ACK
+  conn->delack = 0;                                /* Nothing left to ACK */
+#endif
+
   /* Set the TCP window */
 
   if (conn->tcpstateflags & TCP_STOPPED)
@@ -267,8 +271,13 @@ static int sixlowpan_tcp_header(FAR struct tcp_conn_s *conn,
     }
   else
     {
-      ipv6tcp->tcp.wnd[0] = ((NET_DEV_RCVWNDO(dev)) >> 8);
-      ipv6tcp->tcp.wnd[1] = ((NET_DEV_RCVWNDO(dev)) & 0xff);
+      uint32_t recvwndo = tcp_get_recvwindow(dev, conn);
+
+#ifdef CONFIG_NET_TCP_WINDOW_SCALE
+      recvwndo >>= conn->rcv_wscale;
+#endif
+      ipv6tcp->tcp.wnd[0] = recvwndo >> 8;
+      ipv6tcp->tcp.wnd[1] = recvwndo & 0xff;
     }
 
   /* Calculate TCP checksum. */
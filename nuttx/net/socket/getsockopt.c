@@ -1,7 +1,8 @@
 /****************************************************************************
  * net/socket/getsockopt.c
  *
- *   Copyright (C) 2007-2009, 2012, 2014, 2017 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007-2009, 2012, 2014, 2017-2018 Gregory Nutt. All
+ *     rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -42,12 +43,16 @@
 
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <netinet/in.h>
 #include <sys/time.h>
 #include <debug.h>
 #include <assert.h>
 #include <errno.h>
 
 #include "socket/socket.h"
+#include "inet/inet.h"
+#include "tcp/tcp.h"
+#include "udp/udp.h"
 #include "usrsock/usrsock.h"
 #include "utils/utils.h"
 
@@ -99,6 +104,21 @@
 int psock_getsockopt(FAR struct socket *psock, int level, int option,
                      FAR void *value, FAR socklen_t *value_len)
 {
+#ifdef NET_TCP_HAVE_STACK
+  /* Options at the IPPROTO_TCP level are handled by the TCP protocol */
+
+  if (level == IPPROTO_TCP && psock->s_type == SOCK_STREAM &&
+      (psock->s_domain == PF_INET || psock->s_domain == PF_INET6))
+    {
+      if (!value || !value_len)
+        {
+          return -EINVAL;
+        }
+
+      return tcp_getsockopt(psock, option, value, value_len);
+    }
+#endif
+
   /* Verify that the socket option if valid (but might not be supported ) */
 
   if (!_SO_GETVALID(option) || !value || !value_len)
@@ -240,12 +260,64 @@ int psock_getsockopt(FAR struct socket *psock, int level, int option,
         }
         break;
 
+#if defined(CONFIG_NET_TCP_READAHEAD) || defined(CONFIG_NET_UDP_READAHEAD)
+      case SO_RCVBUF:     /* Reports receive buffer size */
+        {
+          /* Verify that option is the size of an 'int'.  Should also check
+           * that 'value' is properly aligned for an 'int'
+           */
+
+          if (*value_len < sizeof(int))
+            {
+              return -EINVAL;
+            }
+
+          if (psock->s_domain != PF_INET && psock->s_domain != PF_INET6)
+            {
+              return -ENOPROTOOPT;
+            }
+
+#ifdef CONFIG_NET_TCP_READAHEAD
+          if (psock->s_type == SOCK_STREAM &&
+              psock->s_sockif ==
+                inet_sockif(psock->s_domain, SOCK_STREAM, IPPROTO_TCP))
+            {
+              FAR struct tcp_conn_s *conn =
+                (FAR struct tcp_conn_s *)psock->s_conn;
+
+              *(FAR int *)value = conn->rcvbufs;
+            }
+          else
+#endif
+#ifdef CONFIG_NET_UDP_READAHEAD
+          if (psock->s_type == SOCK_DGRAM &&
+              psock->s_sockif ==
+                inet_sockif(psock->s_domain, SOCK_DGRAM, IPPROTO_UDP))
+            {
+              FAR struct udp_conn_s *conn =
+                (FAR struct udp_conn_s *)psock->s_conn;
+
+              *(FAR int *)value = conn->rcvbufs;
+            }
+          else
+#endif
+            {
+              return -ENOPROTOOPT;
+            }
+
+          *value_len = sizeof(int);
+        }
+        break;
+#endif
+
       /* The following are not yet implemented */
 
       case SO_ACCEPTCONN: /* Reports whether socket listening is enabled */
       case SO_LINGER:
       case SO_SNDBUF:     /* Sets send buffer size */
+#if !defined(CONFIG_NET_TCP_READAHEAD) && !defined(CONFIG_NET_UDP_READAHEAD)
       case SO_RCVBUF:     /* Sets receive buffer size */
+#endif
       case SO_ERROR:      /* Reports and clears error status. */
       case SO_RCVLOWAT:   /* Sets the minimum number of bytes to input */
       case SO_SNDLOWAT:   /* Sets the minimum number of bytes to output */
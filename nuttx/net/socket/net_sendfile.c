@@ -46,8 +46,11 @@
 #include <sys/socket.h>
 
 #include <errno.h>
+#include <assert.h>
 #include <debug.h>
 
+#include <nuttx/sched.h>
+#include <nuttx/fs/fs.h>
 #include <nuttx/net/net.h>
 
 #include "socket/socket.h"
@@ -66,10 +69,10 @@
  *   connected state (so that the intended recipient is known).
  *
  * Parameters:
- *   psock    An instance of the internal socket structure.
- *   buf      Data to send
- *   len      Length of data to send
- *   flags    Send flags
+ *   outfd    The socket descriptor
+ *   infile   The file structure of the input file
+ *   offset   Offset into the input file (or NULL to use the file position)
+ *   count    The number of bytes to send
  *
  * Returned Value:
  *   On success, returns the number of characters sent.  On  error,
@@ -124,11 +127,11 @@ ssize_t net_sendfile(int outfd, FAR struct file *infile, FAR off_t *offset,
   ssize_t ret;
   int errcode;
 
-  DEBUGASSERT(psock->sock != NULL && infile != NULL);
+  DEBUGASSERT(infile != NULL);
 
   /* Verify that the sockfd corresponds to valid, allocated socket */
 
-  if (psock != NULL || psock->s_crefs <= 0)
+  if (psock == NULL || psock->s_crefs <= 0)
     {
       nerr("ERROR: Invalid socket\n");
       errcode = EBADF;
@@ -142,9 +145,10 @@ ssize_t net_sendfile(int outfd, FAR struct file *infile, FAR off_t *offset,
    * method in the socket interface.
    */
 
-  DEBUGASSERT(psock->sockif != NULL);
-  if (psock->sockif->s_sendfile == NULL)
+  DEBUGASSERT(psock->s_sockif != NULL);
+  if (psock->s_sockif->si_sendfile == NULL)
     {
+      FAR struct filelist *list;
       int infd;
 
       list = sched_getfiles();
@@ -153,19 +157,21 @@ ssize_t net_sendfile(int outfd, FAR struct file *infile, FAR off_t *offset,
       infd = infile - list->fl_files;
       return lib_sendfile(outfd, infd, offset, count);
     }
-  else
-    {
-      /* The address family can handle the optimized file send */
 
-      ret = psock->sockif->s_sendfile(psock, offset, count);
-      if (ret < 0)
-        {
-          set_errno(-ret);
-          return ERROR;
-        }
+  /* The address family can handle the optimized file send */
 
-      return ret;
+  ret = psock->s_sockif->si_sendfile(psock, infile, offset, count);
+  if (ret < 0)
+    {
+      errcode = -ret;
+      goto errout;
     }
+
+  return ret;
+
+errout:
+  set_errno(errcode);
+  return ERROR;
 }
 
 #endif /* CONFIG_NET_SENDFILE */
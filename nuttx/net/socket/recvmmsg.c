@@ -0,0 +1,283 @@
+/****************************************************************************
+ * net/socket/recvmmsg.c
+ *
+ *   Copyright (C) 2018 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+#ifdef CONFIG_NET
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <limits.h>
+#include <time.h>
+#include <errno.h>
+#include <assert.h>
+#include <debug.h>
+
+#include <nuttx/clock.h>
+#include <nuttx/cancelpt.h>
+#include <nuttx/net/net.h>
+
+#include "socket/socket.h"
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: psock_recvmmsg
+ *
+ * Description:
+ *   psock_recvmmsg() receives up to 'vlen' messages.  The number of bytes
+ *   received for each message is returned in its msg_len field.  This is
+ *   an internal OS interface.  It is functionally equivalent to recvmmsg()
+ *   except that:
+ *
+ *   - It is not a cancellation point,
+ *   - It does not modify the errno variable, and
+ *   - I accepts the internal socket structure as an input rather than an
+ *     task-specific socket descriptor.
+ *
+ *   Messages already queued for the socket are taken in one batch with the
+ *   address family's si_recvmmsg() method, if it has one.  Otherwise, each
+ *   message is received with psock_recvmsg().
+ *
+ * Input Parameters:
+ *   psock   - A pointer to a NuttX-specific, internal socket structure
+ *   msgvec  - Describes the buffers for each message
+ *   vlen    - The number of messages in 'msgvec'
+ *   flags   - Receive flags.  MSG_WAITFORONE:  Do not wait once one message
+ *             has been received.
+ *   timeout - The time limit of the operation (may be NULL).  As with
+ *             Linux, this is only checked after each message is received.
+ *
+ * Returned Value:
+ *   The number of messages received.  If an error occurs before the first
+ *   message is received, a negated errno value is returned.
+ *
+ ****************************************************************************/
+
+int psock_recvmmsg(FAR struct socket *psock, FAR struct mmsghdr *msgvec,
+                   unsigned int vlen, int flags,
+                   FAR struct timespec *timeout)
+{
+  unsigned int nrecvd = 0;
+  systime_t start = 0;
+  systime_t ticks = 0;
+  ssize_t ret = 0;
+  bool nonblock;
+  int nbatch;
+
+  /* Verify that the sockfd corresponds to valid, allocated socket */
+
+  if (psock == NULL || psock->s_crefs <= 0)
+    {
+      return -EBADF;
+    }
+
+  if (msgvec == NULL && vlen > 0)
+    {
+      return -EFAULT;
+    }
+
+  if (vlen > INT_MAX)
+    {
+      vlen = INT_MAX;
+    }
+
+  if (timeout != NULL)
+    {
+      if (timeout->tv_sec < 0 || timeout->tv_nsec < 0 ||
+          timeout->tv_nsec >= NSEC_PER_SEC)
+        {
+          return -EINVAL;
+        }
+
+      ticks = SEC2TICK(timeout->tv_sec) + NSEC2TICK(timeout->tv_nsec);
+      start = clock_systimer();
+    }
+
+  nonblock = _SS_ISNONBLOCK(psock->s_flags) ||
+             (flags & (MSG_DONTWAIT | MSG_WAITFORONE)) != 0;
+  flags   &= ~MSG_WAITFORONE;
+
+  DEBUGASSERT(psock->s_sockif != NULL);
+
+  while (nrecvd < vlen)
+    {
+      /* Take all of the messages that are already queued in one batch */
+
+      if (psock->s_sockif->si_recvmmsg != NULL)
+        {
+          nbatch = psock->s_sockif->si_recvmmsg(psock, &msgvec[nrecvd],
+                                                vlen - nrecvd, flags);
+          if (nbatch < 0)
+            {
+              ret = nbatch;
+              break;
+            }
+
+          nrecvd += nbatch;
+          if (nrecvd >= vlen)
+            {
+              break;
+            }
+        }
+
+      /* Do not wait for more once something has been received if waiting
+       * is not permitted or the time limit has expired.
+       */
+
+      if (nrecvd > 0 &&
+          (nonblock ||
+           (timeout != NULL && clock_systimer() - start >= ticks)))
+        {
+          break;
+        }
+
+      /* Wait for the next message */
+
+      ret = psock_recvmsg(psock, &msgvec[nrecvd].msg_hdr, flags);
+      if (ret < 0)
+        {
+          break;
+        }
+
+      msgvec[nrecvd].msg_len = ret;
+      nrecvd++;
+
+      /* Zero bytes from a stream is the end of the stream */
+
+      if (ret == 0 && psock->s_type == SOCK_STREAM)
+        {
+          break;
+        }
+    }
+
+  /* An error is reported only if nothing was received */
+
+  return nrecvd > 0 ? (int)nrecvd : (int)ret;
+}
+
+/****************************************************************************
+ * Name: nx_recvmmsg
+ *
+ * Description:
+ *   nx_recvmmsg() is an internal OS interface.  It is functionally
+ *   equivalent to recvmmsg() except that:
+ *
+ *   - It is not a cancellation point, and
+ *   - It does not modify the errno variable.
+ *
+ * Input Parameters:
+ *   sockfd  - Socket descriptor of the socket
+ *   msgvec  - Describes the buffers for each message
+ *   vlen    - The number of messages in 'msgvec'
+ *   flags   - Receive flags
+ *   timeout - The time limit of the operation (may be NULL)
+ *
+ * Returned Value:
+ *   The number of messages received.  On any failure, a negated errno value
+ *   is returned.
+ *
+ ****************************************************************************/
+
+int nx_recvmmsg(int sockfd, FAR struct mmsghdr *msgvec, unsigned int vlen,
+                int flags, FAR struct timespec *timeout)
+{
+  FAR struct socket *psock;
+
+  /* Get the underlying socket structure */
+
+  psock = sockfd_socket(sockfd);
+
+  /* Then let psock_recvmmsg() do all of the work */
+
+  return psock_recvmmsg(psock, msgvec, vlen, flags, timeout);
+}
+
+/****************************************************************************
+ * Name: recvmmsg
+ *
+ * Description:
+ *   The recvmmsg() call receives several messages from a socket with a
+ *   single call.  Each element of 'msgvec' is filled in as with recvmsg()
+ *   and the number of bytes received is returned in its msg_len field.
+ *
+ *   UDP sockets with read-ahead buffering take all of the datagrams that
+ *   are already queued with a single acquisition of the network lock.
+ *
+ * Input Parameters:
+ *   sockfd  - Socket descriptor of the socket
+ *   msgvec  - Describes the buffers for each message
+ *   vlen    - The number of messages in 'msgvec'
+ *   flags   - Receive flags.  MSG_WAITFORONE: Return as soon as one message
+ *             has been received.
+ *   timeout - The time limit of the operation (may be NULL).  It is only
+ *             checked after each message is received, so recvmmsg() may
+ *             still block indefinitely.
+ *
+ * Returned Value:
+ *   On success, returns the number of messages received in 'msgvec'.  On
+ *   error, -1 is returned and errno is set appropriately (see recvmsg()).
+ *
+ ****************************************************************************/
+
+int recvmmsg(int sockfd, FAR struct mmsghdr *msgvec, unsigned int vlen,
+             int flags, FAR struct timespec *timeout)
+{
+  int ret;
+
+  /* recvmmsg() is a cancellation point */
+
+  (void)enter_cancellation_point();
+
+  /* Let nx_recvmmsg() and psock_recvmmsg() do all of the work */
+
+  ret = nx_recvmmsg(sockfd, msgvec, vlen, flags, timeout);
+  if (ret < 0)
+    {
+      set_errno(-ret);
+      ret = ERROR;
+    }
+
+  leave_cancellation_point();
+  return ret;
+}
+
+#endif /* CONFIG_NET */
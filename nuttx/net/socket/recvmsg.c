@@ -0,0 +1,323 @@
+/****************************************************************************
+ * net/socket/recvmsg.c
+ *
+ *   Copyright (C) 2018 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+#ifdef CONFIG_NET
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+#include <assert.h>
+#include <debug.h>
+
+#include <nuttx/cancelpt.h>
+#include <nuttx/kmalloc.h>
+#include <nuttx/net/net.h>
+
+#include "socket/socket.h"
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: psock_recvmsg_scatter
+ *
+ * Description:
+ *   Receive a message for an address family that cannot receive directly
+ *   into the buffers of a struct msghdr.  The message is received with a
+ *   single psock_recvfrom() into a temporary buffer and then scattered so
+ *   that a datagram is never split across several receive operations.
+ *   No ancillary data is returned.
+ *
+ ****************************************************************************/
+
+static ssize_t psock_recvmsg_scatter(FAR struct socket *psock,
+                                     FAR struct msghdr *msg, int flags)
+{
+  FAR const struct iovec *iov = msg->msg_iov;
+  FAR struct sockaddr *from = NULL;
+  FAR socklen_t *fromlen = NULL;
+  FAR uint8_t *buffer;
+  size_t total;
+  size_t ncopy;
+  ssize_t ret;
+  uint8_t dummy;
+  int i;
+
+  msg->msg_controllen = 0;
+
+  if (msg->msg_name != NULL && msg->msg_namelen > 0)
+    {
+      from    = (FAR struct sockaddr *)msg->msg_name;
+      fromlen = &msg->msg_namelen;
+    }
+
+  /* The sum of the buffer lengths may not exceed SSIZE_MAX */
+
+  for (i = 0, total = 0; i < msg->msg_iovlen; i++)
+    {
+      if (iov[i].iov_len > SSIZE_MAX - total)
+        {
+          return -EINVAL;
+        }
+
+      total += iov[i].iov_len;
+    }
+
+  /* A single buffer can be used as it is */
+
+  if (msg->msg_iovlen < 2)
+    {
+      return psock_recvfrom(psock,
+                            msg->msg_iovlen > 0 ? iov[0].iov_base : &dummy,
+                            total, flags, from, fromlen);
+    }
+
+  buffer = (FAR uint8_t *)kmm_malloc(total > 0 ? total : 1);
+  if (buffer == NULL)
+    {
+      if (psock->s_type != SOCK_STREAM)
+        {
+          return -ENOMEM;
+        }
+
+      /* A short read is acceptable for a stream.  Receive into the first
+       * non-empty buffer only.
+       */
+
+      for (i = 0; i < msg->msg_iovlen && iov[i].iov_len == 0; i++)
+        {
+        }
+
+      return psock_recvfrom(psock,
+                            i < msg->msg_iovlen ? iov[i].iov_base : &dummy,
+                            i < msg->msg_iovlen ? iov[i].iov_len : 0,
+                            flags, from, fromlen);
+    }
+
+  ret = psock_recvfrom(psock, buffer, total, flags, from, fromlen);
+
+  /* Scatter the received data */
+
+  for (i = 0, total = 0; ret > 0 && total < (size_t)ret; i++)
+    {
+      ncopy = iov[i].iov_len;
+      if (ncopy > (size_t)ret - total)
+        {
+          ncopy = (size_t)ret - total;
+        }
+
+      memcpy(iov[i].iov_base, &buffer[total], ncopy);
+      total += ncopy;
+    }
+
+  kmm_free(buffer);
+  return ret;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: psock_recvmsg
+ *
+ * Description:
+ *   psock_recvmsg() receives a message into the buffers described by
+ *   msg->msg_iov.  The source address and any ancillary data are returned
+ *   in msg->msg_name and msg->msg_control.  This is an internal OS
+ *   interface.  It is functionally equivalent to recvmsg() except that:
+ *
+ *   - It is not a cancellation point,
+ *   - It does not modify the errno variable, and
+ *   - I accepts the internal socket structure as an input rather than an
+ *     task-specific socket descriptor.
+ *
+ *   The address family's si_recvmsg() method is used if it has one.
+ *   Otherwise, the message is received with a single recvfrom() and
+ *   scattered into the buffers.
+ *
+ * Input Parameters:
+ *   psock - A pointer to a NuttX-specific, internal socket structure
+ *   msg   - Describes the buffers and returns the message attributes
+ *   flags - Receive flags
+ *
+ * Returned Value:
+ *   On success, returns the number of characters received.  If no data is
+ *   available to be received and the peer has performed an orderly
+ *   shutdown, zero is returned.  Otherwise, on any failure, a negated errno
+ *   value is returned.
+ *
+ ****************************************************************************/
+
+ssize_t psock_recvmsg(FAR struct socket *psock, FAR struct msghdr *msg,
+                      int flags)
+{
+  ssize_t ret;
+
+  /* Verify the message description */
+
+  if (msg == NULL || msg->msg_iovlen < 0 ||
+      (msg->msg_iov == NULL && msg->msg_iovlen > 0) ||
+      (msg->msg_control == NULL && msg->msg_controllen > 0))
+    {
+      return -EINVAL;
+    }
+
+  /* Verify that the sockfd corresponds to valid, allocated socket */
+
+  if (psock == NULL || psock->s_crefs <= 0)
+    {
+      return -EBADF;
+    }
+
+  msg->msg_flags = 0;
+
+  /* Let the address family's recvmsg() method handle the operation if
+   * there is one.
+   */
+
+  DEBUGASSERT(psock->s_sockif != NULL);
+
+  if (psock->s_sockif->si_recvmsg != NULL)
+    {
+      /* Set the socket state to receiving */
+
+      psock->s_flags = _SS_SETSTATE(psock->s_flags, _SF_RECV);
+
+      ret = psock->s_sockif->si_recvmsg(psock, msg, flags);
+
+      /* Set the socket state to idle */
+
+      psock->s_flags = _SS_SETSTATE(psock->s_flags, _SF_IDLE);
+    }
+  else
+    {
+      ret = psock_recvmsg_scatter(psock, msg, flags);
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: nx_recvmsg
+ *
+ * Description:
+ *   nx_recvmsg() is an internal OS interface.  It is functionally
+ *   equivalent to recvmsg() except that:
+ *
+ *   - It is not a cancellation point, and
+ *   - It does not modify the errno variable.
+ *
+ * Input Parameters:
+ *   sockfd - Socket descriptor of socket
+ *   msg    - Describes the buffers and returns the message attributes
+ *   flags  - Receive flags
+ *
+ * Returned Value:
+ *   On success, returns the number of characters received.  On any
+ *   failure, a negated errno value is returned.
+ *
+ ****************************************************************************/
+
+ssize_t nx_recvmsg(int sockfd, FAR struct msghdr *msg, int flags)
+{
+  FAR struct socket *psock;
+
+  /* Get the underlying socket structure */
+
+  psock = sockfd_socket(sockfd);
+
+  /* Then let psock_recvmsg() do all of the work */
+
+  return psock_recvmsg(psock, msg, flags);
+}
+
+/****************************************************************************
+ * Name: recvmsg
+ *
+ * Description:
+ *   The recvmsg() call receives a message from a socket into the buffers
+ *   described by the msg_iov array of msg.  If msg->msg_name is not NULL,
+ *   the source address is returned there as with recvfrom().  Ancillary
+ *   data, such as file descriptors passed over a Unix domain socket
+ *   (SCM_RIGHTS), is returned in msg->msg_control and msg->msg_controllen
+ *   is updated.  MSG_CTRUNC is set in msg->msg_flags if some ancillary data
+ *   did not fit.
+ *
+ * Input Parameters:
+ *   sockfd - Socket descriptor of socket
+ *   msg    - Describes the buffers and returns the message attributes
+ *   flags  - Receive flags
+ *
+ * Returned Value:
+ *   On success, returns the number of characters received.  If no data is
+ *   available to be received and the peer has performed an orderly
+ *   shutdown, recvmsg() will return 0.  Otherwise, on errors, -1 is
+ *   returned, and errno is set appropriately (see recvfrom()).
+ *
+ ****************************************************************************/
+
+ssize_t recvmsg(int sockfd, FAR struct msghdr *msg, int flags)
+{
+  ssize_t ret;
+
+  /* recvmsg() is a cancellation point */
+
+  (void)enter_cancellation_point();
+
+  /* Let nx_recvmsg() and psock_recvmsg() do all of the work */
+
+  ret = nx_recvmsg(sockfd, msg, flags);
+  if (ret < 0)
+    {
+      set_errno((int)-ret);
+      ret = ERROR;
+    }
+
+  leave_cancellation_point();
+  return ret;
+}
+
+#endif /* CONFIG_NET */
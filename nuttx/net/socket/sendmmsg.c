@@ -0,0 +1,221 @@
+/****************************************************************************
+ * net/socket/sendmmsg.c
+ *
+ *   Copyright (C) 2018 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+#ifdef CONFIG_NET
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <limits.h>
+#include <errno.h>
+#include <assert.h>
+#include <debug.h>
+
+#include <nuttx/cancelpt.h>
+#include <nuttx/net/net.h>
+
+#include "socket/socket.h"
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: psock_sendmmsg
+ *
+ * Description:
+ *   psock_sendmmsg() sends up to 'vlen' messages.  The number of bytes sent
+ *   for each message is returned in its msg_len field.  This is an internal
+ *   OS interface.  It is functionally equivalent to sendmmsg() except that:
+ *
+ *   - It is not a cancellation point,
+ *   - It does not modify the errno variable, and
+ *   - I accepts the internal socket structure as an input rather than an
+ *     task-specific socket descriptor.
+ *
+ *   The address family's si_sendmmsg() method is used if it has one.
+ *   Otherwise, each message is sent with psock_sendmsg().
+ *
+ * Input Parameters:
+ *   psock  - A pointer to a NuttX-specific, internal socket structure
+ *   msgvec - The messages to send
+ *   vlen   - The number of messages in 'msgvec'
+ *   flags  - Send flags
+ *
+ * Returned Value:
+ *   The number of messages sent.  If an error occurs before the first
+ *   message is sent, a negated errno value is returned.
+ *
+ ****************************************************************************/
+
+int psock_sendmmsg(FAR struct socket *psock, FAR struct mmsghdr *msgvec,
+                   unsigned int vlen, int flags)
+{
+  unsigned int nsent;
+  ssize_t ret;
+
+  /* Verify that the sockfd corresponds to valid, allocated socket */
+
+  if (psock == NULL || psock->s_crefs <= 0)
+    {
+      return -EBADF;
+    }
+
+  if (msgvec == NULL && vlen > 0)
+    {
+      return -EFAULT;
+    }
+
+  if (vlen > INT_MAX)
+    {
+      vlen = INT_MAX;
+    }
+
+  /* Let the address family queue the whole batch if it can */
+
+  DEBUGASSERT(psock->s_sockif != NULL);
+
+  if (psock->s_sockif->si_sendmmsg != NULL)
+    {
+      return psock->s_sockif->si_sendmmsg(psock, msgvec, vlen, flags);
+    }
+
+  /* Otherwise, send the messages one at a time.  Stop at the first error;
+   * it is reported only if no message was sent.
+   */
+
+  for (nsent = 0; nsent < vlen; nsent++)
+    {
+      ret = psock_sendmsg(psock, &msgvec[nsent].msg_hdr, flags);
+      if (ret < 0)
+        {
+          return nsent > 0 ? (int)nsent : (int)ret;
+        }
+
+      msgvec[nsent].msg_len = ret;
+    }
+
+  return nsent;
+}
+
+/****************************************************************************
+ * Name: nx_sendmmsg
+ *
+ * Description:
+ *   nx_sendmmsg() is an internal OS interface.  It is functionally
+ *   equivalent to sendmmsg() except that:
+ *
+ *   - It is not a cancellation point, and
+ *   - It does not modify the errno variable.
+ *
+ * Input Parameters:
+ *   sockfd - Socket descriptor of the socket
+ *   msgvec - The messages to send
+ *   vlen   - The number of messages in 'msgvec'
+ *   flags  - Send flags
+ *
+ * Returned Value:
+ *   The number of messages sent.  On any failure, a negated errno value is
+ *   returned.
+ *
+ ****************************************************************************/
+
+int nx_sendmmsg(int sockfd, FAR struct mmsghdr *msgvec, unsigned int vlen,
+                int flags)
+{
+  FAR struct socket *psock;
+
+  /* Get the underlying socket structure */
+
+  psock = sockfd_socket(sockfd);
+
+  /* Then let psock_sendmmsg() do all of the work */
+
+  return psock_sendmmsg(psock, msgvec, vlen, flags);
+}
+
+/****************************************************************************
+ * Name: sendmmsg
+ *
+ * Description:
+ *   The sendmmsg() call sends several messages on a socket with a single
+ *   call.  Each element of 'msgvec' is sent as with sendmsg() and the
+ *   number of bytes sent is returned in its msg_len field.
+ *
+ *   UDP sockets with write buffers queue all of the datagrams with a single
+ *   acquisition of the network lock.
+ *
+ * Input Parameters:
+ *   sockfd - Socket descriptor of the socket
+ *   msgvec - The messages to send
+ *   vlen   - The number of messages in 'msgvec'
+ *   flags  - Send flags
+ *
+ * Returned Value:
+ *   On success, returns the number of messages sent from 'msgvec'.  If
+ *   this is less than 'vlen', the caller can retry with the remaining
+ *   messages.  On error, -1 is returned and errno is set appropriately (see
+ *   sendmsg()).
+ *
+ ****************************************************************************/
+
+int sendmmsg(int sockfd, FAR struct mmsghdr *msgvec, unsigned int vlen,
+             int flags)
+{
+  int ret;
+
+  /* sendmmsg() is a cancellation point */
+
+  (void)enter_cancellation_point();
+
+  /* Let nx_sendmmsg() and psock_sendmmsg() do all of the work */
+
+  ret = nx_sendmmsg(sockfd, msgvec, vlen, flags);
+  if (ret < 0)
+    {
+      set_errno(-ret);
+      ret = ERROR;
+    }
+
+  leave_cancellation_point();
+  return ret;
+}
+
+#endif /* CONFIG_NET */
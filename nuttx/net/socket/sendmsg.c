@@ -0,0 +1,320 @@
+/****************************************************************************
+ * net/socket/sendmsg.c
+ *
+ *   Copyright (C) 2018 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+#ifdef CONFIG_NET
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+#include <assert.h>
+#include <debug.h>
+
+#include <nuttx/cancelpt.h>
+#include <nuttx/kmalloc.h>
+#include <nuttx/net/net.h>
+
+#include "socket/socket.h"
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: psock_sendmsg_gather
+ *
+ * Description:
+ *   Send a message for an address family that cannot send directly from
+ *   the buffers of a struct msghdr.  The buffers are gathered into one
+ *   temporary buffer and sent with a single psock_sendto() so that the
+ *   message still goes out as one datagram or as one write to the stream.
+ *   Ancillary data is not supported.
+ *
+ * Input Parameters:
+ *   psock - An instance of the internal socket structure.
+ *   msg   - The message to send
+ *   flags - Send flags
+ *
+ * Returned Value:
+ *   On success, returns the number of characters sent.  On any failure, a
+ *   negated errno value is returned.
+ *
+ ****************************************************************************/
+
+ssize_t psock_sendmsg_gather(FAR struct socket *psock,
+                             FAR const struct msghdr *msg, int flags)
+{
+  FAR const struct iovec *iov = msg->msg_iov;
+  FAR const struct sockaddr *to = (FAR const struct sockaddr *)msg->msg_name;
+  FAR uint8_t *buffer;
+  size_t total;
+  ssize_t ntotal;
+  ssize_t ret;
+  uint8_t dummy;
+  int i;
+
+  if (msg->msg_controllen > 0)
+    {
+      return -EOPNOTSUPP;
+    }
+
+  /* The sum of the buffer lengths may not exceed SSIZE_MAX */
+
+  for (i = 0, total = 0; i < msg->msg_iovlen; i++)
+    {
+      if (iov[i].iov_len > SSIZE_MAX - total)
+        {
+          return -EINVAL;
+        }
+
+      total += iov[i].iov_len;
+    }
+
+  /* A single buffer can be sent as it is */
+
+  if (msg->msg_iovlen < 2)
+    {
+      return psock_sendto(psock,
+                          msg->msg_iovlen > 0 ? iov[0].iov_base : &dummy,
+                          total, flags, to, msg->msg_namelen);
+    }
+
+  /* Otherwise, gather the buffers */
+
+  buffer = (FAR uint8_t *)kmm_malloc(total > 0 ? total : 1);
+  if (buffer == NULL)
+    {
+      if (psock->s_type != SOCK_STREAM)
+        {
+          return -ENOMEM;
+        }
+
+      /* A stream does not preserve message boundaries anyway.  Send the
+       * buffers one at a time.
+       */
+
+      for (i = 0, ntotal = 0; i < msg->msg_iovlen; i++)
+        {
+          if (iov[i].iov_len == 0)
+            {
+              continue;
+            }
+
+          ret = psock_sendto(psock, iov[i].iov_base, iov[i].iov_len, flags,
+                             to, msg->msg_namelen);
+          if (ret < 0)
+            {
+              return ntotal > 0 ? ntotal : ret;
+            }
+
+          ntotal += ret;
+          if ((size_t)ret < iov[i].iov_len)
+            {
+              break;
+            }
+        }
+
+      return ntotal;
+    }
+
+  for (i = 0, total = 0; i < msg->msg_iovlen; i++)
+    {
+      memcpy(&buffer[total], iov[i].iov_base, iov[i].iov_len);
+      total += iov[i].iov_len;
+    }
+
+  ret = psock_sendto(psock, buffer, total, flags, to, msg->msg_namelen);
+  kmm_free(buffer);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: psock_sendmsg
+ *
+ * Description:
+ *   psock_sendmsg() sends a message gathered from the buffers described by
+ *   msg->msg_iov, optionally to the address msg->msg_name and with the
+ *   ancillary data in msg->msg_control.  This is an internal OS interface.
+ *   It is functionally equivalent to sendmsg() except that:
+ *
+ *   - It is not a cancellation point,
+ *   - It does not modify the errno variable, and
+ *   - I accepts the internal socket structure as an input rather than an
+ *     task-specific socket descriptor.
+ *
+ *   The address family's si_sendmsg() method is used if it has one.
+ *   Otherwise, the buffers are gathered and sent with a single sendto().
+ *
+ * Input Parameters:
+ *   psock - A pointer to a NuttX-specific, internal socket structure
+ *   msg   - The message to send
+ *   flags - Send flags
+ *
+ * Returned Value:
+ *   On success, returns the number of characters sent.  On any failure, a
+ *   negated errno value is returned (See comments with send() for a list
+ *   of the appropriate errno value).
+ *
+ ****************************************************************************/
+
+ssize_t psock_sendmsg(FAR struct socket *psock, FAR const struct msghdr *msg,
+                      int flags)
+{
+  ssize_t ret;
+
+  /* Verify the message description */
+
+  if (msg == NULL || msg->msg_iovlen < 0 ||
+      (msg->msg_iov == NULL && msg->msg_iovlen > 0) ||
+      (msg->msg_control == NULL && msg->msg_controllen > 0))
+    {
+      return -EINVAL;
+    }
+
+  /* Verify that the sockfd corresponds to valid, allocated socket */
+
+  if (psock == NULL || psock->s_crefs <= 0)
+    {
+      return -EBADF;
+    }
+
+  /* Let the address family's sendmsg() method handle the operation if
+   * there is one.
+   */
+
+  DEBUGASSERT(psock->s_sockif != NULL);
+
+  if (psock->s_sockif->si_sendmsg != NULL)
+    {
+      ret = psock->s_sockif->si_sendmsg(psock, msg, flags);
+    }
+  else
+    {
+      ret = psock_sendmsg_gather(psock, msg, flags);
+    }
+
+  if (ret < 0)
+    {
+      nerr("ERROR: sendmsg failed: %ld\n", (long)ret);
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: nx_sendmsg
+ *
+ * Description:
+ *   nx_sendmsg() is an internal OS interface.  It is functionally
+ *   equivalent to sendmsg() except that:
+ *
+ *   - It is not a cancellation point, and
+ *   - It does not modify the errno variable.
+ *
+ * Input Parameters:
+ *   sockfd - Socket descriptor of the socket
+ *   msg    - The message to send
+ *   flags  - Send flags
+ *
+ * Returned Value:
+ *   On success, returns the number of characters sent.  On any failure, a
+ *   negated errno value is returned.
+ *
+ ****************************************************************************/
+
+ssize_t nx_sendmsg(int sockfd, FAR const struct msghdr *msg, int flags)
+{
+  FAR struct socket *psock;
+
+  /* Get the underlying socket structure */
+
+  psock = sockfd_socket(sockfd);
+
+  /* And let psock_sendmsg do all of the work */
+
+  return psock_sendmsg(psock, msg, flags);
+}
+
+/****************************************************************************
+ * Name: sendmsg
+ *
+ * Description:
+ *   The sendmsg() call sends the data described by the msg_iov array of
+ *   msg as a single message.  If msg->msg_name is not NULL, the message is
+ *   sent to that address as with sendto().  Ancillary data in
+ *   msg->msg_control is passed to the address family; Unix domain sockets
+ *   use it to pass open file descriptors (SCM_RIGHTS).
+ *
+ * Input Parameters:
+ *   sockfd - Socket descriptor of the socket
+ *   msg    - The message to send
+ *   flags  - Send flags
+ *
+ * Returned Value:
+ *   On success, returns the number of characters sent.  On  error, -1 is
+ *   returned, and errno is set appropriately (see send() and sendto()).
+ *
+ ****************************************************************************/
+
+ssize_t sendmsg(int sockfd, FAR const struct msghdr *msg, int flags)
+{
+  ssize_t ret;
+
+  /* sendmsg() is a cancellation point */
+
+  (void)enter_cancellation_point();
+
+  /* Let nx_sendmsg() and psock_sendmsg() do all of the work */
+
+  ret = nx_sendmsg(sockfd, msg, flags);
+  if (ret < 0)
+    {
+      set_errno((int)-ret);
+      ret = ERROR;
+    }
+
+  leave_cancellation_point();
+  return ret;
+}
+
+#endif /* CONFIG_NET */
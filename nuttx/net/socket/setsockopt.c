@@ -1,8 +1,8 @@
 /****************************************************************************
  * net/socket/setsockopt.c
  *
- *   Copyright (C) 2007, 2008, 2011-2012, 2014-2015, 2017 Gregory Nutt. All
- *     rights reserved.
+ *   Copyright (C) 2007, 2008, 2011-2012, 2014-2015, 2017-2018 Gregory Nutt.
+ *     All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -43,6 +43,7 @@
 
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <netinet/in.h>
 #include <sys/time.h>
 #include <errno.h>
 #include <debug.h>
@@ -50,11 +51,28 @@
 #include <arch/irq.h>
 
 #include <nuttx/net/net.h>
+#include <nuttx/net/netdev.h>
+#include <nuttx/net/ethernet.h>
 
 #include "socket/socket.h"
+#include "inet/inet.h"
+#include "tcp/tcp.h"
+#include "udp/udp.h"
 #include "usrsock/usrsock.h"
 #include "utils/utils.h"
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The smallest non-zero SO_RCVBUF limits.  Like SOCK_MIN_RCVBUF in Linux,
+ * a smaller limit is rounded up so that the read-ahead buffer can always
+ * hold at least one full segment or datagram.
+ */
+
+#define TCP_MIN_RCVBUF __MAX_TCP_MSS(__IPv4_HDRLEN)
+#define UDP_MIN_RCVBUF __MAX_UDP_MSS(__IPv4_HDRLEN)
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -109,6 +127,21 @@
 int psock_setsockopt(FAR struct socket *psock, int level, int option,
                      FAR const void *value, socklen_t value_len)
 {
+#ifdef NET_TCP_HAVE_STACK
+  /* Options at the IPPROTO_TCP level are handled by the TCP protocol */
+
+  if (level == IPPROTO_TCP && psock->s_type == SOCK_STREAM &&
+      (psock->s_domain == PF_INET || psock->s_domain == PF_INET6))
+    {
+      if (!value)
+        {
+          return -EINVAL;
+        }
+
+      return tcp_setsockopt(psock, option, value, value_len);
+    }
+#endif
+
   /* Verify that the socket option if valid (but might not be supported ) */
 
   if (!_SO_SETVALID(option) || !value)
@@ -190,6 +223,23 @@ int psock_setsockopt(FAR struct socket *psock, int level, int option,
               _SO_CLROPT(psock->s_options, option);
             }
 
+#ifdef CONFIG_NET_TCP_KEEPALIVE
+          /* Keep-alive probing is done by the TCP timer, which sees only
+           * the connection structure.
+           */
+
+          if (option == SO_KEEPALIVE && psock->s_type == SOCK_STREAM &&
+              (psock->s_domain == PF_INET || psock->s_domain == PF_INET6))
+            {
+              FAR struct tcp_conn_s *conn =
+                (FAR struct tcp_conn_s *)psock->s_conn;
+
+              conn->keepalive   = (setting != 0);
+              conn->keeptime    = clock_systimer();
+              conn->keepretries = 0;
+            }
+#endif
+
           net_unlock();
         }
         break;
@@ -276,10 +326,105 @@ int psock_setsockopt(FAR struct socket *psock, int level, int option,
         }
         break;
 #endif
+
+#if defined(CONFIG_NET_TCP_READAHEAD) || defined(CONFIG_NET_UDP_READAHEAD)
+      case SO_RCVBUF:     /* Sets receive buffer size */
+        {
+          int buffersize;
+
+          /* Verify that option is the size of an 'int'.  Should also check
+           * that 'value' is properly aligned for an 'int'
+           */
+
+          if (value_len != sizeof(int))
+            {
+              return -EINVAL;
+            }
+
+          /* Get the value.  Zero removes the limit. */
+
+          buffersize = *(FAR int *)value;
+          if (buffersize < 0)
+            {
+              return -EINVAL;
+            }
+
+          /* Only TCP and UDP sockets hold read-ahead data.  ICMP and ICMPv6
+           * sockets are also SOCK_DGRAM, so check the socket interface too.
+           */
+
+          if (psock->s_domain != PF_INET && psock->s_domain != PF_INET6)
+            {
+              return -ENOPROTOOPT;
+            }
+
+          net_lock();
+
+#ifdef CONFIG_NET_TCP_READAHEAD
+          if (psock->s_type == SOCK_STREAM &&
+              psock->s_sockif ==
+                inet_sockif(psock->s_domain, SOCK_STREAM, IPPROTO_TCP))
+            {
+              FAR struct tcp_conn_s *conn =
+                (FAR struct tcp_conn_s *)psock->s_conn;
+
+              /* Not less than one segment or the receive window of the
+               * device, if the connection already has one.
+               */
+
+              if (buffersize > 0)
+                {
+                  if (buffersize < TCP_MIN_RCVBUF)
+                    {
+                      buffersize = TCP_MIN_RCVBUF;
+                    }
+
+                  if (conn->dev != NULL &&
+                      buffersize < NET_DEV_RCVWNDO(conn->dev))
+                    {
+                      buffersize = NET_DEV_RCVWNDO(conn->dev);
+                    }
+                }
+
+              conn->rcvbufs = buffersize;
+            }
+          else
+#endif
+#ifdef CONFIG_NET_UDP_READAHEAD
+          if (psock->s_type == SOCK_DGRAM &&
+              psock->s_sockif ==
+                inet_sockif(psock->s_domain, SOCK_DGRAM, IPPROTO_UDP))
+            {
+              FAR struct udp_conn_s *conn =
+                (FAR struct udp_conn_s *)psock->s_conn;
+
+              /* Not less than one datagram of the largest size */
+
+              if (buffersize > 0 && buffersize < UDP_MIN_RCVBUF)
+                {
+                  buffersize = UDP_MIN_RCVBUF;
+                }
+
+              conn->rcvbufs = buffersize;
+            }
+          else
+#endif
+            {
+              net_unlock();
+              return -ENOPROTOOPT;
+            }
+
+          net_unlock();
+        }
+        break;
+#endif
+
       /* The following are not yet implemented */
 
       case SO_SNDBUF:     /* Sets send buffer size */
+#if !defined(CONFIG_NET_TCP_READAHEAD) && !defined(CONFIG_NET_UDP_READAHEAD)
       case SO_RCVBUF:     /* Sets receive buffer size */
+#endif
       case SO_RCVLOWAT:   /* Sets the minimum number of bytes to input */
       case SO_SNDLOWAT:   /* Sets the minimum number of bytes to output */
 
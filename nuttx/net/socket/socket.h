@@ -1,7 +1,7 @@
 /****************************************************************************
  * net/socket/socket.h
  *
- *   Copyright (C) 2007-2009, 2011-2014, 2017 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007-2009, 2011-2014, 2017-2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -340,5 +340,29 @@ ssize_t psock_send(FAR struct socket *psock, FAR const void *buf, size_t len,
 
 int net_clone(FAR struct socket *psock1, FAR struct socket *psock2);
 
+/****************************************************************************
+ * Name: psock_sendmsg_gather
+ *
+ * Description:
+ *   Send a message for an address family that cannot send directly from
+ *   the buffers of a struct msghdr.  The buffers are gathered into one
+ *   temporary buffer and sent with a single psock_sendto() so that the
+ *   message still goes out as one datagram or as one write to the stream.
+ *   Ancillary data is not supported.
+ *
+ * Input Parameters:
+ *   psock - An instance of the internal socket structure.
+ *   msg   - The message to send
+ *   flags - Send flags
+ *
+ * Returned Value:
+ *   On success, returns the number of characters sent.  On any failure, a
+ *   negated errno value is returned.
+ *
+ ****************************************************************************/
+
+ssize_t psock_sendmsg_gather(FAR struct socket *psock,
+                             FAR const struct msghdr *msg, int flags);
+
 #endif /* CONFIG_NET */
 #endif /* _NET_SOCKET_SOCKET_H */
@@ -43,8 +43,10 @@
 #include <nuttx/config.h>
 
 #include <sys/types.h>
+#include <stdbool.h>
 #include <queue.h>
 
+#include <nuttx/clock.h>
 #include <nuttx/mm/iob.h>
 #include <nuttx/net/ip.h>
 
@@ -83,10 +85,10 @@
 #  define TCP_WBNRTX(wrb)            ((wrb)->wb_nrtx)
 #  define TCP_WBIOB(wrb)             ((wrb)->wb_iob)
 #  define TCP_WBCOPYOUT(wrb,dest,n)  (iob_copyout(dest,(wrb)->wb_iob,(n),0))
-#  define TCP_WBCOPYIN(wrb,src,n) \
-     (iob_copyin((wrb)->wb_iob,src,(n),0,false))
-#  define TCP_WBTRYCOPYIN(wrb,src,n) \
-     (iob_trycopyin((wrb)->wb_iob,src,(n),0,false))
+#  define TCP_WBCOPYIN(wrb,src,n,off) \
+     (iob_copyin((wrb)->wb_iob,src,(n),(off),false))
+#  define TCP_WBTRYCOPYIN(wrb,src,n,off) \
+     (iob_trycopyin((wrb)->wb_iob,src,(n),(off),false))
 
 #  define TCP_WBTRIM(wrb,n) \
      do { (wrb)->wb_iob = iob_trimhead((wrb)->wb_iob,(n)); } while (0)
@@ -99,6 +101,113 @@
 #  endif
 #endif
 
+#ifdef CONFIG_NET_TCP_CC
+/* Congestion control definitions */
+
+#  define TCP_CC_DUPTHRESH           3          /* Dup ACKs before fast rexmit */
+#  define TCP_CC_MAXCWND             0x3fffffff /* Upper limit on cwnd */
+
+/* Bit definitions for the flags field of struct tcp_cc_s */
+
+#  define TCP_CC_RECOVERY            (1 << 0)   /* In fast recovery */
+#  define TCP_CC_FASTREXMIT          (1 << 1)   /* Fast retransmit pending */
+#endif
+
+#ifdef CONFIG_NET_TCP_SACK
+/* Maximum number of SACK blocks in one SACK option */
+
+#  define TCP_SACK_MAXBLOCKS         4
+
+/* SACK information from the peer is used by the fast recovery logic of the
+ * congestion control.
+ */
+
+#  ifdef CONFIG_NET_TCP_CC
+#    define HAVE_TCP_SACKREXMIT      1
+#  endif
+#endif
+
+#ifdef CONFIG_NET_TCP_WINDOW_SCALE
+/* The largest window scale shift permitted by RFC 7323 */
+
+#  define TCP_WSCALE_MAXSHIFT        14
+
+/* The largest receive window that tcp_get_recvwindow() can offer:  The
+ * space in every I/O buffer that may exist, including those that the pool
+ * can grow by and the large I/O buffers.  The window scale offered in the
+ * SYN must be able to describe it.
+ */
+
+#  ifdef CONFIG_IOB_ELASTIC
+#    define TCP_IOB_NBUFFERS         CONFIG_IOB_MAXBUFFERS
+#  else
+#    define TCP_IOB_NBUFFERS         CONFIG_IOB_NBUFFERS
+#  endif
+
+#  ifdef CONFIG_IOB_LARGE
+#    define TCP_MAX_RECVWNDO \
+       ((uint32_t)TCP_IOB_NBUFFERS * CONFIG_IOB_BUFSIZE + \
+        (uint32_t)CONFIG_IOB_LARGE_NBUFFERS * CONFIG_IOB_LARGE_BUFSIZE)
+#  else
+#    define TCP_MAX_RECVWNDO \
+       ((uint32_t)TCP_IOB_NBUFFERS * CONFIG_IOB_BUFSIZE)
+#  endif
+#endif
+
+#ifdef CONFIG_NET_TCP_TIMESTAMPS
+/* The space used by the timestamps option, padded with two NOPs, in every
+ * segment once timestamps have been negotiated.
+ */
+
+#  define TCP_OPT_TS_ALIGNED_LEN     (TCP_OPT_TS_LEN + 2)
+
+/* The current time as a timestamp value (TSval).  The clock is in msec. */
+
+#  define TCP_TSNOW()                ((uint32_t)TICK2MSEC(clock_systimer()))
+#endif
+
+/* Bit definitions for the optflags field of struct tcp_conn_s:  Options
+ * that the peer has agreed to in its SYN.
+ */
+
+#define TCP_OPTF_SACKPERM            (1 << 0)   /* Peer accepts SACK options */
+#define TCP_OPTF_WSCALE              (1 << 1)   /* Window scaling in use */
+#define TCP_OPTF_TIMESTAMP           (1 << 2)   /* Timestamps in use */
+
+#if defined(CONFIG_NET_TCP_NAGLE) || defined(CONFIG_NET_TCP_DELAYED_ACK)
+/* Bit definitions for the sndflags field of struct tcp_conn_s */
+
+#  define TCP_HAVE_SNDFLAGS          1
+#  define TCP_SNDF_NODELAY           (1 << 0)   /* TCP_NODELAY: No Nagle */
+#  define TCP_SNDF_CORK              (1 << 1)   /* TCP_CORK: Full segments only */
+#  define TCP_SNDF_QUICKACK          (1 << 2)   /* TCP_QUICKACK: No delayed ACK */
+#endif
+
+#ifdef CONFIG_NET_TCP_KEEPALIVE
+/* Keep-alive defaults and limits (RFC 1122, section 4.2.3.6) */
+
+#  ifndef CONFIG_NET_TCP_KEEPIDLE
+#    define CONFIG_NET_TCP_KEEPIDLE  7200       /* Seconds */
+#  endif
+#  ifndef CONFIG_NET_TCP_KEEPINTVL
+#    define CONFIG_NET_TCP_KEEPINTVL 75         /* Seconds */
+#  endif
+#  ifndef CONFIG_NET_TCP_KEEPCNT
+#    define CONFIG_NET_TCP_KEEPCNT   9
+#  endif
+
+#  define TCP_MAXKEEPIDLE            32767      /* Seconds */
+#  define TCP_MAXKEEPINTVL           32767      /* Seconds */
+#  define TCP_MAXKEEPCNT             127
+#endif
+
+/* Sequence number comparisons that account for wrap-around */
+
+#define TCP_SEQ_LT(a,b)              ((int32_t)((a) - (b)) < 0)
+#define TCP_SEQ_LTE(a,b)             ((int32_t)((a) - (b)) <= 0)
+#define TCP_SEQ_GT(a,b)              ((int32_t)((a) - (b)) > 0)
+#define TCP_SEQ_GTE(a,b)             ((int32_t)((a) - (b)) >= 0)
+
 /****************************************************************************
  * Public Type Definitions
  ****************************************************************************/
@@ -117,6 +226,53 @@ struct devif_callback_s;  /* Forward reference */
 struct tcp_backlog_s;     /* Forward reference */
 struct tcp_hdr_s;         /* Forward reference */
 
+#ifdef CONFIG_NET_TCP_CC
+/* Per-connection congestion control state (RFC 5681, RFC 6582).  All
+ * window sizes are in bytes.
+ */
+
+struct tcp_cc_s
+{
+  uint32_t cwnd;          /* Congestion window */
+  uint32_t ssthresh;      /* Slow start threshold */
+  uint32_t lastack;       /* Highest cumulative ACK received */
+  uint32_t recover;       /* Highest sequence number sent when fast
+                           * recovery was entered */
+  uint32_t lastwnd;       /* Peer window advertised with lastack */
+  uint8_t  dupacks;       /* Count of consecutive duplicate ACKs */
+  uint8_t  flags;         /* See TCP_CC_* definitions */
+#ifdef CONFIG_NET_TCP_CC_CUBIC
+  uint32_t wmax;          /* cwnd before the last reduction */
+  uint32_t westimate;     /* TCP-friendly (Reno) window estimate */
+  uint32_t kmsec;         /* Time to grow back to wmax (msec) */
+  systime_t epoch;        /* Start of the current avoidance epoch */
+#endif
+};
+#endif
+
+#ifdef CONFIG_NET_TCP_OUT_OF_ORDER
+/* A range of data received ahead of rcvseq.  Adjacent and overlapping
+ * segments are coalesced into one range.
+ */
+
+struct tcp_ofoseg_s
+{
+  uint32_t left;          /* Sequence number of the first byte */
+  uint32_t right;         /* Sequence number following the last byte */
+  FAR struct iob_s *data; /* The buffered data */
+};
+#endif
+
+#ifdef HAVE_TCP_SACKREXMIT
+/* A range of sequence numbers reported by the peer in a SACK option */
+
+struct tcp_sackblk_s
+{
+  uint32_t left;          /* Sequence number of the first byte */
+  uint32_t right;         /* Sequence number following the last byte */
+};
+#endif
+
 struct tcp_conn_s
 {
   dq_entry_t node;        /* Implements a doubly linked list */
@@ -124,6 +280,12 @@ struct tcp_conn_s
   uint8_t  rcvseq[4];     /* The sequence number that we expect to
                            * receive next */
   uint8_t  sndseq[4];     /* The sequence number that was last sent by us */
+#ifdef CONFIG_NET_TCP_WINDOW_SCALE
+  uint32_t rcv_adv;       /* Right edge of the last window that we sent */
+#endif
+#ifdef CONFIG_NET_TCP_TIMESTAMPS
+  uint32_t ts_recent;     /* Last timestamp from the peer, to be echoed */
+#endif
   uint8_t  crefs;         /* Reference counts on this instance */
 #if defined(CONFIG_NET_IPv4) && defined(CONFIG_NET_IPv6)
   uint8_t  domain;        /* IP domain: PF_INET or PF_INET6 */
@@ -137,11 +299,22 @@ struct tcp_conn_s
   uint8_t  timer;         /* The retransmission timer (units: half-seconds) */
   uint8_t  nrtx;          /* The number of retransmissions for the last
                            * segment sent */
+  uint8_t  optflags;      /* Options agreed by the peer (see TCP_OPTF_*) */
+#ifdef TCP_HAVE_SNDFLAGS
+  uint8_t  sndflags;      /* Send options (see TCP_SNDF_*) */
+#endif
+#ifdef CONFIG_NET_TCP_DELAYED_ACK
+  uint8_t  delack;        /* Received segments not yet ACKed */
+#endif
+#ifdef CONFIG_NET_TCP_WINDOW_SCALE
+  uint8_t  snd_wscale;    /* Shift applied to the window from the peer */
+  uint8_t  rcv_wscale;    /* Shift applied to the window that we send */
+#endif
   uint16_t lport;         /* The local TCP port, in network byte order */
   uint16_t rport;         /* The remoteTCP port, in network byte order */
   uint16_t mss;           /* Current maximum segment size for the
                            * connection */
-  uint16_t winsize;       /* Current window size of the connection */
+  uint32_t winsize;       /* Current window size of the connection */
 #ifdef CONFIG_NET_TCP_WRITE_BUFFERS
   uint32_t unacked;       /* Number bytes sent but not yet ACKed */
 #else
@@ -163,6 +336,25 @@ struct tcp_conn_s
    */
 
   struct iob_queue_s readahead;   /* Read-ahead buffering */
+  uint32_t rcvbufs;               /* Maximum read-ahead bytes (SO_RCVBUF) */
+  uint32_t rcvqueued;             /* Bytes now held in readahead */
+#endif
+
+#ifdef CONFIG_NET_TCP_OUT_OF_ORDER
+  /* Out-of-order reassembly
+   *
+   *   ofosegs  - Data received beyond a gap at rcvseq, sorted by sequence
+   *              number.  Each entry is also one SACK block.
+   *   nofosegs - The number of valid entries in ofosegs[]
+   *   ofolast  - Sequence number of the most recently received out-of-
+   *              order segment.  Its block is reported first in SACKs.
+   */
+
+  struct tcp_ofoseg_s ofosegs[CONFIG_NET_TCP_OFOSEGS];
+  uint8_t  nofosegs;
+#ifdef CONFIG_NET_TCP_SACK
+  uint32_t ofolast;
+#endif
 #endif
 
 #ifdef CONFIG_NET_TCP_WRITE_BUFFERS
@@ -184,6 +376,53 @@ struct tcp_conn_s
                            * segment (next greater sndseq) */
 #endif
 
+#ifdef HAVE_TCP_SACKREXMIT
+  /* SACK scoreboard
+   *
+   *   sacks      - Data beyond the cumulative ACK that the peer reported
+   *                receiving, sorted by sequence number.
+   *   nsacks     - The number of valid entries in sacks[]
+   *   sackrexmit - Holes below this sequence number have already been
+   *                retransmitted during the current fast recovery.
+   */
+
+  struct tcp_sackblk_s sacks[TCP_SACK_MAXBLOCKS];
+  uint8_t    nsacks;
+  uint32_t   sackrexmit;
+#endif
+
+#ifdef CONFIG_NET_TCP_CC
+  struct tcp_cc_s cc;     /* Congestion control state */
+#endif
+
+#ifdef CONFIG_NET_TCP_KEEPALIVE
+  /* Keep-alive and user time-out (see tcp_timer.c)
+   *
+   *   keeptime     - The time that a segment was last received from the
+   *                  peer
+   *   sndtime      - The time that unACKed data was first seen by the TCP
+   *                  timer or last ACKed.  Zero if there is no unACKed
+   *                  data.
+   *   user_timeout - TCP_USER_TIMEOUT:  Abort the connection if data
+   *                  stays unACKed this long (msec).  Zero if disabled.
+   *   keepidle     - TCP_KEEPIDLE:  Idle time before probing (sec)
+   *   keepintvl    - TCP_KEEPINTVL:  Time between probes (sec)
+   *   keepcnt      - TCP_KEEPCNT:  Unanswered probes before aborting
+   *   keepretries  - The number of probes sent since the peer was last
+   *                  heard from
+   *   keepalive    - SO_KEEPALIVE:  Probe idle connections
+   */
+
+  systime_t  keeptime;
+  systime_t  sndtime;
+  uint32_t   user_timeout;
+  uint16_t   keepidle;
+  uint16_t   keepintvl;
+  uint8_t    keepcnt;
+  uint8_t    keepretries;
+  bool       keepalive;
+#endif
+
 #ifdef CONFIG_NET_TCPBACKLOG
   /* Listen backlog support
    *
@@ -259,6 +498,28 @@ struct tcp_wrbuffer_s
 };
 #endif
 
+/* The congestion control algorithm.  The common logic in tcp_cc.c
+ * implements slow start, duplicate ACK detection, fast retransmit and
+ * NewReno fast recovery;  the algorithm provides the window growth
+ * during congestion avoidance and the reduction on a congestion event.
+ *
+ *   init - Initialize algorithm specific state.  cwnd and ssthresh have
+ *          already been set up.
+ *   ack  - 'acked' new bytes were ACKed while in congestion avoidance.
+ *          Open cwnd accordingly.
+ *   loss - A congestion event was detected with 'flight' bytes still
+ *          outstanding.  Return the new value of ssthresh.
+ */
+
+#ifdef CONFIG_NET_TCP_CC
+struct tcp_cc_ops_s
+{
+  CODE void (*init)(FAR struct tcp_conn_s *conn);
+  CODE void (*ack)(FAR struct tcp_conn_s *conn, uint32_t acked);
+  CODE uint32_t (*loss)(FAR struct tcp_conn_s *conn, uint32_t flight);
+};
+#endif
+
 /* Support for listen backlog:
  *
  *   struct tcp_blcontainer_s describes one backlogged connection
@@ -302,6 +563,15 @@ extern "C"
 EXTERN struct net_driver_s *g_netdevices;
 #endif
 
+#ifdef CONFIG_NET_TCP_CC
+/* Available congestion control algorithms */
+
+EXTERN const struct tcp_cc_ops_s g_tcp_newreno;
+#ifdef CONFIG_NET_TCP_CC_CUBIC
+EXTERN const struct tcp_cc_ops_s g_tcp_cubic;
+#endif
+#endif
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
@@ -877,11 +1147,16 @@ void tcp_send(FAR struct net_driver_s *dev, FAR struct tcp_conn_s *conn,
  *   The tcp_sendfile() call may be used only when the INET socket is in a
  *   connected state (so that the intended recipient is known).
  *
+ *   If CONFIG_NET_TCP_WRITE_BUFFERS is enabled, the file data is read
+ *   directly into I/O buffer chains that are queued on the TCP write
+ *   buffer.  Otherwise, the file data is read directly into the device
+ *   packet buffer as each segment is sent.
+ *
  * Parameters:
  *   psock    An instance of the internal socket structure.
- *   buf      Data to send
- *   len      Length of data to send
- *   flags    Send flags
+ *   infile   The file structure of the input file
+ *   offset   Offset into the input file (or NULL to use the file position)
+ *   count    The number of bytes to send
  *
  * Returned Value:
  *   On success, returns the number of characters sent.  On  error,
@@ -936,6 +1211,27 @@ void tcp_reset(FAR struct net_driver_s *dev);
 void tcp_ack(FAR struct net_driver_s *dev, FAR struct tcp_conn_s *conn,
              uint8_t ack);
 
+/****************************************************************************
+ * Name: tcp_get_recvwindow
+ *
+ * Description:
+ *   Calculate the receive window to advertise for the connection.
+ *
+ * Parameters:
+ *   dev  - The device driver structure to use in the send operation
+ *   conn - The TCP connection structure holding connection information
+ *
+ * Returned Value:
+ *   The receive window in bytes, before any window scaling is applied.
+ *
+ * Assumptions:
+ *   Called from network stack logic with the network stack locked
+ *
+ ****************************************************************************/
+
+uint32_t tcp_get_recvwindow(FAR struct net_driver_s *dev,
+                            FAR struct tcp_conn_s *conn);
+
 /****************************************************************************
  * Name: tcp_appsend
  *
@@ -1271,6 +1567,32 @@ struct socket;
 ssize_t psock_tcp_send(FAR struct socket *psock, FAR const void *buf,
                        size_t len);
 
+/****************************************************************************
+ * Name: psock_tcp_sendv
+ *
+ * Description:
+ *   Like psock_tcp_send() but the data is gathered from several buffers.
+ *   All of the buffers are copied into a single write buffer so that data
+ *   such as a protocol header and its payload go out in the same TCP
+ *   segment whenever the MSS permits.
+ *
+ * Parameters:
+ *   psock    An instance of the internal socket structure.
+ *   iov      Array of buffers to send
+ *   iovcnt   Number of elements in iov[]
+ *
+ * Returned Value:
+ *   On success, returns the number of characters sent.  On error, a negated
+ *   errno value is returned (see psock_tcp_send()).
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_WRITE_BUFFERS
+struct iovec;
+ssize_t psock_tcp_sendv(FAR struct socket *psock,
+                        FAR const struct iovec *iov, int iovcnt);
+#endif
+
 /****************************************************************************
  * Name: psock_tcp_cansend
  *
@@ -1297,6 +1619,92 @@ ssize_t psock_tcp_send(FAR struct socket *psock, FAR const void *buf,
 
 int psock_tcp_cansend(FAR struct socket *psock);
 
+/****************************************************************************
+ * Name: psock_tcp_sendwrb
+ *
+ * Description:
+ *   Queue a write buffer that has already been filled with data for
+ *   transmission on the TCP connection.  The data will be sent in FIFO
+ *   order and the write buffer will be released when all of the data has
+ *   been ACKed.
+ *
+ * Parameters:
+ *   psock - An instance of the internal socket structure.
+ *   wrb   - The filled write buffer
+ *
+ * Returned Value:
+ *   Zero (OK) is returned on success; a negated errno value is returned on
+ *   failure.  The caller still owns the write buffer on failure.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_WRITE_BUFFERS
+struct tcp_wrbuffer_s;
+int psock_tcp_sendwrb(FAR struct socket *psock,
+                      FAR struct tcp_wrbuffer_s *wrb);
+#endif
+
+/****************************************************************************
+ * Name: tcp_setsockopt
+ *
+ * Description:
+ *   tcp_setsockopt() sets the TCP-protocol option specified by the
+ *   'option' argument to the value pointed to by the 'value' argument for
+ *   the socket specified by the 'psock' argument.
+ *
+ *   See <netinet/tcp.h> for the a complete list of values of TCP protocol
+ *   options.
+ *
+ * Input Parameters:
+ *   psock     Socket structure of socket to operate on
+ *   option    identifies the option to set
+ *   value     Points to the argument value
+ *   value_len The length of the argument value
+ *
+ * Returned Value:
+ *   Returns zero (OK) on success.  On failure, it returns a negated errno
+ *   value to indicate the nature of the error.  See psock_setsockopt() for
+ *   the list of possible error values.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_SOCKOPTS
+int tcp_setsockopt(FAR struct socket *psock, int option,
+                   FAR const void *value, socklen_t value_len);
+#endif
+
+/****************************************************************************
+ * Name: tcp_getsockopt
+ *
+ * Description:
+ *   tcp_getsockopt() retrieves the value for the TCP-protocol option
+ *   specified by the 'option' argument for the socket specified by the
+ *   'psock' argument.
+ *
+ *   See <netinet/tcp.h> for the a complete list of values of TCP protocol
+ *   options.
+ *
+ * Input Parameters:
+ *   psock     Socket structure of the socket to query
+ *   option    identifies the option to get
+ *   value     Points to the argument value buffer
+ *   value_len The length of the argument value buffer
+ *
+ * Returned Value:
+ *   Returns zero (OK) on success.  On failure, it returns a negated errno
+ *   value to indicate the nature of the error.  See psock_getsockopt() for
+ *   the list of possible error values.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_SOCKOPTS
+int tcp_getsockopt(FAR struct socket *psock, int option,
+                   FAR void *value, FAR socklen_t *value_len);
+#endif
+
 /****************************************************************************
  * Name: tcp_wrbuffer_initialize
  *
@@ -1383,6 +1791,248 @@ void tcp_wrbuffer_dump(FAR const char *msg, FAR struct tcp_wrbuffer_s *wrb,
 #endif
 #endif /* CONFIG_NET_TCP_WRITE_BUFFERS */
 
+/****************************************************************************
+ * Name: tcp_cc_init
+ *
+ * Description:
+ *   Initialize the congestion control state of a connection that has just
+ *   entered the ESTABLISHED state.  The MSS and the initial sequence number
+ *   must already be known.
+ *
+ * Input Parameters:
+ *   conn - The TCP connection structure
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_CC
+void tcp_cc_init(FAR struct tcp_conn_s *conn);
+#endif
+
+/****************************************************************************
+ * Name: tcp_cc_recvack
+ *
+ * Description:
+ *   Update the congestion control state on receipt of an ACK.  New ACKs
+ *   open the congestion window;  the third duplicate ACK enters fast
+ *   recovery and sets TCP_CC_FASTREXMIT to request that the first
+ *   unacknowledged segment be retransmitted by the send logic.
+ *
+ * Input Parameters:
+ *   conn   - The TCP connection structure
+ *   ackseq - The acknowledgement number of the incoming segment
+ *   dlen   - The length of the payload of the incoming segment
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   The network is locked.  conn->winsize already holds the window
+ *   advertised in the incoming segment.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_CC
+void tcp_cc_recvack(FAR struct tcp_conn_s *conn, uint32_t ackseq,
+                    uint16_t dlen);
+#endif
+
+/****************************************************************************
+ * Name: tcp_cc_timeout
+ *
+ * Description:
+ *   Collapse the congestion window after a retransmission timeout.
+ *
+ * Input Parameters:
+ *   conn - The TCP connection structure
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_CC
+void tcp_cc_timeout(FAR struct tcp_conn_s *conn);
+#endif
+
+/****************************************************************************
+ * Name: tcp_ofoseg_add
+ *
+ * Description:
+ *   Hold a segment that was received ahead of a gap in the sequence space
+ *   (seqno is beyond rcvseq) until the missing data arrives.
+ *
+ * Input Parameters:
+ *   conn   - The TCP connection structure
+ *   seqno  - The sequence number of the first byte of the segment
+ *   buffer - The segment payload
+ *   buflen - The length of the segment payload
+ *
+ * Returned Value:
+ *   OK on success;  A negated errno value is returned if the segment could
+ *   not be held:
+ *
+ *   ENOSPC - All out-of-order entries are in use by data closer to rcvseq
+ *   ENOMEM - No I/O buffers are available
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_OUT_OF_ORDER
+int tcp_ofoseg_add(FAR struct tcp_conn_s *conn, uint32_t seqno,
+                   FAR const uint8_t *buffer, uint16_t buflen);
+#endif
+
+/****************************************************************************
+ * Name: tcp_ofoseg_deliver
+ *
+ * Description:
+ *   Move any held out-of-order data that has become contiguous with
+ *   rcvseq to the read-ahead queue and advance rcvseq past it.
+ *
+ * Input Parameters:
+ *   conn - The TCP connection structure
+ *
+ * Returned Value:
+ *   The number of bytes delivered.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_OUT_OF_ORDER
+uint32_t tcp_ofoseg_deliver(FAR struct tcp_conn_s *conn);
+#endif
+
+/****************************************************************************
+ * Name: tcp_ofoseg_free
+ *
+ * Description:
+ *   Discard all out-of-order data held by the connection.
+ *
+ * Input Parameters:
+ *   conn - The TCP connection structure
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_OUT_OF_ORDER
+void tcp_ofoseg_free(FAR struct tcp_conn_s *conn);
+#endif
+
+/****************************************************************************
+ * Name: tcp_sack_build
+ *
+ * Description:
+ *   Build the SACK option describing the out-of-order data held by the
+ *   connection.
+ *
+ * Input Parameters:
+ *   conn    - The TCP connection structure
+ *   optdata - Location to write the option.  There must be room for
+ *             TCP_SACK_MAXBLOCKS blocks.
+ *
+ * Returned Value:
+ *   The size of the option in bytes (a multiple of four);  zero if there
+ *   is nothing to report or the peer did not permit SACK.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_SACK
+unsigned int tcp_sack_build(FAR struct tcp_conn_s *conn,
+                            FAR uint8_t *optdata);
+#endif
+
+/****************************************************************************
+ * Name: tcp_sack_add
+ *
+ * Description:
+ *   Add one block of a SACK option received from the peer to the SACK
+ *   scoreboard.
+ *
+ * Input Parameters:
+ *   conn  - The TCP connection structure
+ *   left  - Sequence number of the first byte of the block
+ *   right - Sequence number following the last byte of the block
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+#ifdef HAVE_TCP_SACKREXMIT
+void tcp_sack_add(FAR struct tcp_conn_s *conn, uint32_t left,
+                  uint32_t right);
+#endif
+
+/****************************************************************************
+ * Name: tcp_sack_ack
+ *
+ * Description:
+ *   Remove everything at or below the cumulative ACK from the SACK
+ *   scoreboard.
+ *
+ * Input Parameters:
+ *   conn   - The TCP connection structure
+ *   ackseq - The acknowledgement number of the incoming segment
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+#ifdef HAVE_TCP_SACKREXMIT
+void tcp_sack_ack(FAR struct tcp_conn_s *conn, uint32_t ackseq);
+#endif
+
+/****************************************************************************
+ * Name: tcp_sack_nexthole
+ *
+ * Description:
+ *   Find the first range of data at or after *seqno that the peer has not
+ *   reported receiving and that lies below data that it has.
+ *
+ * Input Parameters:
+ *   conn   - The TCP connection structure
+ *   seqno  - On input, where to start looking.  On output, the start of
+ *            the hole.
+ *   len    - Location to return the size of the hole
+ *
+ * Returned Value:
+ *   true if a hole was found.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+#ifdef HAVE_TCP_SACKREXMIT
+bool tcp_sack_nexthole(FAR struct tcp_conn_s *conn, FAR uint32_t *seqno,
+                       FAR uint32_t *len);
+#endif
+
 /****************************************************************************
  * Name: tcp_pollsetup
  *
@@ -236,6 +236,17 @@ uint16_t tcp_datahandler(FAR struct tcp_conn_s *conn, FAR uint8_t *buffer,
   FAR struct iob_s *iob;
   int ret;
 
+  /* Don't let one connection hold more read-ahead data than its share.
+   * The data is dropped and will be retransmitted by the peer.
+   */
+
+  if (conn->rcvbufs > 0 && conn->rcvqueued + buflen > conn->rcvbufs)
+    {
+      ninfo("Read-ahead limit reached: %lu\n",
+            (unsigned long)conn->rcvbufs);
+      return 0;
+    }
+
   /* Try to allocate on I/O buffer to start the chain without waiting (and
    * throttling as necessary).  If we would have to wait, then drop the
    * packet.
@@ -274,6 +285,7 @@ uint16_t tcp_datahandler(FAR struct tcp_conn_s *conn, FAR uint8_t *buffer,
       return 0;
     }
 
+  conn->rcvqueued += buflen;
   ninfo("Buffered %d bytes\n", buflen);
   return buflen;
 }
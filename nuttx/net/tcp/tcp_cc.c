@@ -0,0 +1,362 @@
+/****************************************************************************
+ * net/tcp/tcp_cc.c
+ * TCP congestion control
+ *
+ *   Copyright (C) 2018 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+#if defined(CONFIG_NET) && defined(CONFIG_NET_TCP) && \
+    defined(CONFIG_NET_TCP_CC)
+
+#include <stdint.h>
+#include <debug.h>
+
+#include <nuttx/net/netconfig.h>
+#include <nuttx/net/netstats.h>
+#include <nuttx/net/tcp.h>
+
+#include "tcp/tcp.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The algorithm selected by the configuration */
+
+#ifdef CONFIG_NET_TCP_CC_CUBIC
+#  define TCP_CC_OPS (&g_tcp_cubic)
+#else
+#  define TCP_CC_OPS (&g_tcp_newreno)
+#endif
+
+/* RFC 3390 initial window:  min(4*MSS, max(2*MSS, 4380 bytes)) */
+
+#define TCP_CC_INITWND(mss) MIN(4 * (mss), MAX(2 * (mss), 4380))
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static void newreno_ack(FAR struct tcp_conn_s *conn, uint32_t acked);
+static uint32_t newreno_loss(FAR struct tcp_conn_s *conn, uint32_t flight);
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+const struct tcp_cc_ops_s g_tcp_newreno =
+{
+  NULL,                 /* init */
+  newreno_ack,          /* ack */
+  newreno_loss          /* loss */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: newreno_ack
+ *
+ * Description:
+ *   Congestion avoidance:  Open cwnd by SMSS*SMSS/cwnd on each new ACK,
+ *   i.e., by about one MSS per round trip (RFC 5681, equation 3).
+ *
+ ****************************************************************************/
+
+static void newreno_ack(FAR struct tcp_conn_s *conn, uint32_t acked)
+{
+  FAR struct tcp_cc_s *cc = &conn->cc;
+  uint32_t incr;
+
+  incr = ((uint32_t)conn->mss * conn->mss) / cc->cwnd;
+  cc->cwnd += incr > 0 ? incr : 1;
+}
+
+/****************************************************************************
+ * Name: newreno_loss
+ *
+ * Description:
+ *   Halve the amount of data in flight (RFC 5681, equation 4).
+ *
+ ****************************************************************************/
+
+static uint32_t newreno_loss(FAR struct tcp_conn_s *conn, uint32_t flight)
+{
+  return MAX(flight / 2, 2 * (uint32_t)conn->mss);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: tcp_cc_init
+ *
+ * Description:
+ *   Initialize the congestion control state of a connection that has just
+ *   entered the ESTABLISHED state.  The MSS and the initial sequence number
+ *   must already be known.
+ *
+ * Input Parameters:
+ *   conn - The TCP connection structure
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+void tcp_cc_init(FAR struct tcp_conn_s *conn)
+{
+  FAR struct tcp_cc_s *cc = &conn->cc;
+
+  /* isn is the sequence number of the first data byte so isn - 1, the
+   * sequence number of our SYN, is the initial recovery point
+   * (RFC 6582, section 3.2 step 1).
+   */
+
+  cc->cwnd     = TCP_CC_INITWND((uint32_t)conn->mss);
+  cc->ssthresh = TCP_CC_MAXCWND;
+  cc->lastack  = conn->isn;
+  cc->recover  = conn->isn - 1;
+  cc->lastwnd  = conn->winsize;
+  cc->dupacks  = 0;
+  cc->flags    = 0;
+
+  if (TCP_CC_OPS->init != NULL)
+    {
+      TCP_CC_OPS->init(conn);
+    }
+
+  ninfo("cwnd=%u ssthresh=%u\n", cc->cwnd, cc->ssthresh);
+}
+
+/****************************************************************************
+ * Name: tcp_cc_recvack
+ *
+ * Description:
+ *   Update the congestion control state on receipt of an ACK.  New ACKs
+ *   open the congestion window;  the third duplicate ACK enters fast
+ *   recovery and sets TCP_CC_FASTREXMIT to request that the first
+ *   unacknowledged segment be retransmitted by the send logic.
+ *
+ * Input Parameters:
+ *   conn   - The TCP connection structure
+ *   ackseq - The acknowledgement number of the incoming segment
+ *   dlen   - The length of the payload of the incoming segment
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   The network is locked.  conn->winsize already holds the window
+ *   advertised in the incoming segment.
+ *
+ ****************************************************************************/
+
+void tcp_cc_recvack(FAR struct tcp_conn_s *conn, uint32_t ackseq,
+                    uint16_t dlen)
+{
+  FAR struct tcp_cc_s *cc = &conn->cc;
+  uint32_t mss = conn->mss;
+  uint32_t flight;
+  uint32_t acked;
+
+  if (TCP_SEQ_GT(ackseq, cc->lastack))
+    {
+      /* New data was ACKed */
+
+      acked       = ackseq - cc->lastack;
+      cc->lastack = ackseq;
+      cc->dupacks = 0;
+
+      if ((cc->flags & TCP_CC_RECOVERY) != 0)
+        {
+          if (TCP_SEQ_GTE(ackseq, cc->recover))
+            {
+              /* Full ACK:  Everything outstanding when the loss was
+               * detected has now been ACKed.  Deflate the window and
+               * leave fast recovery (RFC 6582, section 3.2 step 3).
+               */
+
+              flight    = conn->sndseq_max - ackseq;
+              cc->cwnd  = MIN(cc->ssthresh, MAX(flight, mss) + mss);
+              cc->flags &= ~TCP_CC_RECOVERY;
+
+              ninfo("Full ACK: cwnd=%u\n", cc->cwnd);
+            }
+          else
+            {
+              /* Partial ACK:  The segment at ackseq was also lost.
+               * Retransmit it and deflate the window by the amount of
+               * new data ACKed (RFC 6582, section 3.2 step 4).
+               */
+
+              cc->cwnd = cc->cwnd > acked + mss ? cc->cwnd - acked : mss;
+              if (acked >= mss)
+                {
+                  cc->cwnd += mss;
+                }
+
+              cc->flags |= TCP_CC_FASTREXMIT;
+
+              ninfo("Partial ACK: cwnd=%u\n", cc->cwnd);
+            }
+        }
+      else if (cc->cwnd < cc->ssthresh)
+        {
+          /* Slow start:  Open cwnd by the amount ACKed, but by no more than
+           * one MSS per ACK (RFC 5681, section 3.1).
+           */
+
+          cc->cwnd += MIN(acked, mss);
+        }
+      else
+        {
+          /* Congestion avoidance */
+
+          TCP_CC_OPS->ack(conn, acked);
+        }
+
+      if (cc->cwnd > TCP_CC_MAXCWND)
+        {
+          cc->cwnd = TCP_CC_MAXCWND;
+        }
+    }
+  else if (ackseq == cc->lastack && dlen == 0 &&
+           conn->winsize == cc->lastwnd && conn->sndseq_max != ackseq)
+    {
+      /* A duplicate ACK:  No data, no window update and data is
+       * outstanding (RFC 5681, section 2).
+       */
+
+      if ((cc->flags & TCP_CC_RECOVERY) != 0)
+        {
+          /* Each further duplicate ACK means that another segment has left
+           * the network.  Inflate the window.
+           */
+
+          cc->cwnd += mss;
+
+#ifdef HAVE_TCP_SACKREXMIT
+          /* With SACK information, the window opened by the duplicate ACK
+           * is used to fill the next hole rather than to send new data.
+           */
+
+          if (conn->nsacks > 0)
+            {
+              cc->flags |= TCP_CC_FASTREXMIT;
+            }
+#endif
+        }
+      else if (++cc->dupacks == TCP_CC_DUPTHRESH &&
+               TCP_SEQ_GT(ackseq, cc->recover))
+        {
+          /* Fast retransmit and enter fast recovery.  The check against
+           * 'recover' prevents multiple window reductions for losses in
+           * the same window of data.
+           */
+
+          flight       = conn->sndseq_max - ackseq;
+          cc->ssthresh = TCP_CC_OPS->loss(conn, flight);
+          cc->cwnd     = cc->ssthresh + TCP_CC_DUPTHRESH * mss;
+          cc->recover  = conn->sndseq_max;
+          cc->flags   |= (TCP_CC_RECOVERY | TCP_CC_FASTREXMIT);
+#ifdef HAVE_TCP_SACKREXMIT
+          conn->sackrexmit = ackseq;
+#endif
+
+#ifdef CONFIG_NET_STATISTICS
+          g_netstats.tcp.rexmit++;
+#endif
+          ninfo("Fast retransmit: seqno=%u ssthresh=%u cwnd=%u\n",
+                ackseq, cc->ssthresh, cc->cwnd);
+        }
+    }
+
+  cc->lastwnd = conn->winsize;
+}
+
+/****************************************************************************
+ * Name: tcp_cc_timeout
+ *
+ * Description:
+ *   Collapse the congestion window after a retransmission timeout.
+ *
+ * Input Parameters:
+ *   conn - The TCP connection structure
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+void tcp_cc_timeout(FAR struct tcp_conn_s *conn)
+{
+  FAR struct tcp_cc_s *cc = &conn->cc;
+  uint32_t flight;
+
+  /* Everything sent since the last ACK is presumed lost.  Set ssthresh
+   * from the amount of data in flight and restart in slow start with a
+   * loss window of one MSS (RFC 5681, section 3.1).
+   */
+
+  flight       = conn->sndseq_max - cc->lastack;
+  cc->ssthresh = TCP_CC_OPS->loss(conn, flight);
+  cc->cwnd     = conn->mss;
+  cc->recover  = conn->sndseq_max;
+  cc->dupacks  = 0;
+  cc->flags    = 0;
+
+#ifdef HAVE_TCP_SACKREXMIT
+  /* The receiver may have discarded data that it SACKed (RFC 2018,
+   * section 8) so the scoreboard cannot be trusted after a timeout.
+   */
+
+  conn->nsacks = 0;
+#endif
+
+  ninfo("RTO: ssthresh=%u cwnd=%u\n", cc->ssthresh, cc->cwnd);
+}
+
+#endif /* CONFIG_NET && CONFIG_NET_TCP && CONFIG_NET_TCP_CC */
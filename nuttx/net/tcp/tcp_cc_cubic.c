@@ -0,0 +1,258 @@
+/****************************************************************************
+ * net/tcp/tcp_cc_cubic.c
+ * CUBIC congestion control (RFC 8312)
+ *
+ *   Copyright (C) 2018 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+#if defined(CONFIG_NET) && defined(CONFIG_NET_TCP) && \
+    defined(CONFIG_NET_TCP_CC_CUBIC)
+
+#include <stdint.h>
+#include <debug.h>
+
+#include <nuttx/clock.h>
+#include <nuttx/net/netconfig.h>
+
+#include "tcp/tcp.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* CUBIC constants:  C = 0.4 and beta = 0.7, expressed as fractions.  The
+ * TCP-friendly additive increase, 3 * (1 - beta) / (1 + beta), is 9/17.
+ */
+
+#define CUBIC_C_NUM        4
+#define CUBIC_C_DEN        10
+#define CUBIC_BETA_NUM     7
+#define CUBIC_BETA_DEN     10
+#define CUBIC_ALPHA_NUM    9
+#define CUBIC_ALPHA_DEN    17
+
+/* Limit on |t - K| (msec) that keeps the cubic term in range */
+
+#define CUBIC_MAXDELTA     1000000
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static void cubic_init(FAR struct tcp_conn_s *conn);
+static void cubic_ack(FAR struct tcp_conn_s *conn, uint32_t acked);
+static uint32_t cubic_loss(FAR struct tcp_conn_s *conn, uint32_t flight);
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+const struct tcp_cc_ops_s g_tcp_cubic =
+{
+  cubic_init,           /* init */
+  cubic_ack,            /* ack */
+  cubic_loss            /* loss */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: cubic_cbrt
+ *
+ * Description:
+ *   Integer cube root (bitwise, no multiplications wider than 64 bits).
+ *
+ ****************************************************************************/
+
+static uint32_t cubic_cbrt(uint64_t x)
+{
+  uint64_t y = 0;
+  uint64_t b;
+  int s;
+
+  for (s = 63; s >= 0; s -= 3)
+    {
+      y <<= 1;
+      b = 3 * y * (y + 1) + 1;
+      if ((x >> s) >= b)
+        {
+          x -= b << s;
+          y++;
+        }
+    }
+
+  return (uint32_t)y;
+}
+
+/****************************************************************************
+ * Name: cubic_init
+ ****************************************************************************/
+
+static void cubic_init(FAR struct tcp_conn_s *conn)
+{
+  FAR struct tcp_cc_s *cc = &conn->cc;
+
+  cc->wmax      = 0;
+  cc->westimate = 0;
+  cc->kmsec     = 0;
+  cc->epoch     = 0;
+}
+
+/****************************************************************************
+ * Name: cubic_ack
+ *
+ * Description:
+ *   Congestion avoidance:  Grow cwnd towards
+ *
+ *     W(t) = C * (t - K)^3 + Wmax
+ *
+ *   where t is the time since the start of the current epoch and K the
+ *   time needed to return to Wmax, but never more slowly than standard TCP
+ *   would (the TCP-friendly region, RFC 8312 section 4.2).
+ *
+ ****************************************************************************/
+
+static void cubic_ack(FAR struct tcp_conn_s *conn, uint32_t acked)
+{
+  FAR struct tcp_cc_s *cc = &conn->cc;
+  uint32_t mss = conn->mss;
+  systime_t now = clock_systimer();
+  int64_t delta;
+  int64_t target;
+
+  if (cc->epoch == 0)
+    {
+      /* First ACK in congestion avoidance since the last congestion
+       * event:  Start a new epoch.
+       */
+
+      cc->epoch = now != 0 ? now : 1;
+      if (cc->cwnd < cc->wmax)
+        {
+          /* K = cbrt((Wmax - cwnd) / C) in seconds, computed in msec with
+           * the window in units of MSS.
+           */
+
+          cc->kmsec = cubic_cbrt((uint64_t)(cc->wmax - cc->cwnd) *
+                                 (1000000000ull * CUBIC_C_DEN /
+                                  CUBIC_C_NUM) / mss);
+        }
+      else
+        {
+          cc->kmsec = 0;
+          cc->wmax  = cc->cwnd;
+        }
+
+      cc->westimate = cc->cwnd;
+    }
+
+  /* W(t) in bytes.  The cube of t - K is in msec^3, scaled down to sec^3
+   * step-by-step to stay within 64 bits.
+   */
+
+  delta = (int64_t)TICK2MSEC(now - cc->epoch) - (int64_t)cc->kmsec;
+  if (delta > CUBIC_MAXDELTA)
+    {
+      delta = CUBIC_MAXDELTA;
+    }
+  else if (delta < -CUBIC_MAXDELTA)
+    {
+      delta = -CUBIC_MAXDELTA;
+    }
+
+  delta  = ((delta * delta) / 1000) * delta / 1000;
+  target = (int64_t)cc->wmax +
+           (CUBIC_C_NUM * (int64_t)mss * delta) / (CUBIC_C_DEN * 1000);
+
+  /* Standard TCP estimate of the window for the same elapsed time */
+
+  cc->westimate += (uint32_t)(((uint64_t)acked * mss * CUBIC_ALPHA_NUM) /
+                              ((uint64_t)cc->cwnd * CUBIC_ALPHA_DEN));
+  if ((int64_t)cc->westimate > target)
+    {
+      target = cc->westimate;
+    }
+
+  /* Limit the increase to 1.5 * cwnd per round trip */
+
+  if (target > (int64_t)cc->cwnd + cc->cwnd / 2)
+    {
+      target = (int64_t)cc->cwnd + cc->cwnd / 2;
+    }
+
+  if (target > (int64_t)cc->cwnd)
+    {
+      cc->cwnd += (uint32_t)(((uint64_t)(target - cc->cwnd) * acked) /
+                             cc->cwnd);
+    }
+}
+
+/****************************************************************************
+ * Name: cubic_loss
+ *
+ * Description:
+ *   Multiplicative decrease by beta.  With fast convergence, Wmax is
+ *   further reduced if the window has not recovered since the previous
+ *   congestion event, releasing bandwidth to new flows.
+ *
+ ****************************************************************************/
+
+static uint32_t cubic_loss(FAR struct tcp_conn_s *conn, uint32_t flight)
+{
+  FAR struct tcp_cc_s *cc = &conn->cc;
+
+  if (cc->cwnd < cc->wmax)
+    {
+      cc->wmax = (uint32_t)(((uint64_t)cc->cwnd *
+                             (CUBIC_BETA_DEN + CUBIC_BETA_NUM)) /
+                            (2 * CUBIC_BETA_DEN));
+    }
+  else
+    {
+      cc->wmax = cc->cwnd;
+    }
+
+  cc->epoch = 0;
+
+  return MAX((uint32_t)(((uint64_t)cc->cwnd * CUBIC_BETA_NUM) /
+                        CUBIC_BETA_DEN),
+             2 * (uint32_t)conn->mss);
+}
+
+#endif /* CONFIG_NET && CONFIG_NET_TCP && CONFIG_NET_TCP_CC_CUBIC */
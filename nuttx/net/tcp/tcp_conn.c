@@ -1,7 +1,8 @@
 /****************************************************************************
  * net/tcp/tcp_conn.c
  *
- *   Copyright (C) 2007-2011, 2013-2015 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007-2011, 2013-2015, 2018 Gregory Nutt. All rights
+ *     reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Large parts of this file were leveraged from uIP logic:
@@ -714,6 +715,14 @@ FAR struct tcp_conn_s *tcp_alloc(uint8_t domain)
       conn->tcpstateflags = TCP_ALLOCATED;
 #if defined(CONFIG_NET_IPv4) && defined(CONFIG_NET_IPv6)
       conn->domain        = domain;
+#endif
+#ifdef CONFIG_NET_TCP_KEEPALIVE
+      conn->keepidle      = CONFIG_NET_TCP_KEEPIDLE;
+      conn->keepintvl     = CONFIG_NET_TCP_KEEPINTVL;
+      conn->keepcnt       = CONFIG_NET_TCP_KEEPCNT;
+#endif
+#ifdef CONFIG_NET_TCP_READAHEAD
+      conn->rcvbufs       = CONFIG_NET_RECV_BUFSIZE;
 #endif
     }
 
@@ -770,6 +779,13 @@ void tcp_free(FAR struct tcp_conn_s *conn)
   /* Release any read-ahead buffers attached to the connection */
 
   iob_free_queue(&conn->readahead);
+  conn->rcvqueued = 0;
+#endif
+
+#ifdef CONFIG_NET_TCP_OUT_OF_ORDER
+  /* Release any out-of-order segments held by the connection */
+
+  tcp_ofoseg_free(conn);
 #endif
 
 #ifdef CONFIG_NET_TCP_WRITE_BUFFERS
@@ -1013,6 +1029,7 @@ FAR struct tcp_conn_s *tcp_alloc_accept(FAR struct net_driver_s *dev,
       /* Initialize the list of TCP read-ahead buffers */
 
       IOB_QINIT(&conn->readahead);
+      conn->rcvqueued = 0;
 #endif
 
 #ifdef CONFIG_NET_TCP_WRITE_BUFFERS
@@ -1250,6 +1267,7 @@ int tcp_connect(FAR struct tcp_conn_s *conn, FAR const struct sockaddr *addr)
   /* Initialize the list of TCP read-ahead buffers */
 
   IOB_QINIT(&conn->readahead);
+  conn->rcvqueued = 0;
 #endif
 
 #ifdef CONFIG_NET_TCP_WRITE_BUFFERS
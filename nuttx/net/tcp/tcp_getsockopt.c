@@ -0,0 +1,215 @@
+/****************************************************************************
+ * net/tcp/tcp_getsockopt.c
+ *
+ *   Copyright (C) 2018 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <stdint.h>
+#include <errno.h>
+#include <assert.h>
+#include <debug.h>
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#include <nuttx/net/net.h>
+#include <nuttx/net/tcp.h>
+
+#include "socket/socket.h"
+#include "tcp/tcp.h"
+
+#if defined(NET_TCP_HAVE_STACK) && defined(CONFIG_NET_SOCKOPTS)
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: tcp_getsockopt
+ *
+ * Description:
+ *   tcp_getsockopt() retrieves the value for the TCP-protocol option
+ *   specified by the 'option' argument for the socket specified by the
+ *   'psock' argument.
+ *
+ *   See <netinet/tcp.h> for the a complete list of values of TCP protocol
+ *   options.
+ *
+ * Input Parameters:
+ *   psock     Socket structure of the socket to query
+ *   option    identifies the option to get
+ *   value     Points to the argument value buffer
+ *   value_len The length of the argument value buffer
+ *
+ * Returned Value:
+ *   Returns zero (OK) on success.  On failure, it returns a negated errno
+ *   value to indicate the nature of the error.  See psock_getsockopt() for
+ *   the list of possible error values.
+ *
+ ****************************************************************************/
+
+int tcp_getsockopt(FAR struct socket *psock, int option,
+                   FAR void *value, FAR socklen_t *value_len)
+{
+#if defined(TCP_HAVE_SNDFLAGS) || defined(CONFIG_NET_TCP_KEEPALIVE)
+  FAR struct tcp_conn_s *conn;
+#endif
+#ifdef TCP_HAVE_SNDFLAGS
+  uint8_t flag;
+#endif
+
+  DEBUGASSERT(psock != NULL && value != NULL && value_len != NULL);
+
+  if (psock->s_type != SOCK_STREAM)
+    {
+      return -ENOPROTOOPT;
+    }
+
+  switch (option)
+    {
+      /* These options return an integer boolean value */
+
+      case TCP_NODELAY:  /* Send small segments without waiting for ACKs */
+      case TCP_CORK:     /* Hold partial segments until uncorked */
+      case TCP_QUICKACK: /* ACK received data immediately */
+        {
+          /* Verify that option is the size of an 'int'.  Should also check
+           * that 'value' is properly aligned for an 'int'
+           */
+
+          if (*value_len < sizeof(int))
+            {
+              return -EINVAL;
+            }
+
+#ifdef TCP_HAVE_SNDFLAGS
+          switch (option)
+            {
+#ifdef CONFIG_NET_TCP_NAGLE
+              case TCP_NODELAY:
+                flag = TCP_SNDF_NODELAY;
+                break;
+
+              case TCP_CORK:
+                flag = TCP_SNDF_CORK;
+                break;
+#endif
+#ifdef CONFIG_NET_TCP_DELAYED_ACK
+              case TCP_QUICKACK:
+                flag = TCP_SNDF_QUICKACK;
+                break;
+#endif
+              default:
+                flag = 0;
+                break;
+            }
+
+          if (flag != 0)
+            {
+              conn = (FAR struct tcp_conn_s *)psock->s_conn;
+              DEBUGASSERT(conn != NULL);
+
+              *(FAR int *)value = (conn->sndflags & flag) != 0;
+            }
+          else
+#endif
+            {
+              /* Fixed in this configuration:  Small writes are always sent
+               * immediately, never corked, and all data is ACKed
+               * immediately.
+               */
+
+              *(FAR int *)value = (option != TCP_CORK);
+            }
+
+          *value_len = sizeof(int);
+        }
+        break;
+
+#ifdef CONFIG_NET_TCP_KEEPALIVE
+      /* These options return an integer value */
+
+      case TCP_KEEPIDLE:     /* Idle time before keep-alive probes (sec) */
+      case TCP_KEEPINTVL:    /* Time between keep-alive probes (sec) */
+      case TCP_KEEPCNT:      /* Unanswered probes before aborting */
+      case TCP_USER_TIMEOUT: /* Time that data may stay unACKed (msec) */
+        {
+          if (*value_len < sizeof(int))
+            {
+              return -EINVAL;
+            }
+
+          conn = (FAR struct tcp_conn_s *)psock->s_conn;
+          DEBUGASSERT(conn != NULL);
+
+          switch (option)
+            {
+              case TCP_KEEPIDLE:
+                *(FAR int *)value = conn->keepidle;
+                break;
+
+              case TCP_KEEPINTVL:
+                *(FAR int *)value = conn->keepintvl;
+                break;
+
+              case TCP_KEEPCNT:
+                *(FAR int *)value = conn->keepcnt;
+                break;
+
+              default: /* TCP_USER_TIMEOUT */
+                *(FAR int *)value = (int)conn->user_timeout;
+                break;
+            }
+
+          *value_len = sizeof(int);
+        }
+        break;
+#endif
+
+      default:
+        nerr("ERROR: Unrecognized TCP option: %d\n", option);
+        return -ENOPROTOOPT;
+    }
+
+  return OK;
+}
+
+#endif /* NET_TCP_HAVE_STACK && CONFIG_NET_SOCKOPTS */
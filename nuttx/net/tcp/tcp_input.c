@@ -2,7 +2,7 @@
  * net/tcp/tcp_input.c
  * Handling incoming TCP input
  *
- *   Copyright (C) 2007-2014, 2017 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007-2014, 2017-2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Adapted for NuttX from logic in uIP which also has a BSD-like license:
@@ -46,6 +46,7 @@
 
 #if defined(CONFIG_NET) && defined(CONFIG_NET_TCP)
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <string.h>
 #include <assert.h>
@@ -65,6 +66,251 @@
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: tcp_parseoptions
+ *
+ * Description:
+ *   Parse the options of an incoming TCP segment.  The MSS, window scale
+ *   and SACK-permitted options are only honored in SYN segments, SACK
+ *   blocks only in other segments.  Timestamps are accepted in any segment
+ *   once offered in the SYN.
+ *
+ * Parameters:
+ *   dev    - The device driver structure containing the received packet
+ *   conn   - The TCP connection that the segment belongs to
+ *   tcp    - The TCP header of the segment
+ *   iplen  - Length of the IP header (IPv4_HDRLEN or IPv6_HDRLEN)
+ *   hdrlen - Offset of the TCP options in d_buf
+ *   tsecr  - Location to return the echoed timestamp (TSecr).  Unchanged
+ *            if the segment has no timestamps option.
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+static void tcp_parseoptions(FAR struct net_driver_s *dev,
+                             FAR struct tcp_conn_s *conn,
+                             FAR struct tcp_hdr_s *tcp,
+                             unsigned int iplen, unsigned int hdrlen,
+                             FAR uint32_t *tsecr)
+{
+  FAR uint8_t *optdata = &dev->d_buf[hdrlen];
+  unsigned int optlen;
+  unsigned int i;
+  uint16_t tmp16;
+  uint8_t opt;
+
+  optlen = (((tcp->tcpoffset >> 4) << 2) > TCP_HDRLEN) ?
+           (((tcp->tcpoffset >> 4) << 2) - TCP_HDRLEN) : 0;
+
+  for (i = 0; i < optlen; )
+    {
+      opt = optdata[i];
+      if (opt == TCP_OPT_END)
+        {
+          /* End of options. */
+
+          break;
+        }
+      else if (opt == TCP_OPT_NOOP)
+        {
+          /* NOP option. */
+
+          ++i;
+          continue;
+        }
+
+      /* All other options have a length field, so that we easily can skip
+       * past them.  If the length field is invalid, the options are
+       * malformed and we don't process them further.
+       */
+
+      if (i + 1 >= optlen || optdata[i + 1] < 2 ||
+          i + optdata[i + 1] > optlen)
+        {
+          break;
+        }
+
+      if ((tcp->flags & TCP_SYN) != 0)
+        {
+          if (opt == TCP_OPT_MSS && optdata[i + 1] == TCP_OPT_MSS_LEN)
+            {
+              uint16_t tcp_mss = TCP_MSS(dev, iplen);
+
+              /* An MSS option with the right option length. */
+
+              tmp16 = ((uint16_t)optdata[i + 2] << 8) |
+                       (uint16_t)optdata[i + 3];
+              conn->mss = tmp16 > tcp_mss ? tcp_mss : tmp16;
+            }
+#ifdef CONFIG_NET_TCP_SACK
+          else if (opt == TCP_OPT_SACK_PERM &&
+                   optdata[i + 1] == TCP_OPT_SACK_PERM_LEN)
+            {
+              /* The peer will accept SACK options from us */
+
+              conn->optflags |= TCP_OPTF_SACKPERM;
+            }
+#endif
+#ifdef CONFIG_NET_TCP_WINDOW_SCALE
+          else if (opt == TCP_OPT_WS && optdata[i + 1] == TCP_OPT_WS_LEN)
+            {
+              /* The peer will scale the windows that it sends us */
+
+              conn->snd_wscale = MIN(optdata[i + 2], TCP_WSCALE_MAXSHIFT);
+              conn->optflags  |= TCP_OPTF_WSCALE;
+            }
+#endif
+#ifdef CONFIG_NET_TCP_TIMESTAMPS
+          else if (opt == TCP_OPT_TS && optdata[i + 1] == TCP_OPT_TS_LEN)
+            {
+              /* The peer will send timestamps in every segment */
+
+              conn->optflags |= TCP_OPTF_TIMESTAMP;
+              conn->ts_recent = tcp_getsequence(&optdata[i + 2]);
+            }
+#endif
+        }
+      else
+        {
+#ifdef HAVE_TCP_SACKREXMIT
+          if (opt == TCP_OPT_SACK)
+            {
+              unsigned int blk;
+
+              /* Add each block to the SACK scoreboard */
+
+              for (blk = i + 2; blk + 8 <= i + optdata[i + 1]; blk += 8)
+                {
+                  tcp_sack_add(conn, tcp_getsequence(&optdata[blk]),
+                               tcp_getsequence(&optdata[blk + 4]));
+                }
+            }
+#endif
+#ifdef CONFIG_NET_TCP_TIMESTAMPS
+          if (opt == TCP_OPT_TS && optdata[i + 1] == TCP_OPT_TS_LEN &&
+              (conn->optflags & TCP_OPTF_TIMESTAMP) != 0)
+            {
+              /* Echo the timestamp of the segment that we are about to
+               * ACK.  Those of later, out-of-order segments are ignored
+               * (RFC 7323, section 4.3).
+               */
+
+              if (TCP_SEQ_LTE(tcp_getsequence(tcp->seqno),
+                              tcp_getsequence(conn->rcvseq)))
+                {
+                  conn->ts_recent = tcp_getsequence(&optdata[i + 2]);
+                }
+
+              *tsecr = tcp_getsequence(&optdata[i + 6]);
+            }
+#endif
+        }
+
+      i += optdata[i + 1];
+    }
+
+  if ((tcp->flags & TCP_SYN) != 0)
+    {
+#ifdef CONFIG_NET_TCP_WINDOW_SCALE
+      /* Window scaling is only used if both sides sent the option */
+
+      if ((conn->optflags & TCP_OPTF_WSCALE) == 0)
+        {
+          conn->snd_wscale = 0;
+          conn->rcv_wscale = 0;
+        }
+#endif
+
+#ifdef CONFIG_NET_TCP_TIMESTAMPS
+      /* The timestamps option reduces the payload of every segment */
+
+      if ((conn->optflags & TCP_OPTF_TIMESTAMP) != 0)
+        {
+          conn->mss -= TCP_OPT_TS_ALIGNED_LEN;
+        }
+#endif
+    }
+}
+
+/****************************************************************************
+ * Name: tcp_rttestimate
+ *
+ * Description:
+ *   Update the smoothed round trip time and the retransmission time-out
+ *   with a new measurement.  This is taken directly from VJs original code
+ *   in his paper.
+ *
+ * Parameters:
+ *   conn - The TCP connection structure
+ *   m    - The measured round trip time (units: half-seconds)
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+static void tcp_rttestimate(FAR struct tcp_conn_s *conn, signed char m)
+{
+  m = m - (conn->sa >> 3);
+  conn->sa += m;
+  if (m < 0)
+    {
+      m = -m;
+    }
+
+  m = m - (conn->sv >> 2);
+  conn->sv += m;
+  conn->rto = (conn->sa >> 3) + conn->sv;
+}
+
+/****************************************************************************
+ * Name: tcp_delayack
+ *
+ * Description:
+ *   Decide whether the ACK of newly received, in-order data may be delayed.
+ *   Per RFC 1122, at least every second segment must be ACKed and, per
+ *   RFC 5681, segments that lie beyond or fill a gap are ACKed immediately.
+ *
+ * Parameters:
+ *   conn - The TCP connection structure
+ *
+ * Returned Value:
+ *   true if the ACK should be delayed.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_DELAYED_ACK
+static bool tcp_delayack(FAR struct tcp_conn_s *conn)
+{
+  if ((conn->sndflags & TCP_SNDF_QUICKACK) != 0 || conn->delack > 0)
+    {
+      return false;
+    }
+
+#ifdef CONFIG_NET_TCP_OUT_OF_ORDER
+  if (conn->nofosegs > 0)
+    {
+      return false;
+    }
+#endif
+
+  /* The ACK is cleared when the next segment goes out on this connection,
+   * or by the TCP timer.
+   */
+
+  conn->delack = 1;
+  return true;
+}
+#endif
+
 /****************************************************************************
  * Name: tcp_input
  *
@@ -94,9 +340,8 @@ static void tcp_input(FAR struct net_driver_s *dev, uint8_t domain,
   uint16_t tmp16;
   uint16_t flags;
   uint16_t result;
-  uint8_t  opt;
+  uint32_t tsecr = 0;
   int      len;
-  int      i;
 
 #ifdef CONFIG_NET_STATISTICS
   /* Bump up the count of TCP packets received */
@@ -226,58 +471,9 @@ static void tcp_input(FAR struct net_driver_s *dev, uint8_t domain,
 
           net_incr32(conn->rcvseq, 1);
 
-          /* Parse the TCP MSS option, if present. */
+          /* Parse the TCP options of the SYN, if present. */
 
-          if ((tcp->tcpoffset & 0xf0) > 0x50)
-            {
-              for (i = 0; i < ((tcp->tcpoffset >> 4) - 5) << 2 ; )
-                {
-                  opt = dev->d_buf[hdrlen + i];
-                  if (opt == TCP_OPT_END)
-                    {
-                      /* End of options. */
-
-                      break;
-                    }
-                  else if (opt == TCP_OPT_NOOP)
-                    {
-                      /* NOP option. */
-
-                      ++i;
-                    }
-                  else if (opt == TCP_OPT_MSS &&
-                          dev->d_buf[hdrlen + 1 + i] == TCP_OPT_MSS_LEN)
-                    {
-                      uint16_t tcp_mss = TCP_MSS(dev, iplen);
-
-                      /* An MSS option with the right option length. */
-
-                      tmp16 = ((uint16_t)dev->d_buf[hdrlen + 2 + i] << 8) |
-                               (uint16_t)dev->d_buf[hdrlen + 3 + i];
-                      conn->mss = tmp16 > tcp_mss ? tcp_mss : tmp16;
-
-                      /* And we are done processing options. */
-
-                      break;
-                    }
-                  else
-                    {
-                      /* All other options have a length field, so that we easily
-                       * can skip past them.
-                       */
-
-                      if (dev->d_buf[hdrlen + 1 + i] == 0)
-                        {
-                          /* If the length field is zero, the options are malformed
-                           * and we don't process them further.
-                           */
-
-                          break;
-                        }
-                      i += dev->d_buf[hdrlen + 1 + i];
-                    }
-                }
-            }
+          tcp_parseoptions(dev, conn, tcp, iplen, hdrlen, &tsecr);
 
           /* Our response will be a SYNACK. */
 
@@ -309,10 +505,26 @@ reset:
 
 found:
 
+#ifdef CONFIG_NET_TCP_KEEPALIVE
+  /* The peer is alive */
+
+  conn->keeptime    = clock_systimer();
+  conn->keepretries = 0;
+#endif
+
   /* Update the connection's window size */
 
   conn->winsize = ((uint16_t)tcp->wnd[0] << 8) + (uint16_t)tcp->wnd[1];
 
+#ifdef CONFIG_NET_TCP_WINDOW_SCALE
+  /* The window in a SYN segment is never scaled */
+
+  if ((tcp->flags & TCP_SYN) == 0)
+    {
+      conn->winsize <<= conn->snd_wscale;
+    }
+#endif
+
   flags = 0;
 
   /* We do a very naive form of TCP reset processing; we just accept
@@ -384,6 +596,25 @@ found:
 
   dev->d_len -= (len + iplen);
 
+  /* Parse the TCP options.  The options of a SYN are only of interest in
+   * the SYN_SENT state;  a SYN in any other state is a retransmission.
+   */
+
+  if ((tcp->flags & TCP_SYN) == 0 ||
+      (conn->tcpstateflags & TCP_STATE_MASK) == TCP_SYN_SENT)
+    {
+      tcp_parseoptions(dev, conn, tcp, iplen, hdrlen, &tsecr);
+    }
+
+  /* d_appdata assumes a TCP header without options, so move any payload
+   * down to where d_appdata points.
+   */
+
+  if (len > TCP_HDRLEN && dev->d_len > 0)
+    {
+      memmove(dev->d_appdata, (FAR uint8_t *)tcp + len, dev->d_len);
+    }
+
   /* First, check if the sequence number of the incoming packet is
    * what we're expecting next. If not, we send out an ACK with the
    * correct numbers in, unless we are in the SYN_RCVD state and
@@ -399,6 +630,32 @@ found:
       if ((dev->d_len > 0 || ((tcp->flags & (TCP_SYN | TCP_FIN)) != 0)) &&
           memcmp(tcp->seqno, conn->rcvseq, 4) != 0)
         {
+#ifdef CONFIG_NET_TCP_OUT_OF_ORDER
+          /* Hold on to data that arrives beyond a gap (and within the
+           * receive window) so that only the missing data needs to be
+           * retransmitted.
+           */
+
+          if ((conn->tcpstateflags & TCP_STATE_MASK) == TCP_ESTABLISHED &&
+              (tcp->flags & (TCP_SYN | TCP_FIN)) == 0 && dev->d_len > 0)
+            {
+              uint32_t seqno  = tcp_getsequence(tcp->seqno);
+              uint32_t rcvseq = tcp_getsequence(conn->rcvseq);
+
+              if (TCP_SEQ_GT(seqno, rcvseq) &&
+                  seqno + dev->d_len - rcvseq <=
+                  tcp_get_recvwindow(dev, conn))
+                {
+                  (void)tcp_ofoseg_add(conn, seqno, dev->d_appdata,
+                                       dev->d_len);
+                }
+            }
+#endif
+
+          /* The ACK for the expected sequence number (with any SACK
+           * blocks) tells the peer what is missing.
+           */
+
           tcp_send(dev, conn, TCP_ACK, tcpiplen);
           return;
         }
@@ -441,6 +698,15 @@ found:
 
       if (ackseq <= unackseq)
         {
+#ifdef CONFIG_NET_TCP_KEEPALIVE
+          /* Progress restarts the user time-out */
+
+          if (unackseq - ackseq < conn->unacked)
+            {
+              conn->sndtime = 0;
+            }
+#endif
+
           /* Calculate the new number of outstanding, unacknowledged bytes */
 
           conn->unacked = unackseq - ackseq;
@@ -468,29 +734,43 @@ found:
        * be beyond ackseq.
        */
 
+#ifdef CONFIG_NET_TCP_CC
+      /* Let congestion control see the ACK before the send logic does.
+       * SYN and FIN segments never count as duplicate ACKs.
+       */
+
+      if ((conn->tcpstateflags & TCP_STATE_MASK) == TCP_ESTABLISHED &&
+          (tcp->flags & (TCP_SYN | TCP_FIN)) == 0)
+        {
+#ifdef HAVE_TCP_SACKREXMIT
+          tcp_sack_ack(conn, ackseq);
+#endif
+          tcp_cc_recvack(conn, ackseq, dev->d_len);
+        }
+#endif
+
       ninfo("sndseq: %08x->%08x unackseq: %08x new unacked: %d\n",
             conn->sndseq, ackseq, unackseq, conn->unacked);
       tcp_setsequence(conn->sndseq, ackseq);
 
-      /* Do RTT estimation, unless we have done retransmissions. */
+#ifdef CONFIG_NET_TCP_TIMESTAMPS
+      /* With timestamps, the echoed TSval measures the round trip time
+       * even for retransmitted segments (RFC 7323, section 4).
+       */
 
-      if (conn->nrtx == 0)
+      if (tsecr != 0)
         {
-          signed char m;
-          m = conn->rto - conn->timer;
-
-          /* This is taken directly from VJs original code in his paper */
+          tcp_rttestimate(conn, (signed char)
+                          MIN((TCP_TSNOW() - tsecr) / MSEC_PER_HSEC, 127));
+        }
+      else
+#endif
 
-          m = m - (conn->sa >> 3);
-          conn->sa += m;
-          if (m < 0)
-            {
-              m = -m;
-            }
+      /* Do RTT estimation, unless we have done retransmissions. */
 
-          m = m - (conn->sv >> 2);
-          conn->sv += m;
-          conn->rto = (conn->sa >> 3) + conn->sv;
+      if (conn->nrtx == 0)
+        {
+          tcp_rttestimate(conn, conn->rto - conn->timer);
         }
 
         /* Set the acknowledged flag. */
@@ -555,6 +835,9 @@ found:
             tcp_setsequence(conn->sndseq, conn->isn);
             conn->sent          = 0;
             conn->sndseq_max    = 0;
+#endif
+#ifdef CONFIG_NET_TCP_CC
+            tcp_cc_init(conn);
 #endif
             conn->unacked       = 0;
             flags               = TCP_CONNECTED;
@@ -591,59 +874,7 @@ found:
 
         if ((flags & TCP_ACKDATA) != 0 && (tcp->flags & TCP_CTL) == (TCP_SYN | TCP_ACK))
           {
-            /* Parse the TCP MSS option, if present. */
-
-            if ((tcp->tcpoffset & 0xf0) > 0x50)
-              {
-                for (i = 0; i < ((tcp->tcpoffset >> 4) - 5) << 2 ; )
-                  {
-                    opt = dev->d_buf[hdrlen + i];
-                    if (opt == TCP_OPT_END)
-                      {
-                        /* End of options. */
-
-                        break;
-                      }
-                    else if (opt == TCP_OPT_NOOP)
-                      {
-                        /* NOP option. */
-
-                        ++i;
-                      }
-                    else if (opt == TCP_OPT_MSS &&
-                              dev->d_buf[hdrlen + 1 + i] == TCP_OPT_MSS_LEN)
-                      {
-                        uint16_t tcp_mss = TCP_MSS(dev, iplen);
-
-                        /* An MSS option with the right option length. */
-
-                        tmp16 =
-                          (dev->d_buf[hdrlen + 2 + i] << 8) |
-                          dev->d_buf[hdrlen + 3 + i];
-                        conn->mss = tmp16 > tcp_mss ? tcp_mss : tmp16;
-
-                        /* And we are done processing options. */
-
-                        break;
-                      }
-                    else
-                      {
-                        /* All other options have a length field, so that we
-                         * easily can skip past them.
-                         */
-
-                        if (dev->d_buf[hdrlen + 1 + i] == 0)
-                          {
-                            /* If the length field is zero, the options are
-                             * malformed and we don't process them further.
-                             */
-
-                            break;
-                          }
-                        i += dev->d_buf[hdrlen + 1 + i];
-                      }
-                  }
-              }
+            /* The TCP options were parsed when the segment was received */
 
             conn->tcpstateflags = TCP_ESTABLISHED;
             memcpy(conn->rcvseq, tcp->seqno, 4);
@@ -654,6 +885,9 @@ found:
 #ifdef CONFIG_NET_TCP_WRITE_BUFFERS
             conn->isn           = tcp_getsequence(tcp->ackno);
             tcp_setsequence(conn->sndseq, conn->isn);
+#endif
+#ifdef CONFIG_NET_TCP_CC
+            tcp_cc_init(conn);
 #endif
             dev->d_len          = 0;
             dev->d_sndlen       = 0;
@@ -817,6 +1051,26 @@ found:
                 /* Update the sequence number using the saved length */
 
                 net_incr32(conn->rcvseq, len);
+
+#ifdef CONFIG_NET_TCP_DELAYED_ACK
+                /* If the ACK can wait, tcp_appsend() will only send one if
+                 * the application has data to send in response.
+                 */
+
+                if (len > 0 && tcp_delayack(conn))
+                  {
+                    result &= ~TCP_SNDACK;
+                  }
+#endif
+
+#ifdef CONFIG_NET_TCP_OUT_OF_ORDER
+                /* The new data may have closed the gap before data held
+                 * out-of-order.  Then that can be passed on too and
+                 * covered by the same ACK.
+                 */
+
+                (void)tcp_ofoseg_deliver(conn);
+#endif
               }
 
             /* Send the response, ACKing the data or not, as appropriate */
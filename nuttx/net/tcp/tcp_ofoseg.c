@@ -0,0 +1,427 @@
+/****************************************************************************
+ * net/tcp/tcp_ofoseg.c
+ * Out-of-order segment reassembly and SACK option generation
+ *
+ *   Copyright (C) 2018 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+#if defined(CONFIG_NET) && defined(CONFIG_NET_TCP) && \
+    defined(CONFIG_NET_TCP_OUT_OF_ORDER)
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/mm/iob.h>
+#include <nuttx/net/netconfig.h>
+#include <nuttx/net/tcp.h>
+
+#include "devif/devif.h"
+#include "tcp/tcp.h"
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: tcp_ofoseg_remove
+ *
+ * Description:
+ *   Remove entry 'ndx' from the out-of-order list (without freeing its
+ *   data).
+ *
+ ****************************************************************************/
+
+static void tcp_ofoseg_remove(FAR struct tcp_conn_s *conn, int ndx)
+{
+  conn->nofosegs--;
+  memmove(&conn->ofosegs[ndx], &conn->ofosegs[ndx + 1],
+          (conn->nofosegs - ndx) * sizeof(struct tcp_ofoseg_s));
+}
+
+/****************************************************************************
+ * Name: tcp_ofoseg_coalesce
+ *
+ * Description:
+ *   Merge entries that touch or overlap so that the list again holds
+ *   disjoint ranges.  Overlapping bytes are trimmed from the later entry.
+ *
+ ****************************************************************************/
+
+static void tcp_ofoseg_coalesce(FAR struct tcp_conn_s *conn)
+{
+  FAR struct tcp_ofoseg_s *cur;
+  FAR struct tcp_ofoseg_s *next;
+  int ndx = 0;
+
+  while (ndx + 1 < conn->nofosegs)
+    {
+      cur  = &conn->ofosegs[ndx];
+      next = &conn->ofosegs[ndx + 1];
+
+      if (TCP_SEQ_LT(cur->right, next->left))
+        {
+          /* There is a gap between these two */
+
+          ndx++;
+          continue;
+        }
+
+      if (TCP_SEQ_GTE(cur->right, next->right))
+        {
+          /* The next entry holds nothing new */
+
+          iob_free_chain(next->data);
+        }
+      else
+        {
+          next->data = iob_trimhead(next->data, cur->right - next->left);
+          iob_concat(cur->data, next->data);
+          cur->right = next->right;
+        }
+
+      tcp_ofoseg_remove(conn, ndx + 1);
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: tcp_ofoseg_add
+ *
+ * Description:
+ *   Hold a segment that was received ahead of a gap in the sequence space
+ *   (seqno is beyond rcvseq) until the missing data arrives.
+ *
+ * Input Parameters:
+ *   conn   - The TCP connection structure
+ *   seqno  - The sequence number of the first byte of the segment
+ *   buffer - The segment payload
+ *   buflen - The length of the segment payload
+ *
+ * Returned Value:
+ *   OK on success;  A negated errno value is returned if the segment could
+ *   not be held:
+ *
+ *   ENOSPC - All out-of-order entries are in use by data closer to rcvseq
+ *   ENOMEM - No I/O buffers are available
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+int tcp_ofoseg_add(FAR struct tcp_conn_s *conn, uint32_t seqno,
+                   FAR const uint8_t *buffer, uint16_t buflen)
+{
+  FAR struct tcp_ofoseg_s *seg;
+  FAR struct iob_s *iob;
+  uint32_t right = seqno + buflen;
+  int ndx;
+  int ret;
+
+#ifdef CONFIG_NET_TCP_SACK
+  conn->ofolast = seqno;
+#endif
+
+  /* Find the insertion point that keeps the list sorted */
+
+  for (ndx = 0;
+       ndx < conn->nofosegs && TCP_SEQ_LT(conn->ofosegs[ndx].left, seqno);
+       ndx++);
+
+  /* Is this a retransmission of data that we already hold? */
+
+  if ((ndx > 0 && TCP_SEQ_GTE(conn->ofosegs[ndx - 1].right, right)) ||
+      (ndx < conn->nofosegs && conn->ofosegs[ndx].left == seqno &&
+       TCP_SEQ_GTE(conn->ofosegs[ndx].right, right)))
+    {
+      ninfo("Duplicate: seqno=%u len=%u\n", seqno, buflen);
+      return OK;
+    }
+
+  /* If the list is full, give up the entry farthest from rcvseq:  It is
+   * the least useful.
+   */
+
+  if (conn->nofosegs >= CONFIG_NET_TCP_OFOSEGS)
+    {
+      if (ndx >= conn->nofosegs)
+        {
+          ninfo("No space: seqno=%u len=%u\n", seqno, buflen);
+          return -ENOSPC;
+        }
+
+      iob_free_chain(conn->ofosegs[conn->nofosegs - 1].data);
+      conn->nofosegs--;
+    }
+
+  /* Copy the payload into an I/O buffer chain (without waiting) */
+
+  iob = iob_tryalloc(true);
+  if (iob == NULL)
+    {
+      nerr("ERROR: Failed to allocate an I/O buffer\n");
+      return -ENOMEM;
+    }
+
+  ret = iob_trycopyin(iob, buffer, buflen, 0, true);
+  if (ret < 0)
+    {
+      nerr("ERROR: Failed to copy the segment: %d\n", ret);
+      iob_free_chain(iob);
+      return ret;
+    }
+
+  /* Insert the new entry and merge it with its neighbors */
+
+  memmove(&conn->ofosegs[ndx + 1], &conn->ofosegs[ndx],
+          (conn->nofosegs - ndx) * sizeof(struct tcp_ofoseg_s));
+
+  seg        = &conn->ofosegs[ndx];
+  seg->left  = seqno;
+  seg->right = right;
+  seg->data  = iob;
+  conn->nofosegs++;
+
+  tcp_ofoseg_coalesce(conn);
+
+  ninfo("Queued: seqno=%u len=%u nofosegs=%u\n",
+        seqno, buflen, conn->nofosegs);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: tcp_ofoseg_deliver
+ *
+ * Description:
+ *   Move any held out-of-order data that has become contiguous with
+ *   rcvseq to the read-ahead queue and advance rcvseq past it.
+ *
+ * Input Parameters:
+ *   conn - The TCP connection structure
+ *
+ * Returned Value:
+ *   The number of bytes delivered.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+uint32_t tcp_ofoseg_deliver(FAR struct tcp_conn_s *conn)
+{
+  FAR struct tcp_ofoseg_s *seg;
+  uint32_t rcvseq = tcp_getsequence(conn->rcvseq);
+  uint32_t total = 0;
+
+  while (conn->nofosegs > 0)
+    {
+      seg = &conn->ofosegs[0];
+      if (TCP_SEQ_GT(seg->left, rcvseq))
+        {
+          /* There is still a gap */
+
+          break;
+        }
+
+      if (TCP_SEQ_GT(seg->right, rcvseq))
+        {
+          /* Drop what the in-order data has already covered and pass the
+           * rest on.
+           */
+
+          seg->data = iob_trimhead(seg->data, rcvseq - seg->left);
+          seg->left = rcvseq;
+
+          if (iob_tryadd_queue(seg->data, &conn->readahead) < 0)
+            {
+              /* Keep it.  It will be delivered along with the next
+               * in-order segment.
+               */
+
+              nerr("ERROR: Failed to queue the I/O buffer chain\n");
+              break;
+            }
+
+          conn->rcvqueued += seg->data->io_pktlen;
+          total  += seg->right - rcvseq;
+          rcvseq  = seg->right;
+        }
+      else
+        {
+          iob_free_chain(seg->data);
+        }
+
+      tcp_ofoseg_remove(conn, 0);
+    }
+
+  if (total > 0)
+    {
+      ninfo("Delivered %u bytes\n", total);
+      tcp_setsequence(conn->rcvseq, rcvseq);
+    }
+
+  return total;
+}
+
+/****************************************************************************
+ * Name: tcp_ofoseg_free
+ *
+ * Description:
+ *   Discard all out-of-order data held by the connection.
+ *
+ * Input Parameters:
+ *   conn - The TCP connection structure
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+void tcp_ofoseg_free(FAR struct tcp_conn_s *conn)
+{
+  int ndx;
+
+  for (ndx = 0; ndx < conn->nofosegs; ndx++)
+    {
+      iob_free_chain(conn->ofosegs[ndx].data);
+    }
+
+  conn->nofosegs = 0;
+}
+
+/****************************************************************************
+ * Name: tcp_sack_build
+ *
+ * Description:
+ *   Build the SACK option describing the out-of-order data held by the
+ *   connection.
+ *
+ * Input Parameters:
+ *   conn    - The TCP connection structure
+ *   optdata - Location to write the option.  There must be room for
+ *             TCP_SACK_MAXBLOCKS blocks (one less if timestamps are in
+ *             use).
+ *
+ * Returned Value:
+ *   The size of the option in bytes (a multiple of four);  zero if there
+ *   is nothing to report or the peer did not permit SACK.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_SACK
+unsigned int tcp_sack_build(FAR struct tcp_conn_s *conn,
+                            FAR uint8_t *optdata)
+{
+  FAR struct tcp_ofoseg_s *seg;
+  FAR uint8_t *blk;
+  int nblocks;
+  int first;
+  int ndx;
+
+  if ((conn->optflags & TCP_OPTF_SACKPERM) == 0 || conn->nofosegs == 0)
+    {
+      return 0;
+    }
+
+  /* The first block must be the one holding the most recently received
+   * segment (RFC 2018, section 4).  The rest follow in sequence order.
+   */
+
+  for (first = 0; first < conn->nofosegs - 1; first++)
+    {
+      seg = &conn->ofosegs[first];
+      if (TCP_SEQ_GTE(conn->ofolast, seg->left) &&
+          TCP_SEQ_LT(conn->ofolast, seg->right))
+        {
+          break;
+        }
+    }
+
+  nblocks = conn->nofosegs;
+  if (nblocks > TCP_SACK_MAXBLOCKS)
+    {
+      nblocks = TCP_SACK_MAXBLOCKS;
+    }
+
+#ifdef CONFIG_NET_TCP_TIMESTAMPS
+  /* With the timestamps option, only three blocks fit in the 40 bytes of
+   * TCP option space.
+   */
+
+  if ((conn->optflags & TCP_OPTF_TIMESTAMP) != 0 &&
+      nblocks > TCP_SACK_MAXBLOCKS - 1)
+    {
+      nblocks = TCP_SACK_MAXBLOCKS - 1;
+    }
+#endif
+
+  /* Two NOPs keep the blocks 32-bit aligned */
+
+  optdata[0] = TCP_OPT_NOOP;
+  optdata[1] = TCP_OPT_NOOP;
+  optdata[2] = TCP_OPT_SACK;
+  optdata[3] = TCP_OPT_SACK_LEN(nblocks);
+
+  blk = &optdata[4];
+  tcp_setsequence(blk, conn->ofosegs[first].left);
+  tcp_setsequence(blk + 4, conn->ofosegs[first].right);
+  blk += 8;
+
+  for (ndx = 0; ndx < conn->nofosegs && blk < &optdata[4 + 8 * nblocks];
+       ndx++)
+    {
+      if (ndx != first)
+        {
+          tcp_setsequence(blk, conn->ofosegs[ndx].left);
+          tcp_setsequence(blk + 4, conn->ofosegs[ndx].right);
+          blk += 8;
+        }
+    }
+
+  return 4 + 8 * nblocks;
+}
+#endif /* CONFIG_NET_TCP_SACK */
+
+#endif /* CONFIG_NET && CONFIG_NET_TCP && CONFIG_NET_TCP_OUT_OF_ORDER */
@@ -0,0 +1,177 @@
+/****************************************************************************
+ * net/tcp/tcp_recvwindow.c
+ * Calculation of the advertised TCP receive window
+ *
+ *   Copyright (C) 2018 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+#if defined(CONFIG_NET) && defined(CONFIG_NET_TCP)
+
+#include <stdint.h>
+#include <semaphore.h>
+#include <debug.h>
+
+#include <nuttx/semaphore.h>
+#include <nuttx/mm/iob.h>
+#include <nuttx/net/netconfig.h>
+#include <nuttx/net/netdev.h>
+#include <nuttx/net/ip.h>
+#include <nuttx/net/tcp.h>
+
+#include "tcp/tcp.h"
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: tcp_get_recvwindow
+ *
+ * Description:
+ *   Calculate the receive window to advertise for the connection.
+ *
+ *   Normally, this is the fixed window of the device.  With window scaling,
+ *   the window instead follows the number of free I/O buffers that are
+ *   available to hold read-ahead data, so that a single connection can
+ *   use most of the IOB pool when the pool is otherwise idle.  In either
+ *   case, the window is limited to the space left under the SO_RCVBUF
+ *   read-ahead limit of the connection.
+ *
+ * Parameters:
+ *   dev  - The device driver structure to use in the send operation
+ *   conn - The TCP connection structure holding connection information
+ *
+ * Returned Value:
+ *   The receive window in bytes, before any window scaling is applied.
+ *
+ * Assumptions:
+ *   Called from network stack logic with the network stack locked
+ *
+ ****************************************************************************/
+
+uint32_t tcp_get_recvwindow(FAR struct net_driver_s *dev,
+                            FAR struct tcp_conn_s *conn)
+{
+  uint32_t recvwndo;
+#ifdef CONFIG_NET_TCP_WINDOW_SCALE
+  uint32_t maxwndo;
+  uint32_t iobwndo;
+  uint32_t rcvseq;
+#endif
+#ifdef CONFIG_NET_TCP_RWND_CONTROL
+  extern sem_t g_qentry_sem;
+  int qentry_sem_count;
+
+  /* Update the TCP received window based on I/O buffer */
+  /* NOTE: This algorithm is still experimental */
+
+  if (OK == nxsem_getvalue(&g_qentry_sem, &qentry_sem_count))
+    {
+      NET_DEV_RCVWNDO(dev) = (uint16_t)((qentry_sem_count *
+                                         CONFIG_NET_ETH_TCP_RECVWNDO) /
+                                        CONFIG_IOB_NCHAINS);
+    }
+#endif
+
+  recvwndo = NET_DEV_RCVWNDO(dev);
+
+#ifdef CONFIG_NET_TCP_WINDOW_SCALE
+  /* Offer the space in the free I/O buffers, but never less than the
+   * device window.
+   */
+
+  iobwndo = (uint32_t)iob_navail(true) * CONFIG_IOB_BUFSIZE;
+  if (iobwndo > recvwndo)
+    {
+      recvwndo = iobwndo;
+    }
+#endif
+
+#ifdef CONFIG_NET_TCP_READAHEAD
+  /* But never more than the read-ahead limit of the connection will still
+   * hold.  Data beyond that would only be dropped by tcp_datahandler().
+   * A closed window is reopened by the zero window probes of the peer.
+   */
+
+  if (conn->rcvbufs > 0)
+    {
+      uint32_t space = conn->rcvbufs > conn->rcvqueued ?
+                       conn->rcvbufs - conn->rcvqueued : 0;
+
+      if (recvwndo > space)
+        {
+          recvwndo = space;
+        }
+    }
+#endif
+
+#ifdef CONFIG_NET_TCP_WINDOW_SCALE
+  /* The window must fit in the window field after scaling.  It is never
+   * scaled in SYN segments (RFC 7323, section 2.2).
+   */
+
+  if ((conn->tcpstateflags & TCP_STATE_MASK) == TCP_SYN_SENT ||
+      (conn->tcpstateflags & TCP_STATE_MASK) == TCP_SYN_RCVD)
+    {
+      maxwndo = UINT16_MAX;
+    }
+  else
+    {
+      maxwndo = (uint32_t)UINT16_MAX << conn->rcv_wscale;
+    }
+
+  if (recvwndo > maxwndo)
+    {
+      recvwndo = maxwndo;
+    }
+
+  /* Don't take back space that has already been offered.  The right edge
+   * of the window must not move left (RFC 7323, section 2.4).
+   */
+
+  rcvseq = tcp_getsequence(conn->rcvseq);
+  if ((conn->tcpstateflags & TCP_STATE_MASK) == TCP_ESTABLISHED &&
+      TCP_SEQ_GT(conn->rcv_adv, rcvseq + recvwndo))
+    {
+      recvwndo = conn->rcv_adv - rcvseq;
+    }
+#endif
+
+  return recvwndo;
+}
+
+#endif /* CONFIG_NET && CONFIG_NET_TCP */
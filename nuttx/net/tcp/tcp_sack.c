@@ -0,0 +1,250 @@
+/****************************************************************************
+ * net/tcp/tcp_sack.c
+ * SACK scoreboard for SACK-based loss recovery
+ *
+ *   Copyright (C) 2018 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+#if defined(CONFIG_NET) && defined(CONFIG_NET_TCP) && \
+    defined(CONFIG_NET_TCP_SACK) && defined(CONFIG_NET_TCP_CC)
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <debug.h>
+
+#include <nuttx/net/netconfig.h>
+
+#include "tcp/tcp.h"
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: tcp_sack_remove
+ *
+ * Description:
+ *   Remove entry 'ndx' from the SACK scoreboard.
+ *
+ ****************************************************************************/
+
+static void tcp_sack_remove(FAR struct tcp_conn_s *conn, int ndx)
+{
+  conn->nsacks--;
+  memmove(&conn->sacks[ndx], &conn->sacks[ndx + 1],
+          (conn->nsacks - ndx) * sizeof(struct tcp_sackblk_s));
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: tcp_sack_add
+ *
+ * Description:
+ *   Add one block of a SACK option received from the peer to the SACK
+ *   scoreboard.
+ *
+ * Input Parameters:
+ *   conn  - The TCP connection structure
+ *   left  - Sequence number of the first byte of the block
+ *   right - Sequence number following the last byte of the block
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+void tcp_sack_add(FAR struct tcp_conn_s *conn, uint32_t left,
+                  uint32_t right)
+{
+  FAR struct tcp_sackblk_s *blk;
+  int ndx;
+
+  /* Ignore empty blocks and blocks describing data never sent */
+
+  if (!TCP_SEQ_LT(left, right) || TCP_SEQ_GT(right, conn->sndseq_max))
+    {
+      return;
+    }
+
+  /* Find the insertion point that keeps the scoreboard sorted */
+
+  for (ndx = 0;
+       ndx < conn->nsacks && TCP_SEQ_LT(conn->sacks[ndx].left, left);
+       ndx++);
+
+  if (conn->nsacks >= TCP_SACK_MAXBLOCKS)
+    {
+      /* Forgetting a block only means that some data may be retransmitted
+       * needlessly.  Forget the one farthest from the cumulative ACK.
+       */
+
+      if (ndx >= conn->nsacks)
+        {
+          return;
+        }
+
+      conn->nsacks--;
+    }
+
+  memmove(&conn->sacks[ndx + 1], &conn->sacks[ndx],
+          (conn->nsacks - ndx) * sizeof(struct tcp_sackblk_s));
+
+  conn->sacks[ndx].left  = left;
+  conn->sacks[ndx].right = right;
+  conn->nsacks++;
+
+  /* Merge blocks that touch or overlap */
+
+  ndx = 0;
+  while (ndx + 1 < conn->nsacks)
+    {
+      blk = &conn->sacks[ndx];
+      if (TCP_SEQ_LT(blk->right, blk[1].left))
+        {
+          ndx++;
+          continue;
+        }
+
+      if (TCP_SEQ_GT(blk[1].right, blk->right))
+        {
+          blk->right = blk[1].right;
+        }
+
+      tcp_sack_remove(conn, ndx + 1);
+    }
+}
+
+/****************************************************************************
+ * Name: tcp_sack_ack
+ *
+ * Description:
+ *   Remove everything at or below the cumulative ACK from the SACK
+ *   scoreboard.
+ *
+ * Input Parameters:
+ *   conn   - The TCP connection structure
+ *   ackseq - The acknowledgement number of the incoming segment
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+void tcp_sack_ack(FAR struct tcp_conn_s *conn, uint32_t ackseq)
+{
+  while (conn->nsacks > 0 && TCP_SEQ_LTE(conn->sacks[0].right, ackseq))
+    {
+      tcp_sack_remove(conn, 0);
+    }
+
+  if (conn->nsacks > 0 && TCP_SEQ_LT(conn->sacks[0].left, ackseq))
+    {
+      conn->sacks[0].left = ackseq;
+    }
+}
+
+/****************************************************************************
+ * Name: tcp_sack_nexthole
+ *
+ * Description:
+ *   Find the first range of data at or after *seqno that the peer has not
+ *   reported receiving and that lies below data that it has.
+ *
+ * Input Parameters:
+ *   conn   - The TCP connection structure
+ *   seqno  - On input, where to start looking.  On output, the start of
+ *            the hole.
+ *   len    - Location to return the size of the hole
+ *
+ * Returned Value:
+ *   true if a hole was found.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+bool tcp_sack_nexthole(FAR struct tcp_conn_s *conn, FAR uint32_t *seqno,
+                       FAR uint32_t *len)
+{
+  FAR struct tcp_sackblk_s *blk;
+  uint32_t start = *seqno;
+  int ndx;
+
+  for (ndx = 0; ndx < conn->nsacks; ndx++)
+    {
+      blk = &conn->sacks[ndx];
+      if (TCP_SEQ_LTE(blk->right, start))
+        {
+          /* This block is entirely below the start point */
+
+          continue;
+        }
+
+      if (TCP_SEQ_LTE(blk->left, start))
+        {
+          /* The start point has been SACKed.  Skip past this block. */
+
+          start = blk->right;
+          continue;
+        }
+
+      /* The data between the start point and this block is missing */
+
+      *seqno = start;
+      *len   = blk->left - start;
+      return true;
+    }
+
+  /* Nothing above is known to have arrived.  Leave any further loss
+   * recovery to the retransmission timer.
+   */
+
+  return false;
+}
+
+#endif /* CONFIG_NET && CONFIG_NET_TCP && CONFIG_NET_TCP_SACK && CONFIG_NET_TCP_CC */
@@ -1,7 +1,8 @@
 /****************************************************************************
  * net/tcp/tcp_send.c
  *
- *   Copyright (C) 2007-2010, 2012, 2015 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007-2010, 2012, 2015, 2018 Gregory Nutt. All rights
+ *     reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Adapted for NuttX from logic in uIP which also has a BSD-like license:
@@ -54,10 +55,6 @@
 #include <nuttx/net/ip.h>
 #include <nuttx/net/tcp.h>
 
-#ifdef CONFIG_NET_TCP_RWND_CONTROL
-#  include <nuttx/semaphore.h>
-#endif
-
 #include "devif/devif.h"
 #include "inet/inet.h"
 #include "tcp/tcp.h"
@@ -289,6 +286,36 @@ static void tcp_sendcomplete(FAR struct net_driver_s *dev,
 #endif
 }
 
+/****************************************************************************
+ * Name: tcp_timestamp_option
+ *
+ * Description:
+ *   Write the timestamps option, preceded by two NOPs for alignment.
+ *
+ * Parameters:
+ *   conn    - The TCP connection structure holding connection information
+ *   optdata - Location to write the option
+ *
+ * Returned Value:
+ *   The number of bytes written (TCP_OPT_TS_ALIGNED_LEN)
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_TIMESTAMPS
+static unsigned int tcp_timestamp_option(FAR struct tcp_conn_s *conn,
+                                         FAR uint8_t *optdata)
+{
+  optdata[0] = TCP_OPT_NOOP;
+  optdata[1] = TCP_OPT_NOOP;
+  optdata[2] = TCP_OPT_TS;
+  optdata[3] = TCP_OPT_TS_LEN;
+  tcp_setsequence(&optdata[4], TCP_TSNOW());
+  tcp_setsequence(&optdata[8], conn->ts_recent);
+
+  return TCP_OPT_TS_ALIGNED_LEN;
+}
+#endif
+
 /****************************************************************************
  * Name: tcp_sendcommon
  *
@@ -313,11 +340,7 @@ static void tcp_sendcommon(FAR struct net_driver_s *dev,
                            FAR struct tcp_conn_s *conn,
                            FAR struct tcp_hdr_s *tcp)
 {
-#ifdef CONFIG_NET_TCP_RWND_CONTROL
-  extern sem_t g_qentry_sem;
-  int  qentry_sem_count;
-  uint32_t rwnd;
-#endif
+  uint32_t recvwndo;
 
   /* Copy the IP address into the IPv6 header */
 
@@ -348,22 +371,15 @@ static void tcp_sendcommon(FAR struct net_driver_s *dev,
   memcpy(tcp->ackno, conn->rcvseq, 4);
   memcpy(tcp->seqno, conn->sndseq, 4);
 
-  tcp->srcport  = conn->lport;
-  tcp->destport = conn->rport;
-
-#ifdef CONFIG_NET_TCP_RWND_CONTROL
-  /* Update the TCP received window based on I/O buffer */
-  /* NOTE: This algorithm is still experimental */
-
-  if (OK == nxsem_getvalue(&g_qentry_sem, &qentry_sem_count))
-    {
-      rwnd = (qentry_sem_count * CONFIG_NET_ETH_TCP_RECVWNDO)
-             / CONFIG_IOB_NCHAINS;
+#ifdef CONFIG_NET_TCP_DELAYED_ACK
+  /* This segment ACKs everything received so far */
 
-      NET_DEV_RCVWNDO(dev) = (uint16_t)rwnd;
-    }
+  conn->delack = 0;
 #endif
 
+  tcp->srcport  = conn->lport;
+  tcp->destport = conn->rport;
+
   /* Set the TCP window */
 
   if (conn->tcpstateflags & TCP_STOPPED)
@@ -377,8 +393,23 @@ static void tcp_sendcommon(FAR struct net_driver_s *dev,
     }
   else
     {
-      tcp->wnd[0] = ((NET_DEV_RCVWNDO(dev)) >> 8);
-      tcp->wnd[1] = ((NET_DEV_RCVWNDO(dev)) & 0xff);
+      recvwndo = tcp_get_recvwindow(dev, conn);
+
+#ifdef CONFIG_NET_TCP_WINDOW_SCALE
+      /* The window in SYN segments is never scaled.  Remember the right
+       * edge of the window offered so that it will not be taken back.
+       */
+
+      if ((tcp->flags & TCP_SYN) == 0)
+        {
+          recvwndo    >>= conn->rcv_wscale;
+          conn->rcv_adv = tcp_getsequence(conn->rcvseq) +
+                          (recvwndo << conn->rcv_wscale);
+        }
+#endif
+
+      tcp->wnd[0] = recvwndo >> 8;
+      tcp->wnd[1] = recvwndo & 0xff;
     }
 
   /* Finish the IP portion of the message and calculate checksums */
@@ -415,10 +446,44 @@ void tcp_send(FAR struct net_driver_s *dev, FAR struct tcp_conn_s *conn,
               uint16_t flags, uint16_t len)
 {
   FAR struct tcp_hdr_s *tcp = tcp_header(dev);
+#if defined(CONFIG_NET_TCP_TIMESTAMPS) || defined(CONFIG_NET_TCP_SACK)
+  FAR uint8_t *optdata = (FAR uint8_t *)tcp + TCP_HDRLEN;
+#endif
+  unsigned int optlen = 0;
+
+#ifdef CONFIG_NET_TCP_TIMESTAMPS
+  /* Once negotiated, the timestamps option is sent in every segment except
+   * for RSTs (RFC 7323, section 3.2).  The TCP options go between the TCP
+   * header and any payload, so the payload must be moved up.
+   */
+
+  if ((conn->optflags & TCP_OPTF_TIMESTAMP) != 0 &&
+      (flags & TCP_RST) == 0)
+    {
+      unsigned int hdrlen = optdata -
+                            &dev->d_buf[NET_LL_HDRLEN(dev)];
+
+      if (len > hdrlen)
+        {
+          memmove(optdata + TCP_OPT_TS_ALIGNED_LEN, optdata, len - hdrlen);
+        }
+
+      optlen = tcp_timestamp_option(conn, optdata);
+    }
+#endif
+
+#ifdef CONFIG_NET_TCP_SACK
+  /* A pure ACK reports any out-of-order data that we hold */
+
+  if (flags == TCP_ACK)
+    {
+      optlen += tcp_sack_build(conn, optdata + optlen);
+    }
+#endif
 
   tcp->flags     = flags;
-  dev->d_len     = len;
-  tcp->tcpoffset = (TCP_HDRLEN / 4) << 4;
+  dev->d_len     = len + optlen;
+  tcp->tcpoffset = ((TCP_HDRLEN + optlen) / 4) << 4;
   tcp_sendcommon(dev, conn, tcp);
 }
 
@@ -560,6 +625,7 @@ void tcp_ack(FAR struct net_driver_s *dev, FAR struct tcp_conn_s *conn,
              uint8_t ack)
 {
   struct tcp_hdr_s *tcp;
+  FAR uint8_t *optdata;
   uint16_t tcp_mss;
 
   /* Get values that vary with the underlying IP domain */
@@ -574,9 +640,9 @@ void tcp_ack(FAR struct net_driver_s *dev, FAR struct tcp_conn_s *conn,
       tcp     = TCPIPv6BUF;
       tcp_mss = TCP_IPv6_MSS(dev);
 
-      /* Set the packet length for the TCP Maximum Segment Size */
+      /* Set the packet length, not including the TCP options */
 
-      dev->d_len  = IPv6TCP_HDRLEN + TCP_OPT_MSS_LEN;
+      dev->d_len  = IPv6TCP_HDRLEN;
     }
 #endif /* CONFIG_NET_IPv6 */
 
@@ -590,9 +656,9 @@ void tcp_ack(FAR struct net_driver_s *dev, FAR struct tcp_conn_s *conn,
       tcp     = TCPIPv4BUF;
       tcp_mss = TCP_IPv4_MSS(dev);
 
-      /* Set the packet length for the TCP Maximum Segment Size */
+      /* Set the packet length, not including the TCP options */
 
-      dev->d_len  = IPv4TCP_HDRLEN + TCP_OPT_MSS_LEN;
+      dev->d_len  = IPv4TCP_HDRLEN;
     }
 #endif /* CONFIG_NET_IPv4 */
 
@@ -602,11 +668,60 @@ void tcp_ack(FAR struct net_driver_s *dev, FAR struct tcp_conn_s *conn,
 
   /* We send out the TCP Maximum Segment Size option with our ack. */
 
-  tcp->optdata[0] = TCP_OPT_MSS;
-  tcp->optdata[1] = TCP_OPT_MSS_LEN;
-  tcp->optdata[2] = tcp_mss >> 8;
-  tcp->optdata[3] = tcp_mss & 0xff;
-  tcp->tcpoffset  = ((TCP_HDRLEN + TCP_OPT_MSS_LEN) / 4) << 4;
+  optdata         = (FAR uint8_t *)tcp + TCP_HDRLEN;
+  optdata[0]      = TCP_OPT_MSS;
+  optdata[1]      = TCP_OPT_MSS_LEN;
+  optdata[2]      = tcp_mss >> 8;
+  optdata[3]      = tcp_mss & 0xff;
+  optdata        += TCP_OPT_MSS_LEN;
+
+#ifdef CONFIG_NET_TCP_SACK
+  /* Offer SACK in our SYN.  In a SYNACK, only if the peer offered it. */
+
+  if ((ack & TCP_ACK) == 0 || (conn->optflags & TCP_OPTF_SACKPERM) != 0)
+    {
+      optdata[0]  = TCP_OPT_NOOP;
+      optdata[1]  = TCP_OPT_NOOP;
+      optdata[2]  = TCP_OPT_SACK_PERM;
+      optdata[3]  = TCP_OPT_SACK_PERM_LEN;
+      optdata    += 4;
+    }
+#endif
+
+#ifdef CONFIG_NET_TCP_WINDOW_SCALE
+  /* Offer window scaling in our SYN.  In a SYNACK, only if the peer
+   * offered it.  Select the smallest shift that can describe the largest
+   * window that tcp_get_recvwindow() can offer.
+   */
+
+  if ((ack & TCP_ACK) == 0 || (conn->optflags & TCP_OPTF_WSCALE) != 0)
+    {
+      uint32_t maxwndo = TCP_MAX_RECVWNDO;
+
+      for (conn->rcv_wscale = 0;
+           conn->rcv_wscale < TCP_WSCALE_MAXSHIFT &&
+           (maxwndo >> conn->rcv_wscale) > UINT16_MAX;
+           conn->rcv_wscale++);
+
+      optdata[0]  = TCP_OPT_NOOP;
+      optdata[1]  = TCP_OPT_WS;
+      optdata[2]  = TCP_OPT_WS_LEN;
+      optdata[3]  = conn->rcv_wscale;
+      optdata    += 4;
+    }
+#endif
+
+#ifdef CONFIG_NET_TCP_TIMESTAMPS
+  /* Likewise, offer timestamps.  TSecr is only valid in a SYNACK. */
+
+  if ((ack & TCP_ACK) == 0 || (conn->optflags & TCP_OPTF_TIMESTAMP) != 0)
+    {
+      optdata    += tcp_timestamp_option(conn, optdata);
+    }
+#endif
+
+  dev->d_len     += optdata - ((FAR uint8_t *)tcp + TCP_HDRLEN);
+  tcp->tcpoffset  = ((optdata - (FAR uint8_t *)tcp) / 4) << 4;
 
   /* Complete the common portions of the TCP message */
 
@@ -52,6 +52,7 @@
 
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 
 #include <stdint.h>
 #include <stdbool.h>
@@ -102,6 +103,13 @@
 #  define TCP_WBDUMP(msg,wrb,len,offset)
 #endif
 
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static inline void send_txnotify(FAR struct socket *psock,
+                                 FAR struct tcp_conn_s *conn);
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -320,6 +328,167 @@ static inline bool psock_send_addrchck(FAR struct tcp_conn_s *conn)
 #  define psock_send_addrchck(r) (true)
 #endif /* CONFIG_NET_ETHERNET */
 
+/****************************************************************************
+ * Name: psock_fast_retransmit
+ *
+ * Description:
+ *   Resend one segment starting at the sequence number that the peer keeps
+ *   asking for (fast retransmit).  Unlike the timeout case, nothing is moved
+ *   back to the write_q:  the segment is sent directly from the write buffer
+ *   and the accounting of sent and un-ACKed data is left unchanged.
+ *
+ *   If the peer has reported SACK blocks, the segment is instead taken from
+ *   the next hole in the SACK scoreboard that has not already been resent
+ *   in this recovery episode.
+ *
+ * Parameters:
+ *   dev   - The structure of the network driver
+ *   conn  - The TCP connection structure
+ *   ackno - The sequence number of the segment to be resent
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   The network is locked
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_CC
+static void psock_fast_retransmit(FAR struct net_driver_s *dev,
+                                  FAR struct tcp_conn_s *conn,
+                                  uint32_t ackno)
+{
+  FAR struct tcp_wrbuffer_s *wrb;
+  uint32_t seqno = ackno;
+  uint32_t maxlen = conn->mss;
+  uint32_t offset;
+  size_t sndlen;
+
+#ifdef HAVE_TCP_SACKREXMIT
+  if (conn->nsacks > 0)
+    {
+      uint32_t holelen;
+
+      /* Continue from where the last retransmission left off */
+
+      if (TCP_SEQ_GT(conn->sackrexmit, seqno))
+        {
+          seqno = conn->sackrexmit;
+        }
+
+      if (!tcp_sack_nexthole(conn, &seqno, &holelen))
+        {
+          ninfo("FASTREXMIT: No hole above %u\n", seqno);
+          return;
+        }
+
+      if (holelen < maxlen)
+        {
+          maxlen = holelen;
+        }
+    }
+#endif
+
+  /* The lost data is in one of the write buffers in the unacked_q or, if it
+   * is in the write buffer at the head of the write_q, in the already sent
+   * part of that write buffer.
+   */
+
+  for (wrb = (FAR struct tcp_wrbuffer_s *)sq_peek(&conn->unacked_q);
+       wrb != NULL;
+       wrb = (FAR struct tcp_wrbuffer_s *)sq_next(&wrb->wb_node))
+    {
+      if (TCP_SEQ_GTE(seqno, TCP_WBSEQNO(wrb)) &&
+          TCP_SEQ_LT(seqno, TCP_WBSEQNO(wrb) + TCP_WBPKTLEN(wrb)))
+        {
+          break;
+        }
+    }
+
+  if (wrb != NULL)
+    {
+      sndlen = TCP_WBPKTLEN(wrb);
+    }
+  else
+    {
+      wrb = (FAR struct tcp_wrbuffer_s *)sq_peek(&conn->write_q);
+      if (wrb == NULL || TCP_WBSENT(wrb) == 0 ||
+          TCP_SEQ_LT(seqno, TCP_WBSEQNO(wrb)) ||
+          TCP_SEQ_GTE(seqno, TCP_WBSEQNO(wrb) + TCP_WBSENT(wrb)))
+        {
+          ninfo("FASTREXMIT: No segment at %u\n", seqno);
+          return;
+        }
+
+      sndlen = TCP_WBSENT(wrb);
+    }
+
+  /* The outgoing packet may already be in use and the peer must be
+   * reachable.  If not, the retransmission timer will take care of it.
+   */
+
+  if (dev->d_sndlen > 0 || !psock_send_addrchck(conn))
+    {
+      return;
+    }
+
+  offset  = seqno - TCP_WBSEQNO(wrb);
+  sndlen -= offset;
+  if (sndlen > maxlen)
+    {
+      sndlen = maxlen;
+    }
+
+  ninfo("FASTREXMIT: wrb=%p seqno=%u sndlen=%u\n", wrb, seqno, sndlen);
+
+  tcp_setsequence(conn->sndseq, seqno);
+#ifdef HAVE_TCP_SACKREXMIT
+  conn->sackrexmit = seqno + sndlen;
+#endif
+
+#ifdef NEED_IPDOMAIN_SUPPORT
+  send_ipselect(dev, conn);
+#endif
+  devif_iob_send(dev, TCP_WBIOB(wrb), sndlen, offset);
+}
+#endif
+
+/****************************************************************************
+ * Name: psock_tail_wrb
+ *
+ * Description:
+ *   Return the write buffer at the tail of the write_q if none of its data
+ *   has been sent yet.  New data may then be appended to it so that small
+ *   writes are coalesced into full-sized segments.
+ *
+ * Parameters:
+ *   conn - The TCP connection structure
+ *
+ * Returned Value:
+ *   The write buffer or NULL if there is none that can be appended to.
+ *
+ * Assumptions:
+ *   The network is locked
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_NAGLE
+static FAR struct tcp_wrbuffer_s *psock_tail_wrb(FAR struct tcp_conn_s *conn)
+{
+  FAR struct tcp_wrbuffer_s *wrb;
+
+  wrb = (FAR struct tcp_wrbuffer_s *)conn->write_q.tail;
+  if (wrb != NULL && TCP_WBSEQNO(wrb) == (unsigned)-1 &&
+      TCP_WBSENT(wrb) == 0)
+    {
+      return wrb;
+    }
+
+  return NULL;
+}
+#endif
+
 /****************************************************************************
  * Name: psock_send_eventhandler
  *
@@ -504,6 +673,31 @@ static uint16_t psock_send_eventhandler(FAR struct net_driver_s *dev,
           ninfo("ACK: wrb=%p seqno=%u pktlen=%u sent=%u\n",
                 wrb, TCP_WBSEQNO(wrb), TCP_WBPKTLEN(wrb), TCP_WBSENT(wrb));
         }
+
+#ifdef CONFIG_NET_TCP_CC
+      /* Congestion control may have asked for the first un-ACKed segment
+       * to be resent now rather than after the retransmission timeout.
+       */
+
+      if ((conn->cc.flags & TCP_CC_FASTREXMIT) != 0)
+        {
+          conn->cc.flags &= ~TCP_CC_FASTREXMIT;
+          psock_fast_retransmit(dev, conn, ackno);
+        }
+#endif
+
+#ifdef CONFIG_NET_TCP_NAGLE
+      /* If all sent data has now been ACKed, a partial segment that the
+       * Nagle algorithm was holding back may go out.  Ask the driver to
+       * poll now rather than wait for its next periodic poll.
+       */
+
+      if (conn->unacked == 0 && !sq_empty(&conn->write_q) &&
+          (conn->sndflags & TCP_SNDF_CORK) == 0)
+        {
+          send_txnotify(psock, conn);
+        }
+#endif
     }
 
   /* Check for a loss of connection */
@@ -728,6 +922,26 @@ static uint16_t psock_send_eventhandler(FAR struct net_driver_s *dev,
            */
 
           sndlen = TCP_WBPKTLEN(wrb) - TCP_WBSENT(wrb);
+
+#ifdef CONFIG_NET_TCP_NAGLE
+          /* Hold back a partial segment at the end of the queued data while
+           * the connection is corked or, per the Nagle algorithm (RFC 896),
+           * while earlier data is still waiting for an ACK.  Later writes
+           * are appended to the same write buffer in the meantime.
+           */
+
+          if (sndlen < conn->mss && TCP_WBNRTX(wrb) == 0 &&
+              sq_next(&wrb->wb_node) == NULL &&
+              ((conn->sndflags & TCP_SNDF_CORK) != 0 ||
+               ((conn->sndflags & TCP_SNDF_NODELAY) == 0 &&
+                conn->unacked > 0)))
+            {
+              ninfo("SEND: Holding %u bytes, unacked=%u\n",
+                    sndlen, conn->unacked);
+              return flags;
+            }
+#endif
+
           if (sndlen > conn->mss)
             {
               sndlen = conn->mss;
@@ -738,6 +952,25 @@ static uint16_t psock_send_eventhandler(FAR struct net_driver_s *dev,
               sndlen = conn->winsize;
             }
 
+#ifdef CONFIG_NET_TCP_CC
+          /* Do not put more than cwnd bytes in flight.  Rather than sending
+           * a runt segment into the remainder of the window, wait for ACKs
+           * to open it up unless nothing at all is outstanding.
+           */
+
+          if (conn->unacked + sndlen > conn->cc.cwnd)
+            {
+              if (conn->unacked > 0)
+                {
+                  ninfo("SEND: cwnd=%u full, unacked=%u\n",
+                        conn->cc.cwnd, conn->unacked);
+                  return flags;
+                }
+
+              sndlen = conn->cc.cwnd;
+            }
+#endif
+
           ninfo("SEND: wrb=%p pktlen=%u sent=%u sndlen=%u\n",
                 wrb, TCP_WBPKTLEN(wrb), TCP_WBSENT(wrb), sndlen);
 
@@ -892,16 +1125,95 @@ static inline void send_txnotify(FAR struct socket *psock,
  ****************************************************************************/
 
 /****************************************************************************
- * Name: psock_tcp_send
+ * Name: psock_tcp_sendwrb
  *
  * Description:
- *   psock_tcp_send() call may be used only when the TCP socket is in a
- *   connected state (so that the intended recipient is known).
+ *   Queue a write buffer that has already been filled with data for
+ *   transmission on the TCP connection.  The data will be sent in FIFO
+ *   order by psock_send_eventhandler() and the write buffer will be
+ *   released when all of the data has been ACKed.
+ *
+ * Parameters:
+ *   psock - An instance of the internal socket structure.
+ *   wrb   - The filled write buffer
+ *
+ * Returned Value:
+ *   Zero (OK) is returned on success; a negated errno value is returned on
+ *   failure.  The caller still owns the write buffer on failure.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+int psock_tcp_sendwrb(FAR struct socket *psock,
+                      FAR struct tcp_wrbuffer_s *wrb)
+{
+  FAR struct tcp_conn_s *conn = (FAR struct tcp_conn_s *)psock->s_conn;
+
+  DEBUGASSERT(conn != NULL && wrb != NULL);
+
+  /* Allocate resources to receive a callback */
+
+  if (psock->s_sndcb == NULL)
+    {
+      psock->s_sndcb = tcp_callback_alloc(conn);
+    }
+
+  /* Test if the callback has been allocated */
+
+  if (psock->s_sndcb == NULL)
+    {
+      /* A buffer allocation error occurred */
+
+      nerr("ERROR: Failed to allocate callback\n");
+      return -ENOMEM;
+    }
+
+  /* Set up the callback in the connection */
+
+  psock->s_sndcb->flags = (TCP_ACKDATA | TCP_REXMIT | TCP_POLL |
+                           TCP_DISCONN_EVENTS);
+  psock->s_sndcb->priv  = (FAR void *)psock;
+  psock->s_sndcb->event = psock_send_eventhandler;
+
+  /* Initialize the write buffer */
+
+  TCP_WBSEQNO(wrb) = (unsigned)-1;
+  TCP_WBNRTX(wrb)  = 0;
+
+  /* Dump I/O buffer chain */
+
+  TCP_WBDUMP("I/O buffer chain", wrb, TCP_WBPKTLEN(wrb), 0);
+
+  /* psock_send_eventhandler() will send data in FIFO order from the
+   * conn->write_q
+   */
+
+  sq_addlast(&wrb->wb_node, &conn->write_q);
+  ninfo("Queued WRB=%p pktlen=%u write_q(%p,%p)\n",
+        wrb, TCP_WBPKTLEN(wrb),
+        conn->write_q.head, conn->write_q.tail);
+
+  /* Notify the device driver of the availability of TX data */
+
+  send_txnotify(psock, conn);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: psock_tcp_sendv
+ *
+ * Description:
+ *   psock_tcp_sendv() call may be used only when the TCP socket is in a
+ *   connected state (so that the intended recipient is known).  The data
+ *   is gathered from all of the buffers into a single write buffer so that
+ *   it is sent in as few segments as possible.
  *
  * Parameters:
  *   psock    An instance of the internal socket structure.
- *   buf      Data to send
- *   len      Length of data to send
+ *   iov      Array of buffers to send
+ *   iovcnt   Number of elements in iov[]
  *
  * Returned Value:
  *   On success, returns the number of characters sent.  On  error,
@@ -946,13 +1258,17 @@ static inline void send_txnotify(FAR struct socket *psock,
  *
  ****************************************************************************/
 
-ssize_t psock_tcp_send(FAR struct socket *psock, FAR const void *buf,
-                       size_t len)
+ssize_t psock_tcp_sendv(FAR struct socket *psock,
+                        FAR const struct iovec *iov, int iovcnt)
 {
   FAR struct tcp_conn_s *conn;
   FAR struct tcp_wrbuffer_s *wrb;
   ssize_t    result = 0;
+  ssize_t    ncopied;
+  size_t     offset = 0;
+  size_t     len;
   int        ret = OK;
+  int        i;
 
   if (psock == NULL || psock->s_crefs <= 0)
     {
@@ -1006,9 +1322,13 @@ ssize_t psock_tcp_send(FAR struct socket *psock, FAR const void *buf,
     }
 #endif /* CONFIG_NET_ARP_SEND || CONFIG_NET_ICMPv6_NEIGHBOR */
 
-  /* Dump the incoming buffer */
+  /* Get the total length of the data and dump the incoming buffers */
 
-  BUF_DUMP("psock_tcp_send", buf, len);
+  for (i = 0, len = 0; i < iovcnt; i++)
+    {
+      BUF_DUMP("psock_tcp_send", iov[i].iov_base, iov[i].iov_len);
+      len += iov[i].iov_len;
+    }
 
   /* Set the socket state to sending */
 
@@ -1021,7 +1341,23 @@ ssize_t psock_tcp_send(FAR struct socket *psock, FAR const void *buf,
        */
 
       net_lock();
-      wrb = tcp_wrbuffer_alloc();
+
+#ifdef CONFIG_NET_TCP_NAGLE
+      /* If the last write buffer is still waiting to be sent, append the
+       * data to it rather than starting a new segment.
+       */
+
+      wrb = psock_tail_wrb(conn);
+      if (wrb != NULL)
+        {
+          offset = TCP_WBPKTLEN(wrb);
+        }
+      else
+#endif
+        {
+          wrb = tcp_wrbuffer_alloc();
+        }
+
       if (!wrb)
         {
           /* A buffer allocation error occurred */
@@ -1031,65 +1367,82 @@ ssize_t psock_tcp_send(FAR struct socket *psock, FAR const void *buf,
           goto errout_with_lock;
         }
 
-      /* Allocate resources to receive a callback */
+      /* Copy the user data into the write buffer.  All of the buffers are
+       * appended to the same write buffer so that they are sent together.
+       * We cannot wait for buffer space if the socket was opened
+       * non-blocking.
+       */
 
-      if (psock->s_sndcb == NULL)
+      for (i = 0; i < iovcnt; i++)
         {
-          psock->s_sndcb = tcp_callback_alloc(conn);
-        }
+          if (iov[i].iov_len == 0)
+            {
+              continue;
+            }
 
-      /* Test if the callback has been allocated */
+          if (_SS_ISNONBLOCK(psock->s_flags))
+            {
+              ncopied = TCP_WBTRYCOPYIN(wrb, (FAR uint8_t *)iov[i].iov_base,
+                                        iov[i].iov_len, offset + result);
+            }
+          else
+            {
+              ncopied = TCP_WBCOPYIN(wrb, (FAR uint8_t *)iov[i].iov_base,
+                                     iov[i].iov_len, offset + result);
+            }
 
-      if (psock->s_sndcb == NULL)
-        {
-          /* A buffer allocation error occurred */
+          if (ncopied < 0)
+            {
+              /* Discard any partial copy */
 
-          nerr("ERROR: Failed to allocate callback\n");
-          ret = -ENOMEM;
-          goto errout_with_wrb;
-        }
+              if (offset + result > 0 &&
+                  TCP_WBPKTLEN(wrb) > offset + result)
+                {
+                  TCP_WBIOB(wrb) = iob_trimtail(TCP_WBIOB(wrb),
+                                                TCP_WBPKTLEN(wrb) -
+                                                (offset + result));
+                }
+
+              /* Nothing could be copied?  Then report the failure.  A
+               * write buffer that we appended to stays queued.
+               */
+
+              if (result == 0)
+                {
+                  ret = ncopied;
+                  if (offset > 0)
+                    {
+                      goto errout_with_lock;
+                    }
 
-      /* Set up the callback in the connection */
+                  goto errout_with_wrb;
+                }
 
-      psock->s_sndcb->flags = (TCP_ACKDATA | TCP_REXMIT | TCP_POLL |
-                               TCP_DISCONN_EVENTS);
-      psock->s_sndcb->priv  = (FAR void *)psock;
-      psock->s_sndcb->event = psock_send_eventhandler;
+              /* Otherwise, send what was copied successfully. */
 
-      /* Initialize the write buffer */
+              break;
+            }
 
-      TCP_WBSEQNO(wrb) = (unsigned)-1;
-      TCP_WBNRTX(wrb)  = 0;
+          result += ncopied;
+        }
 
-      /* Copy the user data into the write buffer.  We cannot wait for
-       * buffer space if the socket was opened non-blocking.
+      /* Then queue the write buffer for transmission.  One that was
+       * appended to is already queued.
        */
 
-      if (_SS_ISNONBLOCK(psock->s_flags))
+      if (offset > 0)
         {
-          result = TCP_WBTRYCOPYIN(wrb, (FAR uint8_t *)buf, len);
+          send_txnotify(psock, conn);
         }
       else
         {
-          result = TCP_WBCOPYIN(wrb, (FAR uint8_t *)buf, len);
+          ret = psock_tcp_sendwrb(psock, wrb);
+          if (ret < 0)
+            {
+              goto errout_with_wrb;
+            }
         }
 
-      /* Dump I/O buffer chain */
-
-      TCP_WBDUMP("I/O buffer chain", wrb, TCP_WBPKTLEN(wrb), 0);
-
-      /* psock_send_eventhandler() will send data in FIFO order from the
-       * conn->write_q
-       */
-
-      sq_addlast(&wrb->wb_node, &conn->write_q);
-      ninfo("Queued WRB=%p pktlen=%u write_q(%p,%p)\n",
-            wrb, TCP_WBPKTLEN(wrb),
-            conn->write_q.head, conn->write_q.tail);
-
-      /* Notify the device driver of the availability of TX data */
-
-      send_txnotify(psock, conn);
       net_unlock();
     }
 
@@ -1131,6 +1484,35 @@ errout:
   return ret;
 }
 
+/****************************************************************************
+ * Name: psock_tcp_send
+ *
+ * Description:
+ *   psock_tcp_send() call may be used only when the TCP socket is in a
+ *   connected state (so that the intended recipient is known).
+ *
+ * Parameters:
+ *   psock    An instance of the internal socket structure.
+ *   buf      Data to send
+ *   len      Length of data to send
+ *
+ * Returned Value:
+ *   On success, returns the number of characters sent.  On error, a negated
+ *   errno value is returned (see psock_tcp_sendv()).
+ *
+ ****************************************************************************/
+
+ssize_t psock_tcp_send(FAR struct socket *psock, FAR const void *buf,
+                       size_t len)
+{
+  struct iovec iov;
+
+  iov.iov_base = (FAR void *)buf;
+  iov.iov_len  = len;
+
+  return psock_tcp_sendv(psock, &iov, 1);
+}
+
 /****************************************************************************
  * Name: psock_tcp_cansend
  *
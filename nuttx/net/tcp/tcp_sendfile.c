@@ -2,7 +2,7 @@
  * net/tcp/tcp_sendfile.c
  *
  *   Copyright (C) 2013 UVC Ingenieure. All rights reserved.
- *   Copyright (C) 2007-2017 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007-2018 Gregory Nutt. All rights reserved.
  *   Authors: Gregory Nutt <gnutt@nuttx.org>
  *            Max Holtzberg <mh@uvc.de>
  *
@@ -58,6 +58,7 @@
 #include <nuttx/clock.h>
 #include <nuttx/semaphore.h>
 #include <nuttx/fs/fs.h>
+#include <nuttx/mm/iob.h>
 #include <nuttx/net/net.h>
 #include <nuttx/net/netdev.h>
 #include <nuttx/net/arp.h>
@@ -85,10 +86,18 @@
 #define TCPIPv4BUF ((struct tcp_hdr_s *)&dev->d_buf[NET_LL_HDRLEN(dev) + IPv4_HDRLEN])
 #define TCPIPv6BUF ((struct tcp_hdr_s *)&dev->d_buf[NET_LL_HDRLEN(dev) + IPv6_HDRLEN])
 
+/* The maximum amount of file data that will be queued in one write buffer.
+ * This is limited by the 16-bit packet length of the I/O buffer chain.
+ */
+
+#define SENDFILE_WRBMAX UINT16_MAX
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
 
+#ifndef CONFIG_NET_TCP_WRITE_BUFFERS
+
 /* This structure holds the state of the send operation until it can be
  * operated upon from the driver poll event.
  */
@@ -109,6 +118,7 @@ struct sendfile_s
   systime_t          snd_time;    /* Last send time for determining timeout */
 #endif
 };
+#endif /* !CONFIG_NET_TCP_WRITE_BUFFERS */
 
 /****************************************************************************
  * Private Functions
@@ -131,6 +141,7 @@ struct sendfile_s
  *
  ****************************************************************************/
 
+#ifndef CONFIG_NET_TCP_WRITE_BUFFERS
 #ifdef CONFIG_NET_SOCKOPTS
 static inline int sendfile_timeout(FAR struct sendfile_s *pstate)
 {
@@ -179,7 +190,7 @@ static uint16_t ack_eventhandler(FAR struct net_driver_s *dev,
       if (IFF_IS_IPv6(dev->d_flags))
 #endif
         {
-          DEBUGASSERT(pstate->snd_sock == PF_INET6);
+          DEBUGASSERT(pstate->snd_sock->s_domain == PF_INET6);
           tcp = TCPIPv6BUF;
         }
 #endif /* CONFIG_NET_IPv6 */
@@ -189,7 +200,7 @@ static uint16_t ack_eventhandler(FAR struct net_driver_s *dev,
       else
 #endif
         {
-          DEBUGASSERT(pstate->snd_sock == PF_INET);
+          DEBUGASSERT(pstate->snd_sock->s_domain == PF_INET);
           tcp = TCPIPv4BUF;
         }
 #endif /* CONFIG_NET_IPv4 */
@@ -318,7 +329,7 @@ static inline bool sendfile_addrcheck(FAR struct tcp_conn_s *conn)
 }
 
 #else /* CONFIG_NET_ETHERNET */
-#  sendfile_addrcheck(r) (true)
+#  define sendfile_addrcheck(r) (true)
 #endif /* CONFIG_NET_ETHERNET */
 
 /****************************************************************************
@@ -434,7 +445,17 @@ static uint16_t sendfile_eventhandler(FAR struct net_driver_s *dev,
               pstate->snd_sent = ret;
               goto end_wait;
             }
+          else if (ret == 0)
+            {
+              /* End of file.  Nothing more can be sent; just wait for the
+               * ACKs of the data already sent.
+               */
 
+              pstate->snd_flen = pstate->snd_sent;
+              goto end_wait;
+            }
+
+          sndlen = ret;
           dev->d_sndlen = sndlen;
 
           /* Set the sequence number for this packet.  NOTE:  The network updates
@@ -485,8 +506,8 @@ static uint16_t sendfile_eventhandler(FAR struct net_driver_s *dev,
     }
 #endif /* CONFIG_NET_SOCKOPTS */
 
-  if (pstate->snd_sent >= pstate->snd_flen
-      && pstate->snd_acked < pstate->snd_flen)
+  if (pstate->snd_sent >= 0 && pstate->snd_sent >= pstate->snd_flen &&
+      pstate->snd_acked < pstate->snd_flen)
     {
       /* All data has been sent, but there are outstanding ACK's */
 
@@ -557,84 +578,33 @@ static inline void sendfile_txnotify(FAR struct socket *psock,
 }
 
 /****************************************************************************
- * Public Functions
- ****************************************************************************/
-
-/****************************************************************************
- * Name: tcp_sendfile
+ * Name: sendfile_unbuffered
  *
  * Description:
- *   The tcp_sendfile() call may be used only when the INET socket is in a
- *   connected state (so that the intended recipient is known).
+ *   Send the file data without write buffering.  The file data is read
+ *   directly into the device packet buffer as each segment is sent and
+ *   the function does not return until all of the data has been ACKed.
  *
  * Parameters:
- *   psock    An instance of the internal socket structure.
- *   buf      Data to send
- *   len      Length of data to send
- *   flags    Send flags
+ *   psock    - An instance of the internal socket structure.
+ *   conn     - The TCP connection structure
+ *   infile   - The file structure of the input file
+ *   startpos - The offset into the file of the first byte to be sent
+ *   count    - The number of bytes to send
  *
  * Returned Value:
- *   On success, returns the number of characters sent.  On  error,
- *   a negated errno value is returned.  See sendfile() for a list
- *   appropriate error return values.
+ *   The number of bytes sent on success; a negated errno value on failure.
  *
  ****************************************************************************/
 
-ssize_t tcp_sendfile(FAR struct socket *psock, FAR struct file *infile,
-                      FAR off_t *offset, size_t count)
+static ssize_t sendfile_unbuffered(FAR struct socket *psock,
+                                   FAR struct tcp_conn_s *conn,
+                                   FAR struct file *infile, off_t startpos,
+                                   size_t count)
 {
-  FAR struct tcp_conn_s *conn;
   struct sendfile_s state;
   int ret;
 
-  /* If this is an un-connected socket, then return ENOTCONN */
-
-  if (psock->s_type != SOCK_STREAM || !_SS_ISCONNECTED(psock->s_flags))
-    {
-      nerr("ERROR: Not connected\n");
-      return -ENOTCONN;
-    }
-
-  /* Make sure that we have the IP address mapping */
-
-  conn = (FAR struct tcp_conn_s *)psock->s_conn;
-  DEBUGASSERT(conn != NULL);
-
-#if defined(CONFIG_NET_ARP_SEND) || defined(CONFIG_NET_ICMPv6_NEIGHBOR)
-#ifdef CONFIG_NET_ARP_SEND
-#ifdef CONFIG_NET_ICMPv6_NEIGHBOR
-  if (psock->s_domain == PF_INET)
-#endif
-    {
-      /* Make sure that the IP address mapping is in the ARP table */
-
-      ret = arp_send(conn->u.ipv4.raddr);
-    }
-#endif /* CONFIG_NET_ARP_SEND */
-#ifdef CONFIG_NET_ICMPv6_NEIGHBOR
-#ifdef CONFIG_NET_ARP_SEND
-  else
-#endif
-    {
-      /* Make sure that the IP address mapping is in the Neighbor Table */
-
-      ret = icmpv6_neighbor(conn->u.ipv6.raddr);
-    }
-#endif /* CONFIG_NET_ICMPv6_NEIGHBOR */
-
-  /* Did we successfully get the address mapping? */
-
-  if (ret < 0)
-    {
-      nerr("ERROR: Not reachable\n");
-      return -ENETUNREACH;
-    }
-#endif /* CONFIG_NET_ARP_SEND || CONFIG_NET_ICMPv6_NEIGHBOR */
-
-  /* Set the socket state to sending */
-
-  psock->s_flags = _SS_SETSTATE(psock->s_flags, _SF_SEND);
-
   /* Initialize the state structure.  This is done with the network
    * locked because we don't want anything to happen until we are
    * ready.
@@ -651,7 +621,7 @@ ssize_t tcp_sendfile(FAR struct socket *psock, FAR struct file *infile,
   nxsem_setprotocol(&state.snd_sem, SEM_PRIO_NONE);
 
   state.snd_sock    = psock;                /* Socket descriptor to use */
-  state.snd_foffset = offset ? *offset : 0; /* Input file offset */
+  state.snd_foffset = startpos;             /* Input file offset */
   state.snd_flen    = count;                /* Number of bytes to send */
   state.snd_file    = infile;               /* File to read from */
 
@@ -662,7 +632,7 @@ ssize_t tcp_sendfile(FAR struct socket *psock, FAR struct file *infile,
   if (state.snd_datacb == NULL)
     {
       nerr("ERROR: Failed to allocate data callback\n");
-      ret =- ENOMEM;
+      ret = -ENOMEM;
       goto errout_locked;
     }
 
@@ -712,30 +682,349 @@ ssize_t tcp_sendfile(FAR struct socket *psock, FAR struct file *infile,
     }
   while (state.snd_sent >= 0 && state.snd_acked < state.snd_flen);
 
-  /* Set the socket state to idle */
-
-  psock->s_flags = _SS_SETSTATE(psock->s_flags, _SF_IDLE);
-
+  ret = state.snd_sent;
   tcp_callback_free(conn, state.snd_ackcb);
 
 errout_datacb:
   tcp_callback_free(conn, state.snd_datacb);
 
 errout_locked:
-
-  nxsem_destroy(&state. snd_sem);
+  nxsem_destroy(&state.snd_sem);
   net_unlock();
+  return ret;
+}
+#endif /* !CONFIG_NET_TCP_WRITE_BUFFERS */
+
+/****************************************************************************
+ * Name: sendfile_readiob
+ *
+ * Description:
+ *   Read file data directly into the I/O buffer chain of a write buffer.
+ *   The first I/O buffer of the chain was allocated with the write buffer.
+ *   Additional I/O buffers are added to the chain only as long as they are
+ *   available without waiting; the throttled allocation leaves I/O buffers
+ *   for packet reception.
+ *
+ * Parameters:
+ *   infile - The file structure of the input file
+ *   wrb    - The write buffer to be filled
+ *   count  - The maximum number of bytes to read
+ *
+ * Returned Value:
+ *   The number of bytes read into the write buffer (zero at the end of the
+ *   file) or a negated errno value if nothing could be read.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_WRITE_BUFFERS
+static ssize_t sendfile_readiob(FAR struct file *infile,
+                                FAR struct tcp_wrbuffer_s *wrb,
+                                size_t count)
+{
+  FAR struct iob_s *head = TCP_WBIOB(wrb);
+  FAR struct iob_s *iob  = head;
+  FAR struct iob_s *next;
+  size_t total = 0;
+  size_t nbytes;
+  ssize_t nread;
+
+  DEBUGASSERT(iob != NULL && iob->io_len == 0);
+
+  if (count > SENDFILE_WRBMAX)
+    {
+      count = SENDFILE_WRBMAX;
+    }
+
+  while (total < count)
+    {
+      /* Add another I/O buffer to the chain if this one is full */
+
+      if (iob->io_len >= IOB_BUFSIZE(iob))
+        {
+          next = iob_tryalloc_size(count - total, true);
+          if (next == NULL)
+            {
+              break;
+            }
+
+          iob->io_flink = next;
+          iob           = next;
+        }
+
+      /* Read directly into the I/O buffer */
+
+      nbytes = IOB_BUFSIZE(iob) - iob->io_len;
+      if (nbytes > count - total)
+        {
+          nbytes = count - total;
+        }
+
+      nread = file_read(infile, &iob->io_data[iob->io_len], nbytes);
+      if (nread < 0)
+        {
+          nerr("ERROR: Failed to read from input file: %d\n", (int)nread);
+          if (total == 0)
+            {
+              return nread;
+            }
+
+          break;
+        }
+      else if (nread == 0)
+        {
+          /* End of file */
+
+          break;
+        }
+
+      iob->io_len += nread;
+      total       += nread;
+    }
+
+  head->io_pktlen = total;
+  return total;
+}
+
+/****************************************************************************
+ * Name: sendfile_buffered
+ *
+ * Description:
+ *   Send the file data through the TCP write buffers.  The file data is
+ *   read from the current file position directly into I/O buffer chains
+ *   which are queued for transmission without any intermediate copy.  The
+ *   function returns as soon as all of the data has been queued.
+ *
+ * Parameters:
+ *   psock    - An instance of the internal socket structure.
+ *   infile   - The file structure of the input file
+ *   count    - The number of bytes to send
+ *
+ * Returned Value:
+ *   The number of bytes queued for transmission on success; a negated
+ *   errno value on failure.
+ *
+ ****************************************************************************/
+
+static ssize_t sendfile_buffered(FAR struct socket *psock,
+                                 FAR struct file *infile, size_t count)
+{
+  FAR struct tcp_wrbuffer_s *wrb;
+  ssize_t nread;
+  size_t sent = 0;
+  int ret = OK;
+
+  while (sent < count)
+    {
+      /* Check for a loss of connection while we were sending */
+
+      if (!_SS_ISCONNECTED(psock->s_flags))
+        {
+          ret = -ENOTCONN;
+          break;
+        }
+
+      /* We cannot wait for a write buffer if the socket was opened
+       * non-blocking.
+       */
+
+      if (_SS_ISNONBLOCK(psock->s_flags) && tcp_wrbuffer_test() < 0)
+        {
+          ret = -EAGAIN;
+          break;
+        }
+
+      /* Allocate a write buffer.  Careful, the network will be momentarily
+       * unlocked here.
+       */
+
+      net_lock();
+      wrb = tcp_wrbuffer_alloc();
+      net_unlock();
+
+      if (wrb == NULL)
+        {
+          nerr("ERROR: Failed to allocate write buffer\n");
+          ret = -ENOMEM;
+          break;
+        }
+
+      /* Fill the write buffer with file data.  The network is not locked
+       * while we wait for the file system.
+       */
+
+      nread = sendfile_readiob(infile, wrb, count - sent);
+
+      net_lock();
+      if (nread <= 0)
+        {
+          /* Error or end of file */
+
+          tcp_wrbuffer_release(wrb);
+          net_unlock();
+
+          ret = (int)nread;
+          break;
+        }
+
+      /* Queue the write buffer for transmission */
+
+      ret = psock_tcp_sendwrb(psock, wrb);
+      if (ret < 0)
+        {
+          tcp_wrbuffer_release(wrb);
+          net_unlock();
+          break;
+        }
+
+      net_unlock();
+      sent += nread;
+    }
+
+  /* Return the number of bytes queued unless nothing could be queued */
+
+  return (sent > 0 || ret >= 0) ? (ssize_t)sent : (ssize_t)ret;
+}
+#endif /* CONFIG_NET_TCP_WRITE_BUFFERS */
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: tcp_sendfile
+ *
+ * Description:
+ *   The tcp_sendfile() call may be used only when the INET socket is in a
+ *   connected state (so that the intended recipient is known).
+ *
+ * Parameters:
+ *   psock    An instance of the internal socket structure.
+ *   infile   The file structure of the input file
+ *   offset   Offset into the input file (or NULL to use the file position)
+ *   count    The number of bytes to send
+ *
+ * Returned Value:
+ *   On success, returns the number of characters sent.  On  error,
+ *   a negated errno value is returned.  See sendfile() for a list
+ *   appropriate error return values.
+ *
+ ****************************************************************************/
+
+ssize_t tcp_sendfile(FAR struct socket *psock, FAR struct file *infile,
+                     FAR off_t *offset, size_t count)
+{
+  FAR struct tcp_conn_s *conn;
+  off_t startpos;
+  off_t curpos;
+  ssize_t nsent;
+  int ret;
+
+  /* If this is an un-connected socket, then return ENOTCONN */
+
+  if (psock->s_type != SOCK_STREAM || !_SS_ISCONNECTED(psock->s_flags))
+    {
+      nerr("ERROR: Not connected\n");
+      return -ENOTCONN;
+    }
+
+  /* Make sure that we have the IP address mapping */
 
-errout:
+  conn = (FAR struct tcp_conn_s *)psock->s_conn;
+  DEBUGASSERT(conn != NULL);
+
+#if defined(CONFIG_NET_ARP_SEND) || defined(CONFIG_NET_ICMPv6_NEIGHBOR)
+#ifdef CONFIG_NET_ARP_SEND
+#ifdef CONFIG_NET_ICMPv6_NEIGHBOR
+  if (psock->s_domain == PF_INET)
+#endif
+    {
+      /* Make sure that the IP address mapping is in the ARP table */
+
+      ret = arp_send(conn->u.ipv4.raddr);
+    }
+#endif /* CONFIG_NET_ARP_SEND */
+#ifdef CONFIG_NET_ICMPv6_NEIGHBOR
+#ifdef CONFIG_NET_ARP_SEND
+  else
+#endif
+    {
+      /* Make sure that the IP address mapping is in the Neighbor Table */
+
+      ret = icmpv6_neighbor(conn->u.ipv6.raddr);
+    }
+#endif /* CONFIG_NET_ICMPv6_NEIGHBOR */
+
+  /* Did we successfully get the address mapping? */
 
   if (ret < 0)
     {
-      return ret;
+      nerr("ERROR: Not reachable\n");
+      return -ENETUNREACH;
+    }
+#endif /* CONFIG_NET_ARP_SEND || CONFIG_NET_ICMPv6_NEIGHBOR */
+
+  /* Get the current file position and the position of the first byte to
+   * be sent.
+   */
+
+  curpos = file_seek(infile, 0, SEEK_CUR);
+  if (curpos < 0)
+    {
+      nerr("ERROR: Failed to lseek: %d\n", (int)curpos);
+      return (ssize_t)curpos;
+    }
+
+  startpos = offset != NULL ? *offset : curpos;
+
+#ifdef CONFIG_NET_TCP_WRITE_BUFFERS
+  /* The buffered send reads sequentially from the file position */
+
+  if (startpos != curpos)
+    {
+      ret = file_seek(infile, startpos, SEEK_SET);
+      if (ret < 0)
+        {
+          nerr("ERROR: Failed to lseek: %d\n", ret);
+          return ret;
+        }
+    }
+#endif
+
+  /* Set the socket state to sending */
+
+  psock->s_flags = _SS_SETSTATE(psock->s_flags, _SF_SEND);
+
+#ifdef CONFIG_NET_TCP_WRITE_BUFFERS
+  nsent = sendfile_buffered(psock, infile, count);
+#else
+  nsent = sendfile_unbuffered(psock, conn, infile, startpos, count);
+#endif
+
+  /* Set the socket state to idle */
+
+  psock->s_flags = _SS_SETSTATE(psock->s_flags, _SF_IDLE);
+
+  /* If 'offset' is not NULL, then return the offset of the byte following
+   * the last byte sent and leave the file position unmodified.  Otherwise,
+   * the file position is updated to reflect the bytes sent.
+   */
+
+  if (offset != NULL)
+    {
+      if (nsent > 0)
+        {
+          *offset = startpos + nsent;
+        }
+
+      (void)file_seek(infile, curpos, SEEK_SET);
     }
   else
     {
-      return state.snd_sent;
+      (void)file_seek(infile, startpos + (nsent > 0 ? nsent : 0),
+                      SEEK_SET);
     }
+
+  return nsent;
 }
 
 #endif /* CONFIG_NET_SENDFILE && CONFIG_NET_TCP && NET_TCP_HAVE_STACK */
@@ -0,0 +1,275 @@
+/****************************************************************************
+ * net/tcp/tcp_setsockopt.c
+ *
+ *   Copyright (C) 2018 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <stdint.h>
+#include <errno.h>
+#include <assert.h>
+#include <debug.h>
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#include <nuttx/net/net.h>
+#include <nuttx/net/tcp.h>
+
+#include "netdev/netdev.h"
+#include "socket/socket.h"
+#include "tcp/tcp.h"
+
+#if defined(NET_TCP_HAVE_STACK) && defined(CONFIG_NET_SOCKOPTS)
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: tcp_setsockopt
+ *
+ * Description:
+ *   tcp_setsockopt() sets the TCP-protocol option specified by the
+ *   'option' argument to the value pointed to by the 'value' argument for
+ *   the socket specified by the 'psock' argument.
+ *
+ *   See <netinet/tcp.h> for the a complete list of values of TCP protocol
+ *   options.
+ *
+ * Input Parameters:
+ *   psock     Socket structure of socket to operate on
+ *   option    identifies the option to set
+ *   value     Points to the argument value
+ *   value_len The length of the argument value
+ *
+ * Returned Value:
+ *   Returns zero (OK) on success.  On failure, it returns a negated errno
+ *   value to indicate the nature of the error.  See psock_setsockopt() for
+ *   the list of possible error values.
+ *
+ ****************************************************************************/
+
+int tcp_setsockopt(FAR struct socket *psock, int option,
+                   FAR const void *value, socklen_t value_len)
+{
+#if defined(TCP_HAVE_SNDFLAGS) || defined(CONFIG_NET_TCP_KEEPALIVE)
+  FAR struct tcp_conn_s *conn;
+#endif
+#ifdef TCP_HAVE_SNDFLAGS
+  uint8_t sndflags;
+#endif
+  uint8_t flag;
+  int ret = OK;
+
+  DEBUGASSERT(psock != NULL && value != NULL);
+
+  if (psock->s_type != SOCK_STREAM)
+    {
+      return -ENOPROTOOPT;
+    }
+
+  switch (option)
+    {
+      /* These options take a pointer to an integer boolean value */
+
+      case TCP_NODELAY:  /* Send small segments without waiting for ACKs */
+      case TCP_CORK:     /* Hold partial segments until uncorked */
+      case TCP_QUICKACK: /* ACK received data immediately */
+        {
+          /* Verify that option is the size of an 'int'.  Should also check
+           * that 'value' is properly aligned for an 'int'
+           */
+
+          if (value_len != sizeof(int))
+            {
+              return -EINVAL;
+            }
+
+          switch (option)
+            {
+#ifdef CONFIG_NET_TCP_NAGLE
+              case TCP_NODELAY:
+                flag = TCP_SNDF_NODELAY;
+                break;
+
+              case TCP_CORK:
+                flag = TCP_SNDF_CORK;
+                break;
+#endif
+#ifdef CONFIG_NET_TCP_DELAYED_ACK
+              case TCP_QUICKACK:
+                flag = TCP_SNDF_QUICKACK;
+                break;
+#endif
+              default:
+                flag = 0;
+                break;
+            }
+
+          if (flag == 0)
+            {
+              /* The option cannot be changed in this configuration.  Small
+               * writes are always sent immediately, never corked, and all
+               * data is ACKed immediately.  Only that value is accepted.
+               */
+
+              if ((option != TCP_CORK) != (*(FAR const int *)value != 0))
+                {
+                  ret = -ENOPROTOOPT;
+                }
+
+              break;
+            }
+
+#ifdef TCP_HAVE_SNDFLAGS
+          conn = (FAR struct tcp_conn_s *)psock->s_conn;
+          DEBUGASSERT(conn != NULL);
+
+          net_lock();
+
+          sndflags = conn->sndflags;
+          if (*(FAR const int *)value)
+            {
+              conn->sndflags |= flag;
+            }
+          else
+            {
+              conn->sndflags &= ~flag;
+            }
+
+          /* Setting TCP_NODELAY or clearing TCP_CORK may release data that
+           * was held back.  Have the driver poll the connection.
+           */
+
+          if (conn->dev != NULL &&
+              ((conn->sndflags & ~sndflags & TCP_SNDF_NODELAY) != 0 ||
+               (sndflags & ~conn->sndflags & TCP_SNDF_CORK) != 0))
+            {
+              netdev_txnotify_dev(conn->dev);
+            }
+
+          net_unlock();
+#endif
+        }
+        break;
+
+#ifdef CONFIG_NET_TCP_KEEPALIVE
+      /* These options take a pointer to an integer value */
+
+      case TCP_KEEPIDLE:     /* Idle time before keep-alive probes (sec) */
+      case TCP_KEEPINTVL:    /* Time between keep-alive probes (sec) */
+      case TCP_KEEPCNT:      /* Unanswered probes before aborting */
+      case TCP_USER_TIMEOUT: /* Time that data may stay unACKed (msec) */
+        {
+          int setting;
+
+          if (value_len != sizeof(int))
+            {
+              return -EINVAL;
+            }
+
+          setting = *(FAR const int *)value;
+          conn    = (FAR struct tcp_conn_s *)psock->s_conn;
+          DEBUGASSERT(conn != NULL);
+
+          net_lock();
+
+          switch (option)
+            {
+              case TCP_KEEPIDLE:
+                if (setting < 1 || setting > TCP_MAXKEEPIDLE)
+                  {
+                    ret = -EINVAL;
+                  }
+                else
+                  {
+                    conn->keepidle = (uint16_t)setting;
+                  }
+                break;
+
+              case TCP_KEEPINTVL:
+                if (setting < 1 || setting > TCP_MAXKEEPINTVL)
+                  {
+                    ret = -EINVAL;
+                  }
+                else
+                  {
+                    conn->keepintvl = (uint16_t)setting;
+                  }
+                break;
+
+              case TCP_KEEPCNT:
+                if (setting < 1 || setting > TCP_MAXKEEPCNT)
+                  {
+                    ret = -EINVAL;
+                  }
+                else
+                  {
+                    conn->keepcnt = (uint8_t)setting;
+                  }
+                break;
+
+              default: /* TCP_USER_TIMEOUT */
+                if (setting < 0)
+                  {
+                    ret = -EINVAL;
+                  }
+                else
+                  {
+                    conn->user_timeout = (uint32_t)setting;
+                  }
+                break;
+            }
+
+          net_unlock();
+        }
+        break;
+#endif
+
+      default:
+        nerr("ERROR: Unrecognized TCP option: %d\n", option);
+        ret = -ENOPROTOOPT;
+        break;
+    }
+
+  return ret;
+}
+
+#endif /* NET_TCP_HAVE_STACK && CONFIG_NET_SOCKOPTS */
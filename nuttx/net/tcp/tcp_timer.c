@@ -2,7 +2,7 @@
  * net/tcp/tcp_timer.c
  * Poll for the availability of TCP TX data
  *
- *   Copyright (C) 2007-2010, 2015-2016 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007-2010, 2015-2016, 2018 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Adapted for NuttX from logic in uIP which also has a BSD-like license:
@@ -46,6 +46,7 @@
 #if defined(CONFIG_NET) && defined(CONFIG_NET_TCP)
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <assert.h>
 #include <debug.h>
 
@@ -57,6 +58,94 @@
 #include "devif/devif.h"
 #include "tcp/tcp.h"
 
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: tcp_keepalive
+ *
+ * Description:
+ *   Probe an idle connection on which SO_KEEPALIVE is set.  A probe is an
+ *   ACK with the sequence number one below the next one to be sent, so that
+ *   the peer must answer it with an ACK (RFC 1122, section 4.2.3.6).  The
+ *   connection is aborted if there is no answer after TCP_KEEPCNT probes
+ *   or, if it is set, after TCP_USER_TIMEOUT.
+ *
+ * Parameters:
+ *   dev    - The device driver structure to use in the send operation
+ *   conn   - The TCP connection structure, which has no unACKed data
+ *   hdrlen - The length of the IP and TCP headers
+ *
+ * Returned Value:
+ *   true if a probe or reset was sent.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_KEEPALIVE
+static bool tcp_keepalive(FAR struct net_driver_s *dev,
+                          FAR struct tcp_conn_s *conn, uint8_t hdrlen)
+{
+  uint32_t saveseq;
+  uint32_t idle;
+  bool expired;
+
+  /* Time since the peer was last heard from, in msec */
+
+  idle = TICK2MSEC(clock_systimer() - conn->keeptime);
+  if (idle < (uint32_t)conn->keepidle * MSEC_PER_SEC)
+    {
+      return false;
+    }
+
+  /* Time spent probing */
+
+  idle -= (uint32_t)conn->keepidle * MSEC_PER_SEC;
+
+  if (conn->user_timeout > 0)
+    {
+      expired = (idle >= conn->user_timeout);
+    }
+  else
+    {
+      expired = (conn->keepretries >= conn->keepcnt &&
+                 idle / MSEC_PER_SEC >=
+                 (uint32_t)conn->keepcnt * conn->keepintvl);
+    }
+
+  if (expired)
+    {
+      conn->tcpstateflags = TCP_CLOSED;
+      ninfo("TCP keep-alive: TCP_CLOSED\n");
+
+      (void)tcp_callback(dev, conn, TCP_TIMEDOUT);
+      tcp_send(dev, conn, TCP_RST | TCP_ACK, hdrlen);
+      return true;
+    }
+
+  if (idle / MSEC_PER_SEC >=
+      (uint32_t)conn->keepretries * conn->keepintvl)
+    {
+      saveseq = tcp_getsequence(conn->sndseq);
+      tcp_setsequence(conn->sndseq, saveseq - 1);
+      tcp_send(dev, conn, TCP_ACK, hdrlen);
+      tcp_setsequence(conn->sndseq, saveseq);
+
+      if (conn->keepretries < UINT8_MAX)
+        {
+          conn->keepretries++;
+        }
+
+      return true;
+    }
+
+  return false;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -188,11 +277,50 @@ void tcp_timer(FAR struct net_driver_s *dev, FAR struct tcp_conn_s *conn,
         {
           /* The connection has outstanding data */
 
+#ifdef CONFIG_NET_TCP_KEEPALIVE
+          systime_t now = clock_systimer();
+
+          if (conn->sndtime == 0)
+            {
+              conn->sndtime = (now != 0) ? now : 1;
+            }
+
+          /* Abort the connection if the data has been waiting for an ACK
+           * for longer than TCP_USER_TIMEOUT (RFC 5482).
+           */
+
+          else if (conn->user_timeout > 0 &&
+                   TICK2MSEC(now - conn->sndtime) >= conn->user_timeout &&
+                   dev == conn->dev)
+            {
+              conn->tcpstateflags = TCP_CLOSED;
+              ninfo("TCP user timeout: TCP_CLOSED\n");
+
+              result = tcp_callback(dev, conn, TCP_TIMEDOUT);
+              tcp_send(dev, conn, TCP_RST | TCP_ACK, hdrlen);
+              goto done;
+            }
+#endif
+
           if (conn->timer > hsec)
             {
               /* Will not yet decrement to zero */
 
               conn->timer -= hsec;
+
+#ifdef CONFIG_NET_TCP_DELAYED_ACK
+              /* No retransmission is due, so nothing else will be sent.
+               * Send any ACK that has been delayed.
+               */
+
+              if (conn->delack > 0 &&
+                  (conn->tcpstateflags & TCP_STATE_MASK) == TCP_ESTABLISHED &&
+                  dev == conn->dev)
+                {
+                  tcp_send(dev, conn, TCP_ACK, hdrlen);
+                  goto done;
+                }
+#endif
             }
           else
             {
@@ -326,6 +454,13 @@ void tcp_timer(FAR struct net_driver_s *dev, FAR struct tcp_conn_s *conn,
                      * the code for sending out the packet.
                      */
 
+#ifdef CONFIG_NET_TCP_CC
+                    /* A timeout is taken as a sign of heavy congestion:
+                     * restart from slow start.
+                     */
+
+                    tcp_cc_timeout(conn);
+#endif
                     result = tcp_callback(dev, conn, TCP_REXMIT);
                     tcp_rexmit(dev, conn, result);
                     goto done;
@@ -356,10 +491,29 @@ void tcp_timer(FAR struct net_driver_s *dev, FAR struct tcp_conn_s *conn,
            * we are bound to.
            */
 
+#ifdef CONFIG_NET_TCP_KEEPALIVE
+          conn->sndtime = 0;
+#endif
+
           DEBUGASSERT(conn->dev != NULL);
           if (dev == conn->dev)
             {
+#ifdef CONFIG_NET_TCP_KEEPALIVE
+              if (conn->keepalive && tcp_keepalive(dev, conn, hdrlen))
+                {
+                  goto done;
+                }
+#endif
+
               result = tcp_callback(dev, conn, TCP_POLL);
+#ifdef CONFIG_NET_TCP_DELAYED_ACK
+              if (conn->delack > 0)
+                {
+                  /* Send the delayed ACK, with new data if there is any */
+
+                  result |= TCP_SNDACK;
+                }
+#endif
               tcp_appsend(dev, conn, result);
               goto done;
             }
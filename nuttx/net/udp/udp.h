@@ -113,6 +113,8 @@ struct udp_conn_s
    */
 
   struct iob_queue_s readahead;   /* Read-ahead buffering */
+  uint32_t rcvbufs;               /* Maximum read-ahead bytes (SO_RCVBUF) */
+  uint32_t rcvqueued;             /* Bytes now held in readahead */
 #endif
 
 #ifdef CONFIG_NET_TCP_WRITE_BUFFERS
@@ -594,6 +596,33 @@ ssize_t psock_udp_sendto(FAR struct socket *psock, FAR const void *buf,
                          size_t len, int flags, FAR const struct sockaddr *to,
                          socklen_t tolen);
 
+/****************************************************************************
+ * Name: psock_udp_sendmmsg
+ *
+ * Description:
+ *   Queue a batch of UDP datagrams in write buffers.  All of the datagrams
+ *   are queued with a single acquisition of the network lock and the
+ *   device is notified once, after the whole batch has been queued.
+ *
+ * Input Parameters:
+ *   psock    A pointer to a NuttX-specific, internal socket structure
+ *   msgvec   The datagrams to send.  A message without a msg_name is sent
+ *            to the address that the socket is connected to.
+ *   vlen     The number of messages in 'msgvec'
+ *   flags    Send flags
+ *
+ * Returned Value:
+ *   The number of datagrams queued.  The size of each is returned in its
+ *   msg_len field.  If the first datagram cannot be queued, a negated errno
+ *   value is returned.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_UDP_WRITE_BUFFERS
+int psock_udp_sendmmsg(FAR struct socket *psock, FAR struct mmsghdr *msgvec,
+                       unsigned int vlen, int flags);
+#endif
+
 /****************************************************************************
  * Name: udp_pollsetup
  *
@@ -90,6 +90,15 @@ static uint16_t udp_datahandler(FAR struct net_driver_s *dev, FAR struct udp_con
   FAR void  *src_addr;
   uint8_t src_addr_size;
 
+  /* Drop the datagram if it would exceed the read-ahead limit */
+
+  if (conn->rcvbufs > 0 && conn->rcvqueued + buflen > conn->rcvbufs)
+    {
+      ninfo("Read-ahead limit reached: %lu\n",
+            (unsigned long)conn->rcvbufs);
+      return 0;
+    }
+
   /* Allocate on I/O buffer to start the chain (throttling as necessary).
    * We will not wait for an I/O buffer to become available in this context.
    */
@@ -224,6 +233,7 @@ static uint16_t udp_datahandler(FAR struct net_driver_s *dev, FAR struct udp_con
       return 0;
     }
 
+  conn->rcvqueued += iob->io_pktlen;
   ninfo("Buffered %d bytes\n", buflen);
   return buflen;
 }
@@ -485,6 +485,9 @@ FAR struct udp_conn_s *udp_alloc(uint8_t domain)
 #endif
       conn->lport  = 0;
       conn->ttl    = IP_TTL;
+#ifdef CONFIG_NET_UDP_READAHEAD
+      conn->rcvbufs = CONFIG_NET_RECV_BUFSIZE;
+#endif
 
 #ifdef CONFIG_NET_TCP_WRITE_BUFFERS
       /* Initialize the write buffer lists */
@@ -530,6 +533,7 @@ void udp_free(FAR struct udp_conn_s *conn)
   /* Release any read-ahead buffers attached to the connection */
 
   iob_free_queue(&conn->readahead);
+  conn->rcvqueued = 0;
 #endif
 
 #ifdef CONFIG_NET_UDP_WRITE_BUFFERS
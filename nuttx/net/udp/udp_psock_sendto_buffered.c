@@ -51,6 +51,7 @@
 
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 
 #include <stdint.h>
 #include <stdbool.h>
@@ -119,6 +120,14 @@ static inline bool sendto_addrcheck(FAR struct udp_conn_s *conn,
 static inline int sendto_timeout(FAR struct socket *psock,
                                  FAR struct udp_conn_s *conn);
 #endif
+#if defined(CONFIG_NET_ARP_SEND) || defined(CONFIG_NET_ICMPv6_NEIGHBOR)
+static int sendto_addrmapping(FAR struct socket *psock,
+                              FAR struct udp_conn_s *conn);
+#else
+#  define sendto_addrmapping(p,c) (OK)
+#endif
+static socklen_t sendto_connaddr(FAR struct udp_conn_s *conn,
+                                 FAR struct sockaddr_storage *addr);
 static int sendto_next_transfer(FAR struct socket *psock,
                                 FAR struct udp_conn_s *conn);
 static uint16_t sendto_eventhandler(FAR struct net_driver_s *dev,
@@ -349,6 +358,108 @@ static inline int sendto_timeout(FAR struct socket *psock,
 }
 #endif /* CONFIG_NET_SOCKOPTS */
 
+/****************************************************************************
+ * Name: sendto_addrmapping
+ *
+ * Description:
+ *   Make sure that the link layer address of the remote peer is known.
+ *
+ * Parameters:
+ *   psock - Socket state structure
+ *   conn  - The UDP connection structure
+ *
+ * Returned Value:
+ *   Zero (OK) on success; -ENETUNREACH if the address could not be mapped.
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_NET_ARP_SEND) || defined(CONFIG_NET_ICMPv6_NEIGHBOR)
+static int sendto_addrmapping(FAR struct socket *psock,
+                              FAR struct udp_conn_s *conn)
+{
+  int ret = OK;
+
+#ifdef CONFIG_NET_ARP_SEND
+#ifdef CONFIG_NET_ICMPv6_NEIGHBOR
+  if (psock->s_domain == PF_INET)
+#endif
+    {
+      /* Make sure that the IP address mapping is in the ARP table */
+
+      ret = arp_send(conn->u.ipv4.raddr);
+    }
+#endif /* CONFIG_NET_ARP_SEND */
+
+#ifdef CONFIG_NET_ICMPv6_NEIGHBOR
+#ifdef CONFIG_NET_ARP_SEND
+  else
+#endif
+    {
+      /* Make sure that the IP address mapping is in the Neighbor Table */
+
+      ret = icmpv6_neighbor(conn->u.ipv6.raddr);
+    }
+#endif /* CONFIG_NET_ICMPv6_NEIGHBOR */
+
+  /* Did we successfully get the address mapping? */
+
+  if (ret < 0)
+    {
+      nerr("ERROR: Not reachable\n");
+      return -ENETUNREACH;
+    }
+
+  return OK;
+}
+#endif /* CONFIG_NET_ARP_SEND || CONFIG_NET_ICMPv6_NEIGHBOR */
+
+/****************************************************************************
+ * Name: sendto_connaddr
+ *
+ * Description:
+ *   Return the address that a connected UDP socket sends to.
+ *
+ * Parameters:
+ *   conn - The UDP connection structure
+ *   addr - The location to return the address
+ *
+ * Returned Value:
+ *   The size of the address
+ *
+ ****************************************************************************/
+
+static socklen_t sendto_connaddr(FAR struct udp_conn_s *conn,
+                                 FAR struct sockaddr_storage *addr)
+{
+#ifdef CONFIG_NET_IPv4
+#ifdef CONFIG_NET_IPv6
+  if (conn->domain == PF_INET)
+#endif
+    {
+      FAR struct sockaddr_in *addr4 = (FAR struct sockaddr_in *)addr;
+
+      addr4->sin_family = AF_INET;
+      addr4->sin_port   = conn->rport;
+      net_ipv4addr_copy(addr4->sin_addr.s_addr, conn->u.ipv4.raddr);
+      return sizeof(struct sockaddr_in);
+    }
+#endif /* CONFIG_NET_IPv4 */
+
+#ifdef CONFIG_NET_IPv6
+#ifdef CONFIG_NET_IPv4
+  else
+#endif
+    {
+      FAR struct sockaddr_in6 *addr6 = (FAR struct sockaddr_in6 *)addr;
+
+      addr6->sin6_family = AF_INET6;
+      addr6->sin6_port   = conn->rport;
+      net_ipv6addr_copy(addr6->sin6_addr.s6_addr, conn->u.ipv6.raddr);
+      return sizeof(struct sockaddr_in6);
+    }
+#endif /* CONFIG_NET_IPv6 */
+}
+
 /****************************************************************************
  * Name: sendto_next_transfer
  *
@@ -624,37 +735,11 @@ ssize_t psock_udp_sendto(FAR struct socket *psock, FAR const void *buf,
   conn = (FAR struct udp_conn_s *)psock->s_conn;
   DEBUGASSERT(conn);
 
-#if defined(CONFIG_NET_ARP_SEND) || defined(CONFIG_NET_ICMPv6_NEIGHBOR)
-#ifdef CONFIG_NET_ARP_SEND
-#ifdef CONFIG_NET_ICMPv6_NEIGHBOR
-  if (psock->s_domain == PF_INET)
-#endif
-    {
-      /* Make sure that the IP address mapping is in the ARP table */
-
-      ret = arp_send(conn->u.ipv4.raddr);
-    }
-#endif /* CONFIG_NET_ARP_SEND */
-
-#ifdef CONFIG_NET_ICMPv6_NEIGHBOR
-#ifdef CONFIG_NET_ARP_SEND
-  else
-#endif
-    {
-      /* Make sure that the IP address mapping is in the Neighbor Table */
-
-      ret = icmpv6_neighbor(conn->u.ipv6.raddr);
-    }
-#endif /* CONFIG_NET_ICMPv6_NEIGHBOR */
-
-  /* Did we successfully get the address mapping? */
-
+  ret = sendto_addrmapping(psock, conn);
   if (ret < 0)
     {
-      nerr("ERROR: Not reachable\n");
-      return -ENETUNREACH;
+      return ret;
     }
-#endif /* CONFIG_NET_ARP_SEND || CONFIG_NET_ICMPv6_NEIGHBOR */
 
   /* Dump the incoming buffer */
 
@@ -755,4 +840,224 @@ errout_with_lock:
   return ret;
 }
 
+/****************************************************************************
+ * Name: psock_udp_sendmmsg
+ *
+ * Description:
+ *   Queue a batch of UDP datagrams in write buffers.  All of the datagrams
+ *   are queued with a single acquisition of the network lock and the
+ *   device is notified only once for the whole batch.  If a datagram
+ *   cannot be queued, the batch stops there.
+ *
+ * Input Parameters:
+ *   psock    A pointer to a NuttX-specific, internal socket structure
+ *   msgvec   The datagrams to send.  A message without a msg_name is sent
+ *            to the address that the socket is connected to.
+ *   vlen     The number of messages in 'msgvec'
+ *   flags    Send flags
+ *
+ * Returned Value:
+ *   The number of datagrams queued.  The size of each is returned in its
+ *   msg_len field.  If the first datagram cannot be queued, a negated errno
+ *   value is returned.
+ *
+ ****************************************************************************/
+
+int psock_udp_sendmmsg(FAR struct socket *psock, FAR struct mmsghdr *msgvec,
+                       unsigned int vlen, int flags)
+{
+  FAR struct udp_conn_s *conn;
+  FAR struct udp_wrbuffer_s *wrb;
+  FAR struct msghdr *msg;
+  struct sockaddr_storage raddr;
+  FAR const struct sockaddr *to;
+  socklen_t tolen;
+  unsigned int nqueued;
+  bool notified = false;
+  bool nonblock;
+  size_t len;
+  int ret = OK;
+  int i;
+
+  conn = (FAR struct udp_conn_s *)psock->s_conn;
+  DEBUGASSERT(conn);
+
+  /* Make sure that we have the IP address mapping */
+
+  ret = sendto_addrmapping(psock, conn);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  nonblock = _SS_ISNONBLOCK(psock->s_flags) || (flags & MSG_DONTWAIT) != 0;
+
+  /* Set the socket state to sending */
+
+  psock->s_flags = _SS_SETSTATE(psock->s_flags, _SF_SEND);
+
+  net_lock();
+  for (nqueued = 0; nqueued < vlen; nqueued++)
+    {
+      msg = &msgvec[nqueued].msg_hdr;
+
+      if (msg->msg_iovlen < 0 ||
+          (msg->msg_iov == NULL && msg->msg_iovlen > 0))
+        {
+          ret = -EINVAL;
+          break;
+        }
+
+      if (msg->msg_controllen > 0)
+        {
+          ret = -EOPNOTSUPP;
+          break;
+        }
+
+      /* Get the destination of the datagram */
+
+      if (msg->msg_name != NULL && msg->msg_namelen > 0)
+        {
+          /* Apply the same checks as sendto() */
+
+          to    = (FAR const struct sockaddr *)msg->msg_name;
+          tolen = msg->msg_namelen;
+
+          ret = inet_sendto_checkaddr(psock, to, tolen);
+          if (ret < 0)
+            {
+              break;
+            }
+        }
+      else if (_SS_ISCONNECTED(psock->s_flags))
+        {
+          tolen = sendto_connaddr(conn, &raddr);
+          to    = (FAR const struct sockaddr *)&raddr;
+        }
+      else
+        {
+          ret = -EDESTADDRREQ;
+          break;
+        }
+
+      if (tolen > sizeof(struct sockaddr_storage))
+        {
+          ret = -EINVAL;
+          break;
+        }
+
+      for (len = 0, i = 0; i < msg->msg_iovlen; i++)
+        {
+          len += msg->msg_iov[i].iov_len;
+        }
+
+      msgvec[nqueued].msg_len = len;
+      if (len == 0)
+        {
+          /* Nothing is sent for an empty datagram (as with sendto()) */
+
+          continue;
+        }
+
+      /* Allocate a write buffer.  Careful, the network will be momentarily
+       * unlocked here.
+       */
+
+      wrb = udp_wrbuffer_alloc();
+      if (wrb == NULL)
+        {
+          nerr("ERROR: Failed to allocate write buffer\n");
+          ret = -ENOMEM;
+          break;
+        }
+
+      memcpy(&wrb->wb_dest, to, tolen);
+#ifdef CONFIG_NET_SOCKOPTS
+      wrb->wb_start = clock_systimer();
+#endif
+
+      /* Gather the user data into the write buffer.  We cannot wait for
+       * buffer space if the socket was opened non-blocking.
+       */
+
+      for (len = 0, i = 0; i < msg->msg_iovlen; i++)
+        {
+          BUF_DUMP("psock_udp_sendmmsg", msg->msg_iov[i].iov_base,
+                   msg->msg_iov[i].iov_len);
+
+          if (nonblock)
+            {
+              ret = iob_trycopyin(wrb->wb_iob, msg->msg_iov[i].iov_base,
+                                  msg->msg_iov[i].iov_len, len, false);
+            }
+          else
+            {
+              ret = iob_copyin(wrb->wb_iob, msg->msg_iov[i].iov_base,
+                               msg->msg_iov[i].iov_len, len, false);
+            }
+
+          if (ret < 0)
+            {
+              break;
+            }
+
+          len += msg->msg_iov[i].iov_len;
+        }
+
+      if (ret < 0)
+        {
+          udp_wrbuffer_release(wrb);
+          break;
+        }
+
+      UDP_WBDUMP("I/O buffer chain", wrb, wrb->wb_iob->io_pktlen, 0);
+
+      /* sendto_eventhandler() will send the datagrams in FIFO order */
+
+      sq_addlast(&wrb->wb_node, &conn->write_q);
+      ninfo("Queued WRB=%p pktlen=%u write_q(%p,%p)\n",
+            wrb, wrb->wb_iob->io_pktlen,
+            conn->write_q.head, conn->write_q.tail);
+
+      /* If the datagram is now at the head of the queue, set up its
+       * transfer (this also notifies the device).  Otherwise the transfer
+       * of the datagrams ahead of it is already set up, and the event
+       * handler will move on to this one.  As with sendto(), a datagram
+       * that cannot be sent is taken back off of the queue.
+       */
+
+      if (sq_peek(&conn->write_q) == &wrb->wb_node)
+        {
+          ret = sendto_next_transfer(psock, conn);
+          if (ret < 0)
+            {
+              (void)sq_remlast(&conn->write_q);
+              udp_wrbuffer_release(wrb);
+              break;
+            }
+
+          notified = true;
+        }
+    }
+
+  /* Notify the device once for the whole batch, unless that was already
+   * done when the first datagram was queued.
+   */
+
+  if (!notified && nqueued > 0 && conn->dev != NULL)
+    {
+      netdev_txnotify_dev(conn->dev);
+    }
+
+  net_unlock();
+
+  /* Set the socket state to idle */
+
+  psock->s_flags = _SS_SETSTATE(psock->s_flags, _SF_IDLE);
+
+  /* An error is reported only if nothing was queued */
+
+  return nqueued > 0 ? (int)nqueued : ret;
+}
+
 #endif /* CONFIG_NET && CONFIG_NET_UDP && CONFIG_NET_UDP_WRITE_BUFFERS */
@@ -92,6 +92,10 @@ const struct sock_intf_s g_usrsock_sockif =
   NULL,                       /* si_sendfile */
 #endif
   usrsock_recvfrom,           /* si_recvfrom */
+  NULL,                       /* si_sendmsg */
+  NULL,                       /* si_recvmsg */
+  NULL,                       /* si_sendmmsg */
+  NULL,                       /* si_recvmmsg */
   usrsock_sockif_close        /* si_close */
 };
 
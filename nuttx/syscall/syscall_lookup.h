@@ -201,6 +201,8 @@ SYSCALL_LOOKUP(up_assert,                  2, STUB_up_assert)
   SYSCALL_LOOKUP(write,                    3, STUB_write)
   SYSCALL_LOOKUP(pread,                    4, STUB_pread)
   SYSCALL_LOOKUP(pwrite,                   4, STUB_pwrite)
+  SYSCALL_LOOKUP(readv,                    3, STUB_readv)
+  SYSCALL_LOOKUP(writev,                   3, STUB_writev)
 #  ifdef CONFIG_FS_AIO
   SYSCALL_LOOKUP(aio_read,                 1, STUB_aio_read)
   SYSCALL_LOOKUP(aio_write,                1, STUB_aio_write)
@@ -264,6 +266,11 @@ SYSCALL_LOOKUP(up_assert,                  2, STUB_up_assert)
   SYSCALL_LOOKUP(sendfile,                 4, STUB_fs_sendifile)
 #  endif
 
+#  if defined(CONFIG_PIPES) && defined(CONFIG_DEV_PIPE_SPLICE)
+  SYSCALL_LOOKUP(splice,                   6, STUB_splice)
+  SYSCALL_LOOKUP(tee,                      4, STUB_tee)
+#  endif
+
 #  if !defined(CONFIG_DISABLE_MOUNTPOINT)
 #    if defined(CONFIG_FS_READABLE)
   SYSCALL_LOOKUP(mount,                    5, STUB_mount)
@@ -373,6 +380,10 @@ SYSCALL_LOOKUP(up_assert,                  2, STUB_up_assert)
   SYSCALL_LOOKUP(sendto,                   6, STUB_sendto)
   SYSCALL_LOOKUP(setsockopt,               5, STUB_setsockopt)
   SYSCALL_LOOKUP(socket,                   3, STUB_socket)
+  SYSCALL_LOOKUP(recvmsg,                  3, STUB_recvmsg)
+  SYSCALL_LOOKUP(sendmsg,                  3, STUB_sendmsg)
+  SYSCALL_LOOKUP(recvmmsg,                 5, STUB_recvmmsg)
+  SYSCALL_LOOKUP(sendmmsg,                 4, STUB_sendmmsg)
 #endif
 
 /* The following is defined only if CONFIG_TASK_NAME_SIZE > 0 */